@@ -0,0 +1,118 @@
+#include <Adore/Adore.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static std::vector<uint32_t> const VERTEX_SHADER = {
+#include <Shaders/Mesh.vert.inc>
+};
+
+static std::vector<uint32_t> const FRAGMENT_SHADER = {
+#include <Shaders/Mesh.frag.inc>
+};
+
+struct Vertex
+{
+    float position[3];
+    float normal[3];
+};
+
+// Every buffer is its own allocation, keep well under maxMemoryAllocationCount.
+static unsigned int const BUFFERS = 1024;
+static unsigned int const WARMUP = 30;
+static unsigned int const FRAMES = 300;
+
+// Binds every buffer once a frame, in scattered order, through shared_ptrs or handles. Both make
+// the same virtual call into the renderer, so the difference is only how the Vulkan buffer is
+// found: through the buffer object or in a dense pool. Only the binding loop is timed, not the
+// frame around it.
+template <typename Bind>
+static double benchmark(std::shared_ptr<Adore::Renderer>& renderer, std::shared_ptr<Adore::Shader>& shader,
+                        Bind const& bind)
+{
+    std::chrono::duration<double, std::nano> elapsed(0.0);
+
+    for (unsigned int frame = 0; frame < WARMUP + FRAMES; frame++)
+    {
+        renderer->window()->poll();
+        renderer->begin(shader);
+
+        auto start = std::chrono::steady_clock::now();
+        bind();
+        if (frame >= WARMUP) elapsed += std::chrono::steady_clock::now() - start;
+
+        renderer->end();
+    }
+
+    return elapsed.count() / (static_cast<double>(FRAMES) * BUFFERS * 2);
+}
+
+int main()
+{
+    auto context = Adore::Context::create(Adore::API::Vulkan, "Bind Benchmark", true);
+    auto window = Adore::Window::create(context, "Bind Benchmark");
+    auto renderer = Adore::Renderer::create(window);
+
+    Adore::LayoutDescriptor descriptor = {
+        {
+            { 0, 0, offsetof(Vertex, position), Adore::AttributeFormat::VEC3_FLOAT },
+            { 0, 1, offsetof(Vertex, normal), Adore::AttributeFormat::VEC3_FLOAT }
+        },
+        { { 0, sizeof(Vertex) } },
+        { { 0, 1, Adore::ShaderType::VERTEX, Adore::ResourceType::BUFFER } }
+    };
+
+    auto shader = Adore::Shader::create(window, {
+        { Adore::ShaderType::VERTEX, "", VERTEX_SHADER },
+        { Adore::ShaderType::FRAGMENT, "", FRAGMENT_SHADER }
+    }, descriptor);
+
+    Vertex triangle[3] = {};
+    uint16_t indices[3] = { 0, 1, 2 };
+
+    std::vector<std::shared_ptr<Adore::VertexBuffer>> vertexBuffers;
+    std::vector<std::shared_ptr<Adore::IndexBuffer>> indexBuffers;
+    for (unsigned int i = 0; i < BUFFERS; i++)
+    {
+        vertexBuffers.push_back(Adore::VertexBuffer::create(renderer, triangle, sizeof(triangle)));
+        indexBuffers.push_back(Adore::IndexBuffer::create(renderer, indices, sizeof(indices)));
+    }
+
+    // Scattered so the shared_ptr path reaches buffer objects spread over the heap.
+    std::mt19937 random(1);
+    std::shuffle(vertexBuffers.begin(), vertexBuffers.end(), random);
+    std::shuffle(indexBuffers.begin(), indexBuffers.end(), random);
+
+    std::vector<Adore::VertexBufferHandle> vertexHandles;
+    std::vector<Adore::IndexBufferHandle> indexHandles;
+    for (unsigned int i = 0; i < BUFFERS; i++)
+    {
+        vertexHandles.push_back(vertexBuffers[i]->handle());
+        indexHandles.push_back(indexBuffers[i]->handle());
+    }
+
+    double pointers = benchmark(renderer, shader, [&]()
+    {
+        for (unsigned int i = 0; i < BUFFERS; i++)
+        {
+            renderer->bind(vertexBuffers[i], 0);
+            renderer->bind(indexBuffers[i]);
+        }
+    });
+
+    double handles = benchmark(renderer, shader, [&]()
+    {
+        for (unsigned int i = 0; i < BUFFERS; i++)
+        {
+            renderer->bind(vertexHandles[i], 0);
+            renderer->bind(indexHandles[i]);
+        }
+    });
+
+    std::printf("%u buffers, %u frames\n", BUFFERS * 2, FRAMES);
+    std::printf("  shared_ptr  %8.1f ns/bind\n", pointers);
+    std::printf("  handle      %8.1f ns/bind\n", handles);
+}
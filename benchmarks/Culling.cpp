@@ -0,0 +1,61 @@
+#include <Adore/Culling.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Reports how many objects per millisecond CullingSet::cull gets through, objects are
+// scattered around the camera so roughly a quarter end up visible.
+static void benchmark(char const * name, size_t const& objects, bool const& boxes)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+    auto set = Adore::CullingSet::create();
+
+    for (size_t i = 0; i < objects; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        float radius = size(random);
+
+        if (boxes)
+            set->add(Adore::BoundingBox{ center - radius, center + radius }, static_cast<uint32_t>(i));
+        else
+            set->add(Adore::BoundingSphere{ center, radius }, static_cast<uint32_t>(i));
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Adore::Frustum frustum = Adore::Frustum::create(projection * view);
+
+    std::vector<uint32_t> visible;
+    set->cull(frustum, visible);
+
+    unsigned int iterations = static_cast<unsigned int>(std::max<size_t>(10, 20000000 / objects));
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < iterations; i++)
+        set->cull(frustum, visible);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    double perMillisecond = objects * iterations / elapsed.count();
+
+    std::printf("%-8s %8zu objects  %8zu visible  %12.0f objects/ms\n", name, objects, visible.size(), perMillisecond);
+}
+
+int main()
+{
+    std::printf("Kernel: %s\n", Adore::CullingSet::kernel());
+
+    for (size_t objects : { 10000, 100000, 1000000 })
+    {
+        benchmark("Spheres", objects, false);
+        benchmark("Boxes", objects, true);
+    }
+
+    return 0;
+}
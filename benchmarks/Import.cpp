@@ -0,0 +1,162 @@
+#include <Adore/Adore.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static std::vector<uint32_t> const VERTEX_SHADER = {
+#include <Shaders/Mesh.vert.inc>
+};
+
+static std::vector<uint32_t> const FRAGMENT_SHADER = {
+#include <Shaders/Mesh.frag.inc>
+};
+
+static unsigned int const INSTANCES = 50;
+static unsigned int const WARMUP = 10;
+static unsigned int const FRAMES = 120;
+
+// Sphere with its triangles shuffled, standing in for a mesh exported with no care for order.
+static Adore::ImportedMesh sphere(unsigned int const& rings, unsigned int const& segments)
+{
+    float const pi = 3.14159265f;
+    Adore::ImportedMesh mesh;
+
+    for (unsigned int r = 0; r <= rings; r++)
+    {
+        for (unsigned int s = 0; s <= segments; s++)
+        {
+            float theta = pi * r / rings, phi = 2.0f * pi * s / segments;
+            float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+            mesh.vertices.push_back({ { x, y, z }, { x, y, z },
+                                      { static_cast<float>(s) / segments, static_cast<float>(r) / rings } });
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (unsigned int r = 0; r < rings; r++)
+    {
+        for (unsigned int s = 0; s < segments; s++)
+        {
+            uint32_t a = r * (segments + 1) + s, b = a + 1, c = a + segments + 1, d = c + 1;
+            triangles.push_back({ a, b, c });
+            triangles.push_back({ b, d, c });
+        }
+    }
+
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+    for (auto const& triangle : triangles)
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+
+    return mesh;
+}
+
+// Average GPU time of a frame drawing the mesh INSTANCES times, all overlapping, so both
+// vertex processing and overdraw show up.
+static double gpuTime(std::shared_ptr<Adore::Renderer>& renderer, std::shared_ptr<Adore::Shader>& shader,
+                      std::shared_ptr<Adore::Mesh>& mesh)
+{
+    double total = 0.0;
+
+    for (unsigned int frame = 0; frame < WARMUP + FRAMES; frame++)
+    {
+        renderer->window()->poll();
+
+        renderer->begin(shader);
+        for (unsigned int i = 0; i < INSTANCES; i++)
+            renderer->draw(mesh, 0);
+        renderer->end();
+
+        // Timestamps lag a frame in flight behind, so warm up covers the frames before them too.
+        if (frame >= WARMUP) total += renderer->gpuTime();
+    }
+
+    return total / FRAMES;
+}
+
+int main(int argc, char ** argv)
+{
+    Adore::ImportedMesh source = argc > 1 ? Adore::importMesh(argv[1]) : sphere(150, 200);
+    std::printf("%zu vertices, %zu triangles\n", source.vertices.size(), source.indices.size() / 3);
+
+    // Overdraw runs its own cache pass, so it starts from the source again. Vertex fetch builds on it.
+    std::vector<std::pair<char const *, Adore::ImportedMesh>> stages;
+    stages.push_back({ "Unoptimised", source });
+
+    auto start = std::chrono::steady_clock::now();
+    Adore::ImportedMesh mesh = source;
+    Adore::optimizeVertexCache(mesh.indices, static_cast<uint32_t>(mesh.vertices.size()));
+    stages.push_back({ "Vertex cache", mesh });
+
+    mesh = source;
+    Adore::optimizeOverdraw(mesh.indices, mesh.vertices);
+    stages.push_back({ "Overdraw", mesh });
+
+    Adore::optimizeVertexFetch(mesh);
+    stages.push_back({ "Vertex fetch", mesh });
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("Optimised in %.1f ms\n", elapsed.count());
+
+    auto context = Adore::Context::create(Adore::API::Vulkan, "Import Benchmark");
+    auto window = Adore::Window::create(context, "Import Benchmark");
+    auto renderer = Adore::Renderer::create(window);
+
+    glm::mat4 viewProjection(1.0f);
+    auto camera = Adore::UniformBuffer::create(renderer, &viewProjection, sizeof(viewProjection));
+
+    auto createShader = [&](Adore::VertexStreams const& streams)
+    {
+        Adore::LayoutDescriptor descriptor = Adore::vertexLayout(streams);
+        descriptor.resources = { { 0, 1, Adore::ShaderType::VERTEX, Adore::ResourceType::BUFFER } };
+
+        auto shader = Adore::Shader::create(window, {
+            { Adore::ShaderType::VERTEX, "", VERTEX_SHADER },
+            { Adore::ShaderType::FRAGMENT, "", FRAGMENT_SHADER }
+        }, descriptor);
+        shader->attach(camera, 0);
+        return shader;
+    };
+
+    std::shared_ptr<Adore::Shader> shaders[] = {
+        createShader(Adore::VertexStreams::INTERLEAVED),
+        createShader(Adore::VertexStreams::SPLIT),
+        createShader(Adore::VertexStreams::QUANTIZED)
+    };
+    char const * const names[] = { "Interleaved", "Split", "Quantized" };
+
+    std::printf("%-14s  %-11s  %9s  %9s  %12s\n", "Stage", "Streams", "ACMR 16", "ACMR 32", "GPU ms/frame");
+
+    for (auto& stage : stages)
+    {
+        for (auto streams : { Adore::VertexStreams::INTERLEAVED, Adore::VertexStreams::SPLIT,
+                              Adore::VertexStreams::QUANTIZED })
+        {
+            auto gpuMesh = Adore::createMesh(renderer, stage.second, streams);
+
+            uint32_t width, height;
+            window->framebufferSize(width, height);
+
+            // Close enough to fill most of the screen.
+            auto const& bounds = gpuMesh->bounds();
+            glm::vec3 eye = bounds.center + glm::vec3(0.0f, 0.0f, bounds.radius * 2.0f);
+            viewProjection = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / height,
+                                              bounds.radius * 0.1f, bounds.radius * 4.0f) *
+                             glm::lookAt(eye, bounds.center, glm::vec3(0.0f, 1.0f, 0.0f));
+            camera->set(&viewProjection);
+
+            size_t index = static_cast<size_t>(streams);
+            double time = gpuTime(renderer, shaders[index], gpuMesh);
+
+            std::printf("%-14s  %-11s  %9.3f  %9.3f  %12.3f\n", stage.first, names[index],
+                        Adore::acmr(stage.second.indices, 16), Adore::acmr(stage.second.indices, 32), time);
+        }
+    }
+
+    return 0;
+}
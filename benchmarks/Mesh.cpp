@@ -0,0 +1,154 @@
+#include <Adore/Adore.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static std::vector<uint32_t> const VERTEX_SHADER = {
+#include <Shaders/Mesh.vert.inc>
+};
+
+static std::vector<uint32_t> const FRAGMENT_SHADER = {
+#include <Shaders/Mesh.frag.inc>
+};
+
+struct Vertex
+{
+    float position[3];
+    float normal[3];
+};
+
+static unsigned int const INSTANCES = 100;
+static unsigned int const FRAMES = 120;
+static float const FOV = glm::radians(60.0f);
+
+// Bumpy sphere sharing its vertices so every one of them can be collapsed.
+static void sphere(unsigned int const& rings, unsigned int const& segments,
+                   std::vector<Vertex>& vertices, std::vector<uint16_t>& indices)
+{
+    float const pi = 3.14159265f;
+    auto vertex = [&](float const& theta, float const& phi)
+    {
+        float bump = 1.0f + 0.05f * std::sin(7.0f * phi) * std::sin(5.0f * theta);
+        float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+        vertices.push_back({ { x * bump, y * bump, z * bump }, { x, y, z } });
+    };
+
+    vertex(0.0f, 0.0f);
+    for (unsigned int r = 1; r < rings; r++)
+        for (unsigned int s = 0; s < segments; s++)
+            vertex(pi * r / rings, 2.0f * pi * s / segments);
+    vertex(pi, 0.0f);
+
+    auto index = [&](unsigned int const& r, unsigned int const& s)
+    {
+        return static_cast<uint16_t>(1 + (r - 1) * segments + s % segments);
+    };
+    uint16_t bottom = static_cast<uint16_t>(vertices.size() - 1);
+
+    for (unsigned int s = 0; s < segments; s++)
+        indices.insert(indices.end(), { 0, index(1, s + 1), index(1, s) });
+
+    for (unsigned int r = 1; r < rings - 1; r++)
+    {
+        for (unsigned int s = 0; s < segments; s++)
+        {
+            uint16_t a = index(r, s), b = index(r, s + 1), c = index(r + 1, s), d = index(r + 1, s + 1);
+            indices.insert(indices.end(), { a, b, c, b, d, c });
+        }
+    }
+
+    for (unsigned int s = 0; s < segments; s++)
+        indices.insert(indices.end(), { bottom, index(rings - 1, s), index(rings - 1, s + 1) });
+}
+
+// Draws the mesh INSTANCES times a frame from distance away, with level of detail selection
+// or always at full detail. Frame times include presenting, so they are capped by vsync.
+static void benchmark(std::shared_ptr<Adore::Renderer>& renderer, std::shared_ptr<Adore::Shader>& shader,
+                      std::shared_ptr<Adore::UniformBuffer>& camera, std::shared_ptr<Adore::Mesh>& mesh,
+                      float const& distance, bool const& lod)
+{
+    uint32_t width, height;
+    renderer->window()->framebufferSize(width, height);
+
+    glm::vec3 eye(0.0f, 0.0f, distance);
+    glm::mat4 viewProjection = glm::perspective(FOV, static_cast<float>(width) / height, 0.1f, 1000.0f) *
+                               glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    camera->set(&viewProjection);
+
+    uint32_t level = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int frame = 0; frame < FRAMES; frame++)
+    {
+        renderer->window()->poll();
+
+        if (lod)
+            level = mesh->select(Adore::Mesh::screenSize(mesh->bounds(), eye, FOV, static_cast<float>(height)), level);
+
+        renderer->begin(shader);
+        for (unsigned int i = 0; i < INSTANCES; i++)
+            renderer->draw(mesh, level);
+        renderer->end();
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    double frameTime = elapsed.count() / FRAMES;
+    double triangles = static_cast<double>(mesh->levels()[level].indexCount / 3) * INSTANCES;
+
+    std::printf("%8.1f  %-4s  level %u  %10.0f triangles  %8.3f ms/frame  %10.1f M triangles/s\n",
+                distance, lod ? "LOD" : "Full", level, triangles, frameTime, triangles / frameTime / 1000.0);
+}
+
+int main()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint16_t> indices;
+    sphere(128, 256, vertices, indices);
+
+    auto start = std::chrono::steady_clock::now();
+    auto lods = Adore::Mesh::simplify(vertices.data(), static_cast<uint32_t>(vertices.size()), sizeof(Vertex), indices);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("Simplified %zu triangles into %zu levels in %.1f ms\n", indices.size() / 3, lods.levels.size(),
+                elapsed.count());
+    for (size_t i = 0; i < lods.levels.size(); i++)
+        std::printf("  level %zu  %8u triangles  error %f\n", i, lods.levels[i].indexCount / 3, lods.levels[i].error);
+
+    auto context = Adore::Context::create(Adore::API::Vulkan, "Mesh Benchmark");
+    auto window = Adore::Window::create(context, "Mesh Benchmark");
+    auto renderer = Adore::Renderer::create(window);
+
+    Adore::LayoutDescriptor descriptor = {
+        {
+            { 0, 0, offsetof(Vertex, position), Adore::AttributeFormat::VEC3_FLOAT },
+            { 0, 1, offsetof(Vertex, normal), Adore::AttributeFormat::VEC3_FLOAT }
+        },
+        { { 0, sizeof(Vertex) } },
+        { { 0, 1, Adore::ShaderType::VERTEX, Adore::ResourceType::BUFFER } }
+    };
+
+    auto shader = Adore::Shader::create(window, {
+        { Adore::ShaderType::VERTEX, "", VERTEX_SHADER },
+        { Adore::ShaderType::FRAGMENT, "", FRAGMENT_SHADER }
+    }, descriptor);
+
+    glm::mat4 viewProjection(1.0f);
+    auto camera = Adore::UniformBuffer::create(renderer, &viewProjection, sizeof(viewProjection));
+    shader->attach(camera, 0);
+
+    auto mesh = Adore::Mesh::create(renderer, vertices.data(), static_cast<uint32_t>(vertices.size()),
+                                    sizeof(Vertex), lods);
+
+    std::printf("%8s  %-4s  %s\n", "Distance", "Mode", "Results");
+    for (float distance : { 2.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f, 250.0f })
+    {
+        benchmark(renderer, shader, camera, mesh, distance, false);
+        benchmark(renderer, shader, camera, mesh, distance, true);
+    }
+
+    return 0;
+}
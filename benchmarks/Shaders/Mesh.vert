@@ -0,0 +1,17 @@
+#version 450
+
+layout(binding = 0) uniform Camera
+{
+    mat4 viewProjection;
+} camera;
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+layout(location = 0) out vec3 outNormal;
+
+void main()
+{
+    outNormal = normal;
+    gl_Position = camera.viewProjection * vec4(position, 1.0);
+}
@@ -0,0 +1,304 @@
+#include <Adore/Adore.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Microbenchmarks of Adore's hot paths, run on whatever Vulkan driver the loader picks. Frames go
+// to a headless surface unless --window is given, so no display is needed. For numbers that
+// compare across machines, point it at lavapipe:
+//     VK_DRIVER_FILES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json BenchmarkSuite --json out.json
+// and pass an earlier run with --baseline to flag every case whose median got slower by more
+// than --threshold percent (10 by default). Regressions make the exit code 2.
+static std::vector<uint32_t> const VERTEX_SHADER = {
+#include <Shaders/Mesh.vert.inc>
+};
+
+static std::vector<uint32_t> const FRAGMENT_SHADER = {
+#include <Shaders/Mesh.frag.inc>
+};
+
+struct Vertex
+{
+    float position[3];
+    float normal[3];
+};
+
+static unsigned int const SAMPLES = 20;
+// Objects created per sample, released outside the timed part.
+static unsigned int const BATCH = 32;
+static uint64_t const BUFFER_SIZE = 64 * 1024;
+static uint32_t const TEXTURE_SIZE = 256;
+
+struct Result
+{
+    std::string name;
+    std::string unit;
+    double median;
+    double mean;
+    double min;
+};
+
+// Runs sample SAMPLES times after one warm up run, each call returns its own measurement.
+static Result measure(std::string const& name, std::string const& unit, std::function<double()> const& sample)
+{
+    sample();
+
+    std::vector<double> values;
+    for (unsigned int i = 0; i < SAMPLES; i++)
+        values.push_back(sample());
+
+    std::sort(values.begin(), values.end());
+
+    double mean = 0.0;
+    for (double const& value : values)
+        mean += value / values.size();
+
+    Result result { name, unit, values[values.size() / 2], mean, values.front() };
+    std::printf("  %-24s %12.3f %-10s mean %12.3f  min %12.3f\n",
+                name.c_str(), result.median, unit.c_str(), result.mean, result.min);
+    return result;
+}
+
+template <typename F>
+static double elapsed(F const& work, double const& scale)
+{
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * scale;
+}
+
+static void writeJson(std::string const& path, std::vector<Result> const& results)
+{
+    std::ofstream file(path);
+    if (!file) throw std::runtime_error("Failed to open " + path);
+
+    file << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        Result const& result = results[i];
+        file << "    { \"name\": \"" << result.name << "\", \"unit\": \"" << result.unit
+             << "\", \"median\": " << result.median << ", \"mean\": " << result.mean
+             << ", \"min\": " << result.min << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+// Medians by name from a file writeJson() made, nothing else is read.
+static std::vector<std::pair<std::string, double>> readBaseline(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Failed to open " + path);
+
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::pair<std::string, double>> medians;
+
+    for (size_t at = text.find("\"name\""); at != std::string::npos; at = text.find("\"name\"", at))
+    {
+        size_t open = text.find('"', text.find(':', at) + 1);
+        size_t close = text.find('"', open + 1);
+        size_t median = text.find("\"median\"", close);
+        if (open == std::string::npos || close == std::string::npos || median == std::string::npos)
+            throw std::runtime_error(path + " is not a benchmark result");
+
+        medians.push_back({ text.substr(open + 1, close - open - 1),
+                            std::strtod(text.c_str() + text.find(':', median) + 1, nullptr) });
+        at = close;
+    }
+
+    return medians;
+}
+
+static void usage()
+{
+    std::fprintf(stderr,
+        "Usage: BenchmarkSuite [options]\n"
+        "Options:\n"
+        "  --json <file>       write the results as JSON\n"
+        "  --baseline <file>   compare against an earlier --json file\n"
+        "  --threshold <pct>   slowdown that counts as a regression, 10 by default\n"
+        "  --window            present to a shown window instead of a headless surface\n");
+}
+
+int main(int argc, char ** argv)
+{
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = 10.0;
+    bool headless = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (argument == "--baseline" && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (argument == "--threshold" && i + 1 < argc)
+            threshold = std::atof(argv[++i]);
+        else if (argument == "--window")
+            headless = false;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    auto context = Adore::Context::create(Adore::API::Vulkan, "Benchmark Suite", headless);
+    auto window = Adore::Window::create(context, "Benchmark Suite");
+    auto renderer = Adore::Renderer::create(window);
+
+    Adore::LayoutDescriptor descriptor = {
+        {
+            { 0, 0, offsetof(Vertex, position), Adore::AttributeFormat::VEC3_FLOAT },
+            { 0, 1, offsetof(Vertex, normal), Adore::AttributeFormat::VEC3_FLOAT }
+        },
+        { { 0, sizeof(Vertex) } },
+        { { 0, 1, Adore::ShaderType::VERTEX, Adore::ResourceType::BUFFER } }
+    };
+
+    std::vector<Adore::ShaderModule> modules = {
+        { Adore::ShaderType::VERTEX, "", VERTEX_SHADER },
+        { Adore::ShaderType::FRAGMENT, "", FRAGMENT_SHADER }
+    };
+
+    auto shader = Adore::Shader::create(window, modules, descriptor);
+
+    float viewProjection[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    auto camera = Adore::UniformBuffer::create(renderer, viewProjection, sizeof(viewProjection));
+    shader->attach(camera, 0);
+
+    std::vector<uint8_t> bytes(BUFFER_SIZE);
+    std::vector<uint8_t> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4, 128);
+
+    Vertex triangle[3] = {};
+    uint16_t indices[3] = { 0, 1, 2 };
+    auto vertices = Adore::VertexBuffer::create(renderer, triangle, sizeof(triangle));
+    auto triangleIndices = Adore::IndexBuffer::create(renderer, indices, sizeof(indices));
+
+    std::vector<Result> results;
+    std::printf("%u samples each, medians first\n", SAMPLES);
+
+    // Creation includes uploading the contents, which waits for the transfer.
+    results.push_back(measure("create_vertex_buffer", "us/buffer", [&]()
+    {
+        std::vector<std::shared_ptr<Adore::VertexBuffer>> buffers;
+        return elapsed([&]()
+        {
+            for (unsigned int i = 0; i < BATCH; i++)
+                buffers.push_back(Adore::VertexBuffer::create(renderer, bytes.data(), BUFFER_SIZE));
+        }, 1e6 / BATCH);
+    }));
+
+    results.push_back(measure("create_index_buffer", "us/buffer", [&]()
+    {
+        std::vector<std::shared_ptr<Adore::IndexBuffer>> buffers;
+        return elapsed([&]()
+        {
+            for (unsigned int i = 0; i < BATCH; i++)
+                buffers.push_back(Adore::IndexBuffer::create(renderer, bytes.data(), BUFFER_SIZE));
+        }, 1e6 / BATCH);
+    }));
+
+    results.push_back(measure("create_sampler", "us/sampler", [&]()
+    {
+        std::vector<std::shared_ptr<Adore::Sampler>> samplers;
+        return elapsed([&]()
+        {
+            for (unsigned int i = 0; i < BATCH; i++)
+                samplers.push_back(Adore::Sampler::create(renderer, pixels.data(), TEXTURE_SIZE, TEXTURE_SIZE,
+                                                          Adore::ImageFormat::RGBA8, Adore::Filter::LINEAR,
+                                                          Adore::Wrap::REPEAT));
+        }, 1e6 / BATCH);
+    }));
+
+    // Modules are cached after the first shader, as they are for an application's later ones.
+    results.push_back(measure("create_shader", "ms/shader", [&]()
+    {
+        std::shared_ptr<Adore::Shader> created;
+        return elapsed([&]() { created = Adore::Shader::create(window, modules, descriptor); }, 1e3);
+    }));
+
+    // An empty pass, submitted and presented. Headless, presenting neither shows nor waits for
+    // anything; with --window and vsync the result is the refresh interval instead.
+    results.push_back(measure("frame_begin_end", "us/frame", [&]()
+    {
+        window->poll();
+        return elapsed([&]()
+        {
+            renderer->begin(shader);
+            renderer->end();
+        }, 1e6);
+    }));
+
+    // set() and the pass's first draw, which binds the shader and copies changed uniforms.
+    results.push_back(measure("uniform_set_update", "ns/set", [&]()
+    {
+        window->poll();
+        renderer->begin(shader);
+        renderer->bind(vertices, 0);
+
+        viewProjection[15] += 1.0f;
+        double ns = elapsed([&]()
+        {
+            camera->set(viewProjection);
+            renderer->draw(3);
+        }, 1e9);
+
+        renderer->end();
+        return ns;
+    }));
+
+    // Only recording is timed, submitting and presenting the frame is not.
+    for (unsigned int draws : { 1000u, 10000u, 100000u })
+    {
+        results.push_back(measure("draw_record_" + std::to_string(draws / 1000) + "k", "ns/draw", [&]()
+        {
+            window->poll();
+            renderer->begin(shader);
+
+            double ns = elapsed([&]()
+            {
+                renderer->bind(vertices, 0);
+                renderer->bind(triangleIndices);
+                for (unsigned int i = 0; i < draws; i++)
+                    renderer->drawIndexed(3);
+            }, 1e9 / draws);
+
+            renderer->end();
+            return ns;
+        }));
+    }
+
+    if (!jsonPath.empty())
+        writeJson(jsonPath, results);
+
+    if (baselinePath.empty()) return 0;
+
+    unsigned int regressions = 0;
+    std::printf("Against %s, %.1f%% threshold\n", baselinePath.c_str(), threshold);
+
+    for (auto const& baseline : readBaseline(baselinePath))
+    {
+        auto result = std::find_if(results.begin(), results.end(),
+                                   [&](Result const& r) { return r.name == baseline.first; });
+        if (result == results.end() || baseline.second <= 0.0) continue;
+
+        double change = 100.0 * (result->median / baseline.second - 1.0);
+        bool regressed = change > threshold;
+        regressions += regressed;
+
+        std::printf("  %-24s %+8.1f%%%s\n", result->name.c_str(), change, regressed ? "  REGRESSION" : "");
+    }
+
+    return regressions ? 2 : 0;
+}
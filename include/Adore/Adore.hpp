@@ -7,5 +7,21 @@
 #include "Window.hpp"
 #include "Version.hpp"
 #include "Shader.hpp"
+#include "ShaderVariants.hpp"
 #include "Renderer.hpp"
-#include "Buffer.hpp"
\ No newline at end of file
+#include "Memory.hpp"
+#include "Buffer.hpp"
+#include "RenderTarget.hpp"
+#include "DrawList.hpp"
+#include "Bundle.hpp"
+#include "RenderQueue.hpp"
+#include "Culling.hpp"
+#include "Mesh.hpp"
+#include "OcclusionQuery.hpp"
+#include "Reflection.hpp"
+#include "AssetPack.hpp"
+#include "MeshImport.hpp"
+#include "Quantize.hpp"
+#include "TextureStreamer.hpp"
+#include "Handle.hpp"
+#include "Capture.hpp"
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Buffer.hpp>
+#include <Adore/Shader.hpp>
+
+#include <memory>
+#include <string>
+
+class MappedFile;
+
+namespace Adore
+{
+    enum class AssetType : uint32_t { SHADER, VERTICES, INDICES, TEXTURE, RAW };
+
+    // Packs are written by the AdorePack tool in the host's byte order: the header, every blob
+    // aligned to ASSET_PACK_ALIGNMENT, then the table of contents sorted by name.
+    constexpr char ASSET_PACK_MAGIC[4] = { 'A', 'D', 'P', 'K' };
+    constexpr uint32_t ASSET_PACK_VERSION = 1;
+    constexpr uint64_t ASSET_PACK_ALIGNMENT = 256;
+
+    struct ADORE_EXPORT AssetPackHeader
+    {
+        char     magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t reserved;
+        uint64_t toc;
+    };
+
+    struct ADORE_EXPORT AssetEntry
+    {
+        char      name[64];
+        AssetType type;
+        // ShaderType of shaders, ImageFormat of textures.
+        uint32_t  format;
+        uint32_t  width;
+        uint32_t  height;
+        uint64_t  offset;
+        uint64_t  size;
+    };
+
+    static_assert(sizeof(AssetPackHeader) == 24, "AssetPackHeader is part of the file format.");
+    static_assert(sizeof(AssetEntry) == 96, "AssetEntry is part of the file format.");
+
+    // A pack mapped into memory. Resources are copied out of the mapping into GPU memory, shader
+    // modules borrow it and keep the pack alive.
+    class ADORE_EXPORT AssetPack : public std::enable_shared_from_this<AssetPack>
+    {
+        std::unique_ptr<MappedFile> m_file;
+        AssetEntry const * m_entries = nullptr;
+        uint32_t m_count = 0;
+
+        AssetEntry const& get(std::string const& name, AssetType const& type) const;
+        // Only open() makes packs, shader() needs them owned by a shared_ptr.
+        AssetPack(std::string const& path);
+    public:
+        static std::shared_ptr<AssetPack> open(std::string const& path);
+
+        ~AssetPack();
+
+        // nullptr when the pack has no entry called name.
+        AssetEntry const * find(std::string const& name) const;
+        void const * data(AssetEntry const& entry) const;
+        uint32_t const& count() const { return m_count; }
+        AssetEntry const * entries() const { return m_entries; }
+
+        ShaderModule shader(std::string const& name);
+        std::shared_ptr<VertexBuffer> vertices(std::shared_ptr<Renderer>& renderer, std::string const& name);
+        std::shared_ptr<IndexBuffer> indices(std::shared_ptr<Renderer>& renderer, std::string const& name);
+        std::shared_ptr<Sampler> texture(std::shared_ptr<Renderer>& renderer, std::string const& name,
+                                         Filter const& filter = Filter::LINEAR, Wrap const& wrap = Wrap::REPEAT);
+    };
+}
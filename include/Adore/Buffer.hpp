@@ -2,6 +2,7 @@
 #include "Export.hpp"
 
 #include <Adore/Renderer.hpp>
+#include <Adore/Handle.hpp>
 
 #include <memory>
 
@@ -20,21 +21,27 @@ namespace Adore
     class ADORE_EXPORT IndexBuffer : public Buffer
     {
     protected:
+        IndexBufferHandle m_handle;
         IndexBuffer(std::shared_ptr<Renderer>& renderer) : Buffer(renderer) {};
     public:
         static std::shared_ptr<IndexBuffer> create(std::shared_ptr<Renderer>& renderer,
                                               void* pdata, uint64_t const& size);
         virtual ~IndexBuffer() = default;
+        // Valid for as long as the buffer lives.
+        IndexBufferHandle const& handle() const { return m_handle; }
     };
 
     class ADORE_EXPORT VertexBuffer : public Buffer
     {
     protected:
+        VertexBufferHandle m_handle;
         VertexBuffer(std::shared_ptr<Renderer>& renderer) : Buffer(renderer) {};
     public:
         static std::shared_ptr<VertexBuffer> create(std::shared_ptr<Renderer>& renderer,
                                               void* pdata, uint64_t const& size);
         virtual ~VertexBuffer() = default;
+        // Valid for as long as the buffer lives.
+        VertexBufferHandle const& handle() const { return m_handle; }
     };
 
     class ADORE_EXPORT UniformBuffer : public Buffer
@@ -71,6 +78,14 @@ namespace Adore
         CLAMP_TO_BORDER
     };
 
+    enum class ImageFormat
+    {
+        RGBA8,
+        RGBA8_SRGB,
+        RGBA16_FLOAT,
+        RGBA32_FLOAT
+    };
+
     class ADORE_EXPORT Sampler : public Buffer
     {
     protected:
@@ -79,6 +94,45 @@ namespace Adore
         static std::shared_ptr<Sampler> create(std::shared_ptr<Adore::Renderer>& renderer,
                                                const char* path, Filter const& filter,
                                                Wrap const& wrap);
+        // Tightly packed pixels already in format, nothing is decoded.
+        static std::shared_ptr<Sampler> create(std::shared_ptr<Adore::Renderer>& renderer,
+                                               void const * pixels, uint32_t const& width,
+                                               uint32_t const& height, ImageFormat const& format,
+                                               Filter const& filter, Wrap const& wrap);
         virtual ~Sampler() = default;
     };
+
+    // Device local buffer that shaders can read and write.
+    class ADORE_EXPORT StorageBuffer : public Buffer
+    {
+    protected:
+        uint64_t const m_size;
+        StorageBuffer(std::shared_ptr<Renderer>& renderer, uint64_t const& size)
+            : Buffer(renderer), m_size(size) {};
+    public:
+        // pdata can be nullptr for a zero filled buffer.
+        static std::shared_ptr<StorageBuffer> create(std::shared_ptr<Renderer>& renderer,
+                                                     void* pdata, uint64_t const& size);
+        virtual ~StorageBuffer() = default;
+        uint64_t const& size() { return m_size; }
+    };
+
+    // Image compute shaders can write to, it can also be attached as a Sampler.
+    class ADORE_EXPORT StorageImage : public Sampler
+    {
+    protected:
+        uint32_t const m_width;
+        uint32_t const m_height;
+        StorageImage(std::shared_ptr<Renderer>& renderer, uint32_t const& width, uint32_t const& height)
+            : Sampler(renderer), m_width(width), m_height(height) {};
+    public:
+        static std::shared_ptr<StorageImage> create(std::shared_ptr<Renderer>& renderer,
+                                                    uint32_t const& width, uint32_t const& height,
+                                                    ImageFormat const& format = ImageFormat::RGBA8,
+                                                    Filter const& filter = Filter::LINEAR,
+                                                    Wrap const& wrap = Wrap::CLAMP_TO_EDGE);
+        virtual ~StorageImage() = default;
+        uint32_t const& width() const { return m_width; }
+        uint32_t const& height() const { return m_height; }
+    };
 }
\ No newline at end of file
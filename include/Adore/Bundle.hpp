@@ -0,0 +1,38 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Renderer.hpp>
+
+#include <memory>
+
+namespace Adore
+{
+    class VertexBuffer;
+    class IndexBuffer;
+    class DrawList;
+
+    // Draw commands for content that does not change (static architecture, terrain). They are
+    // recorded to the GPU once and replayed each frame by Renderer::execute(); the recording is
+    // only rebuilt after the commands change or the window's swapchain is recreated.
+    class ADORE_EXPORT Bundle
+    {
+    protected:
+        std::shared_ptr<Renderer> m_renderer;
+        std::shared_ptr<Shader> m_shader;
+        Bundle(std::shared_ptr<Renderer>& renderer, std::shared_ptr<Shader>& shader)
+            : m_renderer(renderer), m_shader(shader) {};
+    public:
+        // shader has to be a window shader, it is bound at the start of the bundle.
+        static std::shared_ptr<Bundle> create(std::shared_ptr<Renderer>& renderer, std::shared_ptr<Shader>& shader);
+        virtual ~Bundle() = default;
+        std::shared_ptr<Renderer> renderer() { return m_renderer; }
+        std::shared_ptr<Shader> shader() { return m_shader; }
+        virtual void bind(std::shared_ptr<VertexBuffer>& buffer, uint32_t const& binding) = 0;
+        virtual void bind(std::shared_ptr<IndexBuffer>& buffer) = 0;
+        virtual void draw(uint32_t const& count) = 0;
+        virtual void drawIndexed(uint32_t const& count) = 0;
+        virtual void draw(std::shared_ptr<DrawList>& list) = 0;
+        // Removes every command so the bundle can be filled again.
+        virtual void clear() = 0;
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Adore
+{
+    // Layout of the files Renderer::capture() writes and AdoreReplay runs. Everything is in the
+    // writing machine's byte order. The file starts with CAPTURE_MAGIC, CAPTURE_VERSION and the
+    // window's width and height, all uint32, followed by records until the end of the file. Each
+    // record is a CaptureRecord byte and its fields. Ids are uint32 and count up from 1 across
+    // every kind of resource. Resources are written before the first call that uses them, with
+    // their contents at that point.
+    uint32_t const CAPTURE_MAGIC = 0x50434441; // "ADCP"
+    uint32_t const CAPTURE_VERSION = 1;
+
+    enum class CaptureRecord : uint8_t
+    {
+        // id, uint64 size, size bytes.
+        VERTEX_BUFFER, INDEX_BUFFER, UNIFORM_BUFFER,
+        // id, width, height, ImageFormat, Filter, Wrap (uint32 each), then the tightly packed pixels.
+        TEXTURE,
+        // id, module count, each module's ShaderType and word count followed by its SPIR-V words,
+        // then the LayoutDescriptor: attribute count and AttributeLayouts, binding count and
+        // BindingLayouts, resource count and ResourceLayouts, push constant bytes. Last the
+        // ShaderVariant: BlendMode, CullMode, Topology (uint32), depthTest, depthWrite,
+        // wireframe (uint8), float lineWidth, specialization count and SpecializationValues.
+        SHADER,
+        // shader id, binding, resource id. Written again whenever a shader's attachments change.
+        ATTACH_UNIFORM, ATTACH_SAMPLER,
+        // uniform id, uint64 size, size bytes.
+        SET_UNIFORM,
+        // shader id.
+        BEGIN,
+        END,
+        // vertex buffer id, binding.
+        BIND_VERTEX,
+        // index buffer id.
+        BIND_INDEX,
+        // count.
+        DRAW,
+        // count, first index.
+        DRAW_INDEXED,
+        // offset, size, size bytes.
+        PUSH,
+        // Closes a frame, double milliseconds since the last frame closed or the capture started.
+        FRAME,
+        // uint64 calls left out because a capture can not hold them, the last record.
+        SKIPPED
+    };
+}
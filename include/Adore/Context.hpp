@@ -9,9 +9,13 @@ namespace Adore
     class ADORE_EXPORT Context
     {
     public:
-        static std::shared_ptr<Context> create(API const& api, std::string const& appName);
+        // Windows of a headless context are never shown and present without waiting for a
+        // display (VK_EXT_headless_surface), for benchmarks and CI machines without one.
+        static std::shared_ptr<Context> create(API const& api, std::string const& appName,
+                                               bool const& headless = false);
         API const api;
-        Context(API const& api) : api(api) {};
+        bool const headless;
+        Context(API const& api, bool const& headless = false) : api(api), headless(headless) {};
         virtual ~Context() = default;
     };
 }
\ No newline at end of file
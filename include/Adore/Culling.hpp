@@ -0,0 +1,61 @@
+#pragma once
+#include "Export.hpp"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace Adore
+{
+    struct ADORE_EXPORT BoundingSphere
+    {
+        glm::vec3 center;
+        float     radius;
+    };
+
+    struct ADORE_EXPORT BoundingBox
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Planes point inwards, normalised so distances are in world units.
+    struct ADORE_EXPORT Frustum
+    {
+        glm::vec4 planes[6];
+        static Frustum create(glm::mat4 const& viewProjection);
+    };
+
+    // Bounding volumes stored structure of arrays so culling tests 4 (SSE) or 8 (AVX) objects
+    // per instruction, split over threads for large sets. Each volume carries an id, usually
+    // the index of its draw, which is what cull() returns for the visible ones.
+    class ADORE_EXPORT CullingSet
+    {
+    public:
+        static std::shared_ptr<CullingSet> create();
+        CullingSet() = default;
+
+        // Returns the slot of the volume, for set().
+        uint32_t add(BoundingSphere const& sphere, uint32_t const& id);
+        uint32_t add(BoundingBox const& box, uint32_t const& id);
+        void set(uint32_t const& slot, BoundingSphere const& sphere);
+        void set(uint32_t const& slot, BoundingBox const& box);
+        void clear();
+        size_t size() const { return m_sphereIds.size() + m_boxIds.size(); }
+
+        // Replaces visible with the ids of every volume at least partly inside frustum.
+        // Spheres come first, each in the order they were added.
+        void cull(Frustum const& frustum, std::vector<uint32_t>& visible) const;
+
+        // The widest kernel this CPU runs, "AVX", "SSE" or "Scalar".
+        static char const * kernel();
+
+    private:
+        // Spheres: centre and radius. Boxes: centre and half extents.
+        std::vector<float> m_sx, m_sy, m_sz, m_sr;
+        std::vector<uint32_t> m_sphereIds;
+        std::vector<float> m_bx, m_by, m_bz, m_ex, m_ey, m_ez;
+        std::vector<uint32_t> m_boxIds;
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Buffer.hpp>
+
+#include <vector>
+
+namespace Adore
+{
+    // Bounding sphere and indexed draw parameters of a single object.
+    struct ADORE_EXPORT DrawObject
+    {
+        float    center[3];
+        float    radius;
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t  vertexOffset;
+        uint32_t firstInstance;
+    };
+
+    // Objects are uploaded once, Renderer::cull() tests them against the camera frustum on the GPU
+    // and Renderer::draw() issues the visible ones with a single indirect draw.
+    class ADORE_EXPORT DrawList : public Buffer
+    {
+    protected:
+        uint32_t const m_count;
+        DrawListHandle m_handle;
+        DrawList(std::shared_ptr<Renderer>& renderer, uint32_t const& count)
+            : Buffer(renderer), m_count(count) {};
+    public:
+        static std::shared_ptr<DrawList> create(std::shared_ptr<Renderer>& renderer,
+                                                std::vector<DrawObject> const& objects);
+        virtual ~DrawList() = default;
+        uint32_t const& count() const { return m_count; }
+        // Valid for as long as the list lives.
+        DrawListHandle const& handle() const { return m_handle; }
+    };
+}
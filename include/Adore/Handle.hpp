@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Adore
+{
+    // 32 bit reference to a resource in its renderer's pool of T. The low 20 bits are its slot and
+    // the high 12 the slot's generation, which changes when the resource is destroyed, so a stale
+    // handle is recognised instead of reaching whatever reuses the slot. The default handle is null.
+    // Handles only mean something to the renderer that made them, or for shaders the window.
+    template <typename T>
+    struct Handle
+    {
+        static uint32_t const INDEX_BITS = 20;
+        static uint32_t const INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+        uint32_t value = 0;
+
+        uint32_t index() const { return value & INDEX_MASK; }
+        uint32_t generation() const { return value >> INDEX_BITS; }
+        bool null() const { return value == 0; }
+        bool operator==(Handle const& other) const { return value == other.value; }
+        bool operator!=(Handle const& other) const { return value != other.value; }
+    };
+
+    class VertexBuffer;
+    class IndexBuffer;
+    class Shader;
+    class DrawList;
+
+    using VertexBufferHandle = Handle<VertexBuffer>;
+    using IndexBufferHandle = Handle<IndexBuffer>;
+    using ShaderHandle = Handle<Shader>;
+    using DrawListHandle = Handle<DrawList>;
+}
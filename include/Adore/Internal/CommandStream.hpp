@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Arena calls are encoded into on one thread and decoded from on another, in the same order.
+// Values are copied as bytes, objects are held on to until the stream is cleared. Clearing keeps
+// the memory, so a reused stream stops allocating once it has seen its largest frame.
+class CommandStream
+{
+    std::vector<uint8_t> m_bytes;
+    std::vector<std::shared_ptr<void>> m_objects;
+    size_t m_read = 0;
+    size_t m_readObject = 0;
+
+public:
+    template <typename T>
+    void write(T const& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written.");
+        write(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void write(std::shared_ptr<T> const& object)
+    {
+        m_objects.push_back(std::const_pointer_cast<typename std::remove_const<T>::type>(object));
+    }
+
+    void write(void const * data, size_t const& size)
+    {
+        size_t offset = m_bytes.size();
+        m_bytes.resize(offset + size);
+        if (size) std::memcpy(m_bytes.data() + offset, data, size);
+    }
+
+    template <typename T>
+    T read()
+    {
+        T value;
+        std::memcpy(&value, read(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // Points into the stream, valid until it is cleared.
+    void const * read(size_t const& size)
+    {
+        void const * data = m_bytes.data() + m_read;
+        m_read += size;
+        return data;
+    }
+
+    // Objects come back in the order they were written, as the type they were written as.
+    template <typename T>
+    std::shared_ptr<T> object()
+    {
+        return std::static_pointer_cast<T>(m_objects[m_readObject++]);
+    }
+
+    bool empty() const { return m_bytes.empty() && m_objects.empty(); }
+    bool done() const { return m_read == m_bytes.size(); }
+
+    void clear()
+    {
+        m_bytes.clear();
+        m_objects.clear();
+        m_read = 0;
+        m_readObject = 0;
+    }
+};
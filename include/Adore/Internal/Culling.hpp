@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Adore/Internal/SIMD.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// Plane coefficients split into arrays so kernels can broadcast them, the abs values are for
+// the box test: a box is outside a plane if its centre is further out than its projected radius.
+struct CullPlanes
+{
+    float a[6], b[6], c[6], d[6];
+    float absA[6], absB[6], absC[6];
+};
+
+struct SphereArrays
+{
+    float const * x, * y, * z, * r;
+    uint32_t const * ids;
+};
+
+struct BoxArrays
+{
+    float const * x, * y, * z, * ex, * ey, * ez;
+    uint32_t const * ids;
+};
+
+// Each kernel writes the ids of the visible volumes in [begin, end) to out and returns how many,
+// out needs room for end - begin ids.
+size_t cullSpheresScalar(CullPlanes const& planes, SphereArrays const& spheres,
+                         size_t begin, size_t end, uint32_t * out);
+size_t cullBoxesScalar(CullPlanes const& planes, BoxArrays const& boxes,
+                       size_t begin, size_t end, uint32_t * out);
+
+#ifdef ADORE_SSE
+size_t cullSpheresSSE(CullPlanes const& planes, SphereArrays const& spheres,
+                      size_t begin, size_t end, uint32_t * out);
+size_t cullBoxesSSE(CullPlanes const& planes, BoxArrays const& boxes,
+                    size_t begin, size_t end, uint32_t * out);
+#endif
+
+#ifdef ADORE_AVX
+size_t cullSpheresAVX(CullPlanes const& planes, SphereArrays const& spheres,
+                      size_t begin, size_t end, uint32_t * out);
+size_t cullBoxesAVX(CullPlanes const& planes, BoxArrays const& boxes,
+                    size_t begin, size_t end, uint32_t * out);
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Adore/Handle.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <vector>
+
+// Values of type V kept contiguous and reached through Handle<T>. Removing swaps the last value
+// into the hole, so the values stay dense however resources come and go. Generations start at 1
+// and skip 0 when they wrap, so no live handle is ever null. Not thread safe.
+template <typename T, typename V>
+class HandlePool
+{
+    struct Slot
+    {
+        uint32_t dense;
+        uint32_t generation = 1;
+    };
+
+    std::vector<V> m_values;
+    // Slot of each value, to fix the slot up when another value is swapped into its place.
+    std::vector<uint32_t> m_owners;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+
+public:
+    Adore::Handle<T> insert(V const& value)
+    {
+        uint32_t slot;
+        if (!m_free.empty())
+        {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            if (m_slots.size() > Adore::Handle<T>::INDEX_MASK)
+                throw Adore::AdoreException("Too many live resources for their handles.");
+
+            slot = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+
+        m_slots[slot].dense = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(value);
+        m_owners.push_back(slot);
+
+        return { m_slots[slot].generation << Adore::Handle<T>::INDEX_BITS | slot };
+    }
+
+    void remove(Adore::Handle<T> const& handle)
+    {
+        if (!get(handle)) return;
+
+        Slot& slot = m_slots[handle.index()];
+        uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+
+        m_values[slot.dense] = m_values[last];
+        m_owners[slot.dense] = m_owners[last];
+        m_slots[m_owners[slot.dense]].dense = slot.dense;
+        m_values.pop_back();
+        m_owners.pop_back();
+
+        slot.generation = (slot.generation + 1) & (0xFFFFFFFFu >> Adore::Handle<T>::INDEX_BITS);
+        if (slot.generation == 0) slot.generation = 1;
+        m_free.push_back(handle.index());
+    }
+
+    // nullptr when the handle is null or stale.
+    V * get(Adore::Handle<T> const& handle)
+    {
+        if (handle.index() >= m_slots.size()) return nullptr;
+
+        Slot const& slot = m_slots[handle.index()];
+        return slot.generation == handle.generation() ? &m_values[slot.dense] : nullptr;
+    }
+
+    size_t size() const { return m_values.size(); }
+    V const * data() const { return m_values.data(); }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Just enough JSON to read glTF. Looking up a missing key or index gives a null value, so
+// optional properties can be read without checking for them first.
+class Json
+{
+public:
+    enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    static Json parse(char const * text, size_t const& size);
+
+    Type const& type() const { return m_type; }
+    bool isNull() const { return m_type == Type::NUL; }
+    double number(double const& fallback = 0.0) const { return m_type == Type::NUMBER ? m_number : fallback; }
+    bool boolean(bool const& fallback = false) const { return m_type == Type::BOOLEAN ? m_boolean : fallback; }
+    std::string const& string() const { return m_string; }
+    // Elements of an array, members of an object.
+    size_t size() const { return m_type == Type::OBJECT ? m_members.size() : m_elements.size(); }
+
+    Json const& operator[](size_t const& index) const;
+    Json const& operator[](char const * key) const;
+
+private:
+    Type m_type = Type::NUL;
+    bool m_boolean = false;
+    double m_number = 0.0;
+    std::string m_string;
+    std::vector<Json> m_elements;
+    std::vector<std::pair<std::string, Json>> m_members;
+
+    friend class JsonParser;
+};
@@ -2,6 +2,9 @@
 
 #include <Adore/Log.hpp>
 
+#include <string>
+#include <vector>
+
 #ifdef DEBUG
     static std::string const sevstrings[] = {"INFO", "WARN", "ERROR" };
     static std::string const sevcolors[] = {"\033[1;96m", "\033[1;93m", "\033[1;91m"};
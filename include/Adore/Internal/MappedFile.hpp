@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read only view of a whole file, mapped instead of copied.
+class MappedFile
+{
+    void const * m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void * m_mapping = nullptr;
+#endif
+public:
+    MappedFile(std::string const& path);
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    void const * data() const { return m_data; }
+    size_t const& size() const { return m_size; }
+};
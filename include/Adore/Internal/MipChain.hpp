@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every mip of an RGBA8 image down to 1x1, stored one after another from mip 0.
+struct MipChain
+{
+    uint32_t width;
+    uint32_t height;
+    std::vector<unsigned char> pixels;
+    // One more than there are levels, mip i is pixels[offsets[i]] up to pixels[offsets[i + 1]].
+    std::vector<size_t> offsets;
+
+    uint32_t levels() const { return static_cast<uint32_t>(offsets.size() - 1); }
+    uint32_t mipWidth(uint32_t const& level) const { return width >> level ? width >> level : 1; }
+    uint32_t mipHeight(uint32_t const& level) const { return height >> level ? height >> level : 1; }
+    // Bytes of mips first down to 1x1.
+    size_t bytes(uint32_t const& first) const { return offsets.back() - offsets[first]; }
+};
+
+// Box filters each mip from the one above it, odd sizes fold their last row and column into
+// the texels before them. sRGB colour is averaged in linear space, alpha as it is.
+MipChain buildMipChain(void const * pixels, uint32_t const& width, uint32_t const& height, bool const& srgb);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Adore/Internal/WorkerPool.hpp>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+// Picks enough threads that each gets at least perThread items, at most one per core.
+inline unsigned int threadCount(size_t const& count, size_t const& perThread)
+{
+    return std::max(1u, std::min<unsigned int>(std::thread::hardware_concurrency(), count / perThread));
+}
+
+// Runs job(thread, begin, end) over equal chunks of [0, count), chunk starts are a multiple of align.
+// The first chunk runs on the caller, the others on WorkerPool::shared(). Called from one of the
+// pool's own threads everything runs there, waiting on the pool from inside it could deadlock.
+template <typename Job>
+void parallel(unsigned int const& threads, size_t const& count, Job const& job, size_t const& align = 1)
+{
+    WorkerPool& pool = WorkerPool::shared();
+
+    if (threads <= 1 || pool.current())
+    {
+        job(0, 0, count);
+        return;
+    }
+
+    size_t chunk = (count + threads - 1) / threads;
+    chunk = (chunk + align - 1) / align * align;
+
+    std::vector<std::shared_future<void>> chunks;
+
+    for (unsigned int t = 1; t < threads; t++)
+    {
+        size_t begin = std::min(count, t * chunk), end = std::min(count, (t + 1) * chunk);
+        chunks.push_back(pool.submit([&job, t, begin, end] { job(t, begin, end); }));
+    }
+
+    // Every chunk refers to job, so all of them finish before anything is rethrown.
+    std::exception_ptr error;
+
+    try
+    {
+        job(0, 0, std::min(count, chunk));
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    for (auto& future : chunks)
+        future.wait();
+
+    if (error) std::rethrow_exception(error);
+
+    for (auto& future : chunks)
+        future.get();
+}
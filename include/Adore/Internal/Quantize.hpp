@@ -0,0 +1,8 @@
+#pragma once
+
+#include <Adore/Quantize.hpp>
+
+// Adore::quantize without SSE, which x86-64 builds never run otherwise. Tests compare the two.
+void quantizeScalar(Adore::AttributeFormat const& format, void * destination, uint32_t const& destinationStride,
+                    float const * source, uint32_t const& sourceStride, uint32_t const& components,
+                    size_t const& count);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Adore/Internal/CommandStream.hpp>
+#include <Adore/Internal/SpscQueue.hpp>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Thread replaying command streams recorded on another one. There are STREAMS of them, so one
+// can be recorded while the one before it is replayed, and recording waits when it gets further
+// ahead than that. Streams are handed over through lock-free queues in both directions.
+class RenderThread
+{
+public:
+    static size_t const STREAMS = 2;
+
+private:
+    // Shared with the thread, which may outlive this when it destroys its owner itself.
+    struct State
+    {
+        CommandStream streams[STREAMS];
+        SpscQueue<CommandStream*, STREAMS> submitted;
+        SpscQueue<CommandStream*, STREAMS> replayed;
+        std::function<void(CommandStream&)> replay;
+        std::atomic<bool> stopping { false };
+        // The first exception replay threw, nothing is replayed after it until it is rethrown.
+        std::exception_ptr error;
+        std::atomic<bool> failed { false };
+    };
+
+    std::shared_ptr<State> m_state;
+    std::thread m_thread;
+    CommandStream * m_recording;
+    std::vector<CommandStream*> m_spare;
+
+    static void run(std::shared_ptr<State> state);
+    void reclaim();
+    // Rethrows what replaying threw once, replaying starts again with the next stream.
+    void rethrow();
+public:
+    RenderThread(std::function<void(CommandStream&)> const& replay);
+    // Replays what was submitted first, recorded but unsubmitted commands are dropped.
+    ~RenderThread();
+    RenderThread(RenderThread const&) = delete;
+    RenderThread& operator=(RenderThread const&) = delete;
+    bool current() const { return std::this_thread::get_id() == m_thread.get_id(); }
+    // The stream to record into, recording thread only.
+    CommandStream& stream() { return *m_recording; }
+    // Hands the recorded stream over, waiting while the thread is a whole stream behind. Rethrows
+    // what replaying threw.
+    void submit();
+    // Waits until every submitted stream is replayed, the one being recorded is left for submit().
+    // Rethrows what replaying threw. Does nothing on the thread itself.
+    void finish();
+};
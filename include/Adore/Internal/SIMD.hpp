@@ -0,0 +1,7 @@
+#pragma once
+
+// SSE2 is part of x86-64, so it needs no runtime check. AVX is defined by the build when the
+// compiler supports it, callers still have to check the CPU.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ADORE_SSE
+#endif
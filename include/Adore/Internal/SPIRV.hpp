@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Adore/Shader.hpp>
+#include <Adore/Internal/MappedFile.hpp>
+
+#include <memory>
+#include <vector>
+
+// The words of a module, its own code, borrowed words or its file mapped into memory. Borrows
+// the module's code, so the module has to outlive it. Empty and misaligned modules, and ones
+// without the SPIR-V magic number, throw.
+class SPIRV
+{
+    std::shared_ptr<MappedFile> m_file;
+    // Whatever keeps the words alive, null when they are the module's code.
+    std::shared_ptr<uint32_t const> m_owner;
+    uint32_t const * m_words = nullptr;
+    size_t m_count = 0;
+public:
+    SPIRV(Adore::ShaderModule const& module);
+    uint32_t const * words() const { return m_words; }
+    size_t const& count() const { return m_count; }
+    // The words kept alive for as long as the pointer is held, sharing the pack or the mapping
+    // they are in. Only a module's own code is copied.
+    std::shared_ptr<uint32_t const> share() const;
+    bool equals(uint32_t const * words, size_t const& count) const;
+    // 64-bit FNV-1a of the words.
+    uint64_t hash() const;
+};
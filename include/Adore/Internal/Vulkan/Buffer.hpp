@@ -3,8 +3,52 @@
 #include <Adore/Buffer.hpp>
 #include <Adore/Internal/FramesInFlight.hpp>
 
+#include <Adore/Internal/Vulkan/Memory.hpp>
+#include <Adore/Internal/Vulkan/RenderGraph.hpp>
+
 #include <vulkan/vulkan.h>
 
+class VulkanRenderer;
+
+uint32_t memoryTypeIndex(uint32_t const& memoryTypeBits,
+                         VkPhysicalDevice const& physicalDevice,
+                         VkMemoryPropertyFlags const& properties);
+
+VkFormat getVulkanFormat(Adore::ImageFormat const& format);
+// Bytes per pixel.
+uint32_t getFormatSize(Adore::ImageFormat const& format);
+
+// More than one distinct queue family makes the resource VK_SHARING_MODE_CONCURRENT.
+// Memory is allocated through memory and has to be freed through it.
+void createBuffer(VulkanMemory& memory, VkDeviceSize size, VkBufferUsageFlags usage,
+                  VkMemoryPropertyFlags properties, Adore::MemoryCategory const& category,
+                  VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+                  std::vector<uint32_t> const& queueFamilies = {});
+
+void createImage(VulkanMemory& memory, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
+                 VkMemoryPropertyFlags properties, Adore::MemoryCategory const& category,
+                 VkImage& image, VkDeviceMemory& imageMemory,
+                 std::vector<uint32_t> const& queueFamilies = {}, uint32_t const& mipLevels = 1);
+
+// Device local buffer filled with pdata. Written in place when host visible memory covers the
+// device's local heap (integrated GPUs, resizable BAR), otherwise through a staging buffer.
+void uploadBuffer(VulkanRenderer * prenderer, void const * pdata, VkDeviceSize size,
+                  VkBufferUsageFlags usage, Adore::MemoryCategory const& category,
+                  VkBuffer& buffer, VkDeviceMemory& memory,
+                  std::vector<uint32_t> const& queueFamilies = {});
+
+VkImageView createImageView(VkDevice const& device, VkImage const& image,
+                            VkFormat format, VkImageAspectFlags aspect, uint32_t const& mipLevels = 1);
+
+// maxLod of VK_LOD_CLAMP_NONE samples every mip the view has.
+VkSampler createSampler(VkDevice const& device, VkPhysicalDevice const& physicalDevice,
+                        Adore::Filter const& filter, Adore::Wrap const& wrap, float const& maxLod = 0.0f);
+
+void copyBuffer(VulkanRenderer * prenderer, VkBuffer const& srcBuffer, VkBuffer const& dstBuffer, VkDeviceSize size);
+
+void transitionImageLayout(VulkanRenderer * prenderer, VkImage const& image,
+                           RenderGraph::Access const& from, RenderGraph::Access const& to);
+
 class VulkanBuffer
 {
 protected:
@@ -16,23 +60,29 @@ public:
     VkBuffer const& buffer() const { return m_buffer; }
 };
 
-class VulkanIndexBuffer : public VulkanBuffer, public Adore::IndexBuffer
+class VulkanIndexBuffer : public VulkanBuffer, public Adore::IndexBuffer,
+                          public std::enable_shared_from_this<VulkanIndexBuffer>
 {
+    VkDeviceSize m_size;
 public:
     VulkanIndexBuffer(std::shared_ptr<Adore::Renderer>& renderer,
                      void* pdata, uint64_t const& size);
     ~VulkanIndexBuffer();
+    VkDeviceSize const& size() const { return m_size; }
 };
 
-class VulkanVertexBuffer : public VulkanBuffer, public Adore::VertexBuffer
+class VulkanVertexBuffer : public VulkanBuffer, public Adore::VertexBuffer,
+                           public std::enable_shared_from_this<VulkanVertexBuffer>
 {
+    VkDeviceSize m_size;
 public:
     VulkanVertexBuffer(std::shared_ptr<Adore::Renderer>& renderer,
                      void* pdata, uint64_t const& size);
     ~VulkanVertexBuffer();
+    VkDeviceSize const& size() const { return m_size; }
 };
 
-class VulkanUniformBuffer : public Adore::UniformBuffer
+class VulkanUniformBuffer : public Adore::UniformBuffer, public std::enable_shared_from_this<VulkanUniformBuffer>
 {
     std::vector<VkBuffer> m_buffers;
     std::vector<VkDeviceMemory> m_memories;
@@ -43,22 +93,70 @@ public:
                         void* pdata, uint64_t const& size);
 
     void set(void const * pdata) override;
+    // What set() does once the renderer gets to it.
+    void store(void const * pdata);
     VkBuffer buffer(size_t const& index);
     void update(size_t const& index);
 
     ~VulkanUniformBuffer();
 };
 
-class VulkanSampler : public Adore::Sampler
+class VulkanImage
 {
+protected:
     VkImage m_image;
     VkDeviceMemory m_memory;
     VkImageView m_view;
     VkSampler m_sampler;
+    VkImageLayout m_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    VulkanImage() {};
+public:
+    virtual ~VulkanImage() {};
+    VkImage const& image() const { return m_image; }
+    VkImageView const& view() const { return m_view; }
+    VkSampler const& sampler() const { return m_sampler; }
+    // Layout the image is in whenever shaders read it.
+    VkImageLayout const& layout() const { return m_layout; }
+};
+
+class VulkanSampler : public VulkanImage, public Adore::Sampler
+{
+    // What the sampler was made with, for captures.
+    uint32_t m_width;
+    uint32_t m_height;
+    Adore::ImageFormat m_format;
+    Adore::Filter m_filter;
+    Adore::Wrap m_wrap;
+
+    void upload(void const * pixels, uint32_t const& width, uint32_t const& height, VkFormat const& format,
+                VkDeviceSize const& size, Adore::Filter const& filter, Adore::Wrap const& wrap);
 public:
     VulkanSampler(std::shared_ptr<Adore::Renderer>& renderer, const char* path,
                   Adore::Filter const& filter, Adore::Wrap const& wrap);
+    VulkanSampler(std::shared_ptr<Adore::Renderer>& renderer, void const * pixels,
+                  uint32_t const& width, uint32_t const& height, Adore::ImageFormat const& format,
+                  Adore::Filter const& filter, Adore::Wrap const& wrap);
     ~VulkanSampler();
-    VkImageView const& view() const { return m_view; }
-    VkSampler const& sampler() const { return m_sampler; }
+    uint32_t const& width() const { return m_width; }
+    uint32_t const& height() const { return m_height; }
+    Adore::ImageFormat const& format() const { return m_format; }
+    Adore::Filter const& filter() const { return m_filter; }
+    Adore::Wrap const& wrap() const { return m_wrap; }
+};
+
+class VulkanStorageBuffer : public VulkanBuffer, public Adore::StorageBuffer
+{
+public:
+    VulkanStorageBuffer(std::shared_ptr<Adore::Renderer>& renderer,
+                        void* pdata, uint64_t const& size);
+    ~VulkanStorageBuffer();
+};
+
+class VulkanStorageImage : public VulkanImage, public Adore::StorageImage
+{
+public:
+    VulkanStorageImage(std::shared_ptr<Adore::Renderer>& renderer,
+                       uint32_t const& width, uint32_t const& height, Adore::ImageFormat const& format,
+                       Adore::Filter const& filter, Adore::Wrap const& wrap);
+    ~VulkanStorageImage();
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Adore/Bundle.hpp>
+
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+class VulkanBundle : public Adore::Bundle
+{
+    std::vector<std::function<void(VkCommandBuffer const&)>> m_commands;
+    // One recording per frame in flight since each binds that frame's descriptor set.
+    std::vector<VkCommandBuffer> m_buffers;
+    // The command, swapchain and descriptor set versions each recording was made from.
+    std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> m_recorded;
+    uint64_t m_version = 1;
+    // The last started frame that executed a recording, which has to finish before its commands
+    // and command buffers are released.
+    uint64_t m_executed = 0;
+public:
+    VulkanBundle(std::shared_ptr<Adore::Renderer>& renderer, std::shared_ptr<Adore::Shader>& shader);
+    ~VulkanBundle();
+    // Re-records the frame's command buffer if it is stale, called each time the bundle is executed.
+    VkCommandBuffer const& record(uint32_t const& frame);
+    void bind(std::shared_ptr<Adore::VertexBuffer>& buffer, uint32_t const& binding) override;
+    void bind(std::shared_ptr<Adore::IndexBuffer>& buffer) override;
+    void draw(uint32_t const& count) override;
+    void drawIndexed(uint32_t const& count) override;
+    void draw(std::shared_ptr<Adore::DrawList>& list) override;
+    void clear() override;
+};
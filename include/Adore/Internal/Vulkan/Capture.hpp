@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Adore/Capture.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+class VulkanRenderer;
+class VulkanShader;
+class VulkanVertexBuffer;
+class VulkanIndexBuffer;
+class VulkanUniformBuffer;
+
+namespace Adore
+{
+    class Shader;
+    class UniformBuffer;
+    class Sampler;
+}
+
+// Writes what the renderer executes to a capture file, see Adore/Capture.hpp. Used from the
+// thread that executes the renderer's calls.
+class VulkanCapture
+{
+    VulkanRenderer * m_renderer;
+    std::ofstream m_file;
+    uint32_t m_frames;
+    uint64_t m_skipped = 0;
+    std::chrono::steady_clock::time_point m_frameStart;
+
+    // Buffers by handle, everything else by address. Holding the resources would keep their
+    // renderer alive, so a resource only keeps its id while it does.
+    struct Resource
+    {
+        uint32_t id;
+        std::weak_ptr<void> resource;
+    };
+    std::unordered_map<uint32_t, uint32_t> m_vertexIds;
+    std::unordered_map<uint32_t, uint32_t> m_indexIds;
+    std::unordered_map<void const *, Resource> m_ids;
+    uint32_t m_nextId = 1;
+    // Ids of the resources each shader had attached when it was last written.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_attached;
+
+    template <typename T>
+    void write(T const& value) { m_file.write(reinterpret_cast<char const *>(&value), sizeof(T)); }
+    void write(void const * data, size_t const& size) { m_file.write(static_cast<char const *>(data), size); }
+    void write(Adore::CaptureRecord const& record) { write<uint8_t>(static_cast<uint8_t>(record)); }
+
+    // The resource's id, and whether it is new to the capture.
+    std::pair<uint32_t, bool> id(std::unordered_map<uint32_t, uint32_t>& ids, uint32_t const& handle);
+    std::pair<uint32_t, bool> id(std::shared_ptr<void> const& resource);
+    uint32_t shader(std::shared_ptr<Adore::Shader> const& shader);
+    uint32_t uniform(std::shared_ptr<Adore::UniformBuffer> const& buffer);
+    uint32_t texture(std::shared_ptr<Adore::Sampler> const& sampler);
+    std::vector<uint8_t> readBuffer(VkBuffer const& buffer, VkDeviceSize const& size);
+public:
+    VulkanCapture(VulkanRenderer * prenderer, std::string const& path, uint32_t const& frames);
+    ~VulkanCapture();
+    bool done() const { return m_frames == 0; }
+    void begin(std::shared_ptr<Adore::Shader> const& shader);
+    // Ends the window's pass, and with it a frame.
+    void end();
+    void bind(VulkanVertexBuffer * pbuffer, uint32_t const& binding);
+    void bind(VulkanIndexBuffer * pbuffer);
+    void draw(uint32_t const& count);
+    void drawIndexed(uint32_t const& count, uint32_t const& firstIndex);
+    void push(void const * data, uint32_t const& size, uint32_t const& offset);
+    // Only buffers already in the capture, the others are written as they are when first used.
+    void set(VulkanUniformBuffer * pbuffer, void const * pdata);
+    void skip() { m_skipped++; }
+};
@@ -15,7 +15,7 @@ class VulkanContext : public Adore::Context
     std::vector<const char*> m_extensions;
 
 public:
-    VulkanContext(std::string const& appName);
+    VulkanContext(std::string const& appName, bool const& headless);
     ~VulkanContext();
 
     VkInstance const& instance() const { return m_instance; }
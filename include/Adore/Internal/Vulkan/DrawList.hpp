@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Adore/DrawList.hpp>
+#include <Adore/Shader.hpp>
+
+#include <vulkan/vulkan.h>
+
+class VulkanHiZ;
+
+class VulkanDrawList : public Adore::DrawList
+{
+    // Matches the std140 uniform block in Shaders/Cull.comp.
+    struct Frustum
+    {
+        float planes[6][4];
+        uint32_t count;
+        uint32_t compact;
+        uint32_t occlusion;
+        uint32_t levels;
+        float hizSize[2];
+        uint32_t padding[2];
+        float viewProjection[16];
+    } m_frustum;
+
+    bool m_compact;
+    std::shared_ptr<Adore::Shader> m_shader;
+    std::shared_ptr<Adore::UniformBuffer> m_uniform;
+    std::shared_ptr<Adore::StorageBuffer> m_objects;
+    std::shared_ptr<Adore::StorageBuffer> m_commands;
+    std::shared_ptr<Adore::StorageBuffer> m_visible;
+    // The Hi-Z each frame's descriptor set points at.
+    std::vector<uint64_t> m_hizVersions;
+public:
+    VulkanDrawList(std::shared_ptr<Adore::Renderer>& renderer, std::vector<Adore::DrawObject> const& objects);
+    ~VulkanDrawList();
+    // Column major view projection matrix, the planes are extracted from it.
+    void setFrustum(float const * viewProjection);
+    // Points frame's descriptor set at hiz, version tells pyramids apart. The occlusion test is
+    // skipped without a viewProjection. Takes effect with the next setFrustum().
+    void setOcclusion(uint32_t const& frame, VulkanHiZ const& hiz, uint64_t const& version,
+                      float const * viewProjection);
+    std::shared_ptr<Adore::Shader>& shader() { return m_shader; }
+    VkBuffer const& commands() const;
+    VkBuffer const& visible() const;
+    // Culled draws are packed and counted, otherwise they stay in place with no instances.
+    bool const& compact() const { return m_compact; }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include <Adore/Internal/Vulkan/Memory.hpp>
+
+#include <vulkan/vulkan.h>
+
+class VulkanRenderer;
+class VulkanWindow;
+
+// Hierarchical depth buffer built from the window's depth after the frame's pass. Level 0 is
+// half the window's size and every texel holds the farthest depth it covers, so anything
+// nearer than it at any level may be visible. The image stays in VK_IMAGE_LAYOUT_GENERAL.
+class VulkanHiZ
+{
+    VkDevice m_device;
+    VulkanMemory& m_memory;
+    VkImage m_image;
+    VkDeviceMemory m_imageMemory;
+    VkImageView m_view;
+    std::vector<VkImageView> m_levelViews;
+    VkSampler m_sampler;
+    VkDescriptorSetLayout m_setLayout;
+    VkDescriptorPool m_descriptorPool;
+    // Set i reads the level before i (the depth buffer for 0) and writes level i.
+    std::vector<VkDescriptorSet> m_sets;
+    VkPipelineLayout m_layout;
+    VkPipeline m_pipeline;
+    // Reads the multisampled depth buffer for level 0, the same as m_pipeline otherwise.
+    VkPipeline m_depthPipeline;
+    VkExtent2D m_depthExtent;
+    uint32_t m_samples;
+    VkExtent2D m_extent;
+    uint32_t m_levels;
+    uint64_t m_swapchainVersion;
+    bool m_placeholder;
+    void createReduction(VulkanWindow * pwindow);
+public:
+    // A placeholder is a single far texel for culling without occlusion, it can not be built.
+    VulkanHiZ(VulkanRenderer * prenderer, VulkanWindow * pwindow, bool const& placeholder = false);
+    ~VulkanHiZ();
+    // Records the reduction as a pass of the renderer's graph, which makes the window's depth
+    // readable before it and the pyramid visible to culling after it.
+    void build(VkCommandBuffer const& commandBuffer);
+    VkImage const& image() const { return m_image; }
+    VkImageView const& view() const { return m_view; }
+    VkSampler const& sampler() const { return m_sampler; }
+    VkExtent2D const& extent() const { return m_extent; }
+    uint32_t const& levels() const { return m_levels; }
+    // The swapchain the pyramid was made for, it has to be recreated with it.
+    uint64_t const& swapchainVersion() const { return m_swapchainVersion; }
+    bool const& placeholder() const { return m_placeholder; }
+};
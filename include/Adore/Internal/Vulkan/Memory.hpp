@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Adore/Memory.hpp>
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Every VkDeviceMemory Adore allocates goes through here, so usage can be told apart by heap and
+// category and checked against the driver's budget. Safe to use from any thread.
+class VulkanMemory
+{
+    struct Allocation
+    {
+        uint32_t heap;
+        VkDeviceSize size;
+        Adore::MemoryCategory category;
+    };
+
+    VkDevice m_device;
+    VkPhysicalDevice m_physicalDevice;
+    bool m_budgetExtension;
+    VkPhysicalDeviceMemoryProperties m_properties;
+
+    std::mutex m_mutex;
+    std::unordered_map<VkDeviceMemory, Allocation> m_allocations;
+    std::vector<uint64_t> m_heaps;
+    std::array<uint64_t, static_cast<size_t>(Adore::MemoryCategory::COUNT)> m_categories {};
+
+    float m_threshold = 1.0f;
+    std::function<void(Adore::MemoryStats const&)> m_callback;
+    bool m_crossed = false;
+
+    Adore::MemoryStats statsLocked();
+public:
+    VulkanMemory(VkDevice const& device, VkPhysicalDevice const& physicalDevice, bool const& budgetExtension);
+    VulkanMemory(VulkanMemory const&) = delete;
+    VulkanMemory& operator=(VulkanMemory const&) = delete;
+    VkDevice const& device() const { return m_device; }
+    VkPhysicalDevice const& physicalDevice() const { return m_physicalDevice; }
+    VkPhysicalDeviceMemoryProperties const& properties() const { return m_properties; }
+    // Throws with the heap's usage when the device is out of memory.
+    VkDeviceMemory allocate(VkDeviceSize const& size, uint32_t const& typeIndex, Adore::MemoryCategory const& category);
+    // VK_NULL_HANDLE is ignored.
+    void free(VkDeviceMemory const& memory);
+    Adore::MemoryStats stats();
+    // callback runs once each time a device local heap's usage rises past fraction of its budget,
+    // on the thread that allocated or ended the frame.
+    void threshold(float const& fraction, std::function<void(Adore::MemoryStats const&)> const& callback);
+    // Rereads the driver's budget, the renderer calls it once a frame.
+    void check();
+};
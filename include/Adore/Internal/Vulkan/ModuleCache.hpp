@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Adore/Shader.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// A VkShaderModule shared by every pipeline made from the same SPIR-V.
+struct VulkanModule
+{
+    VkDevice device;
+    VkShaderModule module;
+    // Compared on a hit, two modules with the same hash are not assumed to be the same. Shares
+    // the pack or file mapping the words are in rather than copying them.
+    std::shared_ptr<uint32_t const> words;
+    size_t count;
+    ~VulkanModule() { vkDestroyShaderModule(device, module, nullptr); }
+};
+
+// Device wide modules keyed by the hash of their SPIR-V. A module lives as long as something
+// holds it, preloaded ones as long as the cache.
+class VulkanModuleCache
+{
+    VkDevice m_device;
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, std::weak_ptr<VulkanModule>> m_modules;
+    std::vector<std::shared_ptr<VulkanModule>> m_preloaded;
+public:
+    VulkanModuleCache(VkDevice const& device) : m_device(device) {};
+    std::shared_ptr<VulkanModule> get(Adore::ShaderModule const& module);
+    // Creates a module for every .spv file in directory, returns how many there were. Throws on
+    // files that are empty, misaligned or not SPIR-V.
+    uint32_t preload(std::string const& directory);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Adore/OcclusionQuery.hpp>
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+class VulkanOcclusionQuery : public Adore::OcclusionQuery
+{
+    // One pool per frame in flight, so a frame's results can be read while the next is recorded.
+    std::vector<VkQueryPool> m_pools;
+    // Indices each frame began, and ones it decided were visible without querying.
+    std::vector<std::vector<bool>> m_written;
+    std::vector<std::vector<bool>> m_forced;
+    std::vector<bool> m_visible;
+    std::vector<uint64_t> m_results;
+public:
+    VulkanOcclusionQuery(std::shared_ptr<Adore::Renderer>& renderer, uint32_t const& count);
+    ~VulkanOcclusionQuery();
+    bool visible(uint32_t const& index) const override;
+    VkQueryPool const& pool(uint32_t const& frame) const { return m_pools[frame]; }
+    // Marks index as written by frame, throws if it already was.
+    void write(uint32_t const& frame, uint32_t const& index, bool const& forced = false);
+    // Reads the results of frame's finished queries and resets its pool.
+    void resolve(VkCommandBuffer const& commandBuffer, uint32_t const& frame);
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <Adore/Internal/Vulkan/Memory.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Passes declare the images / buffers they read and write, compile() orders and culls them,
+// aliases transient images in memory and works out the batched barriers between passes.
+// Passes without an execute are recorded by the caller as they happen (the renderer's
+// begin() / end()), they keep the order they were declared in and are never culled.
+
+class RenderGraph
+{
+public:
+    using Resource = uint32_t;
+    using Execute = std::function<void(VkCommandBuffer const&, RenderGraph const&)>;
+
+    enum class Access
+    {
+        NONE,
+        COLOR_ATTACHMENT, DEPTH_ATTACHMENT, DEPTH_READ,
+        FRAGMENT_SAMPLED, COMPUTE_SAMPLED,
+        COMPUTE_READ, COMPUTE_WRITE,
+        TRANSFER_SRC, TRANSFER_DST,
+        VERTEX_BUFFER, INDEX_BUFFER, INDIRECT_BUFFER, UNIFORM_BUFFER,
+        PRESENT
+    };
+
+    struct AccessInfo
+    {
+        VkPipelineStageFlags stage;
+        VkAccessFlags access;
+        VkImageLayout layout;
+        bool write;
+    };
+
+    struct ImageInfo
+    {
+        VkFormat format;
+        VkExtent2D extent;
+        VkImageUsageFlags usage;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+        uint32_t levels = 1;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        Execute execute;
+        uint32_t index;
+        std::vector<std::pair<Resource, Access>> reads;
+        std::vector<std::pair<Resource, Access>> writes;
+        bool sideEffects = false;
+
+        Pass& read(Resource const& resource, Access const& access);
+        Pass& write(Resource const& resource, Access const& access);
+        // Never cull this pass, even if nothing reads what it writes.
+        Pass& keep() { sideEffects = true; return *this; }
+    };
+
+    static AccessInfo info(Access const& access);
+    // Covers the first levels mips.
+    static void barrier(VkCommandBuffer const& commandBuffer, VkImage const& image,
+                        VkImageAspectFlags const& aspect, Access const& from, Access const& to,
+                        uint32_t const& levels = 1);
+
+    RenderGraph(VkDevice const& device, VulkanMemory& memory);
+    ~RenderGraph();
+
+    RenderGraph(RenderGraph const&) = delete;
+    RenderGraph& operator=(RenderGraph const&) = delete;
+
+    Resource image(std::string const& name, ImageInfo const& info);
+    // An image imported as NONE is undefined at the start of every execution, its first use still
+    // waits for the passes of the last one.
+    Resource import(std::string const& name, VkImage const& image, VkImageView const& view,
+                    VkImageAspectFlags const& aspect, Access const& initial, Access const& final,
+                    uint32_t const& levels = 1);
+    Resource import(std::string const& name, VkBuffer const& buffer, Access const& initial, Access const& final);
+    // Swap the handles of an imported resource (eg. the swapchain image) without recompiling.
+    void update(Resource const& resource, VkImage const& image, VkImageView const& view);
+    void update(Resource const& resource, VkBuffer const& buffer);
+
+    Pass& pass(std::string const& name, Execute const& execute = nullptr);
+
+    void compile();
+    void execute(VkCommandBuffer const& commandBuffer);
+    // Runs the live passes in [first, last) of the compiled order after their barriers, the final
+    // barriers follow when last is livePasses().
+    void execute(VkCommandBuffer const& commandBuffer, size_t const& first, size_t const& last);
+    // Where a pass runs in the compiled order, livePasses() when it was culled.
+    size_t position(Pass const& pass) const;
+    void clear();
+
+    bool empty() const { return m_passes.empty(); }
+    bool compiled() const { return m_compiled; }
+    VkImage const& image(Resource const& resource) const { return m_resources[resource].image; }
+    VkImageView const& view(Resource const& resource) const { return m_resources[resource].view; }
+    VkBuffer const& buffer(Resource const& resource) const { return m_resources[resource].buffer; }
+    VkExtent2D const& extent(Resource const& resource) const { return m_resources[resource].info.extent; }
+    size_t livePasses() const { return m_order.size(); }
+    size_t barrierCount() const;
+    VkDeviceSize transientMemory() const { return m_transientMemory; }
+
+private:
+    struct ResourceEntry
+    {
+        std::string name;
+        bool isImage;
+        bool transient;
+        ImageInfo info;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        Access initial = Access::NONE;
+        Access final = Access::NONE;
+        uint32_t block = UINT32_MAX;
+    };
+
+    struct ImageBarrier
+    {
+        Resource resource;
+        VkAccessFlags srcAccess, dstAccess;
+        VkImageLayout oldLayout, newLayout;
+    };
+
+    struct BufferBarrier
+    {
+        Resource resource;
+        VkAccessFlags srcAccess, dstAccess;
+    };
+
+    struct Batch
+    {
+        VkPipelineStageFlags srcStage = 0;
+        VkPipelineStageFlags dstStage = 0;
+        std::vector<ImageBarrier> images;
+        std::vector<BufferBarrier> buffers;
+        bool empty() const { return images.empty() && buffers.empty(); }
+    };
+
+    VkDevice const& m_device;
+    VulkanMemory& m_memory;
+
+    std::vector<ResourceEntry> m_resources;
+    std::deque<Pass> m_passes;
+    std::vector<uint32_t> m_order;
+    std::vector<Batch> m_batches;
+    Batch m_final;
+    std::vector<VkDeviceMemory> m_blocks;
+    VkDeviceSize m_transientMemory = 0;
+    bool m_compiled = false;
+
+    void sort();
+    void cull();
+    void allocate();
+    void schedule();
+    void release();
+    void record(VkCommandBuffer const& commandBuffer, Batch const& batch) const;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Adore/RenderTarget.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+
+#include <vulkan/vulkan.h>
+
+class VulkanRenderTarget : public VulkanImage, public Adore::RenderTarget
+{
+    VkFormat m_format;
+    bool m_depth;
+    VkImage m_depthImage = VK_NULL_HANDLE;
+    VkDeviceMemory m_depthMemory = VK_NULL_HANDLE;
+    VkImageView m_depthView = VK_NULL_HANDLE;
+    VkRenderPass m_renderPass;
+    VkFramebuffer m_framebuffer;
+public:
+    VulkanRenderTarget(std::shared_ptr<Adore::Renderer>& renderer,
+                       uint32_t const& width, uint32_t const& height,
+                       Adore::ImageFormat const& format, bool const& depth,
+                       Adore::Filter const& filter, Adore::Wrap const& wrap);
+    ~VulkanRenderTarget();
+    VkRenderPass const& renderPass() const { return m_renderPass; }
+    VkFramebuffer const& framebuffer() const { return m_framebuffer; }
+    VkImage const& depthImage() const { return m_depthImage; }
+    VkImageView const& depthView() const { return m_depthView; }
+    VkExtent2D extent() const { return { m_width, m_height }; }
+    bool const& depth() const { return m_depth; }
+};
@@ -1,10 +1,27 @@
 #pragma once
 #include <Adore/Renderer.hpp>
+#include <Adore/RenderQueue.hpp>
+#include <Adore/Internal/HandlePool.hpp>
+#include <Adore/Internal/RenderThread.hpp>
+#include <Adore/Internal/Vulkan/RenderGraph.hpp>
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 
+class VulkanShader;
+class VulkanRenderTarget;
+class VulkanDrawList;
+class VulkanOcclusionQuery;
+class VulkanHiZ;
+class VulkanUniformBuffer;
+class VulkanVertexBuffer;
+class VulkanIndexBuffer;
+class VulkanCapture;
+
 class VulkanRenderer : public Adore::Renderer
 {
     VkCommandPool m_commandPool;
@@ -14,16 +31,194 @@ class VulkanRenderer : public Adore::Renderer
     std::vector<VkFence> m_framesInFlight;
     uint32_t m_currentFrame = 0;
     std::pair<VkResult, uint32_t> m_swapchainImage;
+    bool m_frameStarted = false;
+
+    // The frame's passes as a graph: the render targets' and the window's in the order they were
+    // begun (null for the window's), then the Hi-Z build. It is rebuilt when a frame's passes
+    // differ from the ones it was built for, or its swapchain or pyramid changes.
+    std::shared_ptr<RenderGraph> m_graph;
+    std::vector<VulkanRenderTarget*> m_graphShape;
+    std::vector<RenderGraph::Pass*> m_graphPasses;
+    std::vector<VulkanRenderTarget*> m_framePasses;
+    size_t m_graphCursor = 0;
+    uint64_t m_graphSwapchain = 0;
+    uint64_t m_graphHiZ = 0;
+    RenderGraph::Resource m_swapchainResource = 0;
+    RenderGraph::Resource m_colorResource = 0;
+    RenderGraph::Resource m_depthResource = 0;
+
+    VulkanRenderTarget * m_target = nullptr;
+    bool m_inRenderPass = false;
+    VkExtent2D m_extent;
+
+    // Passes begin lazily: direct draws record inline, bundles need secondary contents.
+    enum class Contents { NONE, INLINE, SECONDARY } m_contents = Contents::NONE;
+    VulkanShader * m_shader = nullptr;
+    std::vector<std::vector<VkCommandBuffer>> m_secondaryBuffers;
+    size_t m_secondaryUsed = 0;
+    VkCommandBuffer m_inlineBuffer = VK_NULL_HANDLE;
+
+    // Shaders that share a pipeline only record their dynamic state, reset whenever a command
+    // buffer starts or executes others.
+    VkCommandBuffer m_boundBuffer = VK_NULL_HANDLE;
+    VkPipeline m_boundPipeline = VK_NULL_HANDLE;
+
+    // Compute writes not yet made visible, and graphics reads compute must not overwrite.
+    bool m_computeWrites = false;
+    bool m_graphicsReads = false;
+
+    VkCommandPool m_computePool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> m_computeBuffers;
+    std::vector<VkSemaphore> m_computeFinished;
+    bool m_asyncRecording = false;
+    bool m_asyncWrites = false;
+
+    std::vector<VulkanOcclusionQuery*> m_queries;
+    VulkanOcclusionQuery * m_activeQuery = nullptr;
+    uint32_t m_activeIndex = 0;
+    std::shared_ptr<Adore::Shader> m_boxShader;
+
+    // The pyramid is built from the frame's depth with the view projection of its last cull().
+    bool m_occlusion = false;
+    std::unique_ptr<VulkanHiZ> m_hiz;
+    uint64_t m_hizVersion = 0;
+    bool m_hizValid = false;
+    bool m_frameCulled = false;
+    float m_frameViewProjection[16];
+    float m_hizViewProjection[16];
+
+    Adore::PendingShaders m_pending = Adore::PendingShaders::WAIT;
+    std::shared_ptr<Adore::Shader> m_fallback;
+
+    // A pair of timestamps around each frame in flight.
+    VkQueryPool m_timestamps = VK_NULL_HANDLE;
+    std::vector<bool> m_timed;
+    float m_timestampPeriod = 0.0f;
+    std::atomic<float> m_gpuTime { 0.0f };
+    std::atomic<uint64_t> m_startedFrames { 0 };
+
+    // Released once the last frame that may use it has finished.
+    struct Retired
+    {
+        std::function<void()> release;
+        uint64_t frame;
+    };
+
+    std::vector<Retired> m_retired;
+
+public:
+    // Binding only needs the VkBuffer, the owner is for captures.
+    template <typename T>
+    struct PooledBuffer
+    {
+        VkBuffer buffer;
+        T * owner;
+    };
+
+private:
+    // Every live vertex buffer, index buffer and draw list of the renderer, in no particular order.
+    HandlePool<Adore::VertexBuffer, PooledBuffer<VulkanVertexBuffer>> m_vertexBuffers;
+    HandlePool<Adore::IndexBuffer, PooledBuffer<VulkanIndexBuffer>> m_indexBuffers;
+    HandlePool<Adore::DrawList, VulkanDrawList*> m_drawLists;
+
+    std::unique_ptr<VulkanCapture> m_capture;
+
+    // With a render thread, calls from any other thread are encoded and replayed on it a frame at
+    // a time, which is handed over when the window's pass ends.
+    enum class Command : uint8_t;
+    std::unique_ptr<RenderThread> m_thread;
+    bool m_recordingTarget = false;
+
+    bool deferred() const { return m_thread && !m_thread->current(); }
+    // Encodes the call when it is deferred, and returns whether it was.
+    template <typename... Args>
+    bool record(Command const& command, Args const&... args);
+    void replay(CommandStream& stream);
+    // Render queue packets copied out of the stream, which does not keep them aligned.
+    std::vector<Adore::DrawPacket> m_replayedPackets;
+    // The capture when the current pass is the window's, otherwise the call is counted as left out.
+    VulkanCapture * captured();
+
+    void startFrame();
+    void buildGraph(std::vector<VulkanRenderTarget*> const& passes);
+    // Records the graph up to the barriers of the pass being begun.
+    void enterPass();
+    void updateUniforms(VulkanShader * pshader);
+    void beginRendering(VkRenderingFlags const& flags);
+    void beginPass(Contents const& contents);
+    VkCommandBuffer drawBuffer();
+    void flushInline();
+    void drawPackets(std::vector<Adore::DrawPacket> const& packets);
+    VulkanShader * computeShader(VulkanShader * pshader);
+    void computeBarrier(VkPipelineStageFlags const& dstStage, VkAccessFlags const& dstAccess);
+    void createHiZ();
+    VulkanShader * boxShader();
+    // The pipeline to draw with in place of pshader, null when its draws are skipped.
+    VulkanShader * usable(VulkanShader * pshader);
 public:
-    VulkanRenderer(std::shared_ptr<Adore::Window>& win);
+    VulkanRenderer(std::shared_ptr<Adore::Window>& win, bool const& renderThread);
     ~VulkanRenderer();
     VkCommandBuffer beginCommandBuffer();
     void endCommandBuffer(VkCommandBuffer const& commandBuffer);
+    VkCommandPool const& commandPool() const { return m_commandPool; }
+    // Buffers and draw lists add themselves when created and remove themselves when destroyed.
+    HandlePool<Adore::VertexBuffer, PooledBuffer<VulkanVertexBuffer>>& vertexBuffers() { return m_vertexBuffers; }
+    HandlePool<Adore::IndexBuffer, PooledBuffer<VulkanIndexBuffer>>& indexBuffers() { return m_indexBuffers; }
+    HandlePool<Adore::DrawList, VulkanDrawList*>& drawLists() { return m_drawLists; }
+    // Begins a secondary command buffer that continues the window's pass.
+    void beginSecondary(VkCommandBuffer const& commandBuffer);
+    void bindShader(VkCommandBuffer const& commandBuffer, VulkanShader * pshader);
+    void drawIndirect(VkCommandBuffer const& commandBuffer, VulkanDrawList * plist);
+    static void setViewport(VkCommandBuffer const& commandBuffer, VkExtent2D const& extent);
+    // Queries register themselves so their results are read as frames finish.
+    void track(VulkanOcclusionQuery * pquery);
+    void untrack(VulkanOcclusionQuery * pquery);
+    // Render targets leave the frame graph when they are destroyed.
+    void untrack(VulkanRenderTarget * ptarget);
+    // Uniform contents change in order with the calls around them, on the render thread if any.
+    void set(std::shared_ptr<VulkanUniformBuffer> const& buffer, void const * pdata);
     void begin(std::shared_ptr<Adore::Shader>& shader) override;
+    void begin(std::shared_ptr<Adore::RenderTarget>& target, std::shared_ptr<Adore::Shader>& shader) override;
     void bind(std::shared_ptr<Adore::VertexBuffer>& buffer, uint32_t const& binding) override;
     // void bind(std::shared_ptr<Adore::UniformBuffer>& buffer, uint32_t const& binding) override;
     void bind(std::shared_ptr<Adore::IndexBuffer>& buffer) override;
+    void begin(Adore::ShaderHandle const& shader) override;
+    void begin(std::shared_ptr<Adore::RenderTarget>& target, Adore::ShaderHandle const& shader) override;
+    void bind(Adore::VertexBufferHandle const& buffer, uint32_t const& binding) override;
+    void bind(Adore::IndexBufferHandle const& buffer) override;
+    void draw(Adore::DrawListHandle const& list) override;
+    void dispatch(Adore::ShaderHandle const& shader, uint32_t const& x,
+                  uint32_t const& y, uint32_t const& z) override;
+    void cull(Adore::DrawListHandle const& list, float const * viewProjection) override;
     void draw(uint32_t const& count) override;
     void drawIndexed(uint32_t const& count) override;
+    void push(void const * data, uint32_t const& size, uint32_t const& offset) override;
+    void draw(std::shared_ptr<Adore::Mesh>& mesh, uint32_t const& level) override;
+    void draw(std::shared_ptr<Adore::DrawList>& list) override;
+    void execute(std::shared_ptr<Adore::Bundle>& bundle) override;
+    void draw(std::shared_ptr<Adore::RenderQueue>& queue) override;
+    void beginQuery(std::shared_ptr<Adore::OcclusionQuery>& query, uint32_t const& index) override;
+    void endQuery(std::shared_ptr<Adore::OcclusionQuery>& query, uint32_t const& index) override;
+    void query(std::shared_ptr<Adore::OcclusionQuery>& query, std::vector<Adore::BoundingBox> const& boxes,
+               float const * viewProjection) override;
     void end() override;
-};
\ No newline at end of file
+    void dispatch(std::shared_ptr<Adore::Shader>& shader, uint32_t const& x,
+                  uint32_t const& y, uint32_t const& z) override;
+    void dispatchIndirect(std::shared_ptr<Adore::Shader>& shader, std::shared_ptr<Adore::StorageBuffer>& buffer,
+                          uint64_t const& offset) override;
+    void dispatchAsync(std::shared_ptr<Adore::Shader>& shader, uint32_t const& x,
+                       uint32_t const& y, uint32_t const& z) override;
+    void cull(std::shared_ptr<Adore::DrawList>& list, float const * viewProjection) override;
+    void occlusionCulling(bool const& enable) override;
+    void pendingShaders(Adore::PendingShaders const& mode, std::shared_ptr<Adore::Shader> const& fallback) override;
+    void finish() override;
+    void capture(std::string const& path, uint32_t const& frames) override;
+    float gpuTime() const override { return m_gpuTime; }
+    // Frames started so far, all but the last FRAMES_IN_FLIGHT of them have finished on the GPU.
+    uint64_t startedFrames() const { return m_startedFrames; }
+    uint64_t finishedFrames() const;
+    // Runs release once frame has finished on the GPU, or when the renderer is destroyed.
+    void retire(uint64_t const& frame, std::function<void()> release);
+    Adore::MemoryStats memoryStats() const override;
+    void memoryThreshold(float const& fraction, std::function<void(Adore::MemoryStats const&)> const& callback) override;
+};
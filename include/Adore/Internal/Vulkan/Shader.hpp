@@ -1,27 +1,108 @@
 #pragma once
 
 #include <Adore/Shader.hpp>
+#include <Adore/Internal/FramesInFlight.hpp>
 #include <Adore/Internal/Vulkan/Window.hpp>
 
+#include <atomic>
+#include <future>
+
 #include <vulkan/vulkan.h>
 
 
-class VulkanShader : public Adore::Shader
+// Fixed function state built-in shaders change, user shaders always get the defaults.
+struct PipelineState
+{
+    bool depthWrite = true;
+    bool colorWrite = true;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    // Bytes of push constants, visible to every stage.
+    uint32_t pushConstants = 0;
+    bool depthTest = true;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    Adore::BlendMode blend = Adore::BlendMode::NONE;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    float lineWidth = 1.0f;
+    std::vector<Adore::SpecializationValue> specialization = {};
+};
+
+// A pipeline and the modules it was made from, shared by every shader that only differs from
+// it in state the device lets the renderer set while recording.
+struct VulkanPipeline
+{
+    VkDevice device = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    std::vector<std::shared_ptr<VulkanModule>> modules;
+    // Set once pipeline is made, which may happen on a compiler thread.
+    std::atomic<bool> ready { false };
+    std::shared_future<void> compiled;
+    ~VulkanPipeline() { vkDestroyPipeline(device, pipeline, nullptr); }
+};
+
+PipelineState pipelineState(Adore::ShaderVariant const& variant);
+// The variant that makes state, as far as variants cover it.
+Adore::ShaderVariant shaderVariant(PipelineState const& state);
+
+class VulkanImage;
+
+class VulkanShader : public Adore::Shader, public std::enable_shared_from_this<VulkanShader>
 {
-    VkDescriptorPool m_descriptorPool;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
     std::vector<VkDescriptorSet> m_descriptorSets;
     VkPipelineLayout m_pipelineLayout;
     VkDescriptorSetLayout m_descriptorSetLayout;
-    VkPipeline m_pipeline;
+    VkRenderPass m_renderPass;
+    VkPipelineBindPoint m_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    std::shared_ptr<VulkanPipeline> m_pipeline;
+    // Kept to derive variants from.
+    std::vector<Adore::ShaderModule> m_sources;
+    PipelineState m_state;
+    bool m_windowPass = true;
+    bool m_useDepth = true;
+    // The view each frame's set holds for every attached sampler, streamed textures change theirs.
+    struct SampledView
+    {
+        uint32_t binding;
+        VulkanImage * image;
+        VkImageView written[FRAMES_IN_FLIGHT];
+    };
+    std::vector<SampledView> m_views;
+    std::vector<uint64_t> m_setVersions = std::vector<uint64_t>(FRAMES_IN_FLIGHT, 0);
+    // The frame each set was last refreshed for.
+    std::vector<uint64_t> m_refreshed = std::vector<uint64_t>(FRAMES_IN_FLIGHT, 0);
+
+    void createLayout();
+    // Shares base's pipeline when it is compatible, otherwise builds one.
+    void build(VulkanShader * base, bool const& async);
+    void createPipeline();
 public:
     VulkanShader(std::shared_ptr<Adore::Window>& win,
                 std::vector<Adore::ShaderModule> const& modules,
-                Adore::LayoutDescriptor const& descriptor);
+                Adore::LayoutDescriptor const& descriptor,
+                VkRenderPass const& renderPass = VK_NULL_HANDLE, bool const& depth = false,
+                PipelineState const& state = {}, bool const& async = false);
+    VulkanShader(VulkanShader& base, PipelineState const& state, bool const& async);
     ~VulkanShader();
     void attach(std::shared_ptr<Adore::UniformBuffer>& buffer, uint32_t const& binding);
     void attach(std::shared_ptr<Adore::Sampler>& buffer, uint32_t const& binding);
-    VkPipeline const& pipeline() const { return m_pipeline; };
+    void attach(std::shared_ptr<Adore::StorageBuffer>& buffer, uint32_t const& binding);
+    void attach(std::shared_ptr<Adore::StorageImage>& image, uint32_t const& binding);
+    bool ready() const override { return m_pipeline->ready.load(std::memory_order_acquire); };
+    void wait() override { if (m_pipeline->compiled.valid()) m_pipeline->compiled.get(); };
+    std::shared_ptr<Adore::Shader> derive(Adore::ShaderVariant const& variant, bool const& async) override;
+    // Sets the state the pipeline left dynamic, after it is bound.
+    void recordState(VkCommandBuffer const& commandBuffer) const;
+    VkPipeline const& pipeline() const { return m_pipeline->pipeline; };
+    VkRenderPass const& renderPass() const { return m_renderPass; };
+    VkPipelineBindPoint const& bindPoint() const { return m_bindPoint; };
+    std::vector<Adore::ShaderModule> const& sources() const { return m_sources; };
+    PipelineState const& state() const { return m_state; };
+    // Empty when the shader has no resources.
     std::vector<VkDescriptorSet> const& descriptorSets() const { return m_descriptorSets; };
+    // Rewrites frame's set for samplers whose view changed, once that frame's last submission
+    // has finished. Only the first call for started writes, later ones may follow a bind of the
+    // set in the same command buffer. Returns the set's version, which every write bumps.
+    uint64_t refresh(uint32_t const& frame, uint64_t const& started);
     VkPipelineLayout const& layout() const
     {
         return m_pipelineLayout;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Adore/TextureStreamer.hpp>
+#include <Adore/Internal/MipChain.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Mips are never changed in place: each residency is a new image of just the mips from first
+// down, so the image shaders are sampling stays valid until every frame using it has finished.
+class VulkanStreamedTexture : public VulkanImage, public Adore::StreamedTexture
+{
+    friend class VulkanTextureStreamer;
+    std::shared_ptr<MipChain const> m_mips;
+    VkFormat m_format;
+    // Mip 0 of m_image.
+    uint32_t m_resident;
+    // Coarsest mip that is always resident.
+    uint32_t m_tail;
+    // First mip once the upload in flight finishes, m_resident when there is none.
+    uint32_t m_target;
+    std::atomic<uint32_t> m_requested;
+    // Finest mip last requested and the update it was requested in.
+    uint32_t m_wanted;
+    uint64_t m_lastUsed = 0;
+public:
+    VulkanStreamedTexture(std::shared_ptr<Adore::Renderer>& renderer, std::shared_ptr<MipChain const> const& mips,
+                          VkFormat const& format, Adore::Filter const& filter, Adore::Wrap const& wrap);
+    ~VulkanStreamedTexture();
+    void request(uint32_t const& mip) override;
+    uint32_t resident() const override { return m_resident; }
+};
+
+class VulkanTextureStreamer : public Adore::TextureStreamer
+{
+    struct Residency
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        uint64_t bytes = 0;
+    };
+
+    // Pixels are copied into staging on a worker, the copy to the image is submitted once they are.
+    struct Upload
+    {
+        std::weak_ptr<VulkanStreamedTexture> texture;
+        uint32_t first;
+        Residency residency;
+        VkBuffer staging = VK_NULL_HANDLE;
+        VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+        std::shared_future<void> staged;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+    };
+
+    // Destroyed once the last frame that may have bound it has finished.
+    struct Retired
+    {
+        Residency residency;
+        uint64_t frame;
+    };
+
+    VkCommandPool m_commandPool;
+    std::vector<std::weak_ptr<VulkanStreamedTexture>> m_textures;
+    std::vector<Upload> m_uploads;
+    std::vector<Retired> m_retired;
+    uint64_t m_update = 1;
+    // Bytes of every image alive, a replaced one lives on until its replacement is uploaded and
+    // frames have stopped sampling it.
+    uint64_t m_allocated = 0;
+
+    Residency createResidency(VulkanStreamedTexture const& texture, uint32_t const& first);
+    void destroy(Residency const& residency);
+    void destroy(Upload const& upload);
+    void recordCopy(VkCommandBuffer const& commandBuffer, Upload const& upload, MipChain const& mips);
+    void swap(VulkanStreamedTexture& texture, Upload const& upload);
+    // Starts streaming texture's mips from first down.
+    void schedule(std::shared_ptr<VulkanStreamedTexture> const& texture, uint32_t const& first);
+    // Drops mips of textures not requested in this update, oldest first, then mips finer than
+    // the ones requested, until bytes are freed. Returns the bytes freed once the uploads finish
+    // and adds to uploaded.
+    uint64_t evict(std::vector<std::shared_ptr<VulkanStreamedTexture>>& textures, uint64_t const& bytes,
+                   uint64_t& uploaded);
+public:
+    VulkanTextureStreamer(std::shared_ptr<Adore::Renderer>& renderer, uint64_t const& budget);
+    ~VulkanTextureStreamer();
+    std::shared_ptr<Adore::StreamedTexture> load(const char* path, Adore::Filter const& filter,
+                                                 Adore::Wrap const& wrap) override;
+    std::shared_ptr<Adore::StreamedTexture> load(void const * pixels, uint32_t const& width,
+                                                 uint32_t const& height, Adore::ImageFormat const& format,
+                                                 Adore::Filter const& filter, Adore::Wrap const& wrap) override;
+    void update() override;
+    uint64_t used() const override;
+};
@@ -1,8 +1,13 @@
 #pragma once
 #include <Adore/Internal/Window.hpp>
 #include <Adore/Internal/Vulkan/Context.hpp>
+#include <Adore/Internal/Vulkan/Memory.hpp>
+#include <Adore/Internal/Vulkan/ModuleCache.hpp>
+#include <Adore/Internal/WorkerPool.hpp>
+#include <Adore/Internal/HandlePool.hpp>
 
 #include <memory>
+#include <mutex>
 
 
 // Check for swapchain support.
@@ -10,23 +15,43 @@
 // Make swapchain into class and resize() reset the swapchain.
 // (call Window::resize(...); swapchain->rebuild();)
 
+class VulkanShader;
+
 class Swapchain
 {
     VkDevice const& m_device;
+    VulkanMemory& m_memory;
 
     std::vector<VkImage> m_images;
     std::vector<VkImageView> m_imageViews;
     std::vector<VkFramebuffer> m_framebuffers;
 
+    // Shared by every swapchain image, the colour image only exists when multisampling. With
+    // dynamic rendering the renderer's graph has its own, and depth is only here when readable.
+    VkImage m_colorImage = VK_NULL_HANDLE;
+    VkDeviceMemory m_colorMemory = VK_NULL_HANDLE;
+    VkImageView m_colorView = VK_NULL_HANDLE;
+    VkImage m_depthImage = VK_NULL_HANDLE;
+    VkDeviceMemory m_depthMemory = VK_NULL_HANDLE;
+    VkImageView m_depthView = VK_NULL_HANDLE;
+
     VkSwapchainKHR m_swapchain;
 public:
-    Swapchain(VkDevice const& device, VkSurfaceKHR const& surface, VkSurfaceFormatKHR const& format,
-                     VkPresentModeKHR const& mode, uint32_t imageCount, VkExtent2D const& extent,
-                     std::vector<uint32_t> const& queueIndices, VkRenderPass const& renderPass); // remove queueIndices later.
+    Swapchain(VkDevice const& device, VulkanMemory& memory, VkSurfaceKHR const& surface,
+                     VkSurfaceFormatKHR const& format, VkPresentModeKHR const& mode, uint32_t imageCount,
+                     VkExtent2D const& extent, std::vector<uint32_t> const& queueIndices, // remove queueIndices later.
+                     VkRenderPass const& renderPass, VkSampleCountFlagBits const& samples, VkFormat const& depthFormat,
+                     bool const& readableDepth);
     ~Swapchain();
     VkSwapchainKHR const& get() const { return m_swapchain; };
-    // std::vector<VkImageView> const& imageViews() const { return m_imageViews; };
+    std::vector<VkImage> const& images() const { return m_images; };
+    std::vector<VkImageView> const& imageViews() const { return m_imageViews; };
+    // Empty when rendering dynamically.
     std::vector<VkFramebuffer> const& framebuffers() const { return m_framebuffers; };
+    VkImage const& colorImage() const { return m_colorImage; };
+    VkImageView const& colorView() const { return m_colorView; };
+    VkImage const& depthImage() const { return m_depthImage; };
+    VkImageView const& depthView() const { return m_depthView; };
 };
 
 class VulkanWindow : public Window
@@ -34,38 +59,117 @@ class VulkanWindow : public Window
     VkSurfaceKHR m_surface;
     VkPhysicalDevice m_physicalDevice;
     VkDevice m_device;
-    VkRenderPass m_renderPass;
+    VkRenderPass m_renderPass = VK_NULL_HANDLE;
+    VkRenderPass m_depthStorePass = VK_NULL_HANDLE;
+    bool m_readableDepth = false;
     VkSurfaceCapabilitiesKHR m_capabilities;
     VkSurfaceFormatKHR m_format;
+    VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits m_samples = VK_SAMPLE_COUNT_1_BIT;
+    VkPhysicalDeviceFeatures m_features;
+    VkPhysicalDeviceLimits m_limits;
+    bool m_drawIndirectCount = false;
+    bool m_dynamicRendering = false;
+    bool m_dynamicState = false;
     VkExtent2D m_extent;
     VkPresentModeKHR m_mode;
     uint32_t m_imageCount;
 
     std::vector<VkPresentModeKHR> m_presentModes;
     std::unique_ptr<Swapchain> m_swapchain;
+    uint64_t m_swapchainVersion = 0;
+    std::unique_ptr<VulkanModuleCache> m_modules;
+    std::unique_ptr<VulkanMemory> m_memory;
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    std::unique_ptr<WorkerPool> m_workers;
+    std::recursive_mutex m_mutex;
+    HandlePool<Adore::Shader, VulkanShader*> m_shaders;
+
+public:
+    // VK_EXT_extended_dynamic_state3 commands, null when the extension is not enabled.
+    struct DynamicState3
+    {
+        PFN_vkCmdSetPolygonModeEXT setPolygonMode = nullptr;
+        PFN_vkCmdSetColorBlendEnableEXT setColorBlendEnable = nullptr;
+        PFN_vkCmdSetColorBlendEquationEXT setColorBlendEquation = nullptr;
+        PFN_vkCmdSetColorWriteMaskEXT setColorWriteMask = nullptr;
+    };
+
+    // Core in 1.2 and 1.3, loaded from the KHR extensions on older devices. Null when unsupported.
+    struct Commands
+    {
+        PFN_vkCmdBeginRendering beginRendering = nullptr;
+        PFN_vkCmdEndRendering endRendering = nullptr;
+        PFN_vkCmdDrawIndexedIndirectCount drawIndexedIndirectCount = nullptr;
+    };
+
+private:
+    DynamicState3 m_dynamicState3;
+    Commands m_commands;
 
     struct Queues
     {
         VkQueue graphics;
         VkQueue present;
+        VkQueue compute;
     } m_queues;
 
     struct QueueIndices
     {
         uint32_t graphics;
         uint32_t present;
+        uint32_t compute;
     } m_queueIndices;
 
 public:
-    VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string const& title);
+    VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string const& title, uint32_t const& samples);
     ~VulkanWindow();
+    // Headless surfaces are never out of date, so their swapchain is recreated here.
+    void resize(int const& width, int const& height) override;
     VkDevice const& device() const { return m_device; };
     Queues const& queues() const { return m_queues; };
     QueueIndices const& queueIndices() const { return m_queueIndices; };
+    // True when there is a compute only queue family that can run alongside graphics.
+    bool asyncCompute() const { return m_queueIndices.compute != m_queueIndices.graphics; };
     Swapchain const& swapchain() const { return *m_swapchain.get(); };
+    // Changes whenever the swapchain is recreated, anything recorded against its extent is stale.
+    uint64_t const& swapchainVersion() const { return m_swapchainVersion; };
     VkExtent2D const& extent() const { return m_extent; };
     VkSurfaceFormatKHR const& format() const { return m_format; };
+    VkFormat const& depthFormat() const { return m_depthFormat; };
+    VkSampleCountFlagBits const& samples() const { return m_samples; };
+    // Optional features that were available and enabled on the device.
+    VkPhysicalDeviceFeatures const& features() const { return m_features; };
+    bool const& drawIndirectCount() const { return m_drawIndirectCount; };
+    VkPhysicalDeviceLimits const& limits() const { return m_limits; };
     void recreateSwapchain();
+    // VK_NULL_HANDLE when rendering dynamically.
     VkRenderPass const& renderpass() const { return m_renderPass; };
+    // The pass frames begin with, compatible with renderpass() but keeps depth when it is readable.
+    VkRenderPass const& framePass() const { return m_readableDepth ? m_depthStorePass : m_renderPass; };
+    // Keeps the depth buffer after the pass and lets shaders sample it, recreates the swapchain.
+    void readableDepth();
+    bool const& depthReadable() const { return m_readableDepth; };
+    bool const& dynamicRendering() const { return m_dynamicRendering; };
+    // Cull mode, topology, depth test and write and line width are set while recording (Vulkan
+    // 1.3), so pipelines that only differ in them can be shared.
+    bool const& dynamicState() const { return m_dynamicState; };
+    // Blend, color write mask and polygon mode are dynamic as well.
+    bool dynamicState3() const { return m_dynamicState3.setPolygonMode != nullptr; };
+    DynamicState3 const& dynamicState3Commands() const { return m_dynamicState3; };
+    Commands const& commands() const { return m_commands; };
+    VulkanModuleCache& modules() { return *m_modules; };
+    // Allocates and frees all of the device's memory.
+    VulkanMemory& memory() { return *m_memory; };
+    // Shared by every pipeline created on the device, from any thread.
+    VkPipelineCache const& pipelineCache() const { return m_pipelineCache; };
+    // Threads that build pipelines for shaders created asynchronously and fill streaming uploads.
+    WorkerPool& workers() { return *m_workers; };
+    // Shaders add themselves when they are created and remove themselves when destroyed, under
+    // mutex().
+    HandlePool<Adore::Shader, VulkanShader*>& shaders() { return m_shaders; };
+    // Held by a render thread while it replays a frame, and by everything else that uses the
+    // queues or the renderer's command pool, or changes what the frame reads.
+    std::recursive_mutex& mutex() { return m_mutex; };
     VkPhysicalDevice const& physicalDevice() const { return m_physicalDevice; };
 };
\ No newline at end of file
@@ -19,14 +19,20 @@ public:
     GLFWManager& operator=(const GLFWManager&) = delete;
 };
 
+// Headless contexts get no GLFW window, only a fixed size and a headless surface.
 class Window : public Adore::Window
 {
 protected:
-    GLFWwindow* m_window;
+    GLFWwindow* m_window = nullptr;
+    int m_width = 1280;
+    int m_height = 720;
+    bool m_open = true;
 public:
     Window(std::shared_ptr<Adore::Context>& ctx, std::string const& title)
         : Adore::Window(ctx)
     {
+        if (ctx->headless) return;
+
         GLFWManager::instance();
 
         GLFWmonitor* monitor = glfwGetPrimaryMonitor();
@@ -44,31 +50,49 @@ public:
 
     void resize(int const& width, int const& height) override
     {
-        glfwSetWindowSize(m_window, width, height);
+        m_width = width;
+        m_height = height;
+        if (m_window) glfwSetWindowSize(m_window, width, height);
     }
 
     void framebufferSize(uint32_t& width, uint32_t& height) override
     {
-        int w, h;
-        glfwGetFramebufferSize(m_window, &w, &h);
+        int w = m_width, h = m_height;
+        if (m_window) glfwGetFramebufferSize(m_window, &w, &h);
         width = static_cast<uint32_t>(w);
         height = static_cast<uint32_t>(h);
     }
     
     void close() override
     {
-        glfwSetWindowShouldClose(m_window, GLFW_TRUE);
+        m_open = false;
+        if (m_window) glfwSetWindowShouldClose(m_window, GLFW_TRUE);
     }
 
     bool is_open() override
     {
-        return !glfwWindowShouldClose(m_window);
+        return m_window ? !glfwWindowShouldClose(m_window) : m_open;
     }
 
-    void poll() override { glfwPollEvents(); }
+    void poll() override { if (m_window) glfwPollEvents(); }
 
     void surface(VkInstance const& instance, VkSurfaceKHR* pSurface)
     {
+        if (!m_window)
+        {
+            auto vkCreateHeadlessSurfaceEXT
+                    = (PFN_vkCreateHeadlessSurfaceEXT)
+                        vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT");
+
+            VkHeadlessSurfaceCreateInfoEXT surfaceInfo {};
+            surfaceInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+            if (!vkCreateHeadlessSurfaceEXT
+             || vkCreateHeadlessSurfaceEXT(instance, &surfaceInfo, nullptr, pSurface) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to create headless surface.");
+            return;
+        }
+
         if (glfwCreateWindowSurface(instance, m_window, nullptr, pSurface) != VK_SUCCESS)
             throw Adore::AdoreException("Failed to create window surface.");
     }
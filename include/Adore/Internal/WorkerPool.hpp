@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Long lived threads that run jobs in the order they were submitted. Jobs still queued when
+// the pool is destroyed are run first.
+class WorkerPool
+{
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_available;
+    bool m_stopping = false;
+
+    void run();
+public:
+    WorkerPool(unsigned int const& threads);
+    ~WorkerPool();
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+    // The future rethrows anything the job threw.
+    std::shared_future<void> submit(std::function<void()> const& job);
+    // Whether the calling thread is one of the pool's.
+    bool current() const;
+    // Process wide pool for splitting CPU work, one thread per core besides the caller's.
+    static WorkerPool& shared();
+};
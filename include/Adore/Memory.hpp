@@ -0,0 +1,41 @@
+#pragma once
+#include "Export.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Adore
+{
+    // What device memory Adore allocates is for. ATTACHMENT covers the window's depth and colour
+    // images, including the transient ones of the renderer's frame graph, and render targets.
+    enum class MemoryCategory { VERTEX, INDEX, UNIFORM, STORAGE, IMAGE, ATTACHMENT, STAGING, COUNT };
+
+    struct ADORE_EXPORT HeapStats
+    {
+        uint64_t size;
+        // What the driver lets the process use and how much it uses, other APIs and processes
+        // included. Without VK_EXT_memory_budget they are the heap's size and allocated.
+        uint64_t budget;
+        uint64_t usage;
+        // Bytes Adore has allocated from the heap.
+        uint64_t allocated;
+        bool deviceLocal;
+    };
+
+    struct ADORE_EXPORT MemoryStats
+    {
+        std::vector<HeapStats> heaps;
+        // Bytes allocated for each MemoryCategory.
+        std::array<uint64_t, static_cast<size_t>(MemoryCategory::COUNT)> categories;
+        uint64_t allocations;
+        // Whether budget and usage came from VK_EXT_memory_budget.
+        bool driverBudget;
+
+        uint64_t const& category(MemoryCategory const& category) const
+        {
+            return categories[static_cast<size_t>(category)];
+        }
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Buffer.hpp>
+#include <Adore/Culling.hpp>
+#include <Adore/RenderQueue.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace Adore
+{
+    // A range of a mesh's index buffer. error is how far, in object space units, the level's
+    // surface may be from the full detail one.
+    struct ADORE_EXPORT MeshLod
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        float    error;
+    };
+
+    // Every level's indices back to back, level 0 (full detail) first.
+    struct ADORE_EXPORT MeshLods
+    {
+        std::vector<uint16_t> indices;
+        std::vector<MeshLod>  levels;
+    };
+
+    // Vertex and index buffer shared by every level of detail of a mesh. Positions are the
+    // first three floats of each vertex. Meshes split into streams keep the rest of their
+    // attributes in a second buffer, bound to binding 1, so position only passes fetch less.
+    class ADORE_EXPORT Mesh
+    {
+    public:
+        // Generates the levels at load, see simplify().
+        static std::shared_ptr<Mesh> create(std::shared_ptr<Renderer>& renderer,
+                                            void const * vertices, uint32_t const& vertexCount,
+                                            uint32_t const& stride, std::vector<uint16_t> const& indices,
+                                            uint32_t const& maxLevels = 4, float const& reduction = 0.5f);
+        // Levels made offline with simplify().
+        static std::shared_ptr<Mesh> create(std::shared_ptr<Renderer>& renderer,
+                                            void const * vertices, uint32_t const& vertexCount,
+                                            uint32_t const& stride, MeshLods const& lods);
+
+        // Edge collapse simplifier driven by quadric error. Each level aims for reduction times
+        // the triangles of the one before, and generation stops early once collapses stop
+        // helping. Vertices on open borders or attribute seams never move.
+        static MeshLods simplify(void const * vertices, uint32_t const& vertexCount, uint32_t const& stride,
+                                 std::vector<uint16_t> const& indices, uint32_t const& maxLevels = 4,
+                                 float const& reduction = 0.5f);
+
+        // Projected diameter of bounds in pixels, fovY is in radians.
+        static float screenSize(BoundingSphere const& bounds, glm::vec3 const& camera,
+                                float const& fovY, float const& viewportHeight);
+
+        // Split streams: vertices and attributes both hold vertexCount elements.
+        static std::shared_ptr<Mesh> create(std::shared_ptr<Renderer>& renderer,
+                                            void const * vertices, uint32_t const& vertexCount,
+                                            uint32_t const& stride, void const * attributes,
+                                            uint32_t const& attributeStride, MeshLods const& lods);
+
+        Mesh(std::shared_ptr<VertexBuffer> const& vertices, std::shared_ptr<IndexBuffer> const& indices,
+             std::vector<MeshLod> const& levels, BoundingSphere const& bounds,
+             std::shared_ptr<VertexBuffer> const& attributes = nullptr)
+            : m_vertices(vertices), m_indices(indices), m_levels(levels), m_bounds(bounds),
+              m_attributes(attributes) {};
+
+        // Coarsest level whose error stays under threshold pixels at screenSize. current is the
+        // level the object used last frame: moving to a coarser level needs the error to be
+        // hysteresis (a fraction of threshold) below the threshold, so objects sitting right
+        // on a boundary do not switch every frame.
+        uint32_t select(float const& screenSize, uint32_t const& current, float const& threshold = 1.0f,
+                        float const& hysteresis = 0.25f) const;
+
+        DrawPacket packet(uint64_t const& key, Shader * shader, uint32_t const& level) const;
+
+        std::shared_ptr<VertexBuffer>& vertices() { return m_vertices; }
+        std::shared_ptr<IndexBuffer>& indices() { return m_indices; }
+        // nullptr unless the mesh is split into streams.
+        std::shared_ptr<VertexBuffer>& attributes() { return m_attributes; }
+        std::vector<MeshLod> const& levels() const { return m_levels; }
+        // Object space.
+        BoundingSphere const& bounds() const { return m_bounds; }
+
+    private:
+        std::shared_ptr<VertexBuffer> m_vertices;
+        std::shared_ptr<IndexBuffer> m_indices;
+        std::vector<MeshLod> m_levels;
+        BoundingSphere m_bounds;
+        std::shared_ptr<VertexBuffer> m_attributes;
+    };
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Mesh.hpp>
+#include <Adore/Shader.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Adore
+{
+    // Attributes missing from the file are zero, apart from normals which are generated.
+    struct ADORE_EXPORT ImportedVertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    // A triangle list.
+    struct ADORE_EXPORT ImportedMesh
+    {
+        std::vector<ImportedVertex> vertices;
+        std::vector<uint32_t>       indices;
+    };
+
+    // INTERLEAVED keeps whole ImportedVertex structs in one buffer. SPLIT puts positions in one
+    // and normals and uvs in another, so depth and shadow passes only fetch positions.
+    // QUANTIZED is SPLIT with normals in A2B10G10R10_SNORM and uvs in VEC2_HALF, 20 bytes a
+    // vertex rather than 32.
+    enum class VertexStreams { INTERLEAVED, SPLIT, QUANTIZED };
+
+    // Reads .obj, .gltf and .glb. Every triangle primitive of a glTF scene is merged into one
+    // mesh with its node transforms applied. Identical vertices are merged, nothing is reordered.
+    ADORE_EXPORT ImportedMesh importMesh(std::string const& path);
+
+    // Merges vertices whose attributes are bitwise equal and drops unreferenced ones.
+    ADORE_EXPORT void deduplicate(ImportedMesh& mesh);
+
+    // Tipsify (Sander et al. 2007): orders triangles so each vertex is reused while it is still
+    // in a FIFO post transform cache of cacheSize entries.
+    ADORE_EXPORT void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t const& vertexCount,
+                                          uint32_t const& cacheSize = 16);
+
+    // Cache optimises, then splits the order into clusters wherever a cut costs at most
+    // threshold times the mesh's cache misses, and draws the most outward facing clusters first
+    // so they occlude the rest from any direction.
+    ADORE_EXPORT void optimizeOverdraw(std::vector<uint32_t>& indices, std::vector<ImportedVertex> const& vertices,
+                                       uint32_t const& cacheSize = 16, float const& threshold = 1.05f);
+
+    // Renumbers vertices in the order the indices first use them, so fetches walk the buffer.
+    ADORE_EXPORT void optimizeVertexFetch(ImportedMesh& mesh);
+
+    // Overdraw (which includes the cache order) then vertex fetch.
+    ADORE_EXPORT void optimize(ImportedMesh& mesh, uint32_t const& cacheSize = 16, float const& threshold = 1.05f);
+
+    // Average cache misses per triangle in a FIFO cache, 0.5 at best and 3 at worst.
+    ADORE_EXPORT float acmr(std::vector<uint32_t> const& indices, uint32_t const& cacheSize = 16);
+
+    // Attributes at locations 0 (position), 1 (normal) and 2 (uv) for the given streams.
+    ADORE_EXPORT LayoutDescriptor vertexLayout(VertexStreams const& streams);
+
+    // Adore meshes use 16 bit indices, so mesh can have at most 65536 vertices. Levels of detail
+    // past the first are simplified from it and cache optimised.
+    ADORE_EXPORT std::shared_ptr<Mesh> createMesh(std::shared_ptr<Renderer>& renderer, ImportedMesh const& mesh,
+                                                  VertexStreams const& streams = VertexStreams::INTERLEAVED,
+                                                  uint32_t const& maxLevels = 1, float const& reduction = 0.5f);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Buffer.hpp>
+
+namespace Adore
+{
+    // A set of occlusion queries, each index counts whether anything drawn between
+    // Renderer::beginQuery() and Renderer::endQuery() passed the depth test. The GPU is never
+    // waited on: results are read once the frame that wrote them has finished, which is
+    // FRAMES_IN_FLIGHT frames later, and an index stays visible until its first result arrives.
+    class ADORE_EXPORT OcclusionQuery : public Buffer
+    {
+    protected:
+        uint32_t const m_count;
+        OcclusionQuery(std::shared_ptr<Renderer>& renderer, uint32_t const& count)
+            : Buffer(renderer), m_count(count) {};
+    public:
+        static std::shared_ptr<OcclusionQuery> create(std::shared_ptr<Renderer>& renderer, uint32_t const& count);
+        virtual ~OcclusionQuery() = default;
+        uint32_t const& count() const { return m_count; }
+        // Result of the last finished query of index.
+        virtual bool visible(uint32_t const& index) const = 0;
+    };
+}
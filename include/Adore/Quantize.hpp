@@ -0,0 +1,29 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Shader.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Adore
+{
+    // Bytes one attribute of format takes in a vertex.
+    ADORE_EXPORT uint32_t attributeSize(AttributeFormat const& format);
+
+    // IEEE half precision, rounded to nearest even. Values past 65504 become infinity.
+    ADORE_EXPORT uint16_t toHalf(float const& value);
+    ADORE_EXPORT float fromHalf(uint16_t const& value);
+
+    // Converts count attributes of components values, sourceStride bytes apart, into format at
+    // destination, destinationStride bytes apart, so streams can be written straight into
+    // interleaved vertices. Normalised formats clamp to their range and round to nearest.
+    // Components past those given are 0, apart from the fourth which is 1, as Vulkan fills
+    // them in on fetch. Integer formats can not be written. Uses SSE2 where available.
+    ADORE_EXPORT void quantize(AttributeFormat const& format, void * destination, uint32_t const& destinationStride,
+                               float const * source, uint32_t const& sourceStride, uint32_t const& components,
+                               size_t const& count);
+    ADORE_EXPORT void quantize(AttributeFormat const& format, void * destination, uint32_t const& destinationStride,
+                               double const * source, uint32_t const& sourceStride, uint32_t const& components,
+                               size_t const& count);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Shader.hpp>
+
+#include <vector>
+
+namespace Adore
+{
+    struct ADORE_EXPORT SpecializationConstant
+    {
+        uint32_t   id;
+        // Bytes, booleans are 4 like in a VkSpecializationMapEntry.
+        uint32_t   size;
+        ShaderType stage;
+    };
+
+    struct ADORE_EXPORT ShaderReflection
+    {
+        LayoutDescriptor                    descriptor;
+        std::vector<SpecializationConstant> specializationConstants;
+    };
+
+    // Reads the interface of SPIR-V modules. Vertex inputs become attributes of one tightly
+    // packed buffer at binding 0, in location order. A resource used by several stages is
+    // listed once for each of them. Only descriptor set 0 is supported. Results are cached by
+    // the modules' content, so reflecting the same SPIR-V again is a lookup.
+    ADORE_EXPORT ShaderReflection reflect(std::vector<ShaderModule> const& modules);
+}
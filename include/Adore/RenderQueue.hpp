@@ -0,0 +1,82 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Shader.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Adore
+{
+    class VertexBuffer;
+    class IndexBuffer;
+
+    // Raw pointers keep packets small, everything they point to has to outlive Renderer::draw().
+    struct ADORE_EXPORT DrawPacket
+    {
+        uint64_t      key;
+        Shader*       shader;
+        VertexBuffer* vertices;     // Bound to binding 0, nullptr for shaders that pull vertices.
+        IndexBuffer*  indices;      // nullptr for a non-indexed draw.
+        uint32_t      count;
+        uint32_t      first = 0;    // First index, or first vertex when not indexed.
+        int32_t       vertexOffset = 0;
+        VertexBuffer* attributes = nullptr; // Bound to binding 1 when set, see Mesh.
+    };
+
+    // Draw packets collected from any number of threads, radix sorted by key before
+    // Renderer::draw() replays them with as few state changes as the keys allow.
+    class ADORE_EXPORT RenderQueue
+    {
+    public:
+        struct StateChanges
+        {
+            uint32_t shaders = 0;
+            uint32_t vertexBuffers = 0;
+            uint32_t indexBuffers = 0;
+        };
+
+        struct Stats
+        {
+            size_t packets = 0;
+            StateChanges unsorted;
+            StateChanges sorted;
+        };
+
+        // Buffers packets for one thread, they are added to the queue when it is destroyed.
+        class ADORE_EXPORT Writer
+        {
+            RenderQueue& m_queue;
+            std::vector<DrawPacket> m_packets;
+        public:
+            Writer(RenderQueue& queue) : m_queue(queue) {};
+            Writer(Writer const&) = delete;
+            ~Writer();
+            void submit(DrawPacket const& packet) { m_packets.push_back(packet); }
+        };
+
+        static std::shared_ptr<RenderQueue> create();
+        // layer (8 bits) | pipeline (12 bits) | material (20 bits) | depth (24 bits), depth is
+        // clamped to [0, 1]. Pass 1 - depth for layers that have to be drawn back to front.
+        static uint64_t key(uint8_t const& layer, uint16_t const& pipeline, uint32_t const& material,
+                            float const& depth);
+
+        RenderQueue() = default;
+        // Thread safe, prefer a Writer per thread when submitting many packets.
+        void submit(DrawPacket const& packet);
+        Writer writer() { return Writer(*this); }
+        // Called by Renderer::draw(), does nothing if nothing was submitted since the last sort.
+        void sort();
+        void clear();
+        std::vector<DrawPacket> const& packets() const { return m_packets; }
+        Stats const& stats() const { return m_stats; }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<DrawPacket> m_packets;
+        bool m_sorted = true;
+        Stats m_stats;
+        void append(std::vector<DrawPacket>& packets);
+    };
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Buffer.hpp>
+
+namespace Adore
+{
+    class ADORE_EXPORT RenderTarget : public Sampler
+    {
+    protected:
+        uint32_t const m_width;
+        uint32_t const m_height;
+        RenderTarget(std::shared_ptr<Renderer>& renderer, uint32_t const& width, uint32_t const& height)
+            : Sampler(renderer), m_width(width), m_height(height) {};
+    public:
+        static std::shared_ptr<RenderTarget> create(std::shared_ptr<Renderer>& renderer,
+                                                    uint32_t const& width, uint32_t const& height,
+                                                    ImageFormat const& format = ImageFormat::RGBA8_SRGB,
+                                                    bool const& depth = true,
+                                                    Filter const& filter = Filter::LINEAR,
+                                                    Wrap const& wrap = Wrap::CLAMP_TO_EDGE);
+        virtual ~RenderTarget() = default;
+        uint32_t const& width() const { return m_width; }
+        uint32_t const& height() const { return m_height; }
+    };
+}
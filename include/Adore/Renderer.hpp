@@ -1,6 +1,10 @@
 #pragma once
 #include <Adore/Window.hpp>
 #include <Adore/Shader.hpp>
+#include <Adore/Memory.hpp>
+#include <Adore/Handle.hpp>
+
+#include <functional>
 
 #include "Export.hpp"
 
@@ -8,19 +12,114 @@ namespace Adore
 {
     class VertexBuffer;
     class IndexBuffer;
+    class RenderTarget;
+    class StorageBuffer;
+    class DrawList;
+    class Bundle;
+    class RenderQueue;
+    class Mesh;
+    class OcclusionQuery;
+    struct BoundingBox;
+
+    // What draws and dispatches do with a shader whose pipeline is still compiling.
+    enum class PendingShaders { WAIT, SKIP, FALLBACK };
+
     class ADORE_EXPORT Renderer
     {
     public:
-        static std::shared_ptr<Renderer> create(std::shared_ptr<Window>& win);
+        // With renderThread the calls below are recorded and executed a frame later on a thread
+        // of the renderer's own, so the next frame can be recorded while the last one is
+        // submitted and presented. Errors they raise are rethrown once by the end() or finish()
+        // after, and frames ended before that are dropped. Objects are used as they are when the
+        // frame is executed, so ones refilled every frame, like render queues, need a second one to
+        // alternate with. Results read back from the GPU, like occlusion queries, are only safe to
+        // read after finish(). Creating and destroying resources waits for the call being executed.
+        static std::shared_ptr<Renderer> create(std::shared_ptr<Window>& win, bool const& renderThread = false);
         Renderer(std::shared_ptr<Window>& win) : m_win(win) {};
         virtual ~Renderer() = default;
         virtual void begin(std::shared_ptr<Shader>& shader) = 0;
+        // Render into target instead of the window; end() finishes the pass but not the frame.
+        virtual void begin(std::shared_ptr<RenderTarget>& target, std::shared_ptr<Shader>& shader) = 0;
         virtual void bind(std::shared_ptr<VertexBuffer>& buffer, uint32_t const& binding) = 0;
         // virtual void bind(std::shared_ptr<UniformBuffer>& buffer, uint32_t const& binding) = 0;
         virtual void bind(std::shared_ptr<IndexBuffer>& buffer) = 0;
+        // Handle versions of begin(), bind(), draw(), dispatch() and cull(). Resources are looked
+        // up in dense pools instead of through their objects, the shared_ptr overloads check them
+        // and forward here. Stale handles throw.
+        virtual void begin(ShaderHandle const& shader) = 0;
+        virtual void begin(std::shared_ptr<RenderTarget>& target, ShaderHandle const& shader) = 0;
+        virtual void bind(VertexBufferHandle const& buffer, uint32_t const& binding) = 0;
+        virtual void bind(IndexBufferHandle const& buffer) = 0;
+        virtual void draw(DrawListHandle const& list) = 0;
+        virtual void dispatch(ShaderHandle const& shader, uint32_t const& x,
+                              uint32_t const& y = 1, uint32_t const& z = 1) = 0;
+        virtual void cull(DrawListHandle const& list, float const * viewProjection) = 0;
         virtual void draw(uint32_t const& count) = 0;
         virtual void drawIndexed(uint32_t const& count) = 0;
+        // Sets push constants of the current pass's shader for the draws after it, offset and
+        // size are in bytes and multiples of 4.
+        virtual void push(void const * data, uint32_t const& size, uint32_t const& offset = 0) = 0;
+        // Binds the mesh's buffers (vertices to binding 0) and draws one of its levels of detail.
+        virtual void draw(std::shared_ptr<Mesh>& mesh, uint32_t const& level) = 0;
+        // Draws what the last cull() of list left visible, using the bound vertex / index buffers.
+        virtual void draw(std::shared_ptr<DrawList>& list) = 0;
+        // Replays a recorded bundle in the window pass. Bundles have to come before any direct
+        // draws, and vertex / index buffers bound outside a bundle do not carry into or past it.
+        virtual void execute(std::shared_ptr<Bundle>& bundle) = 0;
+        // Sorts the queue and replays it, packet shaders have to be made for the current pass.
+        virtual void draw(std::shared_ptr<RenderQueue>& queue) = 0;
+        // Counts the samples of the draws up to endQuery() that pass the depth test into index of
+        // query. Only one query can be active, and bundles can not be executed while it is.
+        virtual void beginQuery(std::shared_ptr<OcclusionQuery>& query, uint32_t const& index) = 0;
+        virtual void endQuery(std::shared_ptr<OcclusionQuery>& query, uint32_t const& index) = 0;
+        // Queries box i into index i of query by drawing it against the depth drawn so far, without
+        // writing anything. Boxes reaching behind the camera count as visible without a draw.
+        // Window pass only, viewProjection is a column major 4x4 matrix.
+        virtual void query(std::shared_ptr<OcclusionQuery>& query, std::vector<BoundingBox> const& boxes,
+                           float const * viewProjection) = 0;
         virtual void end() = 0;
+        // Compute work is recorded outside of begin() / end() and is visible to the draws after it.
+        virtual void dispatch(std::shared_ptr<Shader>& shader, uint32_t const& x,
+                              uint32_t const& y = 1, uint32_t const& z = 1) = 0;
+        virtual void dispatchIndirect(std::shared_ptr<Shader>& shader, std::shared_ptr<StorageBuffer>& buffer,
+                                      uint64_t const& offset = 0) = 0;
+        // Runs on a dedicated compute queue when there is one, overlapping with the previous frame.
+        // Falls back to dispatch() otherwise.
+        virtual void dispatchAsync(std::shared_ptr<Shader>& shader, uint32_t const& x,
+                                   uint32_t const& y = 1, uint32_t const& z = 1) = 0;
+        // Frustum cull list on the GPU, viewProjection is a column major 4x4 matrix.
+        // Like dispatch() this is recorded outside of begin() / end().
+        virtual void cull(std::shared_ptr<DrawList>& list, float const * viewProjection) = 0;
+        // Keeps the window's depth buffer after each frame and reduces it to a hierarchical depth
+        // buffer, which cull() also tests draw lists against using the view projection of the
+        // frame's last cull(). Objects visible for the first time show up a frame late. Has to be
+        // called between frames.
+        virtual void occlusionCulling(bool const& enable) = 0;
+        // WAIT (the default) blocks until the pipeline is ready. SKIP drops the draws, and
+        // FALLBACK draws them with fallback instead, which has to be ready, take the same vertex
+        // input and be made for the same pass; otherwise they are dropped too. Bundles and
+        // dispatches are never drawn with the fallback.
+        virtual void pendingShaders(PendingShaders const& mode, std::shared_ptr<Shader> const& fallback = nullptr) = 0;
+        // Waits until every frame ended so far has been executed, calls made after the last end()
+        // wait for the next one. Only the render thread defers anything, without it this does
+        // nothing.
+        virtual void finish() = 0;
+        // Writes the next frames frames to path for AdoreReplay to run: the calls of their window
+        // passes, uniform changes, and the buffers, textures and shaders they use, read back when
+        // first used. Render target passes, bundles, draw lists, render queues, compute and
+        // occlusion queries are left out and counted. Has to be called between frames, 0 frames
+        // ends a capture early.
+        virtual void capture(std::string const& path, uint32_t const& frames) = 0;
+        // Milliseconds the GPU spent on the last finished frame, 0 until one has finished or when
+        // the graphics queue has no timestamps.
+        virtual float gpuTime() const = 0;
+        // Device memory allocated by the renderer's window and everything made with it, by heap
+        // and category, with the driver's budget for each heap.
+        virtual MemoryStats memoryStats() const = 0;
+        // callback runs each time a device local heap's usage rises past fraction of its budget,
+        // and not again until it falls back under. It runs on the thread that allocated, or at
+        // the end of a frame, so memory can be freed before allocations start failing.
+        virtual void memoryThreshold(float const& fraction, std::function<void(MemoryStats const&)> const& callback) = 0;
         std::shared_ptr<Window> window() { return m_win; };
 
     protected:
@@ -2,19 +2,33 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <Adore/Window.hpp>
+#include <Adore/Handle.hpp>
 #include <Adore/Export.hpp>
 
 namespace Adore
 {
     class UniformBuffer;
     class Sampler;
+    class RenderTarget;
+    class StorageBuffer;
+    class StorageImage;
 
-    enum class ShaderType  { VERTEX, FRAGMENT };
-    enum class ResourceType { BUFFER, SAMPLER };
+    enum class ShaderType  { VERTEX, FRAGMENT, COMPUTE };
+    enum class ResourceType { BUFFER, SAMPLER, STORAGE_BUFFER, STORAGE_IMAGE };
     
-    struct ADORE_EXPORT ShaderModule { ShaderType type; std::string path; };
+    // SPIR-V is read from path unless code or words are given. words is count borrowed words,
+    // such as an AssetPack's, kept alive by the pointer.
+    struct ADORE_EXPORT ShaderModule
+    {
+        ShaderType type;
+        std::string path;
+        std::vector<uint32_t> code = {};
+        std::shared_ptr<uint32_t const> words = nullptr;
+        size_t count = 0;
+    };
 
     enum class AttributeFormat
     {
@@ -22,7 +36,14 @@ namespace Adore
         VEC2_FLOAT, VEC3_FLOAT, VEC4_FLOAT,
         VEC2_DOUBLE, VEC3_DOUBLE, VEC4_DOUBLE, 
         VEC2_INT, VEC3_INT, VEC4_INT,
-        VEC2_UINT, VEC3_UINT, VEC4_UINT
+        VEC2_UINT, VEC3_UINT, VEC4_UINT,
+        // Read as floats by shaders, SNORM as [-1, 1] and UNORM as [0, 1]. 8 and 16 bit formats
+        // have no three component versions, few devices can fetch them.
+        HALF, VEC2_HALF, VEC4_HALF,
+        VEC2_SNORM8, VEC4_SNORM8, VEC2_UNORM8, VEC4_UNORM8,
+        VEC2_SNORM16, VEC4_SNORM16, VEC2_UNORM16, VEC4_UNORM16,
+        // x, y and z in 10 bits from the lowest up, w in the top 2.
+        A2B10G10R10_SNORM, A2B10G10R10_UNORM
     };
 
     struct ADORE_EXPORT AttributeLayout
@@ -52,6 +73,45 @@ namespace Adore
         std::vector<AttributeLayout>    attributes;
         std::vector<BindingLayout>      bindings;
         std::vector<ResourceLayout>     resources;
+        // Bytes of push constants, shared by every stage.
+        uint32_t                        pushConstants = 0;
+    };
+
+    enum class BlendMode { NONE, ALPHA, ADDITIVE, PREMULTIPLIED };
+    enum class CullMode { NONE, BACK, FRONT };
+    enum class Topology { TRIANGLE_LIST, TRIANGLE_STRIP, LINE_LIST, LINE_STRIP, POINT_LIST };
+
+    // Sets the constant_id of every stage that declares it. Booleans, ints and floats are all
+    // four bytes, floats go by their bits.
+    struct ADORE_EXPORT SpecializationValue
+    {
+        uint32_t id;
+        uint32_t value;
+    };
+
+    // Everything that can differ between pipelines made from the same modules.
+    struct ADORE_EXPORT ShaderVariant
+    {
+        std::vector<SpecializationValue> specialization = {};
+        BlendMode blend = BlendMode::NONE;
+        CullMode  cull = CullMode::BACK;
+        Topology  topology = Topology::TRIANGLE_LIST;
+        bool      depthTest = true;
+        bool      depthWrite = true;
+        // Needs fillModeNonSolid.
+        bool      wireframe = false;
+        // Anything but 1 needs wideLines.
+        float     lineWidth = 1.0f;
+
+        bool operator==(ShaderVariant const& other) const;
+        bool operator!=(ShaderVariant const& other) const { return !(*this == other); }
+    };
+
+    struct ADORE_EXPORT ShaderDescription
+    {
+        std::vector<ShaderModule> modules;
+        LayoutDescriptor          descriptor;
+        ShaderVariant             variant = {};
     };
 
     template <typename T>
@@ -67,22 +127,61 @@ namespace Adore
         std::shared_ptr<Window> m_win;
         std::vector<Binding<UniformBuffer>> m_uniforms;
         std::vector<Binding<Sampler>> m_samplers;
+        std::vector<Binding<StorageBuffer>> m_storageBuffers;
+        std::vector<Binding<StorageImage>> m_storageImages;
         LayoutDescriptor m_descriptor;
+        ShaderHandle m_handle;
     public:
 
         static std::shared_ptr<Shader> create(std::shared_ptr<Window>& win,
                 std::vector<ShaderModule> const& modules,
-                Adore::LayoutDescriptor const& descriptor);
+                Adore::LayoutDescriptor const& descriptor,
+                ShaderVariant const& variant = {});
+        // For drawing into a RenderTarget instead of the window.
+        static std::shared_ptr<Shader> create(std::shared_ptr<RenderTarget>& target,
+                std::vector<ShaderModule> const& modules,
+                Adore::LayoutDescriptor const& descriptor,
+                ShaderVariant const& variant = {});
+        // The descriptor is reflected from the modules, see reflect().
+        static std::shared_ptr<Shader> create(std::shared_ptr<Window>& win,
+                std::vector<ShaderModule> const& modules);
+        // Returns straight away and builds the pipeline on the window's compiler threads, see
+        // ready() and Renderer::pendingShaders().
+        static std::shared_ptr<Shader> createAsync(std::shared_ptr<Window>& win,
+                ShaderDescription const& description);
+        static std::shared_ptr<Shader> createAsync(std::shared_ptr<RenderTarget>& target,
+                ShaderDescription const& description);
+        // Builds every pipeline in parallel and returns once all of them are ready.
+        static std::vector<std::shared_ptr<Shader>> createBatch(std::shared_ptr<Window>& win,
+                std::vector<ShaderDescription> const& descriptions);
+        static std::shared_ptr<Shader> create(std::shared_ptr<RenderTarget>& target,
+                std::vector<ShaderModule> const& modules);
+        // Creates a module for every .spv file in directory up front, so shaders made from
+        // the same code later skip loading it. Returns how many were loaded.
+        static uint32_t preload(std::shared_ptr<Window>& win, std::string const& directory);
         Shader(std::shared_ptr<Window>& win, LayoutDescriptor const& descriptor)
                     : m_win(win), m_descriptor(descriptor) {};
         std::shared_ptr<Window> window() { return m_win; }
         LayoutDescriptor const& descriptor() const { return m_descriptor; }
+        // Valid for as long as the shader lives, with the renderers of its window.
+        ShaderHandle const& handle() const { return m_handle; }
+        // False while an asynchronously created pipeline is still compiling, or if it failed.
+        virtual bool ready() const = 0;
+        // Blocks until the pipeline is compiled, rethrows if compiling it failed.
+        virtual void wait() = 0;
+        // Same modules and layout with other variant state. Where the device sets the difference
+        // while recording (extended dynamic state) the pipeline itself is shared, not rebuilt.
+        virtual std::shared_ptr<Shader> derive(ShaderVariant const& variant, bool const& async = false) = 0;
         virtual void attach(std::shared_ptr<UniformBuffer>& buffer, uint32_t const& binding) = 0;
         virtual void attach(std::shared_ptr<Sampler>& buffer, uint32_t const& binding) = 0;
+        virtual void attach(std::shared_ptr<StorageBuffer>& buffer, uint32_t const& binding) = 0;
+        virtual void attach(std::shared_ptr<StorageImage>& image, uint32_t const& binding) = 0;
         // impl if I can be bothered / ever need it.
         // virtual void detach(uint32_t const& binding) = 0;
         std::vector<Binding<UniformBuffer>> const& uniforms() const { return m_uniforms; }
         std::vector<Binding<Sampler>> const& samplers() const { return m_samplers; }
+        std::vector<Binding<StorageBuffer>> const& storageBuffers() const { return m_storageBuffers; }
+        std::vector<Binding<StorageImage>> const& storageImages() const { return m_storageImages; }
         virtual ~Shader() = default;
     };
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Shader.hpp>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Adore
+{
+    struct ADORE_EXPORT ShaderVariantHash
+    {
+        size_t operator()(ShaderVariant const& variant) const;
+    };
+
+    // Pipelines made from the same modules and layout, created the first time a variant is
+    // asked for. Variants that only differ in dynamic state share a pipeline, see
+    // Shader::derive(). Resources attached here are attached to every variant, including ones
+    // made later.
+    class ADORE_EXPORT ShaderVariants
+    {
+        std::shared_ptr<Window> m_win;
+        std::shared_ptr<RenderTarget> m_target;
+        std::vector<ShaderModule> m_modules;
+        LayoutDescriptor m_descriptor;
+        std::unordered_map<ShaderVariant, std::shared_ptr<Shader>, ShaderVariantHash> m_variants;
+        std::shared_ptr<Shader> m_base;
+        std::vector<Binding<UniformBuffer>> m_uniforms;
+        std::vector<Binding<Sampler>> m_samplers;
+        std::vector<Binding<StorageBuffer>> m_storageBuffers;
+        std::vector<Binding<StorageImage>> m_storageImages;
+        std::mutex m_mutex;
+
+        template <typename T>
+        void attach(std::vector<Binding<T>>& bindings, std::shared_ptr<T>& resource, uint32_t const& binding);
+    public:
+        static std::shared_ptr<ShaderVariants> create(std::shared_ptr<Window>& win,
+                std::vector<ShaderModule> const& modules, LayoutDescriptor const& descriptor);
+        static std::shared_ptr<ShaderVariants> create(std::shared_ptr<RenderTarget>& target,
+                std::vector<ShaderModule> const& modules, LayoutDescriptor const& descriptor);
+
+        ShaderVariants(std::shared_ptr<Window> const& win, std::shared_ptr<RenderTarget> const& target,
+                       std::vector<ShaderModule> const& modules, LayoutDescriptor const& descriptor)
+            : m_win(win), m_target(target), m_modules(modules), m_descriptor(descriptor) {};
+
+        // async builds a missing variant like Shader::createAsync(), so asking for it mid frame
+        // does not stall.
+        std::shared_ptr<Shader> get(ShaderVariant const& variant = {}, bool const& async = false);
+        void attach(std::shared_ptr<UniformBuffer>& buffer, uint32_t const& binding);
+        void attach(std::shared_ptr<Sampler>& sampler, uint32_t const& binding);
+        void attach(std::shared_ptr<StorageBuffer>& buffer, uint32_t const& binding);
+        void attach(std::shared_ptr<StorageImage>& image, uint32_t const& binding);
+        // Variants created so far.
+        size_t size();
+    };
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "Export.hpp"
+
+#include <Adore/Buffer.hpp>
+
+#include <memory>
+
+namespace Adore
+{
+    // A Sampler whose finer mips are only on the GPU while something samples them. Shaders attach
+    // it like any other Sampler and see the new mips from the first frame after they arrive.
+    class ADORE_EXPORT StreamedTexture : public Sampler
+    {
+    protected:
+        uint32_t const m_width;
+        uint32_t const m_height;
+        uint32_t const m_levels;
+        StreamedTexture(std::shared_ptr<Renderer>& renderer, uint32_t const& width, uint32_t const& height,
+                        uint32_t const& levels)
+            : Sampler(renderer), m_width(width), m_height(height), m_levels(levels) {};
+    public:
+        virtual ~StreamedTexture() = default;
+        uint32_t const& width() const { return m_width; }
+        uint32_t const& height() const { return m_height; }
+        uint32_t const& levels() const { return m_levels; }
+        // Finest mip drawn this frame, callable from any thread. The finest mip requested
+        // since the last TextureStreamer::update() is the one streamed in.
+        virtual void request(uint32_t const& mip) = 0;
+        // Mip sampled when the texture's longer side covers pixels on screen.
+        uint32_t mipFor(float const& pixels) const;
+        void requestFor(float const& pixels) { request(mipFor(pixels)); }
+        // Finest mip shaders can sample right now.
+        virtual uint32_t resident() const = 0;
+    };
+
+    // Keeps the mips of its textures that were requested resident, within a budget of bytes. A
+    // texture always has its mips of 64 pixels and smaller, which is all it starts with. When
+    // the budget runs out the least recently requested textures drop back to those, and
+    // textures still in use lose mips finer than they last asked for.
+    class ADORE_EXPORT TextureStreamer
+    {
+    protected:
+        std::shared_ptr<Renderer> m_renderer;
+        uint64_t m_budget;
+        TextureStreamer(std::shared_ptr<Renderer>& renderer, uint64_t const& budget)
+            : m_renderer(renderer), m_budget(budget) {};
+    public:
+        static std::shared_ptr<TextureStreamer> create(std::shared_ptr<Renderer>& renderer, uint64_t const& budget);
+        virtual ~TextureStreamer() = default;
+        std::shared_ptr<Renderer> renderer() { return m_renderer; }
+        // Every mip is generated up front and kept in memory to stream from.
+        virtual std::shared_ptr<StreamedTexture> load(const char* path, Filter const& filter, Wrap const& wrap) = 0;
+        // Only RGBA8 and RGBA8_SRGB can be streamed.
+        virtual std::shared_ptr<StreamedTexture> load(void const * pixels, uint32_t const& width,
+                                                      uint32_t const& height, ImageFormat const& format,
+                                                      Filter const& filter, Wrap const& wrap) = 0;
+        // Starts uploads for this frame's requests and swaps in the ones that finished. Call it
+        // once a frame from the thread that renders, outside Renderer::begin() and end().
+        virtual void update() = 0;
+        void budget(uint64_t const& bytes) { m_budget = bytes; }
+        uint64_t const& budget() const { return m_budget; }
+        // Bytes of mips on the GPU as of the last update(), counting uploads in flight and the
+        // images they replace, which live on until the frames sampling them finish.
+        virtual uint64_t used() const = 0;
+    };
+}
@@ -18,7 +18,9 @@ namespace Adore
     protected:
         std::shared_ptr<Context> m_ctx;
     public:
-        static std::shared_ptr<Window> create(std::shared_ptr<Context>& ctx, std::string const& title);
+        // samples > 1 enables MSAA, capped at what the device supports.
+        static std::shared_ptr<Window> create(std::shared_ptr<Context>& ctx, std::string const& title,
+                                              uint32_t const& samples = 1);
         Window(std::shared_ptr<Context>& ctx) : m_ctx(ctx) {}
         virtual ~Window() = default;
         virtual void resize(int const& width, int const& height) = 0;
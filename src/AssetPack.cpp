@@ -0,0 +1,137 @@
+#include <Adore/AssetPack.hpp>
+
+#include <Adore/Internal/MappedFile.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Adore
+{
+    static bool before(AssetEntry const& entry, std::string const& name)
+    {
+        return strncmp(entry.name, name.c_str(), sizeof(entry.name)) < 0;
+    }
+
+    static uint64_t pixelSize(ImageFormat const& format)
+    {
+        switch (format)
+        {
+            case ImageFormat::RGBA8: return 4;
+            case ImageFormat::RGBA8_SRGB: return 4;
+            case ImageFormat::RGBA16_FLOAT: return 8;
+            case ImageFormat::RGBA32_FLOAT: return 16;
+            default: throw AdoreException("Unknown image format in asset pack.");
+        }
+    }
+
+    std::shared_ptr<AssetPack> AssetPack::open(std::string const& path)
+    {
+        return std::shared_ptr<AssetPack>(new AssetPack(path));
+    }
+
+    AssetPack::AssetPack(std::string const& path)
+        : m_file(std::make_unique<MappedFile>(path))
+    {
+        auto bytes = static_cast<char const *>(m_file->data());
+        uint64_t size = m_file->size();
+
+        AssetPackHeader header;
+        if (size < sizeof(header))
+            throw AdoreException("Asset pack is too small: " + path);
+
+        memcpy(&header, bytes, sizeof(header));
+
+        if (memcmp(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic)) != 0)
+            throw AdoreException("File is not an asset pack: " + path);
+        if (header.version != ASSET_PACK_VERSION)
+            throw AdoreException("Unsupported asset pack version " + std::to_string(header.version) + ": " + path);
+        if (header.toc % alignof(AssetEntry) != 0 || header.toc > size
+            || (size - header.toc) / sizeof(AssetEntry) < header.count)
+            throw AdoreException("Asset pack table of contents is out of bounds: " + path);
+
+        m_entries = reinterpret_cast<AssetEntry const *>(bytes + header.toc);
+        m_count = header.count;
+
+        // Only the table is read up front, blobs are paged in when something uses them.
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            AssetEntry const& entry = m_entries[i];
+
+            if (entry.name[sizeof(entry.name) - 1] != '\0')
+                throw AdoreException("Asset pack entry name is not terminated: " + path);
+            if (entry.offset > size || entry.size > size - entry.offset)
+                throw AdoreException("Asset pack entry is out of bounds: " + std::string(entry.name));
+            if (i > 0 && strncmp(m_entries[i - 1].name, entry.name, sizeof(entry.name)) >= 0)
+                throw AdoreException("Asset pack entries are not sorted: " + path);
+        }
+
+        ADORE_INTERNAL_LOG(INFO, "Opened asset pack " + path + " with " + std::to_string(m_count) + " entries.");
+    }
+
+    AssetPack::~AssetPack() = default;
+
+    AssetEntry const * AssetPack::find(std::string const& name) const
+    {
+        AssetEntry const * end = m_entries + m_count;
+        AssetEntry const * it = std::lower_bound(m_entries, end, name, before);
+
+        if (it == end || strncmp(it->name, name.c_str(), sizeof(it->name)) != 0) return nullptr;
+        return it;
+    }
+
+    void const * AssetPack::data(AssetEntry const& entry) const
+    {
+        return static_cast<char const *>(m_file->data()) + entry.offset;
+    }
+
+    AssetEntry const& AssetPack::get(std::string const& name, AssetType const& type) const
+    {
+        AssetEntry const * entry = find(name);
+
+        if (!entry)
+            throw AdoreException("Asset pack has no entry: " + name);
+        if (entry->type != type)
+            throw AdoreException("Asset pack entry has the wrong type: " + name);
+
+        return *entry;
+    }
+
+    ShaderModule AssetPack::shader(std::string const& name)
+    {
+        AssetEntry const& entry = get(name, AssetType::SHADER);
+
+        if (entry.offset % sizeof(uint32_t) != 0 || entry.size % sizeof(uint32_t) != 0)
+            throw AdoreException("Asset pack entry is not SPIR-V: " + name);
+
+        // Shares ownership of the pack, so the words stay mapped as long as the module is around.
+        std::shared_ptr<uint32_t const> words(shared_from_this(), static_cast<uint32_t const *>(data(entry)));
+
+        return { static_cast<ShaderType>(entry.format), name, {}, words, entry.size / sizeof(uint32_t) };
+    }
+
+    // Buffers only read the data they are created from.
+    std::shared_ptr<VertexBuffer> AssetPack::vertices(std::shared_ptr<Renderer>& renderer, std::string const& name)
+    {
+        AssetEntry const& entry = get(name, AssetType::VERTICES);
+        return VertexBuffer::create(renderer, const_cast<void *>(data(entry)), entry.size);
+    }
+
+    std::shared_ptr<IndexBuffer> AssetPack::indices(std::shared_ptr<Renderer>& renderer, std::string const& name)
+    {
+        AssetEntry const& entry = get(name, AssetType::INDICES);
+        return IndexBuffer::create(renderer, const_cast<void *>(data(entry)), entry.size);
+    }
+
+    std::shared_ptr<Sampler> AssetPack::texture(std::shared_ptr<Renderer>& renderer, std::string const& name,
+                                                Filter const& filter, Wrap const& wrap)
+    {
+        AssetEntry const& entry = get(name, AssetType::TEXTURE);
+        auto format = static_cast<ImageFormat>(entry.format);
+
+        if (entry.size != static_cast<uint64_t>(entry.width) * entry.height * pixelSize(format))
+            throw AdoreException("Asset pack texture size does not match its extent: " + name);
+
+        return Sampler::create(renderer, data(entry), entry.width, entry.height, format, filter, wrap);
+    }
+}
@@ -53,4 +53,44 @@ namespace Adore
                 throw AdoreException("Unsupported API.");
         }
     }
+
+    std::shared_ptr<Sampler> Sampler::create(std::shared_ptr<Adore::Renderer>& renderer,
+                                               void const * pixels, uint32_t const& width,
+                                               uint32_t const& height, ImageFormat const& format,
+                                               Filter const& filter, Wrap const& wrap)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanSampler>(renderer, pixels, width, height, format, filter, wrap);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+
+    std::shared_ptr<StorageBuffer> StorageBuffer::create(std::shared_ptr<Renderer>& renderer,
+                                                         void* pdata, uint64_t const& size)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanStorageBuffer>(renderer, pdata, size);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+
+    std::shared_ptr<StorageImage> StorageImage::create(std::shared_ptr<Renderer>& renderer,
+                                                       uint32_t const& width, uint32_t const& height,
+                                                       ImageFormat const& format, Filter const& filter,
+                                                       Wrap const& wrap)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanStorageImage>(renderer, width, height, format, filter, wrap);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include <Adore/Bundle.hpp>
+
+#include <Adore/Internal/Vulkan/Bundle.hpp>
+#include <Adore/Internal/Log.hpp>
+
+namespace Adore
+{
+    std::shared_ptr<Bundle> Bundle::create(std::shared_ptr<Renderer>& renderer, std::shared_ptr<Shader>& shader)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanBundle>(renderer, shader);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+}
@@ -4,12 +4,13 @@
 
 namespace Adore
 {
-    std::shared_ptr<Context> Context::create(API const& api, std::string const& appName)
+    std::shared_ptr<Context> Context::create(API const& api, std::string const& appName,
+                                             bool const& headless)
     {
         switch (api)
         {
             case API::Vulkan:
-                return std::make_shared<VulkanContext>(appName);
+                return std::make_shared<VulkanContext>(appName, headless);
             default:
                 throw AdoreException("Unsupported API.");
         }
@@ -0,0 +1,355 @@
+#include <Adore/Culling.hpp>
+#include <Adore/Log.hpp>
+#include <Adore/Internal/Culling.hpp>
+#include <Adore/Internal/Parallel.hpp>
+
+#include <cmath>
+#include <cstring>
+
+#ifdef ADORE_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(ADORE_AVX) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Below this many volumes a single thread is faster than starting more.
+static constexpr size_t VOLUMES_PER_THREAD = 32768;
+
+size_t cullSpheresScalar(CullPlanes const& planes, SphereArrays const& spheres,
+                         size_t begin, size_t end, uint32_t * out)
+{
+    size_t count = 0;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+
+        for (unsigned int p = 0; p < 6; p++)
+            inside &= planes.a[p] * spheres.x[i] + planes.b[p] * spheres.y[i] +
+                      planes.c[p] * spheres.z[i] + planes.d[p] >= -spheres.r[i];
+
+        out[count] = spheres.ids[i];
+        count += inside;
+    }
+
+    return count;
+}
+
+size_t cullBoxesScalar(CullPlanes const& planes, BoxArrays const& boxes,
+                       size_t begin, size_t end, uint32_t * out)
+{
+    size_t count = 0;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            float radius = planes.absA[p] * boxes.ex[i] + planes.absB[p] * boxes.ey[i] + planes.absC[p] * boxes.ez[i];
+            inside &= planes.a[p] * boxes.x[i] + planes.b[p] * boxes.y[i] +
+                      planes.c[p] * boxes.z[i] + planes.d[p] >= -radius;
+        }
+
+        out[count] = boxes.ids[i];
+        count += inside;
+    }
+
+    return count;
+}
+
+#ifdef ADORE_SSE
+size_t cullSpheresSSE(CullPlanes const& planes, SphereArrays const& spheres,
+                      size_t begin, size_t end, uint32_t * out)
+{
+    __m128 a[6], b[6], c[6], d[6];
+
+    for (unsigned int p = 0; p < 6; p++)
+    {
+        a[p] = _mm_set1_ps(planes.a[p]);
+        b[p] = _mm_set1_ps(planes.b[p]);
+        c[p] = _mm_set1_ps(planes.c[p]);
+        d[p] = _mm_set1_ps(planes.d[p]);
+    }
+
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(spheres.x + i);
+        __m128 y = _mm_loadu_ps(spheres.y + i);
+        __m128 z = _mm_loadu_ps(spheres.z + i);
+        __m128 r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.r + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x), _mm_mul_ps(b[p], y)),
+                                         _mm_add_ps(_mm_mul_ps(c[p], z), d[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, r));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+
+        for (unsigned int lane = 0; lane < 4; lane++)
+        {
+            out[count] = spheres.ids[i + lane];
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + cullSpheresScalar(planes, spheres, i, end, out + count);
+}
+
+size_t cullBoxesSSE(CullPlanes const& planes, BoxArrays const& boxes,
+                    size_t begin, size_t end, uint32_t * out)
+{
+    __m128 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+
+    for (unsigned int p = 0; p < 6; p++)
+    {
+        a[p] = _mm_set1_ps(planes.a[p]);
+        b[p] = _mm_set1_ps(planes.b[p]);
+        c[p] = _mm_set1_ps(planes.c[p]);
+        d[p] = _mm_set1_ps(planes.d[p]);
+        absA[p] = _mm_set1_ps(planes.absA[p]);
+        absB[p] = _mm_set1_ps(planes.absB[p]);
+        absC[p] = _mm_set1_ps(planes.absC[p]);
+    }
+
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(boxes.x + i);
+        __m128 y = _mm_loadu_ps(boxes.y + i);
+        __m128 z = _mm_loadu_ps(boxes.z + i);
+        __m128 ex = _mm_loadu_ps(boxes.ex + i);
+        __m128 ey = _mm_loadu_ps(boxes.ey + i);
+        __m128 ez = _mm_loadu_ps(boxes.ez + i);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x), _mm_mul_ps(b[p], y)),
+                                         _mm_add_ps(_mm_mul_ps(c[p], z), d[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[p], ex), _mm_mul_ps(absB[p], ey)),
+                                       _mm_mul_ps(absC[p], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+
+        for (unsigned int lane = 0; lane < 4; lane++)
+        {
+            out[count] = boxes.ids[i + lane];
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + cullBoxesScalar(planes, boxes, i, end, out + count);
+}
+#endif
+
+namespace
+{
+    struct Kernel
+    {
+        char const * name;
+        size_t (*spheres)(CullPlanes const&, SphereArrays const&, size_t, size_t, uint32_t *);
+        size_t (*boxes)(CullPlanes const&, BoxArrays const&, size_t, size_t, uint32_t *);
+    };
+
+    bool avxSupported()
+    {
+#if defined(ADORE_AVX) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = info[2] & (1 << 27);
+        bool avx = info[2] & (1 << 28);
+        return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#elif defined(ADORE_AVX)
+        return __builtin_cpu_supports("avx");
+#else
+        return false;
+#endif
+    }
+
+    Kernel const& selectKernel()
+    {
+        static Kernel const kernel = []() -> Kernel
+        {
+#ifdef ADORE_AVX
+            if (avxSupported())
+                return { "AVX", cullSpheresAVX, cullBoxesAVX };
+#endif
+#ifdef ADORE_SSE
+            return { "SSE", cullSpheresSSE, cullBoxesSSE };
+#else
+            return { "Scalar", cullSpheresScalar, cullBoxesScalar };
+#endif
+        }();
+
+        return kernel;
+    }
+
+    // Culls [0, count) in chunks, each thread compacting into its own part of out, then
+    // closes the gaps between chunks. Returns how many ids were written.
+    template <typename Arrays, typename Cull>
+    size_t cullChunks(CullPlanes const& planes, Arrays const& arrays, size_t const& count, Cull cull, uint32_t * out)
+    {
+        unsigned int threads = threadCount(count, VOLUMES_PER_THREAD);
+        std::vector<size_t> begins(threads, 0), counts(threads, 0);
+
+        parallel(threads, count, [&](unsigned int const& thread, size_t const& begin, size_t const& end)
+        {
+            begins[thread] = begin;
+            counts[thread] = cull(planes, arrays, begin, end, out + begin);
+        }, 8);
+
+        size_t visible = 0;
+
+        for (unsigned int t = 0; t < threads; t++)
+        {
+            if (begins[t] != visible)
+                std::memmove(out + visible, out + begins[t], counts[t] * sizeof(uint32_t));
+            visible += counts[t];
+        }
+
+        return visible;
+    }
+}
+
+namespace Adore
+{
+    Frustum Frustum::create(glm::mat4 const& viewProjection)
+    {
+        // Gribb/Hartmann: each plane is the last row plus or minus another, glm is column major.
+        auto row = [&](int const& r)
+        {
+            return glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+        };
+
+        Frustum frustum;
+        frustum.planes[0] = row(3) + row(0);
+        frustum.planes[1] = row(3) - row(0);
+        frustum.planes[2] = row(3) + row(1);
+        frustum.planes[3] = row(3) - row(1);
+        frustum.planes[4] = row(3) + row(2);
+        frustum.planes[5] = row(3) - row(2);
+
+        for (auto& plane : frustum.planes)
+            plane /= glm::length(glm::vec3(plane));
+
+        return frustum;
+    }
+
+    std::shared_ptr<CullingSet> CullingSet::create()
+    {
+        return std::make_shared<CullingSet>();
+    }
+
+    uint32_t CullingSet::add(BoundingSphere const& sphere, uint32_t const& id)
+    {
+        m_sx.push_back(0.0f);
+        m_sy.push_back(0.0f);
+        m_sz.push_back(0.0f);
+        m_sr.push_back(0.0f);
+        m_sphereIds.push_back(id);
+
+        uint32_t slot = static_cast<uint32_t>(m_sphereIds.size() - 1);
+        set(slot, sphere);
+        return slot;
+    }
+
+    uint32_t CullingSet::add(BoundingBox const& box, uint32_t const& id)
+    {
+        m_bx.push_back(0.0f);
+        m_by.push_back(0.0f);
+        m_bz.push_back(0.0f);
+        m_ex.push_back(0.0f);
+        m_ey.push_back(0.0f);
+        m_ez.push_back(0.0f);
+        m_boxIds.push_back(id);
+
+        uint32_t slot = static_cast<uint32_t>(m_boxIds.size() - 1);
+        set(slot, box);
+        return slot;
+    }
+
+    void CullingSet::set(uint32_t const& slot, BoundingSphere const& sphere)
+    {
+        if (slot >= m_sphereIds.size())
+            throw Adore::AdoreException("Bounding sphere slot out of range.");
+
+        m_sx[slot] = sphere.center.x;
+        m_sy[slot] = sphere.center.y;
+        m_sz[slot] = sphere.center.z;
+        m_sr[slot] = sphere.radius;
+    }
+
+    void CullingSet::set(uint32_t const& slot, BoundingBox const& box)
+    {
+        if (slot >= m_boxIds.size())
+            throw Adore::AdoreException("Bounding box slot out of range.");
+
+        glm::vec3 center = (box.min + box.max) * 0.5f;
+        glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+        m_bx[slot] = center.x;
+        m_by[slot] = center.y;
+        m_bz[slot] = center.z;
+        m_ex[slot] = extent.x;
+        m_ey[slot] = extent.y;
+        m_ez[slot] = extent.z;
+    }
+
+    void CullingSet::clear()
+    {
+        for (auto * values : { &m_sx, &m_sy, &m_sz, &m_sr, &m_bx, &m_by, &m_bz, &m_ex, &m_ey, &m_ez })
+            values->clear();
+
+        m_sphereIds.clear();
+        m_boxIds.clear();
+    }
+
+    void CullingSet::cull(Frustum const& frustum, std::vector<uint32_t>& visible) const
+    {
+        CullPlanes planes;
+
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            planes.a[p] = frustum.planes[p].x;
+            planes.b[p] = frustum.planes[p].y;
+            planes.c[p] = frustum.planes[p].z;
+            planes.d[p] = frustum.planes[p].w;
+            planes.absA[p] = std::fabs(planes.a[p]);
+            planes.absB[p] = std::fabs(planes.b[p]);
+            planes.absC[p] = std::fabs(planes.c[p]);
+        }
+
+        Kernel const& kernel = selectKernel();
+        visible.resize(size());
+
+        SphereArrays spheres = { m_sx.data(), m_sy.data(), m_sz.data(), m_sr.data(), m_sphereIds.data() };
+        size_t count = cullChunks(planes, spheres, m_sphereIds.size(), kernel.spheres, visible.data());
+
+        BoxArrays boxes = { m_bx.data(), m_by.data(), m_bz.data(), m_ex.data(), m_ey.data(), m_ez.data(),
+                            m_boxIds.data() };
+        count += cullChunks(planes, boxes, m_boxIds.size(), kernel.boxes, visible.data() + count);
+
+        visible.resize(count);
+    }
+
+    char const * CullingSet::kernel()
+    {
+        return selectKernel().name;
+    }
+}
@@ -0,0 +1,19 @@
+#include <Adore/DrawList.hpp>
+
+#include <Adore/Internal/Vulkan/DrawList.hpp>
+#include <Adore/Internal/Log.hpp>
+
+namespace Adore
+{
+    std::shared_ptr<DrawList> DrawList::create(std::shared_ptr<Renderer>& renderer,
+                                               std::vector<DrawObject> const& objects)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanDrawList>(renderer, objects);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+}
@@ -0,0 +1,100 @@
+// Built with AVX enabled, only called once the CPU is known to support it.
+#include <Adore/Internal/Culling.hpp>
+
+#include <immintrin.h>
+
+size_t cullSpheresAVX(CullPlanes const& planes, SphereArrays const& spheres,
+                      size_t begin, size_t end, uint32_t * out)
+{
+    __m256 a[6], b[6], c[6], d[6];
+
+    for (unsigned int p = 0; p < 6; p++)
+    {
+        a[p] = _mm256_set1_ps(planes.a[p]);
+        b[p] = _mm256_set1_ps(planes.b[p]);
+        c[p] = _mm256_set1_ps(planes.c[p]);
+        d[p] = _mm256_set1_ps(planes.d[p]);
+    }
+
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(spheres.x + i);
+        __m256 y = _mm256_loadu_ps(spheres.y + i);
+        __m256 z = _mm256_loadu_ps(spheres.z + i);
+        __m256 r = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.r + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[p], x), _mm256_mul_ps(b[p], y)),
+                                            _mm256_add_ps(_mm256_mul_ps(c[p], z), d[p]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, r, _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+
+        for (unsigned int lane = 0; lane < 8; lane++)
+        {
+            out[count] = spheres.ids[i + lane];
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + cullSpheresScalar(planes, spheres, i, end, out + count);
+}
+
+size_t cullBoxesAVX(CullPlanes const& planes, BoxArrays const& boxes,
+                    size_t begin, size_t end, uint32_t * out)
+{
+    __m256 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+
+    for (unsigned int p = 0; p < 6; p++)
+    {
+        a[p] = _mm256_set1_ps(planes.a[p]);
+        b[p] = _mm256_set1_ps(planes.b[p]);
+        c[p] = _mm256_set1_ps(planes.c[p]);
+        d[p] = _mm256_set1_ps(planes.d[p]);
+        absA[p] = _mm256_set1_ps(planes.absA[p]);
+        absB[p] = _mm256_set1_ps(planes.absB[p]);
+        absC[p] = _mm256_set1_ps(planes.absC[p]);
+    }
+
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(boxes.x + i);
+        __m256 y = _mm256_loadu_ps(boxes.y + i);
+        __m256 z = _mm256_loadu_ps(boxes.z + i);
+        __m256 ex = _mm256_loadu_ps(boxes.ex + i);
+        __m256 ey = _mm256_loadu_ps(boxes.ey + i);
+        __m256 ez = _mm256_loadu_ps(boxes.ez + i);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (unsigned int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[p], x), _mm256_mul_ps(b[p], y)),
+                                            _mm256_add_ps(_mm256_mul_ps(c[p], z), d[p]));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absA[p], ex), _mm256_mul_ps(absB[p], ey)),
+                                          _mm256_mul_ps(absC[p], ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_sub_ps(_mm256_setzero_ps(), radius),
+                                                         _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+
+        for (unsigned int lane = 0; lane < 8; lane++)
+        {
+            out[count] = boxes.ids[i + lane];
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + cullBoxesScalar(planes, boxes, i, end, out + count);
+}
@@ -0,0 +1,241 @@
+#include <Adore/Internal/Json.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <cstdlib>
+#include <cstring>
+
+class JsonParser
+{
+    char const * m_text;
+    char const * m_end;
+    unsigned int m_depth = 0;
+
+    [[noreturn]] void fail(char const * what)
+    {
+        throw Adore::AdoreException(std::string("Invalid JSON: ") + what);
+    }
+
+    void skipSpace()
+    {
+        while (m_text < m_end && (*m_text == ' ' || *m_text == '\t' || *m_text == '\n' || *m_text == '\r'))
+            m_text++;
+    }
+
+    bool consume(char const * word)
+    {
+        size_t length = strlen(word);
+        if (static_cast<size_t>(m_end - m_text) < length || strncmp(m_text, word, length) != 0) return false;
+
+        m_text += length;
+        return true;
+    }
+
+    void expect(char const& c)
+    {
+        skipSpace();
+        if (m_text == m_end || *m_text != c) fail("unexpected character");
+        m_text++;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t const& code)
+    {
+        if (code < 0x80)
+            out += static_cast<char>(code);
+        else if (code < 0x800)
+        {
+            out += static_cast<char>(0xC0 | code >> 6);
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | code >> 12);
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | code >> 18);
+            out += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    uint32_t hex()
+    {
+        if (m_end - m_text < 4) fail("short unicode escape");
+
+        uint32_t code = 0;
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            char c = *m_text++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else fail("bad unicode escape");
+        }
+
+        return code;
+    }
+
+    std::string string()
+    {
+        expect('"');
+        std::string out;
+
+        while (true)
+        {
+            if (m_text == m_end) fail("unterminated string");
+
+            char c = *m_text++;
+            if (c == '"') return out;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+
+            if (m_text == m_end) fail("unterminated string");
+
+            switch (*m_text++)
+            {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    uint32_t code = hex();
+                    if (code >= 0xD800 && code < 0xDC00 && consume("\\u"))
+                        code = 0x10000 + ((code - 0xD800) << 10) + (hex() - 0xDC00);
+                    appendUtf8(out, code);
+                    break;
+                }
+                default: fail("bad escape");
+            }
+        }
+    }
+
+    double number()
+    {
+        // strtod could run past the end of an unterminated buffer, so copy the number out.
+        char const * start = m_text;
+        while (m_text < m_end && (strchr("+-.eE", *m_text) || (*m_text >= '0' && *m_text <= '9')))
+            m_text++;
+
+        std::string digits(start, m_text);
+        char * end = nullptr;
+        double value = strtod(digits.c_str(), &end);
+
+        if (digits.empty() || end != digits.c_str() + digits.size()) fail("bad number");
+        return value;
+    }
+
+public:
+    JsonParser(char const * text, size_t const& size) : m_text(text), m_end(text + size) {};
+
+    Json value()
+    {
+        if (++m_depth > 256) fail("nested too deeply");
+
+        skipSpace();
+        if (m_text == m_end) fail("unexpected end");
+
+        Json json;
+
+        switch (*m_text)
+        {
+            case '{':
+                m_text++;
+                json.m_type = Json::Type::OBJECT;
+                skipSpace();
+                if (m_text < m_end && *m_text == '}')
+                {
+                    m_text++;
+                    break;
+                }
+                do
+                {
+                    std::string key = string();
+                    expect(':');
+                    json.m_members.emplace_back(std::move(key), value());
+                    skipSpace();
+                } while (m_text < m_end && *m_text == ',' && m_text++);
+                expect('}');
+                break;
+            case '[':
+                m_text++;
+                json.m_type = Json::Type::ARRAY;
+                skipSpace();
+                if (m_text < m_end && *m_text == ']')
+                {
+                    m_text++;
+                    break;
+                }
+                do
+                {
+                    json.m_elements.push_back(value());
+                    skipSpace();
+                } while (m_text < m_end && *m_text == ',' && m_text++);
+                expect(']');
+                break;
+            case '"':
+                json.m_type = Json::Type::STRING;
+                json.m_string = string();
+                break;
+            default:
+                if (consume("true"))
+                {
+                    json.m_type = Json::Type::BOOLEAN;
+                    json.m_boolean = true;
+                }
+                else if (consume("false"))
+                    json.m_type = Json::Type::BOOLEAN;
+                else if (consume("null"))
+                    json.m_type = Json::Type::NUL;
+                else
+                {
+                    json.m_type = Json::Type::NUMBER;
+                    json.m_number = number();
+                }
+        }
+
+        m_depth--;
+        return json;
+    }
+
+    void finish()
+    {
+        skipSpace();
+        if (m_text != m_end) fail("trailing characters");
+    }
+};
+
+Json Json::parse(char const * text, size_t const& size)
+{
+    JsonParser parser(text, size);
+    Json json = parser.value();
+    parser.finish();
+    return json;
+}
+
+Json const& Json::operator[](size_t const& index) const
+{
+    static Json const null;
+    return index < m_elements.size() ? m_elements[index] : null;
+}
+
+Json const& Json::operator[](char const * key) const
+{
+    static Json const null;
+
+    for (auto const& member : m_members)
+        if (member.first == key) return member.second;
+
+    return null;
+}
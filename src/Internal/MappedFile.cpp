@@ -0,0 +1,91 @@
+#include <Adore/Internal/MappedFile.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::string const& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw Adore::AdoreException("Failed to open file: " + path);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        throw Adore::AdoreException("Failed to read the size of file: " + path);
+    }
+
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files can not be mapped, and have nothing to map anyway.
+    if (m_size != 0)
+    {
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping) m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    CloseHandle(file);
+
+    if (m_size != 0 && !m_data)
+    {
+        if (m_mapping) CloseHandle(m_mapping);
+        throw Adore::AdoreException("Failed to map file: " + path);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+}
+
+#else
+
+MappedFile::MappedFile(std::string const& path)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw Adore::AdoreException("Failed to open file: " + path);
+
+    struct stat status;
+    if (fstat(file, &status) != 0)
+    {
+        close(file);
+        throw Adore::AdoreException("Failed to read the size of file: " + path);
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+
+    // Empty files can not be mapped, and have nothing to map anyway.
+    if (m_size != 0)
+    {
+        void * data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+        m_data = data == MAP_FAILED ? nullptr : data;
+    }
+
+    // The mapping keeps its own reference to the file.
+    close(file);
+
+    if (m_size != 0 && !m_data)
+        throw Adore::AdoreException("Failed to map file: " + path);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data) munmap(const_cast<void*>(m_data), m_size);
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include <Adore/Internal/MipChain.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    struct SRGBTables
+    {
+        std::array<float, 256> decode;
+        // Linear value halfway between each code and the next, so encoding rounds in sRGB space.
+        std::array<float, 255> midpoints;
+
+        SRGBTables()
+        {
+            auto linear = [](float const& c)
+            {
+                return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            };
+
+            for (unsigned int i = 0; i < 256; i++)
+                decode[i] = linear(i / 255.0f);
+            for (unsigned int i = 0; i < 255; i++)
+                midpoints[i] = linear((i + 0.5f) / 255.0f);
+        }
+
+        unsigned char encode(float const& value) const
+        {
+            return static_cast<unsigned char>(std::upper_bound(midpoints.begin(), midpoints.end(), value) - midpoints.begin());
+        }
+    };
+}
+
+MipChain buildMipChain(void const * pixels, uint32_t const& width, uint32_t const& height, bool const& srgb)
+{
+    static SRGBTables const tables;
+
+    MipChain chain;
+    chain.width = width;
+    chain.height = height;
+
+    uint32_t levels = 1;
+    while ((std::max(width, height) >> levels) > 0) levels++;
+
+    chain.offsets.push_back(0);
+    for (uint32_t level = 0; level < levels; level++)
+        chain.offsets.push_back(chain.offsets.back() + static_cast<size_t>(chain.mipWidth(level)) * chain.mipHeight(level) * 4);
+
+    chain.pixels.resize(chain.offsets.back());
+    std::memcpy(chain.pixels.data(), pixels, chain.offsets[1]);
+
+    for (uint32_t level = 1; level < levels; level++)
+    {
+        unsigned char const * source = chain.pixels.data() + chain.offsets[level - 1];
+        unsigned char * destination = chain.pixels.data() + chain.offsets[level];
+        uint32_t sourceWidth = chain.mipWidth(level - 1), sourceHeight = chain.mipHeight(level - 1);
+        uint32_t mipWidth = chain.mipWidth(level), mipHeight = chain.mipHeight(level);
+
+        for (uint32_t y = 0; y < mipHeight; y++)
+        {
+            // The last row and column also take in the odd one out.
+            uint32_t y0 = std::min(2 * y, sourceHeight - 1);
+            uint32_t y1 = y + 1 == mipHeight ? sourceHeight - 1 : 2 * y + 1;
+
+            for (uint32_t x = 0; x < mipWidth; x++)
+            {
+                uint32_t x0 = std::min(2 * x, sourceWidth - 1);
+                uint32_t x1 = x + 1 == mipWidth ? sourceWidth - 1 : 2 * x + 1;
+
+                float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (uint32_t sy = y0; sy <= y1; sy++)
+                {
+                    for (uint32_t sx = x0; sx <= x1; sx++)
+                    {
+                        unsigned char const * texel = source + (static_cast<size_t>(sy) * sourceWidth + sx) * 4;
+                        for (unsigned int c = 0; c < 3; c++)
+                            sum[c] += srgb ? tables.decode[texel[c]] : texel[c];
+                        sum[3] += texel[3];
+                    }
+                }
+
+                float count = static_cast<float>((y1 - y0 + 1) * (x1 - x0 + 1));
+                unsigned char * texel = destination + (static_cast<size_t>(y) * mipWidth + x) * 4;
+                for (unsigned int c = 0; c < 3; c++)
+                {
+                    texel[c] = srgb ? tables.encode(sum[c] / count)
+                                    : static_cast<unsigned char>(sum[c] / count + 0.5f);
+                }
+                texel[3] = static_cast<unsigned char>(sum[3] / count + 0.5f);
+            }
+        }
+    }
+
+    return chain;
+}
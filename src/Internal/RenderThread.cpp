@@ -0,0 +1,129 @@
+#include <Adore/Internal/RenderThread.hpp>
+
+#include <chrono>
+
+// Spins a little for the short waits of a busy frame, then sleeps so an idle side costs nothing.
+static void pause(unsigned int& spins)
+{
+    if (spins++ < 64)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+RenderThread::RenderThread(std::function<void(CommandStream&)> const& replay)
+    : m_state(std::make_shared<State>())
+{
+    m_state->replay = replay;
+
+    m_recording = &m_state->streams[0];
+    for (size_t i = 1; i < STREAMS; i++)
+        m_spare.push_back(&m_state->streams[i]);
+
+    m_thread = std::thread(&RenderThread::run, m_state);
+}
+
+RenderThread::~RenderThread()
+{
+    // The last object holding the owner can be released by the thread itself, which then stops
+    // replaying and leaves once it has cleared what is left.
+    if (current())
+    {
+        m_state->replay = nullptr;
+        m_state->stopping.store(true, std::memory_order_release);
+        m_thread.detach();
+        return;
+    }
+
+    m_recording->clear();
+
+    try
+    {
+        finish();
+    }
+    catch (...)
+    {
+    }
+
+    m_state->stopping.store(true, std::memory_order_release);
+    m_thread.join();
+}
+
+void RenderThread::run(std::shared_ptr<State> state)
+{
+    unsigned int spins = 0;
+    CommandStream * stream;
+
+    for (;;)
+    {
+        if (!state->submitted.pop(stream))
+        {
+            if (state->stopping.load(std::memory_order_acquire)) return;
+            pause(spins);
+            continue;
+        }
+
+        spins = 0;
+
+        if (state->replay && !state->failed.load(std::memory_order_acquire))
+        {
+            try
+            {
+                state->replay(*stream);
+            }
+            catch (...)
+            {
+                state->error = std::current_exception();
+                state->failed.store(true, std::memory_order_release);
+            }
+        }
+
+        // Objects are released here, so resources recorded last are destroyed on this thread.
+        stream->clear();
+        state->replayed.push(stream);
+    }
+}
+
+void RenderThread::reclaim()
+{
+    CommandStream * stream;
+    while (m_state->replayed.pop(stream))
+        m_spare.push_back(stream);
+}
+
+void RenderThread::rethrow()
+{
+    if (!m_state->failed.load(std::memory_order_acquire)) return;
+
+    // The thread leaves the error alone while failed is set, so it can be taken before replaying
+    // starts again.
+    std::exception_ptr error = m_state->error;
+    m_state->error = nullptr;
+    m_state->failed.store(false, std::memory_order_release);
+    std::rethrow_exception(error);
+}
+
+void RenderThread::submit()
+{
+    m_state->submitted.push(m_recording);
+
+    unsigned int spins = 0;
+    for (reclaim(); m_spare.empty(); reclaim())
+        pause(spins);
+
+    m_recording = m_spare.back();
+    m_spare.pop_back();
+
+    rethrow();
+}
+
+void RenderThread::finish()
+{
+    if (current()) return;
+
+    unsigned int spins = 0;
+    for (reclaim(); m_spare.size() < STREAMS - 1; reclaim())
+        pause(spins);
+
+    rethrow();
+}
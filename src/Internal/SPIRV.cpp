@@ -0,0 +1,65 @@
+#include <Adore/Internal/SPIRV.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+
+static uint32_t const MAGIC = 0x07230203;
+
+SPIRV::SPIRV(Adore::ShaderModule const& module)
+{
+    std::string const name = module.path.empty() ? "in memory" : module.path;
+
+    if (!module.code.empty())
+    {
+        m_words = module.code.data();
+        m_count = module.code.size();
+    }
+    else if (module.words)
+    {
+        m_owner = module.words;
+        m_words = module.words.get();
+        m_count = module.count;
+    }
+    else
+    {
+        m_file = std::make_shared<MappedFile>(module.path);
+
+        if (m_file->size() % sizeof(uint32_t) != 0)
+            throw Adore::AdoreException("Shader file is not SPIR-V: " + module.path);
+
+        // Mappings start on a page boundary, so the words are aligned.
+        m_words = static_cast<uint32_t const *>(m_file->data());
+        m_count = m_file->size() / sizeof(uint32_t);
+        m_owner = std::shared_ptr<uint32_t const>(m_file, m_words);
+    }
+
+    if (m_count == 0 || m_words[0] != MAGIC)
+        throw Adore::AdoreException("Shader module is not SPIR-V: " + name);
+}
+
+std::shared_ptr<uint32_t const> SPIRV::share() const
+{
+    if (m_owner) return m_owner;
+
+    auto copy = std::make_shared<std::vector<uint32_t>>(m_words, m_words + m_count);
+    return std::shared_ptr<uint32_t const>(copy, copy->data());
+}
+
+bool SPIRV::equals(uint32_t const * words, size_t const& count) const
+{
+    return count == m_count && std::equal(m_words, m_words + m_count, words);
+}
+
+uint64_t SPIRV::hash() const
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < m_count; i++)
+        for (unsigned int byte = 0; byte < 4; byte++)
+        {
+            hash ^= (m_words[i] >> (8 * byte)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+
+    return hash;
+}
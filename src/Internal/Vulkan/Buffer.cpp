@@ -1,10 +1,13 @@
 #include <Adore/Internal/Vulkan/Buffer.hpp>
 #include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/RenderGraph.hpp>
 #include <Adore/Internal/Vulkan/Window.hpp>
 #include <Adore/Internal/Log.hpp>
 
 #include <stb_image.h>
 
+#include <algorithm>
+
 VkFilter getVulkanFilter(Adore::Filter const& filter)
 {
     switch (filter)
@@ -25,6 +28,28 @@ VkSamplerAddressMode getVulkanWrap(Adore::Wrap const& wrap)
     }
 }
 
+VkFormat getVulkanFormat(Adore::ImageFormat const& format)
+{
+    switch (format)
+    {
+        case Adore::ImageFormat::RGBA8: return VK_FORMAT_R8G8B8A8_UNORM;
+        case Adore::ImageFormat::RGBA8_SRGB: return VK_FORMAT_R8G8B8A8_SRGB;
+        case Adore::ImageFormat::RGBA16_FLOAT: return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case Adore::ImageFormat::RGBA32_FLOAT: return VK_FORMAT_R32G32B32A32_SFLOAT;
+    }
+}
+
+uint32_t getFormatSize(Adore::ImageFormat const& format)
+{
+    switch (format)
+    {
+        case Adore::ImageFormat::RGBA8: return 4;
+        case Adore::ImageFormat::RGBA8_SRGB: return 4;
+        case Adore::ImageFormat::RGBA16_FLOAT: return 8;
+        case Adore::ImageFormat::RGBA32_FLOAT: return 16;
+    }
+}
+
 uint32_t memoryTypeIndex(uint32_t const& memoryTypeBits,
                          VkPhysicalDevice const& physicalDevice,
                          VkMemoryPropertyFlags const& properties)
@@ -42,16 +67,31 @@ uint32_t memoryTypeIndex(uint32_t const& memoryTypeBits,
     throw Adore::AdoreException("Failed to find suitable Vulkan memory type.");
 }
 
-void createBuffer(VkDevice const& device, VkPhysicalDevice const& physicalDevice,
-                  VkDeviceSize size, VkBufferUsageFlags usage,
-                  VkMemoryPropertyFlags properties,
-                  VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+static void setSharing(std::vector<uint32_t> const& queueFamilies, VkSharingMode& mode,
+                       uint32_t& familyCount, uint32_t const*& pfamilies)
+{
+    bool concurrent = queueFamilies.size() > 1
+        && std::any_of(queueFamilies.begin(), queueFamilies.end(),
+                       [&](uint32_t const& family) { return family != queueFamilies[0]; });
+
+    mode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    familyCount = concurrent ? queueFamilies.size() : 0;
+    pfamilies = concurrent ? queueFamilies.data() : nullptr;
+}
+
+void createBuffer(VulkanMemory& memory, VkDeviceSize size, VkBufferUsageFlags usage,
+                  VkMemoryPropertyFlags properties, Adore::MemoryCategory const& category,
+                  VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+                  std::vector<uint32_t> const& queueFamilies)
 {
+    VkDevice const& device = memory.device();
+
     VkBufferCreateInfo bufferInfo {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    setSharing(queueFamilies, bufferInfo.sharingMode, bufferInfo.queueFamilyIndexCount,
+               bufferInfo.pQueueFamilyIndices);
 
     if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to create Vulkan buffer.");
@@ -59,18 +99,100 @@ void createBuffer(VkDevice const& device, VkPhysicalDevice const& physicalDevice
     VkMemoryRequirements memReqs;
     vkGetBufferMemoryRequirements(device, buffer, &memReqs);
 
-    VkMemoryAllocateInfo allocInfo {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memReqs.size;
-    allocInfo.memoryTypeIndex = memoryTypeIndex(memReqs.memoryTypeBits, physicalDevice, properties);
-
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to allocate Vulkan buffer memory.");
+    bufferMemory = memory.allocate(memReqs.size,
+                                   memoryTypeIndex(memReqs.memoryTypeBits, memory.physicalDevice(), properties),
+                                   category);
 
     if (vkBindBufferMemory(device, buffer, bufferMemory, 0) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to bind Vulkan buffer memory.");
 }
 
+void createImage(VulkanMemory& memory, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
+                 VkMemoryPropertyFlags properties, Adore::MemoryCategory const& category,
+                 VkImage& image, VkDeviceMemory& imageMemory,
+                 std::vector<uint32_t> const& queueFamilies, uint32_t const& mipLevels)
+{
+    VkDevice const& device = memory.device();
+
+    VkImageCreateInfo imageInfo {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = width;
+    imageInfo.extent.height = height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = usage;
+    setSharing(queueFamilies, imageInfo.sharingMode, imageInfo.queueFamilyIndexCount,
+               imageInfo.pQueueFamilyIndices);
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.flags = 0;
+
+    if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan image.");
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, image, &memReqs);
+
+    imageMemory = memory.allocate(memReqs.size,
+                                  memoryTypeIndex(memReqs.memoryTypeBits, memory.physicalDevice(), properties),
+                                  category);
+
+    vkBindImageMemory(device, image, imageMemory, 0);
+}
+
+VkImageView createImageView(VkDevice const& device, VkImage const& image,
+                            VkFormat format, VkImageAspectFlags aspect, uint32_t const& mipLevels)
+{
+    VkImageViewCreateInfo viewInfo {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange = { aspect, 0, mipLevels, 0, 1 };
+
+    VkImageView view;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan image view.");
+
+    return view;
+}
+
+VkSampler createSampler(VkDevice const& device, VkPhysicalDevice const& physicalDevice,
+                        Adore::Filter const& filter, Adore::Wrap const& wrap, float const& maxLod)
+{
+    VkSamplerCreateInfo samplerInfo {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = getVulkanFilter(filter);
+    samplerInfo.minFilter = getVulkanFilter(filter);
+    samplerInfo.addressModeU = getVulkanWrap(wrap);
+    samplerInfo.addressModeV = getVulkanWrap(wrap);
+    samplerInfo.addressModeW = getVulkanWrap(wrap);
+    samplerInfo.anisotropyEnable = VK_TRUE;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_TRANSPARENT_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = maxLod;
+
+    VkSampler sampler;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan sampler.");
+
+    return sampler;
+}
+
 void copyBuffer(VulkanRenderer * prenderer, VkBuffer const& srcBuffer, VkBuffer const& dstBuffer, VkDeviceSize size)
 {
     auto cmdBuf = prenderer->beginCommandBuffer();
@@ -85,46 +207,79 @@ void copyBuffer(VulkanRenderer * prenderer, VkBuffer const& srcBuffer, VkBuffer
     prenderer->endCommandBuffer(cmdBuf);
 }
 
-void transitionImageLayout(VulkanRenderer * prenderer, VkImage const& image, VkImageLayout oldLayout, VkImageLayout newLayout)
+// Without the whole device local heap being mappable, the small BAR window would run out.
+static bool mappableDeviceMemory(VkPhysicalDevice const& physicalDevice)
 {
-    VkCommandBuffer commandBuffer = prenderer->beginCommandBuffer();
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
 
-    VkImageMemoryBarrier barrier {};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = image;
-    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    VkMemoryPropertyFlags const direct = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-    VkPipelineStageFlags srcStage = 0, dstStage = 0;
+    VkDeviceSize largest = 0;
+    VkDeviceSize mappable = 0;
 
-    if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-    {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    for (uint32_t i = 0; i < memProperties.memoryHeapCount; i++)
+        if (memProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            largest = std::max(largest, memProperties.memoryHeaps[i].size);
 
-        srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT; 
-    }
-    else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+        if ((memProperties.memoryTypes[i].propertyFlags & direct) == direct)
+            mappable = std::max(mappable, memProperties.memoryHeaps[memProperties.memoryTypes[i].heapIndex].size);
+
+    return mappable != 0 && mappable >= largest;
+}
+
+void uploadBuffer(VulkanRenderer * prenderer, void const * pdata, VkDeviceSize size,
+                  VkBufferUsageFlags usage, Adore::MemoryCategory const& category,
+                  VkBuffer& buffer, VkDeviceMemory& memory,
+                  std::vector<uint32_t> const& queueFamilies)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(prenderer->window().get());
 
-        srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    if (mappableDeviceMemory(pwindow->physicalDevice()))
+    {
+        createBuffer(pwindow->memory(), size, usage,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                     | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     category, buffer, memory, queueFamilies);
+
+        void * map;
+        vkMapMemory(pwindow->device(), memory, 0, size, 0, &map);
+            memcpy(map, pdata, size);
+        vkUnmapMemory(pwindow->device(), memory);
+        return;
     }
 
-    vkCmdPipelineBarrier
-    (
-        commandBuffer,
-        srcStage, dstStage,
-        0, 0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+
+    createBuffer(pwindow->memory(), size,
+                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 Adore::MemoryCategory::STAGING, stagingBuffer, stagingBufferMemory);
+
+    void * map;
+    vkMapMemory(pwindow->device(), stagingBufferMemory, 0, size, 0, &map);
+        memcpy(map, pdata, size);
+    vkUnmapMemory(pwindow->device(), stagingBufferMemory);
+
+    createBuffer(pwindow->memory(), size,
+                 usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 category, buffer, memory, queueFamilies);
+
+    copyBuffer(prenderer, stagingBuffer, buffer, size);
+
+    vkDestroyBuffer(pwindow->device(), stagingBuffer, nullptr);
+    pwindow->memory().free(stagingBufferMemory);
+}
+
+void transitionImageLayout(VulkanRenderer * prenderer, VkImage const& image,
+                           RenderGraph::Access const& from, RenderGraph::Access const& to)
+{
+    VkCommandBuffer commandBuffer = prenderer->beginCommandBuffer();
+
+    RenderGraph::barrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, from, to);
 
     prenderer->endCommandBuffer(commandBuffer);
 }
@@ -156,33 +311,16 @@ void copyBufferToImage(VulkanRenderer * prenderer, VkBuffer const& buffer, VkIma
 
 VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<Adore::Renderer>& renderer,
                         void* pdata, uint64_t const& size)
-    : Adore::IndexBuffer(renderer)
+    : Adore::IndexBuffer(renderer), m_size(size)
 {
     VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
-    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
 
-    createBuffer(pwindow->device(), pwindow->physicalDevice(), size,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
+    // Captures copy the contents back out.
+    uploadBuffer(prenderer, pdata, size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 Adore::MemoryCategory::INDEX, m_buffer, m_memory);
 
-    void * map;
-    vkMapMemory(pwindow->device(), stagingBufferMemory, 0, size, 0, &map);
-        memcpy(map, pdata, size);
-    vkUnmapMemory(pwindow->device(), stagingBufferMemory);
-
-    createBuffer(pwindow->device(), pwindow->physicalDevice(), size,
-                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                 m_buffer, m_memory);
-
-    copyBuffer(prenderer, stagingBuffer, m_buffer, size);
-
-    vkDestroyBuffer(pwindow->device(), stagingBuffer, nullptr);
-    vkFreeMemory(pwindow->device(), stagingBufferMemory, nullptr);
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_handle = prenderer->indexBuffers().insert({ m_buffer, this });
 
     ADORE_INTERNAL_LOG(INFO, "Created Vulkan Index buffer.");
 }
@@ -190,48 +328,23 @@ VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<Adore::Renderer>& renderer,
 VulkanIndexBuffer::~VulkanIndexBuffer()
 {
     VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    static_cast<VulkanRenderer*>(m_renderer.get())->indexBuffers().remove(m_handle);
     vkDestroyBuffer(pwindow->device(), m_buffer, nullptr);
-    vkFreeMemory(pwindow->device(), m_memory, nullptr);
+    pwindow->memory().free(m_memory);
 }
 
 VulkanVertexBuffer::VulkanVertexBuffer(std::shared_ptr<Adore::Renderer>& renderer,
                         void* pdata, uint64_t const& size)
-    : Adore::VertexBuffer(renderer)
+    : Adore::VertexBuffer(renderer), m_size(size)
 {
     VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
-    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    createBuffer(pwindow->device(), pwindow->physicalDevice(), size,
-                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
-
-    void * map;
-    vkMapMemory(pwindow->device(), stagingBufferMemory, 0, size, 0, &map);
-        memcpy(map, pdata, size);
-    vkUnmapMemory(pwindow->device(), stagingBufferMemory);
-
-    createBuffer(pwindow->device(), pwindow->physicalDevice(), size,
-                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                 m_buffer, m_memory);
-
-    auto cmdBuf = prenderer->beginCommandBuffer();
 
-    VkBufferCopy copyRegion {};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = size;
+    uploadBuffer(prenderer, pdata, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 Adore::MemoryCategory::VERTEX, m_buffer, m_memory);
 
-    vkCmdCopyBuffer(cmdBuf, stagingBuffer, m_buffer, 1, &copyRegion);
-
-    prenderer->endCommandBuffer(cmdBuf);
-
-    vkDestroyBuffer(pwindow->device(), stagingBuffer, nullptr);
-    vkFreeMemory(pwindow->device(), stagingBufferMemory, nullptr);
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_handle = prenderer->vertexBuffers().insert({ m_buffer, this });
 
     ADORE_INTERNAL_LOG(INFO, "Created Vulkan Vertex buffer.");
 }
@@ -239,8 +352,10 @@ VulkanVertexBuffer::VulkanVertexBuffer(std::shared_ptr<Adore::Renderer>& rendere
 VulkanVertexBuffer::~VulkanVertexBuffer()
 {
     VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    static_cast<VulkanRenderer*>(m_renderer.get())->vertexBuffers().remove(m_handle);
     vkDestroyBuffer(pwindow->device(), m_buffer, nullptr);
-    vkFreeMemory(pwindow->device(), m_memory, nullptr);
+    pwindow->memory().free(m_memory);
 }
 
 VulkanUniformBuffer::VulkanUniformBuffer(std::shared_ptr<Adore::Renderer>& renderer,
@@ -256,10 +371,10 @@ VulkanUniformBuffer::VulkanUniformBuffer(std::shared_ptr<Adore::Renderer>& rende
 
     for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
     {
-        createBuffer(pwindow->device(), pwindow->physicalDevice(), size,
+        createBuffer(pwindow->memory(), size,
                      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     m_buffers[i], m_memories[i]);
+                     Adore::MemoryCategory::UNIFORM, m_buffers[i], m_memories[i]);
         vkMapMemory(pwindow->device(), m_memories[i], 0, size, 0, &m_maps[i]);
         memcpy(m_maps[i], pdata, size);
     }
@@ -267,6 +382,11 @@ VulkanUniformBuffer::VulkanUniformBuffer(std::shared_ptr<Adore::Renderer>& rende
 }
 
 void VulkanUniformBuffer::set(void const * pdata)
+{
+    static_cast<VulkanRenderer*>(m_renderer.get())->set(shared_from_this(), pdata);
+}
+
+void VulkanUniformBuffer::store(void const * pdata)
 {
     for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
         m_changed[i] = true;
@@ -276,10 +396,11 @@ void VulkanUniformBuffer::set(void const * pdata)
 VulkanUniformBuffer::~VulkanUniformBuffer()
 {
     VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
     for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
     {
         vkDestroyBuffer(pwindow->device(), m_buffers[i], nullptr);
-        vkFreeMemory(pwindow->device(), m_memories[i], nullptr);
+        pwindow->memory().free(m_memories[i]);
     }
 }
 
@@ -299,117 +420,160 @@ VkBuffer VulkanUniformBuffer::buffer(size_t const& index)
 
 VulkanSampler::VulkanSampler(std::shared_ptr<Adore::Renderer>& renderer, const char* path,
                              Adore::Filter const& filter, Adore::Wrap const& wrap)
-    : Adore::Sampler(renderer)
+    : Adore::Sampler(renderer), m_format(Adore::ImageFormat::RGBA8_SRGB), m_filter(filter), m_wrap(wrap)
 {
-    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
-    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
-
     int width, height, channels;
     stbi_uc * pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
 
     if (!pixels) throw Adore::AdoreException("Failed to load image: " + std::string(path));
 
+    m_width = width;
+    m_height = height;
     VkDeviceSize imageSize = width * height * 4; // 1 byte per channel
 
+    try
+    {
+        upload(pixels, width, height, VK_FORMAT_R8G8B8A8_SRGB, imageSize, filter, wrap);
+    }
+    catch (...)
+    {
+        stbi_image_free(pixels);
+        throw;
+    }
+
+    stbi_image_free(pixels);
+}
+
+VulkanSampler::VulkanSampler(std::shared_ptr<Adore::Renderer>& renderer, void const * pixels,
+                             uint32_t const& width, uint32_t const& height,
+                             Adore::ImageFormat const& format,
+                             Adore::Filter const& filter, Adore::Wrap const& wrap)
+    : Adore::Sampler(renderer), m_width(width), m_height(height), m_format(format), m_filter(filter), m_wrap(wrap)
+{
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(width) * height * getFormatSize(format);
+    upload(pixels, width, height, getVulkanFormat(format), imageSize, filter, wrap);
+}
+
+// Sampled images are optimally tiled, so unlike buffers they always go through staging.
+void VulkanSampler::upload(void const * pixels, uint32_t const& width, uint32_t const& height,
+                           VkFormat const& format, VkDeviceSize const& size,
+                           Adore::Filter const& filter, Adore::Wrap const& wrap)
+{
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
 
-    createBuffer(pwindow->device(), pwindow->physicalDevice(), imageSize,
+    createBuffer(pwindow->memory(), size,
                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
+                 Adore::MemoryCategory::STAGING, stagingBuffer, stagingBufferMemory);
 
     void* data;
-    vkMapMemory(pwindow->device(), stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels, imageSize);
+    vkMapMemory(pwindow->device(), stagingBufferMemory, 0, size, 0, &data);
+        memcpy(data, pixels, size);
     vkUnmapMemory(pwindow->device(), stagingBufferMemory);
 
-    stbi_image_free(pixels);
-
-    VkImageCreateInfo imageInfo {};
-    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    imageInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageInfo.extent.width = width;
-    imageInfo.extent.height = height;
-    imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
-    imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-    imageInfo.flags = 0;
-
-    if (vkCreateImage(pwindow->device(), &imageInfo, nullptr, &m_image) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to create Vulkan image.");
-
-    VkMemoryRequirements memReqs;
-    vkGetImageMemoryRequirements(pwindow->device(), m_image, &memReqs);
-
-    VkMemoryAllocateInfo allocInfo {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memReqs.size;
-    allocInfo.memoryTypeIndex = memoryTypeIndex(memReqs.memoryTypeBits, 
-                                                pwindow->physicalDevice(),
-                                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-                                
-    if (vkAllocateMemory(pwindow->device(), &allocInfo, nullptr, &m_memory) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to allocate Vulkan image memory.");
-    
-    vkBindImageMemory(pwindow->device(), m_image, m_memory, 0);
+    createImage(pwindow->memory(), width, height, format,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Adore::MemoryCategory::IMAGE, m_image, m_memory);
 
-    transitionImageLayout(prenderer, m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    transitionImageLayout(prenderer, m_image, RenderGraph::Access::NONE, RenderGraph::Access::TRANSFER_DST);
     
     copyBufferToImage(prenderer, stagingBuffer, m_image, width, height);
 
     vkDestroyBuffer(pwindow->device(), stagingBuffer, nullptr);
-    vkFreeMemory(pwindow->device(), stagingBufferMemory, nullptr);
+    pwindow->memory().free(stagingBufferMemory);
 
-    transitionImageLayout(prenderer, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    transitionImageLayout(prenderer, m_image, RenderGraph::Access::TRANSFER_DST, RenderGraph::Access::FRAGMENT_SAMPLED);
 
-    VkImageViewCreateInfo viewInfo {};
-    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    viewInfo.image = m_image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
-    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    m_view = createImageView(pwindow->device(), m_image, format, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_sampler = createSampler(pwindow->device(), pwindow->physicalDevice(), filter, wrap);
+}
 
-    if (vkCreateImageView(pwindow->device(), &viewInfo, nullptr, &m_view) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to create Vulkan image view.");
+VulkanSampler::~VulkanSampler()
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    vkDestroySampler(pwindow->device(), m_sampler, nullptr);
+    vkDestroyImageView(pwindow->device(), m_view, nullptr);
+    vkDestroyImage(pwindow->device(), m_image, nullptr);
+    pwindow->memory().free(m_memory);
+}
 
-    VkSamplerCreateInfo samplerInfo {};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = getVulkanFilter(filter);
-    samplerInfo.minFilter = getVulkanFilter(filter);
-    samplerInfo.addressModeU = getVulkanWrap(wrap);
-    samplerInfo.addressModeV = getVulkanWrap(wrap);
-    samplerInfo.addressModeW = getVulkanWrap(wrap);
-    samplerInfo.anisotropyEnable = VK_TRUE;
+VulkanStorageBuffer::VulkanStorageBuffer(std::shared_ptr<Adore::Renderer>& renderer,
+                                         void* pdata, uint64_t const& size)
+    : Adore::StorageBuffer(renderer, size)
+{
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
 
-    VkPhysicalDeviceProperties properties;
-    vkGetPhysicalDeviceProperties(pwindow->physicalDevice(), &properties);
+    // Compute output is commonly drawn from directly, so allow every use that makes sense.
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+        | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+        | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
-    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_TRANSPARENT_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.mipLodBias = 0.0f;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    std::vector<uint32_t> queueFamilies { pwindow->queueIndices().graphics, pwindow->queueIndices().compute };
 
-    if (vkCreateSampler(pwindow->device(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to create Vulkan sampler.");
+    if (pdata)
+        uploadBuffer(prenderer, pdata, size, usage, Adore::MemoryCategory::STORAGE, m_buffer, m_memory, queueFamilies);
+    else
+    {
+        createBuffer(pwindow->memory(), size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     Adore::MemoryCategory::STORAGE, m_buffer, m_memory, queueFamilies);
+
+        auto cmdBuf = prenderer->beginCommandBuffer();
+        vkCmdFillBuffer(cmdBuf, m_buffer, 0, VK_WHOLE_SIZE, 0);
+        prenderer->endCommandBuffer(cmdBuf);
+    }
+
+    ADORE_INTERNAL_LOG(INFO, "Created Vulkan Storage buffer.");
 }
 
-VulkanSampler::~VulkanSampler()
+VulkanStorageBuffer::~VulkanStorageBuffer()
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    vkDestroyBuffer(pwindow->device(), m_buffer, nullptr);
+    pwindow->memory().free(m_memory);
+}
+
+VulkanStorageImage::VulkanStorageImage(std::shared_ptr<Adore::Renderer>& renderer,
+                                       uint32_t const& width, uint32_t const& height,
+                                       Adore::ImageFormat const& format,
+                                       Adore::Filter const& filter, Adore::Wrap const& wrap)
+    : Adore::StorageImage(renderer, width, height)
+{
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    VkFormat vkformat = getVulkanFormat(format);
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(pwindow->physicalDevice(), vkformat, &properties);
+
+    if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+        throw Adore::AdoreException("Image format can not be used for storage images on this device.");
+
+    createImage(pwindow->memory(), width, height, vkformat,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Adore::MemoryCategory::IMAGE, m_image, m_memory,
+                { pwindow->queueIndices().graphics, pwindow->queueIndices().compute });
+
+    // Storage images never leave GENERAL, so compute and graphics can use them without transitions.
+    transitionImageLayout(prenderer, m_image, RenderGraph::Access::NONE, RenderGraph::Access::COMPUTE_WRITE);
+    m_layout = VK_IMAGE_LAYOUT_GENERAL;
+
+    m_view = createImageView(pwindow->device(), m_image, vkformat, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_sampler = createSampler(pwindow->device(), pwindow->physicalDevice(), filter, wrap);
+
+    ADORE_INTERNAL_LOG(INFO, "Created Vulkan Storage image.");
+}
+
+VulkanStorageImage::~VulkanStorageImage()
 {
     VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
     vkDestroySampler(pwindow->device(), m_sampler, nullptr);
     vkDestroyImageView(pwindow->device(), m_view, nullptr);
     vkDestroyImage(pwindow->device(), m_image, nullptr);
-    vkFreeMemory(pwindow->device(), m_memory, nullptr);
-}
\ No newline at end of file
+    pwindow->memory().free(m_memory);
+}
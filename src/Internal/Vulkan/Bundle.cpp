@@ -0,0 +1,152 @@
+#include <Adore/Internal/Vulkan/Bundle.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Vulkan/Shader.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+#include <Adore/Internal/Vulkan/DrawList.hpp>
+#include <Adore/Internal/Log.hpp>
+#include <Adore/Internal/FramesInFlight.hpp>
+
+VulkanBundle::VulkanBundle(std::shared_ptr<Adore::Renderer>& renderer, std::shared_ptr<Adore::Shader>& shader)
+    : Bundle(renderer, shader)
+{
+    auto prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    auto pshader = static_cast<VulkanShader*>(m_shader.get());
+
+    if (m_renderer->window() != m_shader->window())
+        throw Adore::AdoreException("Shader was not created with the same Window as the Renderer.");
+
+    if (pshader->bindPoint() != VK_PIPELINE_BIND_POINT_GRAPHICS || pshader->renderPass() != pwindow->renderpass())
+        throw Adore::AdoreException("Bundles can only be recorded with a window shader.");
+
+    m_buffers.resize(FRAMES_IN_FLIGHT);
+    m_recorded.resize(FRAMES_IN_FLIGHT, { 0, 0, 0 });
+
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+
+    VkCommandBufferAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = prenderer->commandPool();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = m_buffers.size();
+
+    if (vkAllocateCommandBuffers(pwindow->device(), &allocInfo, m_buffers.data()) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to allocate Vulkan secondary command buffers.");
+}
+
+VulkanBundle::~VulkanBundle()
+{
+    auto prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    VkDevice device = pwindow->device();
+    VkCommandPool pool = prenderer->commandPool();
+
+    prenderer->retire(m_executed, [device, pool, buffers = std::move(m_buffers), commands = std::move(m_commands)]()
+    {
+        vkFreeCommandBuffers(device, pool, buffers.size(), buffers.data());
+    });
+}
+
+VkCommandBuffer const& VulkanBundle::record(uint32_t const& frame)
+{
+    auto prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    auto pshader = static_cast<VulkanShader*>(m_shader.get());
+    // Refreshing first means a streamed texture's new view re-records the bundle before it is bound.
+    std::tuple<uint64_t, uint64_t, uint64_t> current = { m_version, pwindow->swapchainVersion(), pshader->refresh(frame, prenderer->startedFrames()) };
+    m_executed = prenderer->startedFrames();
+
+    if (m_recorded[frame] == current) return m_buffers[frame];
+
+    auto commandBuffer = m_buffers[frame];
+
+    prenderer->beginSecondary(commandBuffer);
+    prenderer->bindShader(commandBuffer, pshader);
+    VulkanRenderer::setViewport(commandBuffer, pwindow->extent());
+
+    for (auto const& command : m_commands)
+        command(commandBuffer);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to end Vulkan secondary command buffer.");
+
+    m_recorded[frame] = current;
+    return m_buffers[frame];
+}
+
+// Commands hold on to their resources so they outlive every recording that uses them, cleared
+// ones are retired until the frames that executed them have finished. A render thread records
+// bundles as it replays a frame, which changing them waits for.
+
+void VulkanBundle::bind(std::shared_ptr<Adore::VertexBuffer>& buffer, uint32_t const& binding)
+{
+    if (buffer->renderer() != m_renderer)
+        throw Adore::AdoreException("Vertex Buffer is not bound to this renderer.");
+
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_commands.push_back([buffer, binding](VkCommandBuffer const& commandBuffer)
+    {
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, binding, 1,
+                               &static_cast<VulkanVertexBuffer*>(buffer.get())->buffer(), &offset);
+    });
+    m_version++;
+}
+
+void VulkanBundle::bind(std::shared_ptr<Adore::IndexBuffer>& buffer)
+{
+    if (buffer->renderer() != m_renderer)
+        throw Adore::AdoreException("Index Buffer is not bound to this renderer.");
+
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_commands.push_back([buffer](VkCommandBuffer const& commandBuffer)
+    {
+        vkCmdBindIndexBuffer(commandBuffer, static_cast<VulkanIndexBuffer*>(buffer.get())->buffer(),
+                             0, VK_INDEX_TYPE_UINT16);
+    });
+    m_version++;
+}
+
+void VulkanBundle::draw(uint32_t const& count)
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_commands.push_back([count](VkCommandBuffer const& commandBuffer)
+    {
+        vkCmdDraw(commandBuffer, count, 1, 0, 0);
+    });
+    m_version++;
+}
+
+void VulkanBundle::drawIndexed(uint32_t const& count)
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_commands.push_back([count](VkCommandBuffer const& commandBuffer)
+    {
+        vkCmdDrawIndexed(commandBuffer, count, 1, 0, 0, 0);
+    });
+    m_version++;
+}
+
+void VulkanBundle::draw(std::shared_ptr<Adore::DrawList>& list)
+{
+    if (list->renderer() != m_renderer)
+        throw Adore::AdoreException("Draw List is not bound to this renderer.");
+
+    auto prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    m_commands.push_back([prenderer, list](VkCommandBuffer const& commandBuffer)
+    {
+        prenderer->drawIndirect(commandBuffer, static_cast<VulkanDrawList*>(list.get()));
+    });
+    m_version++;
+}
+
+void VulkanBundle::clear()
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    static_cast<VulkanRenderer*>(m_renderer.get())->retire(m_executed, [commands = std::move(m_commands)]() {});
+    m_commands.clear();
+    m_version++;
+}
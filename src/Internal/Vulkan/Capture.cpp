@@ -0,0 +1,334 @@
+#include <Adore/Internal/Vulkan/Capture.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/Shader.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/SPIRV.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <cstring>
+
+VulkanCapture::VulkanCapture(VulkanRenderer * prenderer, std::string const& path, uint32_t const& frames)
+    : m_renderer(prenderer), m_file(path, std::ios::binary), m_frames(frames)
+{
+    if (!m_file)
+        throw Adore::AdoreException("Failed to open capture file " + path + ".");
+
+    VkExtent2D const& extent = static_cast<VulkanWindow*>(m_renderer->window().get())->extent();
+
+    write(Adore::CAPTURE_MAGIC);
+    write(Adore::CAPTURE_VERSION);
+    write(extent.width);
+    write(extent.height);
+
+    m_frameStart = std::chrono::steady_clock::now();
+
+    ADORE_INTERNAL_LOG(INFO, "Capturing " + std::to_string(frames) + " frames to " + path + ".");
+}
+
+VulkanCapture::~VulkanCapture()
+{
+    write(Adore::CaptureRecord::SKIPPED);
+    write(m_skipped);
+
+    if (m_skipped)
+    {
+        ADORE_INTERNAL_LOG(WARN, "Capture finished, " + std::to_string(m_skipped) + " calls were left out.");
+        return;
+    }
+
+    ADORE_INTERNAL_LOG(INFO, "Capture finished.");
+}
+
+std::pair<uint32_t, bool> VulkanCapture::id(std::unordered_map<uint32_t, uint32_t>& ids, uint32_t const& handle)
+{
+    auto found = ids.find(handle);
+    if (found != ids.end()) return { found->second, false };
+
+    ids[handle] = m_nextId;
+    return { m_nextId++, true };
+}
+
+std::pair<uint32_t, bool> VulkanCapture::id(std::shared_ptr<void> const& resource)
+{
+    Resource& entry = m_ids[resource.get()];
+    if (!entry.resource.expired()) return { entry.id, false };
+
+    entry = { m_nextId, resource };
+    return { m_nextId++, true };
+}
+
+std::vector<uint8_t> VulkanCapture::readBuffer(VkBuffer const& buffer, VkDeviceSize const& size)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+
+    createBuffer(pwindow->memory(), size,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 Adore::MemoryCategory::STAGING, stagingBuffer, stagingBufferMemory);
+
+    copyBuffer(m_renderer, buffer, stagingBuffer, size);
+
+    std::vector<uint8_t> contents(size);
+    void * map;
+    vkMapMemory(pwindow->device(), stagingBufferMemory, 0, size, 0, &map);
+        memcpy(contents.data(), map, size);
+    vkUnmapMemory(pwindow->device(), stagingBufferMemory);
+
+    vkDestroyBuffer(pwindow->device(), stagingBuffer, nullptr);
+    pwindow->memory().free(stagingBufferMemory);
+
+    return contents;
+}
+
+uint32_t VulkanCapture::uniform(std::shared_ptr<Adore::UniformBuffer> const& buffer)
+{
+    auto resource = id(buffer);
+    if (!resource.second) return resource.first;
+
+    write(Adore::CaptureRecord::UNIFORM_BUFFER);
+    write(resource.first);
+    write<uint64_t>(buffer->size());
+    write(buffer->get(), buffer->size());
+
+    return resource.first;
+}
+
+uint32_t VulkanCapture::texture(std::shared_ptr<Adore::Sampler> const& sampler)
+{
+    auto resource = id(sampler);
+    if (!resource.second) return resource.first;
+
+    uint32_t width = 1;
+    uint32_t height = 1;
+    Adore::ImageFormat format = Adore::ImageFormat::RGBA8;
+    Adore::Filter filter = Adore::Filter::LINEAR;
+    Adore::Wrap wrap = Adore::Wrap::REPEAT;
+    std::vector<uint8_t> pixels(4, 255);
+
+    // Storage images and streamed textures change after they are made, they are replaced by white.
+    VulkanSampler * psampler = dynamic_cast<VulkanSampler*>(sampler.get());
+    if (psampler)
+    {
+        VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+        width = psampler->width();
+        height = psampler->height();
+        format = psampler->format();
+        filter = psampler->filter();
+        wrap = psampler->wrap();
+
+        VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * getFormatSize(format);
+
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+
+        createBuffer(pwindow->memory(), size,
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     Adore::MemoryCategory::STAGING, stagingBuffer, stagingBufferMemory);
+
+        VkCommandBuffer commandBuffer = m_renderer->beginCommandBuffer();
+
+        RenderGraph::barrier(commandBuffer, psampler->image(), VK_IMAGE_ASPECT_COLOR_BIT,
+                             RenderGraph::Access::FRAGMENT_SAMPLED, RenderGraph::Access::TRANSFER_SRC);
+
+        VkBufferImageCopy region {};
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        region.imageExtent = { width, height, 1 };
+
+        vkCmdCopyImageToBuffer(commandBuffer, psampler->image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               stagingBuffer, 1, &region);
+
+        RenderGraph::barrier(commandBuffer, psampler->image(), VK_IMAGE_ASPECT_COLOR_BIT,
+                             RenderGraph::Access::TRANSFER_SRC, RenderGraph::Access::FRAGMENT_SAMPLED);
+
+        m_renderer->endCommandBuffer(commandBuffer);
+
+        pixels.resize(size);
+        void * map;
+        vkMapMemory(pwindow->device(), stagingBufferMemory, 0, size, 0, &map);
+            memcpy(pixels.data(), map, size);
+        vkUnmapMemory(pwindow->device(), stagingBufferMemory);
+
+        vkDestroyBuffer(pwindow->device(), stagingBuffer, nullptr);
+        pwindow->memory().free(stagingBufferMemory);
+    }
+    else
+        m_skipped++;
+
+    write(Adore::CaptureRecord::TEXTURE);
+    write(resource.first);
+    write(width);
+    write(height);
+    write<uint32_t>(static_cast<uint32_t>(format));
+    write<uint32_t>(static_cast<uint32_t>(filter));
+    write<uint32_t>(static_cast<uint32_t>(wrap));
+    write(pixels.data(), pixels.size());
+
+    return resource.first;
+}
+
+uint32_t VulkanCapture::shader(std::shared_ptr<Adore::Shader> const& shader)
+{
+    VulkanShader * pshader = static_cast<VulkanShader*>(shader.get());
+    auto resource = id(shader);
+
+    if (resource.second)
+    {
+        write(Adore::CaptureRecord::SHADER);
+        write(resource.first);
+
+        write<uint32_t>(static_cast<uint32_t>(pshader->sources().size()));
+        for (auto const& source : pshader->sources())
+        {
+            SPIRV code(source);
+            write<uint32_t>(static_cast<uint32_t>(source.type));
+            write<uint32_t>(static_cast<uint32_t>(code.count()));
+            write(code.words(), code.count() * sizeof(uint32_t));
+        }
+
+        Adore::LayoutDescriptor const& descriptor = pshader->descriptor();
+        write<uint32_t>(static_cast<uint32_t>(descriptor.attributes.size()));
+        write(descriptor.attributes.data(), descriptor.attributes.size() * sizeof(Adore::AttributeLayout));
+        write<uint32_t>(static_cast<uint32_t>(descriptor.bindings.size()));
+        write(descriptor.bindings.data(), descriptor.bindings.size() * sizeof(Adore::BindingLayout));
+        write<uint32_t>(static_cast<uint32_t>(descriptor.resources.size()));
+        write(descriptor.resources.data(), descriptor.resources.size() * sizeof(Adore::ResourceLayout));
+        write(descriptor.pushConstants);
+
+        Adore::ShaderVariant variant = shaderVariant(pshader->state());
+        write<uint32_t>(static_cast<uint32_t>(variant.blend));
+        write<uint32_t>(static_cast<uint32_t>(variant.cull));
+        write<uint32_t>(static_cast<uint32_t>(variant.topology));
+        write<uint8_t>(variant.depthTest);
+        write<uint8_t>(variant.depthWrite);
+        write<uint8_t>(variant.wireframe);
+        write(variant.lineWidth);
+        write<uint32_t>(static_cast<uint32_t>(variant.specialization.size()));
+        write(variant.specialization.data(), variant.specialization.size() * sizeof(Adore::SpecializationValue));
+    }
+
+    // Binding and id pairs, uniforms first. Resources are written before the records naming them.
+    std::vector<uint32_t> attached;
+    for (auto const& binding : pshader->uniforms())
+    {
+        attached.push_back(binding.binding);
+        attached.push_back(uniform(binding.resource));
+    }
+    size_t uniforms = attached.size();
+    for (auto const& binding : pshader->samplers())
+    {
+        attached.push_back(binding.binding);
+        attached.push_back(texture(binding.resource));
+    }
+
+    std::vector<uint32_t>& last = m_attached[resource.first];
+    if (attached != last)
+    {
+        for (size_t i = 0; i < attached.size(); i += 2)
+        {
+            write(i < uniforms ? Adore::CaptureRecord::ATTACH_UNIFORM : Adore::CaptureRecord::ATTACH_SAMPLER);
+            write(resource.first);
+            write(attached[i]);
+            write(attached[i + 1]);
+        }
+        last = attached;
+    }
+
+    if (resource.second)
+        m_skipped += pshader->storageBuffers().size() + pshader->storageImages().size();
+
+    return resource.first;
+}
+
+void VulkanCapture::begin(std::shared_ptr<Adore::Shader> const& shader)
+{
+    uint32_t shaderId = this->shader(shader);
+
+    write(Adore::CaptureRecord::BEGIN);
+    write(shaderId);
+}
+
+void VulkanCapture::end()
+{
+    auto now = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - m_frameStart).count();
+    m_frameStart = now;
+
+    write(Adore::CaptureRecord::END);
+    write(Adore::CaptureRecord::FRAME);
+    write(ms);
+
+    if (m_frames) m_frames--;
+}
+
+void VulkanCapture::bind(VulkanVertexBuffer * pbuffer, uint32_t const& binding)
+{
+    auto resource = id(m_vertexIds, pbuffer->handle().value);
+
+    if (resource.second)
+    {
+        std::vector<uint8_t> contents = readBuffer(pbuffer->buffer(), pbuffer->size());
+        write(Adore::CaptureRecord::VERTEX_BUFFER);
+        write(resource.first);
+        write<uint64_t>(contents.size());
+        write(contents.data(), contents.size());
+    }
+
+    write(Adore::CaptureRecord::BIND_VERTEX);
+    write(resource.first);
+    write(binding);
+}
+
+void VulkanCapture::bind(VulkanIndexBuffer * pbuffer)
+{
+    auto resource = id(m_indexIds, pbuffer->handle().value);
+
+    if (resource.second)
+    {
+        std::vector<uint8_t> contents = readBuffer(pbuffer->buffer(), pbuffer->size());
+        write(Adore::CaptureRecord::INDEX_BUFFER);
+        write(resource.first);
+        write<uint64_t>(contents.size());
+        write(contents.data(), contents.size());
+    }
+
+    write(Adore::CaptureRecord::BIND_INDEX);
+    write(resource.first);
+}
+
+void VulkanCapture::draw(uint32_t const& count)
+{
+    write(Adore::CaptureRecord::DRAW);
+    write(count);
+}
+
+void VulkanCapture::drawIndexed(uint32_t const& count, uint32_t const& firstIndex)
+{
+    write(Adore::CaptureRecord::DRAW_INDEXED);
+    write(count);
+    write(firstIndex);
+}
+
+void VulkanCapture::push(void const * data, uint32_t const& size, uint32_t const& offset)
+{
+    write(Adore::CaptureRecord::PUSH);
+    write(offset);
+    write(size);
+    write(data, size);
+}
+
+void VulkanCapture::set(VulkanUniformBuffer * pbuffer, void const * pdata)
+{
+    auto found = m_ids.find(static_cast<Adore::UniformBuffer const *>(pbuffer));
+    if (found == m_ids.end() || found->second.resource.expired()) return;
+
+    write(Adore::CaptureRecord::SET_UNIFORM);
+    write(found->second.id);
+    write<uint64_t>(pbuffer->size());
+    write(pdata, pbuffer->size());
+}
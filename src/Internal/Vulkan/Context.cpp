@@ -49,8 +49,8 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL validationCallback(
     return VK_FALSE;
 }
 
-VulkanContext::VulkanContext(std::string const& appName)
-    : Context(Adore::API::Vulkan)
+VulkanContext::VulkanContext(std::string const& appName, bool const& headless)
+    : Context(Adore::API::Vulkan, headless)
 {
     VkApplicationInfo appInfo = {};
     appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -64,7 +64,10 @@ VulkanContext::VulkanContext(std::string const& appName)
     instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     instanceInfo.pApplicationInfo = &appInfo;
 
-    m_extensions = Window::requiredInstanceExtensions();
+    if (headless)
+        m_extensions = { VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+    else
+        m_extensions = Window::requiredInstanceExtensions();
 
     if (debug)
     {
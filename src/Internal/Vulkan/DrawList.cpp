@@ -0,0 +1,144 @@
+#include <Adore/Internal/Vulkan/DrawList.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Vulkan/Shader.hpp>
+#include <Adore/Internal/Vulkan/HiZ.hpp>
+#include <Adore/Internal/FramesInFlight.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+static std::vector<uint32_t> const CULL_SHADER = {
+#include <Shaders/Cull.comp.inc>
+};
+
+VulkanDrawList::VulkanDrawList(std::shared_ptr<Adore::Renderer>& renderer,
+                               std::vector<Adore::DrawObject> const& objects)
+    : DrawList(renderer, objects.size())
+{
+    auto win = m_renderer->window();
+    auto pwindow = static_cast<VulkanWindow*>(win.get());
+
+    if (objects.empty())
+        throw Adore::AdoreException("Draw list has no objects.");
+
+    if ((objects.size() + 63) / 64 > pwindow->limits().maxComputeWorkGroupCount[0])
+        throw Adore::AdoreException("Draw list has too many objects to cull in one dispatch.");
+
+    if (!pwindow->features().drawIndirectFirstInstance
+        && std::any_of(objects.begin(), objects.end(), [](auto const& object) { return object.firstInstance != 0; }))
+        throw Adore::AdoreException("Device does not support indirect draws with a first instance.");
+
+    // A compacted list is drawn with a single call, which has to be able to reach every object.
+    m_compact = pwindow->drawIndirectCount() && pwindow->features().multiDrawIndirect
+             && objects.size() <= pwindow->limits().maxDrawIndirectCount;
+
+    m_objects = Adore::StorageBuffer::create(m_renderer, const_cast<Adore::DrawObject*>(objects.data()),
+                                             objects.size() * sizeof(Adore::DrawObject));
+    m_commands = Adore::StorageBuffer::create(m_renderer, nullptr,
+                                              objects.size() * sizeof(VkDrawIndexedIndirectCommand));
+    m_visible = Adore::StorageBuffer::create(m_renderer, nullptr, sizeof(uint32_t));
+
+    m_frustum = {};
+    m_frustum.count = m_count;
+    m_frustum.compact = m_compact;
+    m_uniform = Adore::UniformBuffer::create(m_renderer, &m_frustum, sizeof(Frustum));
+
+    Adore::LayoutDescriptor descriptor {};
+    descriptor.resources = {
+        { 0, 1, Adore::ShaderType::COMPUTE, Adore::ResourceType::BUFFER },
+        { 1, 1, Adore::ShaderType::COMPUTE, Adore::ResourceType::STORAGE_BUFFER },
+        { 2, 1, Adore::ShaderType::COMPUTE, Adore::ResourceType::STORAGE_BUFFER },
+        { 3, 1, Adore::ShaderType::COMPUTE, Adore::ResourceType::STORAGE_BUFFER },
+        { 4, 1, Adore::ShaderType::COMPUTE, Adore::ResourceType::SAMPLER }
+    };
+
+    m_shader = Adore::Shader::create(win, { { Adore::ShaderType::COMPUTE, "", CULL_SHADER } }, descriptor);
+    m_shader->attach(m_uniform, 0);
+    m_shader->attach(m_objects, 1);
+    m_shader->attach(m_commands, 2);
+    m_shader->attach(m_visible, 3);
+
+    // Binding 4 is written by the renderer before the first cull, see setOcclusion().
+    m_hizVersions.resize(FRAMES_IN_FLIGHT, 0);
+
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    m_handle = static_cast<VulkanRenderer*>(m_renderer.get())->drawLists().insert(this);
+}
+
+VulkanDrawList::~VulkanDrawList()
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_renderer->window().get())->mutex());
+    static_cast<VulkanRenderer*>(m_renderer.get())->drawLists().remove(m_handle);
+}
+
+void VulkanDrawList::setFrustum(float const * m)
+{
+    // Gribb / Hartmann: each plane is the last row of the matrix plus or minus one of the others.
+    // The near plane uses -w <= z so it is conservative for both depth ranges.
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        unsigned int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+        for (unsigned int column = 0; column < 4; column++)
+            m_frustum.planes[i][column] = m[column * 4 + 3] + sign * m[column * 4 + row];
+
+        float length = std::sqrt(m_frustum.planes[i][0] * m_frustum.planes[i][0]
+                               + m_frustum.planes[i][1] * m_frustum.planes[i][1]
+                               + m_frustum.planes[i][2] * m_frustum.planes[i][2]);
+
+        if (length > 0.0f)
+            for (unsigned int column = 0; column < 4; column++)
+                m_frustum.planes[i][column] /= length;
+    }
+
+    m_uniform->set(&m_frustum);
+}
+
+void VulkanDrawList::setOcclusion(uint32_t const& frame, VulkanHiZ const& hiz, uint64_t const& version,
+                                  float const * viewProjection)
+{
+    auto const& sets = static_cast<VulkanShader*>(m_shader.get())->descriptorSets();
+
+    if (m_hizVersions[frame] != version && !sets.empty())
+    {
+        auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+        VkDescriptorImageInfo imageInfo {};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        imageInfo.imageView = hiz.view();
+        imageInfo.sampler = hiz.sampler();
+
+        VkWriteDescriptorSet write {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = sets[frame];
+        write.dstBinding = 4;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(pwindow->device(), 1, &write, 0, nullptr);
+        m_hizVersions[frame] = version;
+    }
+
+    m_frustum.occlusion = viewProjection != nullptr;
+    m_frustum.levels = hiz.levels();
+    m_frustum.hizSize[0] = static_cast<float>(hiz.extent().width);
+    m_frustum.hizSize[1] = static_cast<float>(hiz.extent().height);
+
+    if (viewProjection)
+        std::copy(viewProjection, viewProjection + 16, m_frustum.viewProjection);
+}
+
+VkBuffer const& VulkanDrawList::commands() const
+{
+    return static_cast<VulkanStorageBuffer*>(m_commands.get())->buffer();
+}
+
+VkBuffer const& VulkanDrawList::visible() const
+{
+    return static_cast<VulkanStorageBuffer*>(m_visible.get())->buffer();
+}
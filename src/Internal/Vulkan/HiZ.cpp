@@ -0,0 +1,292 @@
+#include <Adore/Internal/Vulkan/HiZ.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+
+static std::vector<uint32_t> const HIZ_SHADER = {
+#include <Shaders/HiZ.comp.inc>
+};
+
+static std::vector<uint32_t> const HIZ_MULTISAMPLE_SHADER = {
+#include <Shaders/HiZMultisample.comp.inc>
+};
+
+// Matches the push constants in Shaders/HiZ.comp and Shaders/HiZMultisample.comp.
+struct HiZSizes
+{
+    int32_t source[2];
+    int32_t destination[2];
+    int32_t samples;
+};
+
+static VkPipeline computePipeline(VkDevice const& device, VkPipelineLayout const& layout,
+                                  std::vector<uint32_t> const& code)
+{
+    VkShaderModuleCreateInfo moduleInfo {};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.size() * sizeof(uint32_t);
+    moduleInfo.pCode = code.data();
+
+    VkShaderModule module;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &module) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create shader module.");
+
+    VkComputePipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = module;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = layout;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline;
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(device, module, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan compute pipeline.");
+
+    return pipeline;
+}
+
+VulkanHiZ::VulkanHiZ(VulkanRenderer * prenderer, VulkanWindow * pwindow, bool const& placeholder)
+    : m_device(pwindow->device()), m_memory(pwindow->memory()), m_setLayout(VK_NULL_HANDLE),
+      m_descriptorPool(VK_NULL_HANDLE), m_layout(VK_NULL_HANDLE), m_pipeline(VK_NULL_HANDLE),
+      m_depthPipeline(VK_NULL_HANDLE), m_swapchainVersion(pwindow->swapchainVersion()), m_placeholder(placeholder)
+{
+    m_depthExtent = pwindow->extent();
+    m_samples = pwindow->samples();
+    m_extent = placeholder
+        ? VkExtent2D { 1, 1 }
+        : VkExtent2D { std::max(m_depthExtent.width / 2, 1u), std::max(m_depthExtent.height / 2, 1u) };
+
+    m_levels = 1;
+    for (uint32_t size = std::max(m_extent.width, m_extent.height); size > 1; size /= 2)
+        m_levels++;
+
+    VkImageCreateInfo imageInfo {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = { m_extent.width, m_extent.height, 1 };
+    imageInfo.mipLevels = m_levels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = VK_FORMAT_R32_SFLOAT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    if (vkCreateImage(m_device, &imageInfo, nullptr, &m_image) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan Hi-Z image.");
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(m_device, m_image, &memReqs);
+
+    m_imageMemory = m_memory.allocate(memReqs.size,
+                                      memoryTypeIndex(memReqs.memoryTypeBits, pwindow->physicalDevice(),
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+                                      Adore::MemoryCategory::IMAGE);
+
+    vkBindImageMemory(m_device, m_image, m_imageMemory, 0);
+
+    VkImageViewCreateInfo viewInfo {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R32_SFLOAT;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, m_levels, 0, 1 };
+
+    if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_view) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan Hi-Z image view.");
+
+    m_levelViews.resize(m_levels);
+
+    for (uint32_t level = 0; level < m_levels; level++)
+    {
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+
+        if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_levelViews[level]) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan Hi-Z image view.");
+    }
+
+    // Texels are fetched as they are, any filtering would mix depths.
+    VkSamplerCreateInfo samplerInfo {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan Hi-Z sampler.");
+
+    // The placeholder never reduces, so it does not need the depth buffer to be sampled.
+    if (!placeholder)
+        createReduction(pwindow);
+
+    // Until the first build everything is at the far plane, so nothing is occluded.
+    auto commandBuffer = prenderer->beginCommandBuffer();
+
+    VkImageMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, m_levels, 0, 1 };
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkClearColorValue far = {{ 1.0f, 1.0f, 1.0f, 1.0f }};
+    vkCmdClearColorImage(commandBuffer, m_image, VK_IMAGE_LAYOUT_GENERAL, &far, 1, &barrier.subresourceRange);
+
+    prenderer->endCommandBuffer(commandBuffer);
+}
+
+void VulkanHiZ::createReduction(VulkanWindow * pwindow)
+{
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    bindings[0] = { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    bindings[1] = { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+
+    if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_setLayout) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan descriptor set layout.");
+
+    VkDescriptorPoolSize poolSizes[2] = {};
+    poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_levels };
+    poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_levels };
+
+    VkDescriptorPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    poolInfo.maxSets = m_levels;
+
+    if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan descriptor pool.");
+
+    std::vector<VkDescriptorSetLayout> layouts(m_levels, m_setLayout);
+
+    VkDescriptorSetAllocateInfo setInfo {};
+    setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setInfo.descriptorPool = m_descriptorPool;
+    setInfo.descriptorSetCount = m_levels;
+    setInfo.pSetLayouts = layouts.data();
+
+    m_sets.resize(m_levels);
+
+    if (vkAllocateDescriptorSets(m_device, &setInfo, m_sets.data()) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to allocate Vulkan descriptor sets.");
+
+    std::vector<VkDescriptorImageInfo> imageInfos(2 * m_levels);
+    std::vector<VkWriteDescriptorSet> writes(2 * m_levels);
+
+    for (uint32_t level = 0; level < m_levels; level++)
+    {
+        imageInfos[2 * level] = level == 0
+            ? VkDescriptorImageInfo { m_sampler, pwindow->swapchain().depthView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+            : VkDescriptorImageInfo { m_sampler, m_levelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL };
+        imageInfos[2 * level + 1] = { VK_NULL_HANDLE, m_levelViews[level], VK_IMAGE_LAYOUT_GENERAL };
+
+        for (uint32_t binding = 0; binding < 2; binding++)
+        {
+            auto& write = writes[2 * level + binding];
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = m_sets[level];
+            write.dstBinding = binding;
+            write.descriptorCount = 1;
+            write.descriptorType = bindings[binding].descriptorType;
+            write.pImageInfo = &imageInfos[2 * level + binding];
+        }
+    }
+
+    vkUpdateDescriptorSets(m_device, writes.size(), writes.data(), 0, nullptr);
+
+    VkPushConstantRange pushConstantRange { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZSizes) };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create pipeline layout.");
+
+    m_pipeline = computePipeline(m_device, m_layout, HIZ_SHADER);
+    m_depthPipeline = pwindow->samples() == VK_SAMPLE_COUNT_1_BIT
+        ? m_pipeline
+        : computePipeline(m_device, m_layout, HIZ_MULTISAMPLE_SHADER);
+}
+
+VulkanHiZ::~VulkanHiZ()
+{
+    // A placeholder leaves these null, destroying a null handle does nothing.
+    if (m_depthPipeline != m_pipeline)
+        vkDestroyPipeline(m_device, m_depthPipeline, nullptr);
+    vkDestroyPipeline(m_device, m_pipeline, nullptr);
+    vkDestroyPipelineLayout(m_device, m_layout, nullptr);
+    vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+    vkDestroySampler(m_device, m_sampler, nullptr);
+
+    for (auto& view : m_levelViews)
+        vkDestroyImageView(m_device, view, nullptr);
+
+    vkDestroyImageView(m_device, m_view, nullptr);
+    vkDestroyImage(m_device, m_image, nullptr);
+    m_memory.free(m_imageMemory);
+}
+
+void VulkanHiZ::build(VkCommandBuffer const& commandBuffer)
+{
+    VkMemoryBarrier levelBarrier {};
+    levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkExtent2D source = m_depthExtent;
+    VkExtent2D destination = m_extent;
+
+    for (uint32_t level = 0; level < m_levels; level++)
+    {
+        HiZSizes sizes {};
+        sizes.source[0] = source.width;
+        sizes.source[1] = source.height;
+        sizes.destination[0] = destination.width;
+        sizes.destination[1] = destination.height;
+        sizes.samples = level == 0 ? m_samples : 1;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, level == 0 ? m_depthPipeline : m_pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_layout, 0, 1, &m_sets[level], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, m_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZSizes), &sizes);
+        vkCmdDispatch(commandBuffer, (destination.width + 7) / 8, (destination.height + 7) / 8, 1);
+
+        if (level + 1 < m_levels)
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+
+        source = destination;
+        destination = { std::max(destination.width / 2, 1u), std::max(destination.height / 2, 1u) };
+    }
+}
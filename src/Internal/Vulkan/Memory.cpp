@@ -0,0 +1,145 @@
+#include <Adore/Internal/Vulkan/Memory.hpp>
+#include <Adore/Internal/Log.hpp>
+
+static char const * categoryName(Adore::MemoryCategory const& category)
+{
+    switch (category)
+    {
+        case Adore::MemoryCategory::VERTEX: return "vertex";
+        case Adore::MemoryCategory::INDEX: return "index";
+        case Adore::MemoryCategory::UNIFORM: return "uniform";
+        case Adore::MemoryCategory::STORAGE: return "storage";
+        case Adore::MemoryCategory::IMAGE: return "image";
+        case Adore::MemoryCategory::ATTACHMENT: return "attachment";
+        case Adore::MemoryCategory::STAGING: return "staging";
+        default: return "unknown";
+    }
+}
+
+VulkanMemory::VulkanMemory(VkDevice const& device, VkPhysicalDevice const& physicalDevice, bool const& budgetExtension)
+    : m_device(device), m_physicalDevice(physicalDevice), m_budgetExtension(budgetExtension)
+{
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_properties);
+    m_heaps.resize(m_properties.memoryHeapCount, 0);
+}
+
+VkDeviceMemory VulkanMemory::allocate(VkDeviceSize const& size, uint32_t const& typeIndex,
+                                      Adore::MemoryCategory const& category)
+{
+    VkMemoryAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = typeIndex;
+
+    uint32_t heap = m_properties.memoryTypes[typeIndex].heapIndex;
+
+    VkDeviceMemory memory;
+    VkResult result = vkAllocateMemory(m_device, &allocInfo, nullptr, &memory);
+
+    if (result != VK_SUCCESS)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Adore::MemoryStats stats = statsLocked();
+
+        throw Adore::AdoreException(std::string(result == VK_ERROR_OUT_OF_DEVICE_MEMORY
+                                                ? "Out of Vulkan device memory" : "Failed to allocate Vulkan memory")
+            + " for " + std::to_string(size) + " bytes of " + categoryName(category) + " memory, heap "
+            + std::to_string(heap) + " uses " + std::to_string(stats.heaps[heap].usage) + " of "
+            + std::to_string(stats.heaps[heap].budget) + " bytes.");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_allocations[memory] = { heap, size, category };
+        m_heaps[heap] += size;
+        m_categories[static_cast<size_t>(category)] += size;
+    }
+
+    check();
+    return memory;
+}
+
+void VulkanMemory::free(VkDeviceMemory const& memory)
+{
+    if (memory == VK_NULL_HANDLE) return;
+
+    vkFreeMemory(m_device, memory, nullptr);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocations.find(memory);
+    if (it == m_allocations.end()) return;
+
+    m_heaps[it->second.heap] -= it->second.size;
+    m_categories[static_cast<size_t>(it->second.category)] -= it->second.size;
+    m_allocations.erase(it);
+}
+
+Adore::MemoryStats VulkanMemory::statsLocked()
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget {};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    if (m_budgetExtension)
+    {
+        VkPhysicalDeviceMemoryProperties2 properties {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &properties);
+    }
+
+    Adore::MemoryStats stats {};
+    stats.driverBudget = m_budgetExtension;
+    stats.categories = m_categories;
+    stats.allocations = m_allocations.size();
+
+    for (uint32_t i = 0; i < m_properties.memoryHeapCount; i++)
+    {
+        Adore::HeapStats heap {};
+        heap.size = m_properties.memoryHeaps[i].size;
+        heap.budget = m_budgetExtension ? budget.heapBudget[i] : heap.size;
+        heap.usage = m_budgetExtension ? budget.heapUsage[i] : m_heaps[i];
+        heap.allocated = m_heaps[i];
+        heap.deviceLocal = m_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        stats.heaps.push_back(heap);
+    }
+
+    return stats;
+}
+
+Adore::MemoryStats VulkanMemory::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return statsLocked();
+}
+
+void VulkanMemory::threshold(float const& fraction, std::function<void(Adore::MemoryStats const&)> const& callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threshold = fraction;
+    m_callback = callback;
+    m_crossed = false;
+}
+
+void VulkanMemory::check()
+{
+    std::function<void(Adore::MemoryStats const&)> callback;
+    Adore::MemoryStats stats;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_callback) return;
+
+        stats = statsLocked();
+
+        bool crossed = false;
+        for (auto const& heap : stats.heaps)
+            crossed |= heap.deviceLocal && heap.usage > m_threshold * heap.budget;
+
+        // Only the rise past the threshold is reported, falling back under it rearms the callback.
+        if (crossed && !m_crossed) callback = m_callback;
+        m_crossed = crossed;
+    }
+
+    // Outside the lock, the callback is likely to free memory.
+    if (callback) callback(stats);
+}
@@ -0,0 +1,59 @@
+#include <Adore/Internal/Vulkan/ModuleCache.hpp>
+#include <Adore/Internal/SPIRV.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <filesystem>
+
+std::shared_ptr<VulkanModule> VulkanModuleCache::get(Adore::ShaderModule const& module)
+{
+    SPIRV code(module);
+    uint64_t hash = code.hash();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A colliding module is just not cached.
+    auto cached = m_modules[hash].lock();
+    if (cached && code.equals(cached->words.get(), cached->count))
+        return cached;
+
+    VkShaderModuleCreateInfo moduleInfo {};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.count() * sizeof(uint32_t);
+    moduleInfo.pCode = code.words();
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create shader module.");
+
+    std::shared_ptr<VulkanModule> created(new VulkanModule { m_device, shaderModule, code.share(), code.count() });
+    if (!cached) m_modules[hash] = created;
+
+    return created;
+}
+
+uint32_t VulkanModuleCache::preload(std::string const& directory)
+{
+    std::error_code error;
+    std::filesystem::directory_iterator entries(directory, error);
+
+    if (error)
+        throw Adore::AdoreException("Failed to open shader directory: " + directory);
+
+    uint32_t count = 0;
+
+    for (auto const& entry : entries)
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".spv") continue;
+
+        // The stage only matters to reflection, modules are the same for every stage.
+        auto module = get({ Adore::ShaderType::VERTEX, entry.path().string() });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_preloaded.push_back(module);
+        count++;
+    }
+
+    ADORE_INTERNAL_LOG(INFO, "Preloaded " + std::to_string(count) + " shader modules from " + directory + ".");
+
+    return count;
+}
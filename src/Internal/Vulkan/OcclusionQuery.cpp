@@ -0,0 +1,102 @@
+#include <Adore/Internal/Vulkan/OcclusionQuery.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <Adore/Internal/FramesInFlight.hpp>
+
+#include <algorithm>
+
+VulkanOcclusionQuery::VulkanOcclusionQuery(std::shared_ptr<Adore::Renderer>& renderer, uint32_t const& count)
+    : OcclusionQuery(renderer, count)
+{
+    auto prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    if (count == 0)
+        throw Adore::AdoreException("Occlusion query has no indices.");
+
+    VkQueryPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+    poolInfo.queryCount = count;
+
+    m_pools.resize(FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+
+    for (auto& pool : m_pools)
+        if (vkCreateQueryPool(pwindow->device(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan query pool.");
+
+    // Queries have to be reset before their first use, later resets happen in resolve().
+    auto commandBuffer = prenderer->beginCommandBuffer();
+    for (auto& pool : m_pools)
+        vkCmdResetQueryPool(commandBuffer, pool, 0, count);
+    prenderer->endCommandBuffer(commandBuffer);
+
+    m_written.assign(FRAMES_IN_FLIGHT, std::vector<bool>(count, false));
+    m_forced.assign(FRAMES_IN_FLIGHT, std::vector<bool>(count, false));
+    m_visible.assign(count, true);
+    m_results.resize(count * 2);
+
+    prenderer->track(this);
+}
+
+VulkanOcclusionQuery::~VulkanOcclusionQuery()
+{
+    auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    static_cast<VulkanRenderer*>(m_renderer.get())->untrack(this);
+
+    vkQueueWaitIdle(pwindow->queues().graphics);
+
+    for (auto& pool : m_pools)
+        vkDestroyQueryPool(pwindow->device(), pool, nullptr);
+}
+
+bool VulkanOcclusionQuery::visible(uint32_t const& index) const
+{
+    if (index >= m_count)
+        throw Adore::AdoreException("Occlusion query index out of range.");
+
+    return m_visible[index];
+}
+
+void VulkanOcclusionQuery::write(uint32_t const& frame, uint32_t const& index, bool const& forced)
+{
+    if (index >= m_count)
+        throw Adore::AdoreException("Occlusion query index out of range.");
+
+    if (m_written[frame][index] || m_forced[frame][index])
+        throw Adore::AdoreException("Occlusion query index was already used this frame.");
+
+    (forced ? m_forced : m_written)[frame][index] = true;
+}
+
+void VulkanOcclusionQuery::resolve(VkCommandBuffer const& commandBuffer, uint32_t const& frame)
+{
+    auto pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    auto& written = m_written[frame];
+    auto& forced = m_forced[frame];
+
+    // The frame's fence has signalled, so every query it ended is available. Unwritten ones are
+    // not, which makes the call return VK_NOT_READY without waiting.
+    if (std::find(written.begin(), written.end(), true) != written.end())
+    {
+        vkGetQueryPoolResults(pwindow->device(), m_pools[frame], 0, m_count, m_results.size() * sizeof(uint64_t),
+                              m_results.data(), 2 * sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        for (uint32_t i = 0; i < m_count; i++)
+            if (written[i] && m_results[2 * i + 1] != 0)
+                m_visible[i] = m_results[2 * i] != 0;
+
+        vkCmdResetQueryPool(commandBuffer, m_pools[frame], 0, m_count);
+    }
+
+    for (uint32_t i = 0; i < m_count; i++)
+        if (forced[i]) m_visible[i] = true;
+
+    written.assign(m_count, false);
+    forced.assign(m_count, false);
+}
@@ -0,0 +1,714 @@
+#include <Adore/Internal/Vulkan/RenderGraph.hpp>
+#include <Adore/Internal/Vulkan/Buffer.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+
+static VkAccessFlags const WRITE_ACCESS = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                        | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                                        | VK_ACCESS_SHADER_WRITE_BIT
+                                        | VK_ACCESS_TRANSFER_WRITE_BIT
+                                        | VK_ACCESS_HOST_WRITE_BIT
+                                        | VK_ACCESS_MEMORY_WRITE_BIT;
+
+RenderGraph::AccessInfo RenderGraph::info(Access const& access)
+{
+    switch (access)
+    {
+        case Access::NONE:
+            return { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case Access::COLOR_ATTACHMENT:
+            return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+        case Access::DEPTH_ATTACHMENT:
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true };
+        case Access::DEPTH_READ:
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false };
+        case Access::FRAGMENT_SAMPLED:
+            return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+        case Access::COMPUTE_SAMPLED:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+        case Access::COMPUTE_READ:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_IMAGE_LAYOUT_GENERAL, false };
+        case Access::COMPUTE_WRITE:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_GENERAL, true };
+        case Access::TRANSFER_SRC:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+        case Access::TRANSFER_DST:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+        case Access::VERTEX_BUFFER:
+            return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+                     VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case Access::INDEX_BUFFER:
+            return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT,
+                     VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case Access::INDIRECT_BUFFER:
+            return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                     VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case Access::UNIFORM_BUFFER:
+            return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                     | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case Access::PRESENT:
+            return { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false };
+    }
+
+    throw Adore::AdoreException("Unknown render graph access.");
+}
+
+void RenderGraph::barrier(VkCommandBuffer const& commandBuffer, VkImage const& image,
+                          VkImageAspectFlags const& aspect, Access const& from, Access const& to,
+                          uint32_t const& levels)
+{
+    AccessInfo src = info(from), dst = info(to);
+
+    VkImageMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = src.access & WRITE_ACCESS;
+    barrier.dstAccessMask = dst.access;
+    barrier.oldLayout = src.layout;
+    barrier.newLayout = dst.layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { aspect, 0, levels, 0, 1 };
+
+    vkCmdPipelineBarrier
+    (
+        commandBuffer,
+        src.stage, dst.stage,
+        0, 0, nullptr,
+        0, nullptr,
+        1, &barrier
+    );
+}
+
+RenderGraph::Pass& RenderGraph::Pass::read(Resource const& resource, Access const& access)
+{
+    reads.push_back({ resource, access });
+    return *this;
+}
+
+RenderGraph::Pass& RenderGraph::Pass::write(Resource const& resource, Access const& access)
+{
+    writes.push_back({ resource, access });
+    return *this;
+}
+
+RenderGraph::RenderGraph(VkDevice const& device, VulkanMemory& memory)
+    : m_device(device), m_memory(memory)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    release();
+}
+
+RenderGraph::Resource RenderGraph::image(std::string const& name, ImageInfo const& info)
+{
+    ResourceEntry entry {};
+    entry.name = name;
+    entry.isImage = true;
+    entry.transient = true;
+    entry.info = info;
+
+    m_resources.push_back(entry);
+    m_compiled = false;
+
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::import(std::string const& name, VkImage const& image, VkImageView const& view,
+                                          VkImageAspectFlags const& aspect, Access const& initial, Access const& final,
+                                          uint32_t const& levels)
+{
+    ResourceEntry entry {};
+    entry.name = name;
+    entry.isImage = true;
+    entry.transient = false;
+    entry.info.aspect = aspect;
+    entry.info.levels = levels;
+    entry.image = image;
+    entry.view = view;
+    entry.initial = initial;
+    entry.final = final;
+
+    m_resources.push_back(entry);
+    m_compiled = false;
+
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::import(std::string const& name, VkBuffer const& buffer,
+                                          Access const& initial, Access const& final)
+{
+    ResourceEntry entry {};
+    entry.name = name;
+    entry.isImage = false;
+    entry.transient = false;
+    entry.buffer = buffer;
+    entry.initial = initial;
+    entry.final = final;
+
+    m_resources.push_back(entry);
+    m_compiled = false;
+
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+void RenderGraph::update(Resource const& resource, VkImage const& image, VkImageView const& view)
+{
+    if (m_resources[resource].transient || !m_resources[resource].isImage)
+        throw Adore::AdoreException("Only imported images can be updated: " + m_resources[resource].name);
+
+    m_resources[resource].image = image;
+    m_resources[resource].view = view;
+}
+
+void RenderGraph::update(Resource const& resource, VkBuffer const& buffer)
+{
+    if (m_resources[resource].isImage)
+        throw Adore::AdoreException("Only imported buffers can be updated: " + m_resources[resource].name);
+
+    m_resources[resource].buffer = buffer;
+}
+
+RenderGraph::Pass& RenderGraph::pass(std::string const& name, Execute const& execute)
+{
+    m_passes.emplace_back();
+    m_passes.back().name = name;
+    m_passes.back().execute = execute;
+    m_passes.back().index = static_cast<uint32_t>(m_passes.size() - 1);
+    m_compiled = false;
+
+    return m_passes.back();
+}
+
+void RenderGraph::compile()
+{
+    release();
+
+    sort();
+    cull();
+    allocate();
+    schedule();
+
+    m_compiled = true;
+
+    ADORE_INTERNAL_LOG(INFO, "Compiled render graph: " + std::to_string(m_order.size()) + "/"
+                       + std::to_string(m_passes.size()) + " passes, "
+                       + std::to_string(barrierCount()) + " barriers, "
+                       + std::to_string(m_transientMemory / 1024) + " KiB transient memory.");
+}
+
+// Reads bind to the closest writer declared before them (or the first writer if there
+// is none yet), writes to the same resource keep their declaration order and a write
+// waits for the reads of the previous version. Passes the caller records keep their
+// declaration order too. Ties are broken by declaration order.
+void RenderGraph::sort()
+{
+    uint32_t const count = static_cast<uint32_t>(m_passes.size());
+
+    std::vector<std::vector<uint32_t>> edges(count);
+    std::vector<uint32_t> indegree(count, 0);
+
+    auto edge = [&](uint32_t const& from, uint32_t const& to)
+    {
+        if (from == to) return;
+        edges[from].push_back(to);
+        indegree[to]++;
+    };
+
+    std::vector<std::vector<uint32_t>> writers(m_resources.size());
+
+    for (uint32_t i = 0; i < count; i++)
+        for (auto const& [resource, access] : m_passes[i].writes)
+            if (writers[resource].empty() || writers[resource].back() != i)
+                writers[resource].push_back(i);
+
+    for (auto const& passes : writers)
+        for (size_t i = 1; i < passes.size(); i++)
+            edge(passes[i - 1], passes[i]);
+
+    uint32_t previous = UINT32_MAX;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (m_passes[i].execute) continue;
+        if (previous != UINT32_MAX) edge(previous, i);
+        previous = i;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (auto const& [resource, access] : m_passes[i].reads)
+        {
+            auto const& passes = writers[resource];
+            if (passes.empty()) continue;
+
+            auto next = std::lower_bound(passes.begin(), passes.end(), i);
+
+            if (next == passes.begin())
+            {
+                if (*next != i) edge(*next, i);
+                continue;
+            }
+
+            edge(*(next - 1), i);
+
+            if (next != passes.end() && *next == i) next++;
+            if (next != passes.end()) edge(i, *next);
+        }
+    }
+
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+    for (uint32_t i = 0; i < count; i++)
+        if (indegree[i] == 0) ready.push(i);
+
+    m_order.clear();
+    while (!ready.empty())
+    {
+        uint32_t pass = ready.top();
+        ready.pop();
+        m_order.push_back(pass);
+
+        for (auto const& next : edges[pass])
+            if (--indegree[next] == 0) ready.push(next);
+    }
+
+    if (m_order.size() != count)
+        throw Adore::AdoreException("Render graph contains a dependency cycle.");
+}
+
+// Imported resources with a final access are the outputs of the graph. Walking backwards,
+// a pass survives if it has side effects (or is recorded by the caller) or writes
+// something a surviving pass reads.
+void RenderGraph::cull()
+{
+    std::vector<bool> needed(m_resources.size(), false);
+
+    for (size_t i = 0; i < m_resources.size(); i++)
+        needed[i] = !m_resources[i].transient && m_resources[i].final != Access::NONE;
+
+    std::vector<uint32_t> live;
+
+    for (auto it = m_order.rbegin(); it != m_order.rend(); it++)
+    {
+        Pass const& pass = m_passes[*it];
+
+        bool alive = pass.sideEffects || !pass.execute || std::any_of(pass.writes.begin(), pass.writes.end(),
+                                                     [&](auto const& write) { return needed[write.first]; });
+        if (!alive) continue;
+
+        live.push_back(*it);
+
+        for (auto const& [resource, access] : pass.reads)
+            needed[resource] = true;
+    }
+
+    std::reverse(live.begin(), live.end());
+    m_order = live;
+}
+
+// Transient images whose lifetimes (in scheduled pass order) don't overlap share a block
+// of device memory. Blocks are filled largest first so small images slot in behind big ones.
+void RenderGraph::allocate()
+{
+    struct Lifetime { uint32_t first = UINT32_MAX, last = 0; };
+    std::vector<Lifetime> lifetimes(m_resources.size());
+
+    for (uint32_t i = 0; i < m_order.size(); i++)
+    {
+        auto touch = [&](Resource const& resource)
+        {
+            lifetimes[resource].first = std::min(lifetimes[resource].first, i);
+            lifetimes[resource].last = std::max(lifetimes[resource].last, i);
+        };
+
+        for (auto const& [resource, access] : m_passes[m_order[i]].reads) touch(resource);
+        for (auto const& [resource, access] : m_passes[m_order[i]].writes) touch(resource);
+    }
+
+    std::vector<std::pair<Resource, VkMemoryRequirements>> transients;
+
+    for (Resource i = 0; i < m_resources.size(); i++)
+    {
+        ResourceEntry& entry = m_resources[i];
+        if (!entry.transient || lifetimes[i].first == UINT32_MAX) continue;
+
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { entry.info.extent.width, entry.info.extent.height, 1 };
+        imageInfo.mipLevels = entry.info.levels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = entry.info.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = entry.info.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.samples = entry.info.samples;
+
+        if (vkCreateImage(m_device, &imageInfo, nullptr, &entry.image) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan image: " + entry.name);
+
+        VkMemoryRequirements memReqs;
+        vkGetImageMemoryRequirements(m_device, entry.image, &memReqs);
+
+        transients.push_back({ i, memReqs });
+    }
+
+    std::stable_sort(transients.begin(), transients.end(),
+                     [](auto const& a, auto const& b) { return a.second.size > b.second.size; });
+
+    struct Block
+    {
+        VkDeviceSize size;
+        uint32_t memoryTypeBits;
+        std::vector<Resource> occupants;
+        bool lazy;
+    };
+    std::vector<Block> blocks;
+
+    for (auto const& [resource, memReqs] : transients)
+    {
+        auto overlaps = [&](Block const& block)
+        {
+            return std::any_of(block.occupants.begin(), block.occupants.end(), [&](Resource const& other)
+            {
+                return lifetimes[other].first <= lifetimes[resource].last
+                    && lifetimes[resource].first <= lifetimes[other].last;
+            });
+        };
+
+        auto block = std::find_if(blocks.begin(), blocks.end(), [&](Block const& block)
+        {
+            return (block.memoryTypeBits & memReqs.memoryTypeBits) && !overlaps(block);
+        });
+
+        if (block == blocks.end())
+        {
+            blocks.push_back({ memReqs.size, memReqs.memoryTypeBits, {}, true });
+            block = blocks.end() - 1;
+        }
+
+        block->size = std::max(block->size, memReqs.size);
+        block->memoryTypeBits &= memReqs.memoryTypeBits;
+        block->occupants.push_back(resource);
+        block->lazy &= (m_resources[resource].info.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+        m_resources[resource].block = static_cast<uint32_t>(block - blocks.begin());
+    }
+
+    m_transientMemory = 0;
+    m_blocks.resize(blocks.size(), VK_NULL_HANDLE);
+
+    VkPhysicalDeviceMemoryProperties const& memProperties = m_memory.properties();
+
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        // Attachments that never leave the tile take lazily allocated memory where there is some.
+        uint32_t typeIndex = UINT32_MAX;
+        VkMemoryPropertyFlags const lazy = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+        for (uint32_t type = 0; blocks[i].lazy && type < memProperties.memoryTypeCount && typeIndex == UINT32_MAX; type++)
+            if (blocks[i].memoryTypeBits & (1 << type)
+                && (memProperties.memoryTypes[type].propertyFlags & lazy) == lazy)
+                typeIndex = type;
+
+        if (typeIndex == UINT32_MAX)
+            typeIndex = memoryTypeIndex(blocks[i].memoryTypeBits, m_memory.physicalDevice(),
+                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        m_blocks[i] = m_memory.allocate(blocks[i].size, typeIndex, Adore::MemoryCategory::ATTACHMENT);
+
+        m_transientMemory += blocks[i].size;
+
+        for (auto const& resource : blocks[i].occupants)
+        {
+            ResourceEntry& entry = m_resources[resource];
+
+            if (vkBindImageMemory(m_device, entry.image, m_blocks[i], 0) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to bind Vulkan image memory: " + entry.name);
+
+            VkImageViewCreateInfo viewInfo {};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = entry.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = entry.info.format;
+            viewInfo.subresourceRange = { entry.info.aspect, 0, entry.info.levels, 0, 1 };
+
+            if (vkCreateImageView(m_device, &viewInfo, nullptr, &entry.view) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to create Vulkan image view: " + entry.name);
+        }
+    }
+}
+
+// Tracks the last write and the reads since then for every resource and only emits a
+// barrier when an access actually conflicts with them. All barriers needed before a
+// pass go into one vkCmdPipelineBarrier.
+void RenderGraph::schedule()
+{
+    struct State
+    {
+        VkPipelineStageFlags writeStage = 0, readStages = 0;
+        VkAccessFlags writeAccess = 0, readAccess = 0;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    // A transient's first use has to wait for whatever used its memory before, including
+    // the previous frame, so it starts out "written" by every stage that touches the block.
+    // An imported image that starts out undefined only waits for its own uses.
+    std::vector<State> blockStates(m_blocks.size());
+    std::vector<State> touched(m_resources.size());
+
+    for (auto const& pass : m_passes)
+    {
+        for (auto const* accesses : { &pass.reads, &pass.writes })
+        {
+            for (auto const& [resource, access] : *accesses)
+            {
+                AccessInfo i = info(access);
+                touched[resource].writeStage |= i.stage;
+                touched[resource].writeAccess |= i.access & WRITE_ACCESS;
+
+                if (m_resources[resource].block == UINT32_MAX) continue;
+                blockStates[m_resources[resource].block].writeStage |= i.stage;
+                blockStates[m_resources[resource].block].writeAccess |= i.access & WRITE_ACCESS;
+            }
+        }
+    }
+
+    std::vector<State> states(m_resources.size());
+
+    for (size_t r = 0; r < m_resources.size(); r++)
+    {
+        ResourceEntry const& entry = m_resources[r];
+
+        if (entry.transient)
+        {
+            if (entry.block != UINT32_MAX) states[r] = blockStates[entry.block];
+            continue;
+        }
+
+        AccessInfo i = info(entry.initial);
+        if (entry.initial == Access::NONE && entry.isImage)
+        {
+            states[r] = touched[r];
+        }
+        else if (entry.initial != Access::NONE)
+        {
+            if (i.write)
+            {
+                states[r].writeStage = i.stage;
+                states[r].writeAccess = i.access & WRITE_ACCESS;
+            }
+            else
+            {
+                states[r].readStages = i.stage;
+                states[r].readAccess = i.access;
+            }
+        }
+        states[r].layout = i.layout;
+    }
+
+    auto visit = [&](Batch& batch, Resource const& resource, Access const& access)
+    {
+        ResourceEntry const& entry = m_resources[resource];
+        State& state = states[resource];
+        AccessInfo i = info(access);
+
+        bool transition = entry.isImage && state.layout != i.layout;
+        bool needed = false;
+        VkPipelineStageFlags srcStage = state.writeStage;
+
+        if (transition || i.write)
+        {
+            srcStage |= state.readStages;
+            needed = transition || srcStage != 0;
+        }
+        else
+        {
+            needed = state.writeStage != 0
+                  && ((state.readStages & i.stage) != i.stage || (state.readAccess & i.access) != i.access);
+        }
+
+        if (needed)
+        {
+            batch.srcStage |= srcStage ? srcStage : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            batch.dstStage |= i.stage;
+
+            if (entry.isImage)
+                batch.images.push_back({ resource, state.writeAccess, i.access, state.layout, i.layout });
+            else
+                batch.buffers.push_back({ resource, state.writeAccess, i.access });
+        }
+
+        if (transition || i.write)
+        {
+            state.writeStage = i.stage;
+            state.writeAccess = i.access & WRITE_ACCESS;
+            state.readStages = i.write ? 0 : i.stage;
+            state.readAccess = i.write ? 0 : i.access;
+        }
+        else
+        {
+            state.readStages |= i.stage;
+            state.readAccess |= i.access;
+        }
+
+        if (entry.isImage) state.layout = i.layout;
+    };
+
+    m_batches.assign(m_order.size(), Batch {});
+    m_final = Batch {};
+
+    for (size_t k = 0; k < m_order.size(); k++)
+    {
+        Pass const& pass = m_passes[m_order[k]];
+
+        // A resource both read and written by the same pass only needs the write.
+        std::map<Resource, Access> accesses;
+        for (auto const& [resource, access] : pass.reads) accesses[resource] = access;
+        for (auto const& [resource, access] : pass.writes)
+        {
+            auto it = accesses.find(resource);
+            if (it != accesses.end() && m_resources[resource].isImage
+                && info(it->second).layout != info(access).layout)
+                throw Adore::AdoreException("Pass \"" + pass.name + "\" uses \""
+                                            + m_resources[resource].name + "\" in two layouts.");
+            accesses[resource] = access;
+        }
+
+        for (auto const& [resource, access] : accesses)
+            visit(m_batches[k], resource, access);
+    }
+
+    for (Resource r = 0; r < m_resources.size(); r++)
+        if (!m_resources[r].transient && m_resources[r].final != Access::NONE)
+            visit(m_final, r, m_resources[r].final);
+}
+
+void RenderGraph::execute(VkCommandBuffer const& commandBuffer)
+{
+    if (!m_compiled) compile();
+
+    execute(commandBuffer, 0, m_order.size());
+}
+
+void RenderGraph::execute(VkCommandBuffer const& commandBuffer, size_t const& first, size_t const& last)
+{
+    if (!m_compiled) compile();
+
+    for (size_t k = first; k < last; k++)
+    {
+        record(commandBuffer, m_batches[k]);
+        if (m_passes[m_order[k]].execute) m_passes[m_order[k]].execute(commandBuffer, *this);
+    }
+
+    if (last == m_order.size()) record(commandBuffer, m_final);
+}
+
+size_t RenderGraph::position(Pass const& pass) const
+{
+    return std::find(m_order.begin(), m_order.end(), pass.index) - m_order.begin();
+}
+
+void RenderGraph::record(VkCommandBuffer const& commandBuffer, Batch const& batch) const
+{
+    if (batch.empty()) return;
+
+    std::vector<VkImageMemoryBarrier> imageBarriers(batch.images.size());
+    std::vector<VkBufferMemoryBarrier> bufferBarriers(batch.buffers.size());
+
+    for (size_t i = 0; i < batch.images.size(); i++)
+    {
+        ImageBarrier const& src = batch.images[i];
+        VkImageMemoryBarrier& barrier = imageBarriers[i];
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = src.srcAccess;
+        barrier.dstAccessMask = src.dstAccess;
+        barrier.oldLayout = src.oldLayout;
+        barrier.newLayout = src.newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_resources[src.resource].image;
+        barrier.subresourceRange = { m_resources[src.resource].info.aspect, 0,
+                                     m_resources[src.resource].info.levels, 0, 1 };
+    }
+
+    for (size_t i = 0; i < batch.buffers.size(); i++)
+    {
+        BufferBarrier const& src = batch.buffers[i];
+        VkBufferMemoryBarrier& barrier = bufferBarriers[i];
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = src.srcAccess;
+        barrier.dstAccessMask = src.dstAccess;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = m_resources[src.resource].buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+    }
+
+    vkCmdPipelineBarrier
+    (
+        commandBuffer,
+        batch.srcStage, batch.dstStage,
+        0, 0, nullptr,
+        static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+        static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+    );
+}
+
+size_t RenderGraph::barrierCount() const
+{
+    return std::count_if(m_batches.begin(), m_batches.end(), [](Batch const& batch) { return !batch.empty(); })
+         + (m_final.empty() ? 0 : 1);
+}
+
+void RenderGraph::release()
+{
+    for (auto& entry : m_resources)
+    {
+        if (!entry.transient) continue;
+
+        if (entry.view != VK_NULL_HANDLE) vkDestroyImageView(m_device, entry.view, nullptr);
+        if (entry.image != VK_NULL_HANDLE) vkDestroyImage(m_device, entry.image, nullptr);
+
+        entry.view = VK_NULL_HANDLE;
+        entry.image = VK_NULL_HANDLE;
+        entry.block = UINT32_MAX;
+    }
+
+    for (auto& block : m_blocks)
+        m_memory.free(block);
+
+    m_blocks.clear();
+    m_transientMemory = 0;
+    m_compiled = false;
+}
+
+void RenderGraph::clear()
+{
+    release();
+
+    m_resources.clear();
+    m_passes.clear();
+    m_order.clear();
+    m_batches.clear();
+    m_final = Batch {};
+}
@@ -0,0 +1,128 @@
+#include <Adore/Internal/Vulkan/RenderTarget.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Log.hpp>
+
+VulkanRenderTarget::VulkanRenderTarget(std::shared_ptr<Adore::Renderer>& renderer,
+                                       uint32_t const& width, uint32_t const& height,
+                                       Adore::ImageFormat const& format, bool const& depth,
+                                       Adore::Filter const& filter, Adore::Wrap const& wrap)
+    : Adore::RenderTarget(renderer, width, height), m_format(getVulkanFormat(format)), m_depth(depth)
+{
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    if (width == 0 || height == 0)
+        throw Adore::AdoreException("Render Target must have a non-zero size.");
+
+    if (m_depth && pwindow->depthFormat() == VK_FORMAT_UNDEFINED)
+        throw Adore::AdoreException("No supported depth format for Render Target.");
+
+    createImage(pwindow->memory(), width, height, m_format,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Adore::MemoryCategory::ATTACHMENT, m_image, m_memory);
+
+    // So the target can be sampled before anything has been rendered into it.
+    transitionImageLayout(prenderer, m_image, RenderGraph::Access::NONE, RenderGraph::Access::FRAGMENT_SAMPLED);
+
+    m_view = createImageView(pwindow->device(), m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_sampler = createSampler(pwindow->device(), pwindow->physicalDevice(), filter, wrap);
+
+    if (m_depth)
+    {
+        createImage(pwindow->memory(), width, height, pwindow->depthFormat(),
+                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Adore::MemoryCategory::ATTACHMENT,
+                    m_depthImage, m_depthMemory);
+
+        m_depthView = createImageView(pwindow->device(), m_depthImage, pwindow->depthFormat(),
+                                      VK_IMAGE_ASPECT_DEPTH_BIT);
+    }
+
+    // The renderer's graph moves the images in and out of these layouts and orders the pass
+    // against whatever sampled or rendered them before.
+    VkAttachmentDescription attachments[2] = {};
+
+    attachments[0].format = m_format;
+    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    attachments[1].format = pwindow->depthFormat();
+    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorAttachmentRef {};
+    colorAttachmentRef.attachment = 0;
+    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthAttachmentRef {};
+    depthAttachmentRef.attachment = 1;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pDepthStencilAttachment = m_depth ? &depthAttachmentRef : nullptr;
+
+    VkRenderPassCreateInfo renderPassInfo {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = m_depth ? 2 : 1;
+    renderPassInfo.pAttachments = attachments;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    if (vkCreateRenderPass(pwindow->device(), &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan renderpass.");
+
+    VkImageView views[2] = { m_view, m_depthView };
+
+    VkFramebufferCreateInfo framebufferInfo {};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = m_renderPass;
+    framebufferInfo.attachmentCount = m_depth ? 2 : 1;
+    framebufferInfo.pAttachments = views;
+    framebufferInfo.width = width;
+    framebufferInfo.height = height;
+    framebufferInfo.layers = 1;
+
+    if (vkCreateFramebuffer(pwindow->device(), &framebufferInfo, nullptr, &m_framebuffer) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan framebuffer.");
+
+    ADORE_INTERNAL_LOG(INFO, "Created Vulkan Render Target (" + std::to_string(width) + "x"
+                             + std::to_string(height) + ").");
+}
+
+VulkanRenderTarget::~VulkanRenderTarget()
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    vkQueueWaitIdle(pwindow->queues().graphics);
+
+    static_cast<VulkanRenderer*>(m_renderer.get())->untrack(this);
+
+    vkDestroyFramebuffer(pwindow->device(), m_framebuffer, nullptr);
+    vkDestroyRenderPass(pwindow->device(), m_renderPass, nullptr);
+
+    if (m_depth)
+    {
+        vkDestroyImageView(pwindow->device(), m_depthView, nullptr);
+        vkDestroyImage(pwindow->device(), m_depthImage, nullptr);
+        pwindow->memory().free(m_depthMemory);
+    }
+
+    vkDestroySampler(pwindow->device(), m_sampler, nullptr);
+    vkDestroyImageView(pwindow->device(), m_view, nullptr);
+    vkDestroyImage(pwindow->device(), m_image, nullptr);
+    pwindow->memory().free(m_memory);
+}
@@ -1,12 +1,80 @@
 #include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/DrawList.hpp>
+#include <Adore/Internal/Vulkan/Bundle.hpp>
+#include <Adore/RenderQueue.hpp>
+#include <Adore/Mesh.hpp>
 #include <Adore/Internal/Vulkan/Window.hpp>
 #include <Adore/Internal/Log.hpp>
 #include <Adore/Internal/Vulkan/Shader.hpp>
 #include <Adore/Internal/Vulkan/Buffer.hpp>
+#include <Adore/Internal/Vulkan/RenderTarget.hpp>
+#include <Adore/Internal/Vulkan/OcclusionQuery.hpp>
+#include <Adore/Internal/Vulkan/HiZ.hpp>
+#include <Adore/Internal/Vulkan/Capture.hpp>
+#include <Adore/Culling.hpp>
 
 #include <Adore/Internal/FramesInFlight.hpp>
 
-VulkanRenderer::VulkanRenderer(std::shared_ptr<Adore::Window>& win)
+#include <algorithm>
+#include <map>
+#include <cstring>
+
+static std::vector<uint32_t> const OCCLUSION_BOX_VERTEX_SHADER = {
+#include <Shaders/OcclusionBox.vert.inc>
+};
+
+static std::vector<uint32_t> const OCCLUSION_BOX_FRAGMENT_SHADER = {
+#include <Shaders/OcclusionBox.frag.inc>
+};
+
+enum class VulkanRenderer::Command : uint8_t
+{
+    BEGIN, BEGIN_TARGET, END,
+    BIND_VERTEX_BUFFER, BIND_INDEX_BUFFER, BIND_VERTEX, BIND_INDEX,
+    DRAW, DRAW_INDEXED, PUSH, DRAW_MESH, DRAW_LIST, DRAW_QUEUE, EXECUTE,
+    BEGIN_QUERY, END_QUERY, QUERY,
+    DISPATCH, DISPATCH_INDIRECT, DISPATCH_ASYNC, CULL,
+    OCCLUSION_CULLING, PENDING_SHADERS, UNIFORM, CAPTURE,
+    BEGIN_HANDLE, BEGIN_TARGET_HANDLE, DRAW_LIST_HANDLE, DISPATCH_HANDLE, CULL_HANDLE
+};
+
+// Data behind a pointer, copied into the stream after its size.
+struct Bytes
+{
+    void const * data;
+    uint32_t size;
+};
+
+template <typename T>
+static void encode(CommandStream& stream, T const& value)
+{
+    stream.write(value);
+}
+
+static void encode(CommandStream& stream, Bytes const& bytes)
+{
+    stream.write(bytes.size);
+    stream.write(bytes.data, bytes.size);
+}
+
+static Bytes decode(CommandStream& stream)
+{
+    uint32_t size = stream.read<uint32_t>();
+    return { stream.read(size), size };
+}
+
+template <typename... Args>
+bool VulkanRenderer::record(Command const& command, Args const&... args)
+{
+    if (!deferred()) return false;
+
+    CommandStream& stream = m_thread->stream();
+    stream.write(command);
+    (encode(stream, args), ...);
+    return true;
+}
+
+VulkanRenderer::VulkanRenderer(std::shared_ptr<Adore::Window>& win, bool const& renderThread)
     : Adore::Renderer(win)
 {
     VulkanWindow* window = static_cast<VulkanWindow*>(m_win.get());
@@ -20,6 +88,7 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Adore::Window>& win)
         throw Adore::AdoreException("Failed to create Vulkan command pool.");
 
     m_commandBuffers.resize(FRAMES_IN_FLIGHT);
+    m_secondaryBuffers.resize(FRAMES_IN_FLIGHT);
 
     VkCommandBufferAllocateInfo allocInfo {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -51,6 +120,52 @@ VulkanRenderer::VulkanRenderer(std::shared_ptr<Adore::Window>& win)
             throw Adore::AdoreException("Failed to create Vulkan fence.");
     }
 
+    if (window->asyncCompute())
+    {
+        poolInfo.queueFamilyIndex = window->queueIndices().compute;
+
+        if (vkCreateCommandPool(window->device(), &poolInfo, nullptr, &m_computePool) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan compute command pool.");
+
+        m_computeBuffers.resize(FRAMES_IN_FLIGHT);
+        m_computeFinished.resize(FRAMES_IN_FLIGHT);
+
+        allocInfo.commandPool = m_computePool;
+        allocInfo.commandBufferCount = m_computeBuffers.size();
+
+        if (vkAllocateCommandBuffers(window->device(), &allocInfo, m_computeBuffers.data()) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to allocate Vulkan compute command buffer.");
+
+        for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+            if (vkCreateSemaphore(window->device(), &semaphoreInfo, nullptr, &m_computeFinished[i]) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to create Vulkan semaphores.");
+    }
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(window->physicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(window->physicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+    if (queueFamilies[window->queueIndices().graphics].timestampValidBits != 0)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(window->physicalDevice(), &properties);
+        m_timestampPeriod = properties.limits.timestampPeriod;
+
+        VkQueryPoolCreateInfo queryInfo {};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = 2 * FRAMES_IN_FLIGHT;
+
+        if (vkCreateQueryPool(window->device(), &queryInfo, nullptr, &m_timestamps) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan timestamp query pool.");
+
+        m_timed.resize(FRAMES_IN_FLIGHT, false);
+    }
+
+    if (renderThread)
+        m_thread = std::make_unique<RenderThread>([this](CommandStream& stream) { replay(stream); });
+
     ADORE_INTERNAL_LOG(INFO, "Created Renderer (Vulkan).");
 }
 
@@ -58,7 +173,28 @@ VulkanRenderer::~VulkanRenderer()
 {
     auto window = static_cast<VulkanWindow*>(m_win.get());
 
+    m_thread.reset();
+    // Closes a capture that did not run to its end.
+    m_capture.reset();
+
     vkQueueWaitIdle(window->queues().graphics);
+    vkQueueWaitIdle(window->queues().compute);
+
+    m_graph.reset();
+    m_hiz.reset();
+
+    for (auto const& retired : m_retired)
+        retired.release();
+    m_retired.clear();
+
+    for (auto& semaphore : m_computeFinished)
+        vkDestroySemaphore(window->device(), semaphore, nullptr);
+
+    if (m_computePool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(window->device(), m_computePool, nullptr);
+
+    if (m_timestamps != VK_NULL_HANDLE)
+        vkDestroyQueryPool(window->device(), m_timestamps, nullptr);
 
     for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
     {
@@ -70,191 +206,1713 @@ VulkanRenderer::~VulkanRenderer()
     vkDestroyCommandPool(window->device(), m_commandPool, nullptr);
 }
 
-void VulkanRenderer::begin(std::shared_ptr<Adore::Shader>& shader)
+void VulkanRenderer::buildGraph(std::vector<VulkanRenderTarget*> const& passes)
 {
-    if (m_win != shader->window())
-        throw Adore::AdoreException("Shader was not created with the same Window as the Renderer.");
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+    auto const& swapchain = pwindow->swapchain();
+    bool multisampled = pwindow->samples() != VK_SAMPLE_COUNT_1_BIT;
+
+    // Frames in flight may still be rendering into the old graph's images.
+    if (m_graph) retire(m_startedFrames, [graph = m_graph] {});
+
+    m_graph = std::make_shared<RenderGraph>(pwindow->device(), pwindow->memory());
+    m_graphShape = passes;
+    m_graphPasses.clear();
+    m_graphCursor = m_framePasses.size();
+    m_graphSwapchain = pwindow->swapchainVersion();
+    m_graphHiZ = m_hizVersion;
+
+    VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (pwindow->depthFormat() != VK_FORMAT_D32_SFLOAT) depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+    // The window's attachments are cleared by its pass, so none of them is kept from the last frame. The
+    // swapchain image is swapped in when the window's pass is entered.
+    m_swapchainResource = m_graph->import("swapchain", VK_NULL_HANDLE, VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT,
+                                          RenderGraph::Access::NONE, RenderGraph::Access::PRESENT);
+
+    // The swapchain only has the window's other attachments when render pass framebuffers need them
+    // or depth is read after the frame, otherwise they are the graph's transient images.
+    if (multisampled)
+        m_colorResource = swapchain.colorImage() == VK_NULL_HANDLE
+            ? m_graph->image("window colour", { pwindow->format().format, pwindow->extent(),
+                                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+                                               VK_IMAGE_ASPECT_COLOR_BIT, pwindow->samples() })
+            : m_graph->import("window colour", swapchain.colorImage(), swapchain.colorView(),
+                              VK_IMAGE_ASPECT_COLOR_BIT, RenderGraph::Access::NONE, RenderGraph::Access::NONE);
+
+    m_depthResource = swapchain.depthImage() == VK_NULL_HANDLE
+        ? m_graph->image("window depth", { pwindow->depthFormat(), pwindow->extent(),
+                                          VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+                                          depthAspect, pwindow->samples() })
+        : m_graph->import("window depth", swapchain.depthImage(), swapchain.depthView(),
+                          depthAspect, RenderGraph::Access::NONE, RenderGraph::Access::NONE);
+
+    std::map<VulkanRenderTarget*, std::pair<RenderGraph::Resource, RenderGraph::Resource>> targets;
+    std::vector<RenderGraph::Resource> rendered;
+
+    for (auto ptarget : passes)
+    {
+        if (ptarget && !targets.count(ptarget))
+        {
+            RenderGraph::Resource color = m_graph->import("render target", ptarget->image(), ptarget->view(),
+                                                          VK_IMAGE_ASPECT_COLOR_BIT,
+                                                          RenderGraph::Access::FRAGMENT_SAMPLED,
+                                                          RenderGraph::Access::FRAGMENT_SAMPLED);
+            RenderGraph::Resource depth = ptarget->depth()
+                ? m_graph->import("render target depth", ptarget->depthImage(), ptarget->depthView(),
+                                  depthAspect, RenderGraph::Access::NONE, RenderGraph::Access::NONE)
+                : color;
+
+            targets[ptarget] = { color, depth };
+        }
+
+        RenderGraph::Pass& pass = m_graph->pass(ptarget ? "render target" : "window");
+
+        // Any later pass may sample what a target was rendered with.
+        for (auto const& resource : rendered)
+            if (!ptarget || resource != targets[ptarget].first)
+                pass.read(resource, RenderGraph::Access::FRAGMENT_SAMPLED);
+
+        if (ptarget)
+        {
+            pass.write(targets[ptarget].first, RenderGraph::Access::COLOR_ATTACHMENT);
+            if (ptarget->depth()) pass.write(targets[ptarget].second, RenderGraph::Access::DEPTH_ATTACHMENT);
+
+            if (std::find(rendered.begin(), rendered.end(), targets[ptarget].first) == rendered.end())
+                rendered.push_back(targets[ptarget].first);
+        }
+        else
+        {
+            pass.write(m_swapchainResource, RenderGraph::Access::COLOR_ATTACHMENT);
+            if (multisampled) pass.write(m_colorResource, RenderGraph::Access::COLOR_ATTACHMENT);
+            pass.write(m_depthResource, RenderGraph::Access::DEPTH_ATTACHMENT);
+        }
+
+        m_graphPasses.push_back(&pass);
+    }
+
+    // Culling reads the pyramid this frame built in the next one.
+    if (m_occlusion && m_hiz && !m_hiz->placeholder())
+    {
+        RenderGraph::Resource pyramid = m_graph->import("hi-z", m_hiz->image(), m_hiz->view(), VK_IMAGE_ASPECT_COLOR_BIT,
+                                                        RenderGraph::Access::COMPUTE_READ,
+                                                        RenderGraph::Access::COMPUTE_READ, m_hiz->levels());
 
+        m_graph->pass("hi-z", [this](VkCommandBuffer const& commandBuffer, RenderGraph const&)
+        {
+            m_hiz->build(commandBuffer);
+        })
+        .read(m_depthResource, RenderGraph::Access::COMPUTE_SAMPLED)
+        .write(pyramid, RenderGraph::Access::COMPUTE_WRITE);
+    }
+
+    m_graph->compile();
+}
+
+void VulkanRenderer::enterPass()
+{
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+    size_t index = m_framePasses.size();
+
+    // The passes already recorded this frame come first in the new graph, so their barriers
+    // stay the same. What follows is guessed to be the window's pass.
+    if (index >= m_graphShape.size() || m_graphShape[index] != m_target)
+    {
+        std::vector<VulkanRenderTarget*> passes = m_framePasses;
+        passes.push_back(m_target);
+        if (m_target) passes.push_back(nullptr);
+        buildGraph(passes);
+    }
+
+    m_framePasses.push_back(m_target);
+
+    if (!m_target)
+        m_graph->update(m_swapchainResource, pwindow->swapchain().images()[m_swapchainImage.second],
+                        pwindow->swapchain().imageViews()[m_swapchainImage.second]);
+
+    size_t position = m_graph->position(*m_graphPasses[index]);
+    m_graph->execute(m_commandBuffers[m_currentFrame], m_graphCursor, position + 1);
+    m_graphCursor = position + 1;
+}
+
+void VulkanRenderer::untrack(VulkanRenderTarget * ptarget)
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_win.get())->mutex());
+
+    if (std::find(m_graphShape.begin(), m_graphShape.end(), ptarget) == m_graphShape.end()) return;
+
+    m_graphShape.clear();
+    m_framePasses.erase(std::remove(m_framePasses.begin(), m_framePasses.end(), ptarget), m_framePasses.end());
+}
+
+uint64_t VulkanRenderer::finishedFrames() const
+{
+    // Starting a frame waits for the one that last used its slot.
+    uint64_t started = m_startedFrames;
+    return started > FRAMES_IN_FLIGHT ? started - FRAMES_IN_FLIGHT : 0;
+}
+
+void VulkanRenderer::retire(uint64_t const& frame, std::function<void()> release)
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_win.get())->mutex());
+    m_retired.push_back({ std::move(release), frame });
+}
+
+void VulkanRenderer::startFrame()
+{
     auto pwindow = static_cast<VulkanWindow*>(m_win.get());
-    auto pshader = static_cast<VulkanShader*>(shader.get());
 
     vkWaitForFences(pwindow->device(), 1, &m_framesInFlight[m_currentFrame], VK_TRUE, UINT64_MAX);
     vkResetFences(pwindow->device(), 1, &m_framesInFlight[m_currentFrame]);
+    m_startedFrames++;
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+        uint64_t finished = finishedFrames();
+        auto retired_end = std::remove_if(m_retired.begin(), m_retired.end(), [&](Retired const& retired)
+        {
+            if (retired.frame > finished) return false;
+            retired.release();
+            return true;
+        });
+        m_retired.erase(retired_end, m_retired.end());
+    }
+
+    uint32_t firstTimestamp = 2 * m_currentFrame;
+
+    if (m_timestamps != VK_NULL_HANDLE && m_timed[m_currentFrame])
+    {
+        uint64_t times[2];
+        if (vkGetQueryPoolResults(pwindow->device(), m_timestamps, firstTimestamp, 2, sizeof(times), times,
+                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+            m_gpuTime = static_cast<float>(static_cast<double>(times[1] - times[0]) * m_timestampPeriod / 1e6);
+    }
+
+    // Before anything this frame can bind the old pyramid. Without occlusion culling a placeholder
+    // stands in, so the depth buffer is never sampled when it was not made readable.
+    if (m_occlusion ? !m_hiz || m_hiz->placeholder() || m_hiz->swapchainVersion() != pwindow->swapchainVersion()
+                    : m_hiz && !m_hiz->placeholder())
+        createHiZ();
 
     m_swapchainImage.first = vkAcquireNextImageKHR(pwindow->device(), pwindow->swapchain().get(),
                 UINT64_MAX, m_framesAvailable[m_currentFrame], VK_NULL_HANDLE, &m_swapchainImage.second);
 
+    // The graph imports the swapchain's attachments and the pyramid.
+    if (m_graphSwapchain != pwindow->swapchainVersion() || m_graphHiZ != m_hizVersion)
+        m_graphShape.clear();
+
+    m_framePasses.clear();
+    m_graphCursor = 0;
+
     vkResetCommandBuffer(m_commandBuffers[m_currentFrame], 0);
+    m_secondaryUsed = 0;
 
     VkCommandBufferBeginInfo beginInfo {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
+    m_boundPipeline = VK_NULL_HANDLE;
+
     if (vkBeginCommandBuffer(m_commandBuffers[m_currentFrame], &beginInfo) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to begin Vulkan command buffer.");
 
-    VkRenderPassBeginInfo renderPassInfo {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = pwindow->renderpass();
-    renderPassInfo.framebuffer = pwindow->swapchain().framebuffers()[m_swapchainImage.second];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = pwindow->extent();
+    if (m_timestamps != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(m_commandBuffers[m_currentFrame], m_timestamps, firstTimestamp, 2);
+        vkCmdWriteTimestamp(m_commandBuffers[m_currentFrame], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            m_timestamps, firstTimestamp);
+    }
+
+    for (auto pquery : m_queries)
+        pquery->resolve(m_commandBuffers[m_currentFrame], m_currentFrame);
+
+    m_frameCulled = false;
+
+    // The previous frame may still be drawing with buffers compute is about to write.
+    m_graphicsReads = true;
+    m_frameStarted = true;
+}
+
+void VulkanRenderer::computeBarrier(VkPipelineStageFlags const& dstStage, VkAccessFlags const& dstAccess)
+{
+    VkPipelineStageFlags srcStage = 0;
+    VkAccessFlags srcAccess = 0;
 
-    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
+    if (m_computeWrites)
+    {
+        srcStage |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        srcAccess |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+
+    if (m_graphicsReads && (dstStage & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT))
+        srcStage |= VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+
+    if (srcStage == 0) return;
 
-    vkCmdBeginRenderPass(m_commandBuffers[m_currentFrame], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    VkMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
 
-    vkCmdBindPipeline(m_commandBuffers[m_currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, pshader->pipeline());
+    vkCmdPipelineBarrier(m_commandBuffers[m_currentFrame], srcStage, dstStage, 0,
+                         1, &barrier, 0, nullptr, 0, nullptr);
 
-    vkCmdBindDescriptorSets(m_commandBuffers[m_currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, pshader->layout(),
-                            0, 1, &pshader->descriptorSets()[m_currentFrame], 0, nullptr);
+    m_computeWrites = false;
+    if (dstStage & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) m_graphicsReads = false;
+}
+
+// Make compute results visible to everything a draw can read them through.
+static VkPipelineStageFlags const GRAPHICS_STAGES = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT
+                                                  | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+                                                  | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                                                  | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+static VkAccessFlags const GRAPHICS_ACCESS = VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                                           | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+                                           | VK_ACCESS_INDEX_READ_BIT
+                                           | VK_ACCESS_UNIFORM_READ_BIT
+                                           | VK_ACCESS_SHADER_READ_BIT;
 
+void VulkanRenderer::updateUniforms(VulkanShader * pshader)
+{
     for (auto& uniform : pshader->uniforms())
         static_cast<VulkanUniformBuffer*>(uniform.resource.get())->update(m_currentFrame);
 }
 
-void VulkanRenderer::draw(uint32_t const& count)
+void VulkanRenderer::bindShader(VkCommandBuffer const& commandBuffer, VulkanShader * pshader)
+{
+    if (commandBuffer != m_boundBuffer || pshader->pipeline() != m_boundPipeline)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pshader->pipeline());
+        m_boundBuffer = commandBuffer;
+        m_boundPipeline = pshader->pipeline();
+    }
+
+    pshader->recordState(commandBuffer);
+    pshader->refresh(m_currentFrame, m_startedFrames);
+
+    if (!pshader->descriptorSets().empty())
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pshader->layout(),
+                                0, 1, &pshader->descriptorSets()[m_currentFrame], 0, nullptr);
+
+    updateUniforms(pshader);
+}
+
+void VulkanRenderer::beginRendering(VkRenderingFlags const& flags)
 {
     auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+    auto const& swapchain = pwindow->swapchain();
+    bool multisampled = pwindow->samples() != VK_SAMPLE_COUNT_1_BIT;
 
-    VkViewport viewport {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(pwindow->extent().width);
-    viewport.height = static_cast<float>(pwindow->extent().height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
+    // When multisampling, render into the graph's colour image and resolve into the swapchain image.
+    // The graph has already moved every attachment into its layout.
+    VkRenderingAttachmentInfo colorAttachment {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = multisampled ? m_graph->view(m_colorResource) : swapchain.imageViews()[m_swapchainImage.second];
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.clearValue.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
 
-    VkRect2D scissor {};
-    scissor.offset = {0, 0};
-    scissor.extent = pwindow->extent();
+    if (multisampled)
+    {
+        colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        colorAttachment.resolveImageView = swapchain.imageViews()[m_swapchainImage.second];
+        colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    VkRenderingAttachmentInfo depthAttachment {};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.imageView = m_graph->view(m_depthResource);
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = pwindow->depthReadable() ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.clearValue.depthStencil = {1.0f, 0};
 
-    vkCmdSetViewport(m_commandBuffers[m_currentFrame], 0, 1, &viewport);
-    vkCmdSetScissor(m_commandBuffers[m_currentFrame], 0, 1, &scissor);
+    VkRenderingInfo renderingInfo {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = flags;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = pwindow->extent();
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    renderingInfo.pDepthAttachment = &depthAttachment;
 
-    vkCmdDraw(m_commandBuffers[m_currentFrame], count, 1, 0, 0);
+    pwindow->commands().beginRendering(m_commandBuffers[m_currentFrame], &renderingInfo);
 }
 
-void VulkanRenderer::drawIndexed(uint32_t const& count)
+void VulkanRenderer::begin(std::shared_ptr<Adore::Shader>& shader)
+{
+    if (record(Command::BEGIN, shader))
+    {
+        m_recordingTarget = false;
+        return;
+    }
+
+    if (m_win != shader->window())
+        throw Adore::AdoreException("Shader was not created with the same Window as the Renderer.");
+
+    begin(shader->handle());
+}
+
+void VulkanRenderer::begin(Adore::ShaderHandle const& shader)
 {
+    if (record(Command::BEGIN_HANDLE, shader))
+    {
+        m_recordingTarget = false;
+        return;
+    }
+
     auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+    auto pentry = pwindow->shaders().get(shader);
 
-    VkViewport viewport {};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(pwindow->extent().width);
-    viewport.height = static_cast<float>(pwindow->extent().height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
+    if (!pentry)
+        throw Adore::AdoreException("Shader handle is null or its shader was destroyed.");
 
-    VkRect2D scissor {};
-    scissor.offset = {0, 0};
-    scissor.extent = pwindow->extent();
+    auto pshader = *pentry;
+
+    if (pshader->bindPoint() != VK_PIPELINE_BIND_POINT_GRAPHICS)
+        throw Adore::AdoreException("Compute shaders can only be dispatched.");
 
-    vkCmdSetViewport(m_commandBuffers[m_currentFrame], 0, 1, &viewport);
-    vkCmdSetScissor(m_commandBuffers[m_currentFrame], 0, 1, &scissor);
+    if (pshader->renderPass() != pwindow->renderpass())
+        throw Adore::AdoreException("Shader was created for a Render Target, not the Window.");
 
-    vkCmdDrawIndexed(m_commandBuffers[m_currentFrame], count, 1, 0, 0, 0);
+    if (!m_frameStarted) startFrame();
+
+    computeBarrier(GRAPHICS_STAGES, GRAPHICS_ACCESS);
+    m_graphicsReads = true;
+
+    // The pass itself starts with the first draw or bundle, which decides its contents.
+    m_inRenderPass = true;
+    m_contents = Contents::NONE;
+    m_shader = usable(pshader);
+    m_extent = pwindow->extent();
+
+    // A fallback is captured as what the pass draws with.
+    if (m_capture) m_capture->begin(m_shader && m_shader != pshader ? m_fallback : pshader->shared_from_this());
 }
 
-void VulkanRenderer::end()
+void VulkanRenderer::begin(std::shared_ptr<Adore::RenderTarget>& target, std::shared_ptr<Adore::Shader>& shader)
+{
+    if (record(Command::BEGIN_TARGET, target, shader))
+    {
+        m_recordingTarget = true;
+        return;
+    }
+
+    if (m_win != shader->window())
+        throw Adore::AdoreException("Shader was not created with the same Window as the Renderer.");
+
+    begin(target, shader->handle());
+}
+
+void VulkanRenderer::begin(std::shared_ptr<Adore::RenderTarget>& target, Adore::ShaderHandle const& shader)
+{
+    if (record(Command::BEGIN_TARGET_HANDLE, target, shader))
+    {
+        m_recordingTarget = true;
+        return;
+    }
+
+    if (target->renderer().get() != this)
+        throw Adore::AdoreException("Render Target is not bound to this renderer.");
+
+    auto pentry = static_cast<VulkanWindow*>(m_win.get())->shaders().get(shader);
+
+    if (!pentry)
+        throw Adore::AdoreException("Shader handle is null or its shader was destroyed.");
+
+    auto ptarget = static_cast<VulkanRenderTarget*>(target.get());
+    auto pshader = *pentry;
+
+    if (pshader->renderPass() != ptarget->renderPass())
+        throw Adore::AdoreException("Shader was not created for this Render Target.");
+
+    if (!m_frameStarted) startFrame();
+
+    computeBarrier(GRAPHICS_STAGES, GRAPHICS_ACCESS);
+    m_graphicsReads = true;
+
+    m_inRenderPass = true;
+    m_contents = Contents::NONE;
+    m_shader = usable(pshader);
+    m_target = ptarget;
+    m_extent = ptarget->extent();
+
+    if (m_capture) m_capture->skip();
+}
+
+void VulkanRenderer::beginPass(Contents const& contents)
 {
     auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+    auto commandBuffer = m_commandBuffers[m_currentFrame];
+    bool secondary = (contents == Contents::SECONDARY);
 
-    vkCmdEndRenderPass(m_commandBuffers[m_currentFrame]);
-    vkEndCommandBuffer(m_commandBuffers[m_currentFrame]);
+    VkClearValue clearValues[2] = {};
+    clearValues[0].color = {{0.0f, 0.0f, 0.0f, m_target ? 0.0f : 1.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
 
-    VkSubmitInfo submitInfo {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &m_framesAvailable[m_currentFrame];
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.pWaitDstStageMask = waitStages;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &m_commandBuffers[m_currentFrame];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &m_framesRendered[m_currentFrame];
+    VkRenderPassBeginInfo renderPassInfo {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = m_extent;
+    renderPassInfo.pClearValues = clearValues;
 
-    if (vkQueueSubmit(pwindow->queues().graphics, 1, &submitInfo, m_framesInFlight[m_currentFrame]) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to submit Vulkan command buffer.");
+    if (m_target)
+    {
+        renderPassInfo.renderPass = m_target->renderPass();
+        renderPassInfo.framebuffer = m_target->framebuffer();
+        renderPassInfo.clearValueCount = m_target->depth() ? 2 : 1;
+    }
+    else if (!pwindow->dynamicRendering())
+    {
+        renderPassInfo.renderPass = pwindow->framePass();
+        renderPassInfo.framebuffer = pwindow->swapchain().framebuffers()[m_swapchainImage.second];
+        renderPassInfo.clearValueCount = 2;
+    }
 
-    VkPresentInfoKHR presentInfo {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &m_framesRendered[m_currentFrame];
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &pwindow->swapchain().get();
-    presentInfo.pImageIndices = &m_swapchainImage.second;
+    enterPass();
 
-    vkQueuePresentKHR(pwindow->queues().present, &presentInfo);
+    if (renderPassInfo.renderPass != VK_NULL_HANDLE)
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+                             secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+    else
+        beginRendering(secondary ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0);
 
-    if (m_swapchainImage.first == VK_ERROR_OUT_OF_DATE_KHR || m_swapchainImage.first == VK_SUBOPTIMAL_KHR)
-        pwindow->recreateSwapchain();
-    
-    m_currentFrame = (m_currentFrame + 1) % FRAMES_IN_FLIGHT;
+    m_contents = contents;
+    m_boundPipeline = VK_NULL_HANDLE;
+    if (!secondary && m_shader) bindShader(commandBuffer, m_shader);
 }
 
-VkCommandBuffer VulkanRenderer::beginCommandBuffer()
+void VulkanRenderer::beginSecondary(VkCommandBuffer const& commandBuffer)
 {
-    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
 
-    VkCommandBufferAllocateInfo allocInfo {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = m_commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = 1;
+    VkCommandBufferInheritanceRenderingInfo renderingInfo {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &pwindow->format().format;
+    renderingInfo.depthAttachmentFormat = pwindow->depthFormat();
+    renderingInfo.rasterizationSamples = pwindow->samples();
 
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(pwindow->device(), &allocInfo, &commandBuffer);
+    VkCommandBufferInheritanceInfo inheritanceInfo {};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = pwindow->dynamicRendering() ? &renderingInfo : nullptr;
+    inheritanceInfo.renderPass = pwindow->renderpass();
+    inheritanceInfo.subpass = 0;
 
     VkCommandBufferBeginInfo beginInfo {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    m_boundPipeline = VK_NULL_HANDLE;
+
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to begin Vulkan command buffer.");
-    
-    return commandBuffer;
+        throw Adore::AdoreException("Failed to begin Vulkan secondary command buffer.");
 }
 
-void VulkanRenderer::endCommandBuffer(VkCommandBuffer const& commandBuffer)
+VkCommandBuffer VulkanRenderer::drawBuffer()
 {
-    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+    if (!m_inRenderPass)
+        throw Adore::AdoreException("Draw commands have to be recorded inside begin() / end().");
 
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to end Vulkan command buffer.");
+    if (m_contents == Contents::NONE) beginPass(Contents::INLINE);
+    if (m_contents == Contents::INLINE) return m_commandBuffers[m_currentFrame];
 
-    VkSubmitInfo submitInfo {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
+    // Direct draws after a bundle go into a secondary command buffer of their own.
+    if (m_inlineBuffer == VK_NULL_HANDLE)
+    {
+        auto& buffers = m_secondaryBuffers[m_currentFrame];
 
-    vkQueueSubmit(pwindow->queues().graphics, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(pwindow->queues().graphics);
+        if (m_secondaryUsed == buffers.size())
+        {
+            auto pwindow = static_cast<VulkanWindow*>(m_win.get());
 
-    vkFreeCommandBuffers(pwindow->device(), m_commandPool, 1, &commandBuffer);
+            VkCommandBufferAllocateInfo allocInfo {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = m_commandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            buffers.emplace_back();
+            if (vkAllocateCommandBuffers(pwindow->device(), &allocInfo, &buffers.back()) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to allocate Vulkan secondary command buffer.");
+        }
+
+        m_inlineBuffer = buffers[m_secondaryUsed++];
+        beginSecondary(m_inlineBuffer);
+        if (m_shader) bindShader(m_inlineBuffer, m_shader);
+    }
+
+    return m_inlineBuffer;
 }
 
-void VulkanRenderer::bind(std::shared_ptr<Adore::IndexBuffer>& buffer)
+void VulkanRenderer::flushInline()
 {
-    if (buffer->renderer().get() != this)
-        throw Adore::AdoreException("Index Buffer is not bound to this renderer.");
+    if (m_inlineBuffer == VK_NULL_HANDLE) return;
+
+    if (vkEndCommandBuffer(m_inlineBuffer) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to end Vulkan secondary command buffer.");
 
-    vkCmdBindIndexBuffer(m_commandBuffers[m_currentFrame],
-                         static_cast<VulkanIndexBuffer*>(buffer.get())->buffer(),
-                         0, VK_INDEX_TYPE_UINT16);
+    vkCmdExecuteCommands(m_commandBuffers[m_currentFrame], 1, &m_inlineBuffer);
+    m_inlineBuffer = VK_NULL_HANDLE;
+    m_boundPipeline = VK_NULL_HANDLE;
 }
 
-void VulkanRenderer::bind(std::shared_ptr<Adore::VertexBuffer>& buffer, uint32_t const& binding)
+void VulkanRenderer::execute(std::shared_ptr<Adore::Bundle>& bundle)
 {
-    if (buffer->renderer().get() != this)
-        throw Adore::AdoreException("Vertex Buffer is not bound to this renderer.");
+    if (record(Command::EXECUTE, bundle)) return;
+    if (m_capture) m_capture->skip();
 
-    VkDeviceSize offset = 0;
+    if (bundle->renderer().get() != this)
+        throw Adore::AdoreException("Bundle is not bound to this renderer.");
 
-    vkCmdBindVertexBuffers(m_commandBuffers[m_currentFrame], binding, 1,
-                           &static_cast<VulkanVertexBuffer*>(buffer.get())->buffer(),
-                           &offset);
-}
\ No newline at end of file
+    if (!m_inRenderPass || m_target)
+        throw Adore::AdoreException("Bundles can only be executed inside begin() / end() of the window.");
+
+    if (m_contents == Contents::INLINE)
+        throw Adore::AdoreException("Bundles have to be executed before any direct draws in a pass.");
+
+    if (m_activeQuery)
+        throw Adore::AdoreException("Bundles can not be executed while an occlusion query is active.");
+
+    auto pshader = static_cast<VulkanShader*>(bundle->shader().get());
+    if (usable(pshader) != pshader) return;
+
+    if (m_contents == Contents::NONE) beginPass(Contents::SECONDARY);
+
+    flushInline();
+
+    auto pbundle = static_cast<VulkanBundle*>(bundle.get());
+    auto commandBuffer = pbundle->record(m_currentFrame);
+
+    updateUniforms(pshader);
+    vkCmdExecuteCommands(m_commandBuffers[m_currentFrame], 1, &commandBuffer);
+    m_boundPipeline = VK_NULL_HANDLE;
+}
+
+void VulkanRenderer::setViewport(VkCommandBuffer const& commandBuffer, VkExtent2D const& extent)
+{
+    VkViewport viewport {};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor {};
+    scissor.offset = {0, 0};
+    scissor.extent = extent;
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void VulkanRenderer::draw(uint32_t const& count)
+{
+    if (record(Command::DRAW, count)) return;
+    if (!m_shader) return;
+
+    auto commandBuffer = drawBuffer();
+    setViewport(commandBuffer, m_extent);
+
+    vkCmdDraw(commandBuffer, count, 1, 0, 0);
+
+    if (auto pcapture = captured()) pcapture->draw(count);
+}
+
+void VulkanRenderer::drawIndexed(uint32_t const& count)
+{
+    if (record(Command::DRAW_INDEXED, count)) return;
+    if (!m_shader) return;
+
+    auto commandBuffer = drawBuffer();
+    setViewport(commandBuffer, m_extent);
+
+    vkCmdDrawIndexed(commandBuffer, count, 1, 0, 0, 0);
+
+    if (auto pcapture = captured()) pcapture->drawIndexed(count, 0);
+}
+
+void VulkanRenderer::push(void const * data, uint32_t const& size, uint32_t const& offset)
+{
+    if (record(Command::PUSH, Bytes { data, size }, offset)) return;
+    if (!m_shader) return;
+
+    auto commandBuffer = drawBuffer();
+
+    if (offset % 4 != 0 || size % 4 != 0 || offset + size > m_shader->descriptor().pushConstants)
+        throw Adore::AdoreException("Push constants out of the shader's range.");
+
+    vkCmdPushConstants(commandBuffer, m_shader->layout(), VK_SHADER_STAGE_ALL, offset, size, data);
+
+    if (auto pcapture = captured()) pcapture->push(data, size, offset);
+}
+
+void VulkanRenderer::draw(std::shared_ptr<Adore::Mesh>& mesh, uint32_t const& level)
+{
+    if (record(Command::DRAW_MESH, mesh, level)) return;
+
+    if (level >= mesh->levels().size())
+        throw Adore::AdoreException("Mesh does not have that level of detail.");
+
+    if (!m_shader) return;
+
+    bind(mesh->vertices(), 0);
+    if (mesh->attributes()) bind(mesh->attributes(), 1);
+    bind(mesh->indices());
+
+    auto commandBuffer = drawBuffer();
+    setViewport(commandBuffer, m_extent);
+
+    auto const& lod = mesh->levels()[level];
+    vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+
+    if (auto pcapture = captured()) pcapture->drawIndexed(lod.indexCount, lod.firstIndex);
+}
+
+void VulkanRenderer::draw(std::shared_ptr<Adore::DrawList>& list)
+{
+    if (record(Command::DRAW_LIST, list)) return;
+
+    if (list->renderer().get() != this)
+        throw Adore::AdoreException("Draw List is not bound to this renderer.");
+
+    draw(list->handle());
+}
+
+void VulkanRenderer::draw(Adore::DrawListHandle const& list)
+{
+    if (record(Command::DRAW_LIST_HANDLE, list)) return;
+    if (m_capture) m_capture->skip();
+
+    auto pentry = m_drawLists.get(list);
+
+    if (!pentry)
+        throw Adore::AdoreException("Draw List handle is null or its list was destroyed.");
+
+    if (!m_shader) return;
+
+    auto commandBuffer = drawBuffer();
+    setViewport(commandBuffer, m_extent);
+
+    drawIndirect(commandBuffer, *pentry);
+}
+
+void VulkanRenderer::draw(std::shared_ptr<Adore::RenderQueue>& queue)
+{
+    queue->sort();
+    auto const& packets = queue->packets();
+
+    // The queue can be changed, and what its packets point to released, before the render thread
+    // gets to them. The packets are copied and the stream holds everything they point to.
+    if (deferred())
+    {
+        std::vector<std::shared_ptr<void>> held;
+        Adore::DrawPacket const * previous = nullptr;
+
+        for (auto const& packet : packets)
+        {
+            if (!previous || packet.shader != previous->shader)
+                held.push_back(static_cast<VulkanShader*>(packet.shader)->shared_from_this());
+            if (packet.vertices && (!previous || packet.vertices != previous->vertices))
+                held.push_back(static_cast<VulkanVertexBuffer*>(packet.vertices)->shared_from_this());
+            if (packet.indices && (!previous || packet.indices != previous->indices))
+                held.push_back(static_cast<VulkanIndexBuffer*>(packet.indices)->shared_from_this());
+            if (packet.attributes && (!previous || packet.attributes != previous->attributes))
+                held.push_back(static_cast<VulkanVertexBuffer*>(packet.attributes)->shared_from_this());
+            previous = &packet;
+        }
+
+        record(Command::DRAW_QUEUE, Bytes { packets.data(), static_cast<uint32_t>(packets.size() * sizeof(Adore::DrawPacket)) },
+               static_cast<uint32_t>(held.size()));
+        for (auto const& object : held)
+            m_thread->stream().write(object);
+        return;
+    }
+
+    if (m_capture) m_capture->skip();
+    if (!m_shader) return;
+
+    drawPackets(packets);
+}
+
+void VulkanRenderer::drawPackets(std::vector<Adore::DrawPacket> const& packets)
+{
+    auto commandBuffer = drawBuffer();
+    setViewport(commandBuffer, m_extent);
+
+    Adore::Shader * shader = nullptr;
+    VulkanShader * bound = m_shader;
+    bool skip = false;
+    Adore::VertexBuffer * vertices = nullptr;
+    Adore::VertexBuffer * attributes = nullptr;
+    Adore::IndexBuffer * indices = nullptr;
+
+    for (auto const& packet : packets)
+    {
+        if (packet.shader != shader)
+        {
+            auto pshader = static_cast<VulkanShader*>(packet.shader);
+
+            if (pshader->bindPoint() != VK_PIPELINE_BIND_POINT_GRAPHICS || pshader->renderPass() != m_shader->renderPass())
+                throw Adore::AdoreException("Draw packet shader was not created for the current pass.");
+
+            shader = packet.shader;
+            pshader = usable(pshader);
+            skip = !pshader;
+
+            if (pshader && pshader != bound)
+            {
+                bindShader(commandBuffer, pshader);
+                bound = pshader;
+            }
+        }
+
+        if (skip) continue;
+
+        if (packet.vertices && packet.vertices != vertices)
+        {
+            if (packet.vertices->renderer().get() != this)
+                throw Adore::AdoreException("Vertex Buffer is not bound to this renderer.");
+
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1,
+                                   &static_cast<VulkanVertexBuffer*>(packet.vertices)->buffer(), &offset);
+            vertices = packet.vertices;
+        }
+
+        if (packet.attributes && packet.attributes != attributes)
+        {
+            if (packet.attributes->renderer().get() != this)
+                throw Adore::AdoreException("Vertex Buffer is not bound to this renderer.");
+
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 1, 1,
+                                   &static_cast<VulkanVertexBuffer*>(packet.attributes)->buffer(), &offset);
+            attributes = packet.attributes;
+        }
+
+        if (!packet.indices)
+        {
+            vkCmdDraw(commandBuffer, packet.count, 1, packet.first, 0);
+            continue;
+        }
+
+        if (packet.indices != indices)
+        {
+            if (packet.indices->renderer().get() != this)
+                throw Adore::AdoreException("Index Buffer is not bound to this renderer.");
+
+            vkCmdBindIndexBuffer(commandBuffer, static_cast<VulkanIndexBuffer*>(packet.indices)->buffer(),
+                                 0, VK_INDEX_TYPE_UINT16);
+            indices = packet.indices;
+        }
+
+        vkCmdDrawIndexed(commandBuffer, packet.count, 1, packet.first, packet.vertexOffset, 0);
+    }
+
+    // Draws after the queue expect the pass's own shader.
+    if (bound != m_shader) bindShader(commandBuffer, m_shader);
+}
+
+void VulkanRenderer::drawIndirect(VkCommandBuffer const& commandBuffer, VulkanDrawList * plist)
+{
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+    uint32_t const stride = sizeof(VkDrawIndexedIndirectCommand);
+
+    // Without multiDrawIndirect the limit is a single draw per call.
+    uint32_t const batch = pwindow->features().multiDrawIndirect ? pwindow->limits().maxDrawIndirectCount : 1;
+
+    // Compacted lists are only made when one call can draw every object.
+    if (plist->compact())
+    {
+        pwindow->commands().drawIndexedIndirectCount(commandBuffer, plist->commands(), 0, plist->visible(), 0,
+                                                     plist->count(), stride);
+        return;
+    }
+
+    for (uint32_t first = 0; first < plist->count(); first += batch)
+        vkCmdDrawIndexedIndirect(commandBuffer, plist->commands(), static_cast<VkDeviceSize>(first) * stride,
+                                 std::min(plist->count() - first, batch), stride);
+}
+
+void VulkanRenderer::end()
+{
+    if (record(Command::END))
+    {
+        if (!m_recordingTarget) m_thread->submit();
+        m_recordingTarget = false;
+        return;
+    }
+
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    if (!m_inRenderPass)
+        throw Adore::AdoreException("end() has to follow begin().");
+
+    if (m_activeQuery)
+        throw Adore::AdoreException("Occlusion queries have to be ended before their pass.");
+
+    // A pass without draws still clears its attachments.
+    if (m_contents == Contents::NONE) beginPass(Contents::INLINE);
+    flushInline();
+
+    m_inRenderPass = false;
+
+    if (m_target)
+    {
+        vkCmdEndRenderPass(m_commandBuffers[m_currentFrame]);
+        m_target = nullptr;
+        return;
+    }
+
+    if (m_capture)
+    {
+        m_capture->end();
+        if (m_capture->done()) m_capture.reset();
+    }
+
+    if (pwindow->dynamicRendering())
+        pwindow->commands().endRendering(m_commandBuffers[m_currentFrame]);
+    else
+        vkCmdEndRenderPass(m_commandBuffers[m_currentFrame]);
+
+    // What is left of the graph builds the pyramid and hands the swapchain image over for presenting.
+    m_graph->execute(m_commandBuffers[m_currentFrame], m_graphCursor, m_graph->livePasses());
+
+    if (m_occlusion)
+    {
+        // Without a cull this frame there is no telling what the depth was rendered with.
+        m_hizValid = m_frameCulled;
+        std::copy(m_frameViewProjection, m_frameViewProjection + 16, m_hizViewProjection);
+    }
+
+    if (m_timestamps != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(m_commandBuffers[m_currentFrame], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            m_timestamps, 2 * m_currentFrame + 1);
+        m_timed[m_currentFrame] = true;
+    }
+
+    vkEndCommandBuffer(m_commandBuffers[m_currentFrame]);
+
+    std::vector<VkSemaphore> waitSemaphores = { m_framesAvailable[m_currentFrame] };
+    std::vector<VkPipelineStageFlags> waitStages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+    if (m_asyncRecording)
+    {
+        if (vkEndCommandBuffer(m_computeBuffers[m_currentFrame]) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to end Vulkan compute command buffer.");
+
+        VkSubmitInfo computeInfo {};
+        computeInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        computeInfo.commandBufferCount = 1;
+        computeInfo.pCommandBuffers = &m_computeBuffers[m_currentFrame];
+        computeInfo.signalSemaphoreCount = 1;
+        computeInfo.pSignalSemaphores = &m_computeFinished[m_currentFrame];
+
+        if (vkQueueSubmit(pwindow->queues().compute, 1, &computeInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to submit Vulkan compute command buffer.");
+
+        waitSemaphores.push_back(m_computeFinished[m_currentFrame]);
+        waitStages.push_back(GRAPHICS_STAGES | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        m_asyncRecording = false;
+        m_asyncWrites = false;
+    }
+
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = waitSemaphores.size();
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_commandBuffers[m_currentFrame];
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_framesRendered[m_currentFrame];
+
+    if (vkQueueSubmit(pwindow->queues().graphics, 1, &submitInfo, m_framesInFlight[m_currentFrame]) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to submit Vulkan command buffer.");
+
+    VkPresentInfoKHR presentInfo {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &m_framesRendered[m_currentFrame];
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &pwindow->swapchain().get();
+    presentInfo.pImageIndices = &m_swapchainImage.second;
+
+    vkQueuePresentKHR(pwindow->queues().present, &presentInfo);
+
+    if (m_swapchainImage.first == VK_ERROR_OUT_OF_DATE_KHR || m_swapchainImage.first == VK_SUBOPTIMAL_KHR)
+        pwindow->recreateSwapchain();
+
+    m_frameStarted = false;
+    m_currentFrame = (m_currentFrame + 1) % FRAMES_IN_FLIGHT;
+
+    // Budgets move with other processes too, not only when Adore allocates.
+    pwindow->memory().check();
+}
+
+Adore::MemoryStats VulkanRenderer::memoryStats() const
+{
+    return static_cast<VulkanWindow*>(m_win.get())->memory().stats();
+}
+
+void VulkanRenderer::memoryThreshold(float const& fraction, std::function<void(Adore::MemoryStats const&)> const& callback)
+{
+    static_cast<VulkanWindow*>(m_win.get())->memory().threshold(fraction, callback);
+}
+
+VkCommandBuffer VulkanRenderer::beginCommandBuffer()
+{
+    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    VkCommandBufferAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    // Held until endCommandBuffer(), the pool and the queue are shared with the render thread.
+    pwindow->mutex().lock();
+
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(pwindow->device(), &allocInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        vkFreeCommandBuffers(pwindow->device(), m_commandPool, 1, &commandBuffer);
+        pwindow->mutex().unlock();
+        throw Adore::AdoreException("Failed to begin Vulkan command buffer.");
+    }
+    
+    return commandBuffer;
+}
+
+void VulkanRenderer::endCommandBuffer(VkCommandBuffer const& commandBuffer)
+{
+    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex(), std::adopt_lock);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to end Vulkan command buffer.");
+
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkQueueSubmit(pwindow->queues().graphics, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(pwindow->queues().graphics);
+
+    vkFreeCommandBuffers(pwindow->device(), m_commandPool, 1, &commandBuffer);
+}
+
+void VulkanRenderer::bind(std::shared_ptr<Adore::IndexBuffer>& buffer)
+{
+    if (record(Command::BIND_INDEX_BUFFER, buffer)) return;
+
+    if (buffer->renderer().get() != this)
+        throw Adore::AdoreException("Index Buffer is not bound to this renderer.");
+
+    bind(buffer->handle());
+}
+
+void VulkanRenderer::bind(std::shared_ptr<Adore::VertexBuffer>& buffer, uint32_t const& binding)
+{
+    if (record(Command::BIND_VERTEX_BUFFER, buffer, binding)) return;
+
+    if (buffer->renderer().get() != this)
+        throw Adore::AdoreException("Vertex Buffer is not bound to this renderer.");
+
+    bind(buffer->handle(), binding);
+}
+
+void VulkanRenderer::bind(Adore::IndexBufferHandle const& buffer)
+{
+    if (record(Command::BIND_INDEX, buffer)) return;
+
+    auto pbuffer = m_indexBuffers.get(buffer);
+
+    if (!pbuffer)
+        throw Adore::AdoreException("Index Buffer handle is null or its buffer was destroyed.");
+
+    if (!m_shader) return;
+
+    vkCmdBindIndexBuffer(drawBuffer(), pbuffer->buffer, 0, VK_INDEX_TYPE_UINT16);
+
+    if (auto pcapture = captured()) pcapture->bind(pbuffer->owner);
+}
+
+void VulkanRenderer::bind(Adore::VertexBufferHandle const& buffer, uint32_t const& binding)
+{
+    if (record(Command::BIND_VERTEX, buffer, binding)) return;
+
+    auto pbuffer = m_vertexBuffers.get(buffer);
+
+    if (!pbuffer)
+        throw Adore::AdoreException("Vertex Buffer handle is null or its buffer was destroyed.");
+
+    if (!m_shader) return;
+
+    VkDeviceSize offset = 0;
+
+    vkCmdBindVertexBuffers(drawBuffer(), binding, 1, &pbuffer->buffer, &offset);
+
+    if (auto pcapture = captured()) pcapture->bind(pbuffer->owner, binding);
+}
+
+VulkanShader * VulkanRenderer::computeShader(VulkanShader * pshader)
+{
+    if (m_win != pshader->window())
+        throw Adore::AdoreException("Shader was not created with the same Window as the Renderer.");
+
+    if (pshader->bindPoint() != VK_PIPELINE_BIND_POINT_COMPUTE)
+        throw Adore::AdoreException("Only compute shaders can be dispatched.");
+
+    if (m_inRenderPass)
+        throw Adore::AdoreException("Compute shaders can not be dispatched inside begin() / end().");
+
+    // There is no fallback for compute, a dispatch is either waited for or skipped.
+    if (!pshader->ready() && m_pending != Adore::PendingShaders::WAIT) return nullptr;
+    pshader->wait();
+
+    if (!m_frameStarted) startFrame();
+
+    updateUniforms(pshader);
+
+    return pshader;
+}
+
+void VulkanRenderer::dispatch(std::shared_ptr<Adore::Shader>& shader, uint32_t const& x,
+                              uint32_t const& y, uint32_t const& z)
+{
+    if (record(Command::DISPATCH, shader, x, y, z)) return;
+
+    if (m_win != shader->window())
+        throw Adore::AdoreException("Shader was not created with the same Window as the Renderer.");
+
+    dispatch(shader->handle(), x, y, z);
+}
+
+void VulkanRenderer::dispatch(Adore::ShaderHandle const& shader, uint32_t const& x,
+                              uint32_t const& y, uint32_t const& z)
+{
+    if (record(Command::DISPATCH_HANDLE, shader, x, y, z)) return;
+    if (m_capture) m_capture->skip();
+
+    auto pentry = static_cast<VulkanWindow*>(m_win.get())->shaders().get(shader);
+
+    if (!pentry)
+        throw Adore::AdoreException("Shader handle is null or its shader was destroyed.");
+
+    auto pshader = computeShader(*pentry);
+    if (!pshader) return;
+
+    auto commandBuffer = m_commandBuffers[m_currentFrame];
+
+    computeBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    pshader->refresh(m_currentFrame, m_startedFrames);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pshader->pipeline());
+    if (!pshader->descriptorSets().empty())
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pshader->layout(),
+                                0, 1, &pshader->descriptorSets()[m_currentFrame], 0, nullptr);
+    vkCmdDispatch(commandBuffer, x, y, z);
+
+    m_computeWrites = true;
+}
+
+void VulkanRenderer::dispatchIndirect(std::shared_ptr<Adore::Shader>& shader,
+                                      std::shared_ptr<Adore::StorageBuffer>& buffer, uint64_t const& offset)
+{
+    if (record(Command::DISPATCH_INDIRECT, shader, buffer, offset)) return;
+    if (m_capture) m_capture->skip();
+
+    if (buffer->renderer().get() != this)
+        throw Adore::AdoreException("Storage Buffer is not bound to this renderer.");
+
+    auto pshader = computeShader(static_cast<VulkanShader*>(shader.get()));
+    if (!pshader) return;
+
+    auto commandBuffer = m_commandBuffers[m_currentFrame];
+
+    computeBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                   VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+    pshader->refresh(m_currentFrame, m_startedFrames);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pshader->pipeline());
+    if (!pshader->descriptorSets().empty())
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pshader->layout(),
+                                0, 1, &pshader->descriptorSets()[m_currentFrame], 0, nullptr);
+    vkCmdDispatchIndirect(commandBuffer, static_cast<VulkanStorageBuffer*>(buffer.get())->buffer(), offset);
+
+    m_computeWrites = true;
+}
+
+// Async work must not write resources the previous frame may still be reading; nothing orders
+// the two queues apart from the semaphore the graphics submission of this frame waits on.
+void VulkanRenderer::dispatchAsync(std::shared_ptr<Adore::Shader>& shader, uint32_t const& x,
+                                   uint32_t const& y, uint32_t const& z)
+{
+    if (record(Command::DISPATCH_ASYNC, shader, x, y, z)) return;
+    if (m_capture) m_capture->skip();
+
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    if (!pwindow->asyncCompute())
+    {
+        dispatch(shader, x, y, z);
+        return;
+    }
+
+    auto pshader = computeShader(static_cast<VulkanShader*>(shader.get()));
+    if (!pshader) return;
+
+    auto commandBuffer = m_computeBuffers[m_currentFrame];
+
+    if (!m_asyncRecording)
+    {
+        vkResetCommandBuffer(commandBuffer, 0);
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to begin Vulkan compute command buffer.");
+
+        m_asyncRecording = true;
+    }
+    else if (m_asyncWrites)
+    {
+        VkMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    pshader->refresh(m_currentFrame, m_startedFrames);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pshader->pipeline());
+    if (!pshader->descriptorSets().empty())
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pshader->layout(),
+                                0, 1, &pshader->descriptorSets()[m_currentFrame], 0, nullptr);
+    vkCmdDispatch(commandBuffer, x, y, z);
+
+    m_asyncWrites = true;
+}
+
+void VulkanRenderer::cull(std::shared_ptr<Adore::DrawList>& list, float const * viewProjection)
+{
+    if (record(Command::CULL, list, Bytes { viewProjection, 16 * sizeof(float) })) return;
+
+    if (list->renderer().get() != this)
+        throw Adore::AdoreException("Draw List is not bound to this renderer.");
+
+    cull(list->handle(), viewProjection);
+}
+
+void VulkanRenderer::cull(Adore::DrawListHandle const& list, float const * viewProjection)
+{
+    if (record(Command::CULL_HANDLE, list, Bytes { viewProjection, 16 * sizeof(float) })) return;
+    if (m_capture) m_capture->skip();
+
+    auto pentry = m_drawLists.get(list);
+
+    if (!pentry)
+        throw Adore::AdoreException("Draw List handle is null or its list was destroyed.");
+
+    if (m_inRenderPass)
+        throw Adore::AdoreException("Draw Lists can not be culled inside begin() / end().");
+
+    if (!m_frameStarted) startFrame();
+
+    auto plist = *pentry;
+    auto commandBuffer = m_commandBuffers[m_currentFrame];
+
+    // The shader needs a pyramid to sample even while occlusion culling is off, startFrame()
+    // replaces it when that changes.
+    if (!m_hiz) createHiZ();
+
+    std::copy(viewProjection, viewProjection + 16, m_frameViewProjection);
+    m_frameCulled = true;
+
+    plist->setOcclusion(m_currentFrame, *m_hiz, m_hizVersion,
+                        m_occlusion && m_hizValid ? m_hizViewProjection : nullptr);
+    plist->setFrustum(viewProjection);
+
+    if (plist->compact())
+    {
+        // The previous draw of this list may still be reading the count.
+        VkBufferMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = plist->visible();
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        vkCmdFillBuffer(commandBuffer, plist->visible(), 0, VK_WHOLE_SIZE, 0);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    dispatch(plist->shader(), (plist->count() + 63) / 64, 1, 1);
+}
+
+void VulkanRenderer::createHiZ()
+{
+    auto pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    // Draw lists of the other frame may still be sampling the old one.
+    vkQueueWaitIdle(pwindow->queues().graphics);
+    vkQueueWaitIdle(pwindow->queues().compute);
+
+    m_hiz.reset();
+    m_hiz = std::make_unique<VulkanHiZ>(this, pwindow, !m_occlusion);
+    m_hizVersion++;
+    m_hizValid = false;
+}
+
+void VulkanRenderer::occlusionCulling(bool const& enable)
+{
+    if (record(Command::OCCLUSION_CULLING, enable)) return;
+
+    if (m_frameStarted)
+        throw Adore::AdoreException("Occlusion culling can only be switched between frames.");
+
+    if (enable) static_cast<VulkanWindow*>(m_win.get())->readableDepth();
+
+    m_occlusion = enable;
+    m_hizValid = false;
+}
+
+void VulkanRenderer::pendingShaders(Adore::PendingShaders const& mode, std::shared_ptr<Adore::Shader> const& fallback)
+{
+    if (record(Command::PENDING_SHADERS, mode, fallback)) return;
+
+    if (fallback && fallback->window() != m_win)
+        throw Adore::AdoreException("Fallback shader was not created with the same Window as the Renderer.");
+
+    m_pending = mode;
+    m_fallback = fallback;
+}
+
+VulkanShader * VulkanRenderer::usable(VulkanShader * pshader)
+{
+    if (pshader->ready()) return pshader;
+
+    switch (m_pending)
+    {
+        case Adore::PendingShaders::SKIP:
+            return nullptr;
+        case Adore::PendingShaders::FALLBACK:
+        {
+            auto pfallback = static_cast<VulkanShader*>(m_fallback.get());
+            bool compatible = pfallback && pfallback->ready() && pfallback->bindPoint() == pshader->bindPoint()
+                           && pfallback->renderPass() == pshader->renderPass();
+            return compatible ? pfallback : nullptr;
+        }
+        default:
+            pshader->wait();
+            return pshader;
+    }
+}
+
+void VulkanRenderer::track(VulkanOcclusionQuery * pquery)
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_win.get())->mutex());
+    m_queries.push_back(pquery);
+}
+
+void VulkanRenderer::untrack(VulkanOcclusionQuery * pquery)
+{
+    std::lock_guard<std::recursive_mutex> lock(static_cast<VulkanWindow*>(m_win.get())->mutex());
+    m_queries.erase(std::remove(m_queries.begin(), m_queries.end(), pquery), m_queries.end());
+}
+
+void VulkanRenderer::beginQuery(std::shared_ptr<Adore::OcclusionQuery>& query, uint32_t const& index)
+{
+    if (record(Command::BEGIN_QUERY, query, index)) return;
+    if (m_capture) m_capture->skip();
+
+    if (query->renderer().get() != this)
+        throw Adore::AdoreException("Occlusion Query is not bound to this renderer.");
+
+    if (m_activeQuery)
+        throw Adore::AdoreException("Only one occlusion query can be active at a time.");
+
+    auto pquery = static_cast<VulkanOcclusionQuery*>(query.get());
+    auto commandBuffer = drawBuffer();
+
+    pquery->write(m_currentFrame, index);
+    vkCmdBeginQuery(commandBuffer, pquery->pool(m_currentFrame), index, 0);
+
+    m_activeQuery = pquery;
+    m_activeIndex = index;
+}
+
+void VulkanRenderer::endQuery(std::shared_ptr<Adore::OcclusionQuery>& query, uint32_t const& index)
+{
+    if (record(Command::END_QUERY, query, index)) return;
+    if (m_capture) m_capture->skip();
+
+    if (m_activeQuery != query.get() || m_activeIndex != index)
+        throw Adore::AdoreException("endQuery() has to match the active beginQuery().");
+
+    vkCmdEndQuery(drawBuffer(), m_activeQuery->pool(m_currentFrame), index);
+    m_activeQuery = nullptr;
+}
+
+VulkanShader * VulkanRenderer::boxShader()
+{
+    if (!m_boxShader)
+    {
+        PipelineState state {};
+        state.depthWrite = false;
+        state.colorWrite = false;
+        state.cullMode = VK_CULL_MODE_NONE;
+        state.pushConstants = sizeof(float) * 24;
+
+        m_boxShader = std::make_shared<VulkanShader>(m_win,
+            std::vector<Adore::ShaderModule> {
+                { Adore::ShaderType::VERTEX, "", OCCLUSION_BOX_VERTEX_SHADER },
+                { Adore::ShaderType::FRAGMENT, "", OCCLUSION_BOX_FRAGMENT_SHADER }
+            },
+            Adore::LayoutDescriptor {}, VK_NULL_HANDLE, false, state);
+    }
+
+    return static_cast<VulkanShader*>(m_boxShader.get());
+}
+
+void VulkanRenderer::query(std::shared_ptr<Adore::OcclusionQuery>& query, std::vector<Adore::BoundingBox> const& boxes,
+                           float const * viewProjection)
+{
+    if (record(Command::QUERY, query, Bytes { boxes.data(), static_cast<uint32_t>(boxes.size() * sizeof(Adore::BoundingBox)) },
+               Bytes { viewProjection, 16 * sizeof(float) }))
+        return;
+    if (m_capture) m_capture->skip();
+
+    if (query->renderer().get() != this)
+        throw Adore::AdoreException("Occlusion Query is not bound to this renderer.");
+
+    if (boxes.size() > query->count())
+        throw Adore::AdoreException("More boxes than the occlusion query has indices.");
+
+    if (m_activeQuery)
+        throw Adore::AdoreException("Boxes can not be queried while an occlusion query is active.");
+
+    if (m_target)
+        throw Adore::AdoreException("Boxes can only be queried in the window pass.");
+
+    auto commandBuffer = drawBuffer();
+
+    auto pquery = static_cast<VulkanOcclusionQuery*>(query.get());
+    auto pshader = boxShader();
+
+    bindShader(commandBuffer, pshader);
+    setViewport(commandBuffer, m_extent);
+
+    // Matches the push constants in Shaders/OcclusionBox.vert.
+    float constants[24];
+    std::copy(viewProjection, viewProjection + 16, constants);
+
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        auto const& box = boxes[i];
+
+        // A box the camera is in or next to would be clipped by the near plane and could come
+        // back hidden while it is not.
+        bool clipped = false;
+        for (unsigned int corner = 0; corner < 8 && !clipped; corner++)
+        {
+            float position[3] = { (corner & 1) ? box.max.x : box.min.x,
+                                  (corner & 2) ? box.max.y : box.min.y,
+                                  (corner & 4) ? box.max.z : box.min.z };
+            float z = viewProjection[14];
+            float w = viewProjection[15];
+
+            for (unsigned int axis = 0; axis < 3; axis++)
+            {
+                z += viewProjection[axis * 4 + 2] * position[axis];
+                w += viewProjection[axis * 4 + 3] * position[axis];
+            }
+
+            clipped = w <= 0.0f || z < 0.0f;
+        }
+
+        if (clipped)
+        {
+            pquery->write(m_currentFrame, i, true);
+            continue;
+        }
+
+        float bounds[8] = { box.min.x, box.min.y, box.min.z, 1.0f, box.max.x, box.max.y, box.max.z, 1.0f };
+        std::copy(bounds, bounds + 8, constants + 16);
+
+        pquery->write(m_currentFrame, i);
+        vkCmdPushConstants(commandBuffer, pshader->layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), constants);
+        vkCmdBeginQuery(commandBuffer, pquery->pool(m_currentFrame), i, 0);
+        vkCmdDraw(commandBuffer, 36, 1, 0, 0);
+        vkCmdEndQuery(commandBuffer, pquery->pool(m_currentFrame), i);
+    }
+
+    if (m_shader) bindShader(commandBuffer, m_shader);
+}
+
+void VulkanRenderer::set(std::shared_ptr<VulkanUniformBuffer> const& buffer, void const * pdata)
+{
+    if (record(Command::UNIFORM, buffer, Bytes { pdata, static_cast<uint32_t>(buffer->size()) })) return;
+
+    if (m_capture) m_capture->set(buffer.get(), pdata);
+    buffer->store(pdata);
+}
+
+void VulkanRenderer::finish()
+{
+    if (m_thread) m_thread->finish();
+}
+
+VulkanCapture * VulkanRenderer::captured()
+{
+    if (!m_capture) return nullptr;
+
+    if (m_target)
+    {
+        m_capture->skip();
+        return nullptr;
+    }
+
+    return m_capture.get();
+}
+
+void VulkanRenderer::capture(std::string const& path, uint32_t const& frames)
+{
+    if (record(Command::CAPTURE, Bytes { path.data(), static_cast<uint32_t>(path.size()) }, frames)) return;
+
+    if (m_frameStarted || m_inRenderPass)
+        throw Adore::AdoreException("Captures have to start between frames.");
+
+    // A capture still running is closed first, so its file stays whole.
+    m_capture.reset();
+    if (frames) m_capture = std::make_unique<VulkanCapture>(this, path, frames);
+}
+
+// Values and objects are read back in the order record() wrote them, each from its own list.
+void VulkanRenderer::replay(CommandStream& stream)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    while (!stream.done())
+    {
+        // Each command shares the pool, queues and descriptor sets with the recording thread,
+        // which creates and destroys resources in between them.
+        std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+
+        switch (stream.read<Command>())
+        {
+            case Command::BEGIN:
+            {
+                auto shader = stream.object<Adore::Shader>();
+                begin(shader);
+                break;
+            }
+            case Command::BEGIN_TARGET:
+            {
+                auto target = stream.object<Adore::RenderTarget>();
+                auto shader = stream.object<Adore::Shader>();
+                begin(target, shader);
+                break;
+            }
+            case Command::END:
+                end();
+                break;
+            case Command::BIND_VERTEX_BUFFER:
+            {
+                auto buffer = stream.object<Adore::VertexBuffer>();
+                bind(buffer, stream.read<uint32_t>());
+                break;
+            }
+            case Command::BIND_INDEX_BUFFER:
+            {
+                auto buffer = stream.object<Adore::IndexBuffer>();
+                bind(buffer);
+                break;
+            }
+            case Command::BIND_VERTEX:
+            {
+                auto buffer = stream.read<Adore::VertexBufferHandle>();
+                bind(buffer, stream.read<uint32_t>());
+                break;
+            }
+            case Command::BIND_INDEX:
+                bind(stream.read<Adore::IndexBufferHandle>());
+                break;
+            case Command::DRAW:
+                draw(stream.read<uint32_t>());
+                break;
+            case Command::DRAW_INDEXED:
+                drawIndexed(stream.read<uint32_t>());
+                break;
+            case Command::PUSH:
+            {
+                Bytes data = decode(stream);
+                push(data.data, data.size, stream.read<uint32_t>());
+                break;
+            }
+            case Command::DRAW_MESH:
+            {
+                auto mesh = stream.object<Adore::Mesh>();
+                draw(mesh, stream.read<uint32_t>());
+                break;
+            }
+            case Command::DRAW_LIST:
+            {
+                auto list = stream.object<Adore::DrawList>();
+                draw(list);
+                break;
+            }
+            case Command::DRAW_QUEUE:
+            {
+                Bytes data = decode(stream);
+                uint32_t held = stream.read<uint32_t>();
+                // Only held until the stream is cleared after the frame.
+                for (uint32_t i = 0; i < held; i++)
+                    stream.object<void>();
+
+                m_replayedPackets.resize(data.size / sizeof(Adore::DrawPacket));
+                if (data.size) std::memcpy(m_replayedPackets.data(), data.data, data.size);
+
+                if (m_capture) m_capture->skip();
+                if (m_shader) drawPackets(m_replayedPackets);
+                break;
+            }
+            case Command::EXECUTE:
+            {
+                auto bundle = stream.object<Adore::Bundle>();
+                execute(bundle);
+                break;
+            }
+            case Command::BEGIN_QUERY:
+            {
+                auto query = stream.object<Adore::OcclusionQuery>();
+                beginQuery(query, stream.read<uint32_t>());
+                break;
+            }
+            case Command::END_QUERY:
+            {
+                auto query = stream.object<Adore::OcclusionQuery>();
+                endQuery(query, stream.read<uint32_t>());
+                break;
+            }
+            case Command::QUERY:
+            {
+                auto query = stream.object<Adore::OcclusionQuery>();
+                Bytes data = decode(stream);
+                std::vector<Adore::BoundingBox> boxes(data.size / sizeof(Adore::BoundingBox));
+                std::memcpy(boxes.data(), data.data, data.size);
+                float viewProjection[16];
+                std::memcpy(viewProjection, decode(stream).data, sizeof(viewProjection));
+                this->query(query, boxes, viewProjection);
+                break;
+            }
+            case Command::DISPATCH:
+            {
+                auto shader = stream.object<Adore::Shader>();
+                uint32_t x = stream.read<uint32_t>(), y = stream.read<uint32_t>(), z = stream.read<uint32_t>();
+                dispatch(shader, x, y, z);
+                break;
+            }
+            case Command::DISPATCH_INDIRECT:
+            {
+                auto shader = stream.object<Adore::Shader>();
+                auto buffer = stream.object<Adore::StorageBuffer>();
+                dispatchIndirect(shader, buffer, stream.read<uint64_t>());
+                break;
+            }
+            case Command::DISPATCH_ASYNC:
+            {
+                auto shader = stream.object<Adore::Shader>();
+                uint32_t x = stream.read<uint32_t>(), y = stream.read<uint32_t>(), z = stream.read<uint32_t>();
+                dispatchAsync(shader, x, y, z);
+                break;
+            }
+            case Command::CULL:
+            {
+                auto list = stream.object<Adore::DrawList>();
+                float viewProjection[16];
+                std::memcpy(viewProjection, decode(stream).data, sizeof(viewProjection));
+                cull(list, viewProjection);
+                break;
+            }
+            case Command::OCCLUSION_CULLING:
+                occlusionCulling(stream.read<bool>());
+                break;
+            case Command::PENDING_SHADERS:
+            {
+                auto mode = stream.read<Adore::PendingShaders>();
+                pendingShaders(mode, stream.object<Adore::Shader>());
+                break;
+            }
+            case Command::UNIFORM:
+            {
+                auto buffer = stream.object<VulkanUniformBuffer>();
+                set(buffer, decode(stream).data);
+                break;
+            }
+            case Command::BEGIN_HANDLE:
+                begin(stream.read<Adore::ShaderHandle>());
+                break;
+            case Command::BEGIN_TARGET_HANDLE:
+            {
+                auto target = stream.object<Adore::RenderTarget>();
+                begin(target, stream.read<Adore::ShaderHandle>());
+                break;
+            }
+            case Command::DRAW_LIST_HANDLE:
+                draw(stream.read<Adore::DrawListHandle>());
+                break;
+            case Command::DISPATCH_HANDLE:
+            {
+                auto shader = stream.read<Adore::ShaderHandle>();
+                uint32_t x = stream.read<uint32_t>(), y = stream.read<uint32_t>(), z = stream.read<uint32_t>();
+                dispatch(shader, x, y, z);
+                break;
+            }
+            case Command::CULL_HANDLE:
+            {
+                auto list = stream.read<Adore::DrawListHandle>();
+                float viewProjection[16];
+                std::memcpy(viewProjection, decode(stream).data, sizeof(viewProjection));
+                cull(list, viewProjection);
+                break;
+            }
+            case Command::CAPTURE:
+            {
+                Bytes path = decode(stream);
+                capture(std::string(static_cast<char const *>(path.data), path.size), stream.read<uint32_t>());
+                break;
+            }
+        }
+    }
+}
@@ -4,39 +4,24 @@
 #include <Adore/Internal/FramesInFlight.hpp>
 #include <Adore/Internal/Vulkan/Buffer.hpp>
 
-#include <fstream>
-
-std::vector<uint32_t> read(std::string const& path)
-{
-    std::ifstream file(path, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) throw Adore::AdoreException("Failed to open shader file: " + path);
-    std::vector<uint32_t> buffer(file.tellg());
-
-    file.seekg(0, std::ios::beg);
-    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
-    return buffer;
-}
-
-VkShaderModule shader(VkDevice const& device, std::vector<uint32_t> const& code)
-{
-    VkShaderModuleCreateInfo moduleCreateInfo;
-    moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    moduleCreateInfo.codeSize = code.size();
-    moduleCreateInfo.pCode = code.data();
-
-    VkShaderModule module;
-    if (vkCreateShaderModule(device, &moduleCreateInfo, nullptr, &module) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to create shader module.");
-
-    return module;
-}
-
 VkShaderStageFlagBits stage(Adore::ShaderType const& type)
 {
     switch (type)
     {
         case Adore::ShaderType::VERTEX: return VK_SHADER_STAGE_VERTEX_BIT;
         case Adore::ShaderType::FRAGMENT: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case Adore::ShaderType::COMPUTE: return VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+}
+
+VkDescriptorType descriptorType(Adore::ResourceType const& type)
+{
+    switch (type)
+    {
+        case Adore::ResourceType::BUFFER: return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case Adore::ResourceType::SAMPLER: return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        case Adore::ResourceType::STORAGE_BUFFER: return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case Adore::ResourceType::STORAGE_IMAGE: return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
     }
 }
 
@@ -60,26 +45,202 @@ VkFormat format(Adore::AttributeFormat const& type)
         case Adore::AttributeFormat::VEC2_DOUBLE: return VK_FORMAT_R64G64_SFLOAT;
         case Adore::AttributeFormat::VEC3_DOUBLE: return VK_FORMAT_R64G64B64_SFLOAT;
         case Adore::AttributeFormat::VEC4_DOUBLE: return VK_FORMAT_R64G64B64A64_SFLOAT;
+        case Adore::AttributeFormat::HALF:        return VK_FORMAT_R16_SFLOAT;
+        case Adore::AttributeFormat::VEC2_HALF:   return VK_FORMAT_R16G16_SFLOAT;
+        case Adore::AttributeFormat::VEC4_HALF:   return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case Adore::AttributeFormat::VEC2_SNORM8: return VK_FORMAT_R8G8_SNORM;
+        case Adore::AttributeFormat::VEC4_SNORM8: return VK_FORMAT_R8G8B8A8_SNORM;
+        case Adore::AttributeFormat::VEC2_UNORM8: return VK_FORMAT_R8G8_UNORM;
+        case Adore::AttributeFormat::VEC4_UNORM8: return VK_FORMAT_R8G8B8A8_UNORM;
+        case Adore::AttributeFormat::VEC2_SNORM16: return VK_FORMAT_R16G16_SNORM;
+        case Adore::AttributeFormat::VEC4_SNORM16: return VK_FORMAT_R16G16B16A16_SNORM;
+        case Adore::AttributeFormat::VEC2_UNORM16: return VK_FORMAT_R16G16_UNORM;
+        case Adore::AttributeFormat::VEC4_UNORM16: return VK_FORMAT_R16G16B16A16_UNORM;
+        case Adore::AttributeFormat::A2B10G10R10_SNORM: return VK_FORMAT_A2B10G10R10_SNORM_PACK32;
+        case Adore::AttributeFormat::A2B10G10R10_UNORM: return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+    }
+}
+
+PipelineState pipelineState(Adore::ShaderVariant const& variant)
+{
+    PipelineState state {};
+    state.depthTest = variant.depthTest;
+    state.depthWrite = variant.depthWrite;
+    state.blend = variant.blend;
+    state.specialization = variant.specialization;
+    state.polygonMode = variant.wireframe ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;
+    state.lineWidth = variant.lineWidth;
+
+    switch (variant.cull)
+    {
+        case Adore::CullMode::NONE:  state.cullMode = VK_CULL_MODE_NONE; break;
+        case Adore::CullMode::BACK:  state.cullMode = VK_CULL_MODE_BACK_BIT; break;
+        case Adore::CullMode::FRONT: state.cullMode = VK_CULL_MODE_FRONT_BIT; break;
+    }
+
+    switch (variant.topology)
+    {
+        case Adore::Topology::TRIANGLE_LIST:  state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; break;
+        case Adore::Topology::TRIANGLE_STRIP: state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP; break;
+        case Adore::Topology::LINE_LIST:      state.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST; break;
+        case Adore::Topology::LINE_STRIP:     state.topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP; break;
+        case Adore::Topology::POINT_LIST:     state.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST; break;
+    }
+
+    return state;
+}
+
+Adore::ShaderVariant shaderVariant(PipelineState const& state)
+{
+    Adore::ShaderVariant variant {};
+    variant.depthTest = state.depthTest;
+    variant.depthWrite = state.depthWrite;
+    variant.blend = state.blend;
+    variant.specialization = state.specialization;
+    variant.wireframe = state.polygonMode == VK_POLYGON_MODE_LINE;
+    variant.lineWidth = state.lineWidth;
+
+    switch (state.cullMode)
+    {
+        case VK_CULL_MODE_NONE:      variant.cull = Adore::CullMode::NONE; break;
+        case VK_CULL_MODE_FRONT_BIT: variant.cull = Adore::CullMode::FRONT; break;
+        default:                     variant.cull = Adore::CullMode::BACK; break;
+    }
+
+    switch (state.topology)
+    {
+        case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP: variant.topology = Adore::Topology::TRIANGLE_STRIP; break;
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:      variant.topology = Adore::Topology::LINE_LIST; break;
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:     variant.topology = Adore::Topology::LINE_STRIP; break;
+        case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:     variant.topology = Adore::Topology::POINT_LIST; break;
+        default:                                   variant.topology = Adore::Topology::TRIANGLE_LIST; break;
+    }
+
+    return variant;
+}
+
+VkColorComponentFlags colorWriteMask(bool const& colorWrite)
+{
+    return colorWrite ? VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT
+                        | VK_COLOR_COMPONENT_A_BIT : 0;
+}
+
+void blendFactors(Adore::BlendMode const& mode, VkPipelineColorBlendAttachmentState& blend)
+{
+    blend.blendEnable = mode != Adore::BlendMode::NONE ? VK_TRUE : VK_FALSE;
+    blend.colorBlendOp = VK_BLEND_OP_ADD;
+    blend.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    switch (mode)
+    {
+        case Adore::BlendMode::NONE:
+            blend.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+            blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+            break;
+        case Adore::BlendMode::ALPHA:
+            blend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            break;
+        case Adore::BlendMode::ADDITIVE:
+            blend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            break;
+        case Adore::BlendMode::PREMULTIPLIED:
+            blend.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            break;
     }
 }
 
 VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
                 std::vector<Adore::ShaderModule> const& modules,
-                Adore::LayoutDescriptor const& descriptor)
-    : Adore::Shader(win, descriptor)
+                Adore::LayoutDescriptor const& descriptor,
+                VkRenderPass const& renderPass, bool const& depth,
+                PipelineState const& state, bool const& async)
+    : Adore::Shader(win, descriptor), m_sources(modules), m_state(state)
 {
     VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
 
-    std::vector<VkDescriptorSetLayoutBinding> uniformDescriptions(m_descriptor.resources.size());
+    // The window pass always has a depth attachment and may be multisampled, render targets
+    // are single sampled with optional depth.
+    m_windowPass = (renderPass == VK_NULL_HANDLE);
+    m_renderPass = m_windowPass ? pwindow->renderpass() : renderPass;
+    m_useDepth = m_windowPass || depth;
+
+    bool compute = std::any_of(modules.begin(), modules.end(),
+                               [](auto const& module) { return module.type == Adore::ShaderType::COMPUTE; });
 
-    for (unsigned int i = 0; i < m_descriptor.resources.size(); i++)
+    if (compute && modules.size() != 1)
+        throw Adore::AdoreException("A compute shader can not be combined with other modules.");
+
+    m_bindPoint = compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    // Only 32 bit formats are guaranteed, doubles and most packed formats are optional.
+    for (auto const& attribute : descriptor.attributes)
     {
-        uniformDescriptions[i].binding = m_descriptor.resources[i].binding;
-        uniformDescriptions[i].descriptorType = (m_descriptor.resources[i].type == Adore::ResourceType::BUFFER)
-                            ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        uniformDescriptions[i].descriptorCount = m_descriptor.resources[i].count;
-        uniformDescriptions[i].stageFlags = stage(m_descriptor.resources[i].stage);
-        uniformDescriptions[i].pImmutableSamplers = nullptr;
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(pwindow->physicalDevice(), format(attribute.format), &properties);
+
+        if (!(properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT))
+            throw Adore::AdoreException("The device can not fetch the format of the vertex attribute at location "
+                                        + std::to_string(attribute.location) + ".");
+    }
+
+    createLayout();
+    build(nullptr, async);
+
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    m_handle = pwindow->shaders().insert(this);
+}
+
+VulkanShader::VulkanShader(VulkanShader& base, PipelineState const& state, bool const& async)
+    : Adore::Shader(base.m_win, base.m_descriptor), m_renderPass(base.m_renderPass), m_bindPoint(base.m_bindPoint),
+      m_sources(base.m_sources), m_state(state), m_windowPass(base.m_windowPass), m_useDepth(base.m_useDepth)
+{
+    createLayout();
+    build(&base, async);
+
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    m_handle = pwindow->shaders().insert(this);
+}
+
+void VulkanShader::createLayout()
+{
+    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    // A resource listed for several stages shares one binding.
+    std::vector<VkDescriptorSetLayoutBinding> uniformDescriptions;
+
+    for (auto const& resource : m_descriptor.resources)
+    {
+        auto it = std::find_if(uniformDescriptions.begin(), uniformDescriptions.end(),
+                               [&resource](auto const& binding) { return binding.binding == resource.binding; });
+
+        if (it != uniformDescriptions.end())
+        {
+            if (it->descriptorType != descriptorType(resource.type) || it->descriptorCount != resource.count)
+                throw Adore::AdoreException("Binding " + std::to_string(resource.binding) + " is declared twice.");
+
+            it->stageFlags |= stage(resource.stage);
+            continue;
+        }
+
+        VkDescriptorSetLayoutBinding binding {};
+        binding.binding = resource.binding;
+        binding.descriptorType = descriptorType(resource.type);
+        binding.descriptorCount = resource.count;
+        binding.stageFlags = stage(resource.stage);
+        binding.pImmutableSamplers = nullptr;
+        uniformDescriptions.push_back(binding);
     }
 
     VkDescriptorSetLayoutCreateInfo layoutInfo {};
@@ -90,38 +251,39 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
     if (vkCreateDescriptorSetLayout(pwindow->device(), &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to create Vulkan descriptor set layout.");
 
-    std::vector<VkDescriptorPoolSize> poolSizes(m_descriptor.resources.size());
-
-    for (unsigned int i = 0; i < m_descriptor.resources.size(); i++)
+    // A pool needs at least one descriptor, shaders without resources get no sets.
+    if (!uniformDescriptions.empty())
     {
-        poolSizes[i].descriptorCount = FRAMES_IN_FLIGHT;
-        if (m_descriptor.resources[i].type == Adore::ResourceType::BUFFER)
-            poolSizes[i].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        else
-            poolSizes[i].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    }
+        std::vector<VkDescriptorPoolSize> poolSizes(uniformDescriptions.size());
+
+        for (unsigned int i = 0; i < uniformDescriptions.size(); i++)
+        {
+            poolSizes[i].descriptorCount = FRAMES_IN_FLIGHT * uniformDescriptions[i].descriptorCount;
+            poolSizes[i].type = uniformDescriptions[i].descriptorType;
+        }
 
-    VkDescriptorPoolCreateInfo poolInfo {};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = poolSizes.size();
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = FRAMES_IN_FLIGHT;
+        VkDescriptorPoolCreateInfo poolInfo {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = poolSizes.size();
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = FRAMES_IN_FLIGHT;
 
-    if (vkCreateDescriptorPool(pwindow->device(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to create Vulkan descriptor pool.");
+        if (vkCreateDescriptorPool(pwindow->device(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan descriptor pool.");
 
-    std::vector<VkDescriptorSetLayout> layouts(FRAMES_IN_FLIGHT, m_descriptorSetLayout);
+        std::vector<VkDescriptorSetLayout> layouts(FRAMES_IN_FLIGHT, m_descriptorSetLayout);
 
-    VkDescriptorSetAllocateInfo allocInfo {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = m_descriptorPool;
-    allocInfo.descriptorSetCount = FRAMES_IN_FLIGHT;
-    allocInfo.pSetLayouts = layouts.data();
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_descriptorPool;
+        allocInfo.descriptorSetCount = FRAMES_IN_FLIGHT;
+        allocInfo.pSetLayouts = layouts.data();
 
-    m_descriptorSets.resize(FRAMES_IN_FLIGHT);
+        m_descriptorSets.resize(FRAMES_IN_FLIGHT);
 
-    if (vkAllocateDescriptorSets(pwindow->device(), &allocInfo, m_descriptorSets.data()) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to allocate Vulkan descriptor sets.");
+        if (vkAllocateDescriptorSets(pwindow->device(), &allocInfo, m_descriptorSets.data()) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to allocate Vulkan descriptor sets.");
+    }
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -129,26 +291,164 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
     pipelineLayoutInfo.flags = 0;
     pipelineLayoutInfo.setLayoutCount = 1;
     pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    uint32_t pushConstants = std::max(m_state.pushConstants, m_descriptor.pushConstants);
+    VkPushConstantRange pushConstantRange { VK_SHADER_STAGE_ALL, 0, pushConstants };
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstants ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = pushConstants ? &pushConstantRange : nullptr;
 
     if (vkCreatePipelineLayout(pwindow->device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to create pipeline layout.");
+}
+
+// Whether two shaders made from the same modules can draw with the same pipeline, with the
+// difference set while recording.
+bool compatible(PipelineState const& a, PipelineState const& b, VulkanWindow * pwindow)
+{
+    auto topologyClass = [](VkPrimitiveTopology const& topology)
+    {
+        switch (topology)
+        {
+            case VK_PRIMITIVE_TOPOLOGY_POINT_LIST: return 0;
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP: return 1;
+            default: return 2;
+        }
+    };
+
+    bool dynamic = pwindow->dynamicState();
+    bool dynamic3 = pwindow->dynamicState3();
+
+    return a.pushConstants == b.pushConstants
+        && a.specialization.size() == b.specialization.size()
+        && std::equal(a.specialization.begin(), a.specialization.end(), b.specialization.begin(),
+                      [](auto const& x, auto const& y) { return x.id == y.id && x.value == y.value; })
+        && (dynamic ? topologyClass(a.topology) == topologyClass(b.topology) : a.topology == b.topology)
+        && (dynamic || (a.cullMode == b.cullMode && a.depthTest == b.depthTest && a.depthWrite == b.depthWrite
+                        && a.lineWidth == b.lineWidth))
+        && (dynamic3 || (a.blend == b.blend && a.colorWrite == b.colorWrite && a.polygonMode == b.polygonMode));
+}
+
+void VulkanShader::build(VulkanShader * base, bool const& async)
+{
+    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    if ((m_state.polygonMode != VK_POLYGON_MODE_FILL && !pwindow->features().fillModeNonSolid)
+        || (m_state.lineWidth != 1.0f && !pwindow->features().wideLines))
+        throw Adore::AdoreException("Wireframe and wide lines are not supported by the device.");
+
+    if (base && compatible(base->m_state, m_state, pwindow))
+    {
+        m_pipeline = base->m_pipeline;
+        return;
+    }
+
+    m_pipeline = std::make_shared<VulkanPipeline>();
+    m_pipeline->device = pwindow->device();
+
+    if (!async)
+    {
+        createPipeline();
+        m_pipeline->ready = true;
+        return;
+    }
+
+    // The layout and render pass are already made, the job only reads them.
+    m_pipeline->compiled = pwindow->workers().submit([this]
+    {
+        try
+        {
+            createPipeline();
+            m_pipeline->ready = true;
+        }
+        catch (Adore::AdoreException const& e)
+        {
+            ADORE_INTERNAL_LOG(ERROR, std::string("Asynchronous shader compilation failed: ") + e.what());
+            throw;
+        }
+    });
+}
+
+void VulkanShader::createPipeline()
+{
+    VulkanWindow* pwindow = static_cast<VulkanWindow*>(m_win.get());
+    auto const& modules = m_sources;
+    auto const& state = m_state;
+    auto& modulesUsed = m_pipeline->modules;
+
+    // Every stage gets the same constants, ids a stage does not declare are ignored.
+    std::vector<VkSpecializationMapEntry> specializationEntries(state.specialization.size());
+    std::vector<uint32_t> specializationData(state.specialization.size());
+
+    for (unsigned int i = 0; i < state.specialization.size(); i++)
+    {
+        specializationEntries[i] = { state.specialization[i].id, static_cast<uint32_t>(i * sizeof(uint32_t)),
+                                     sizeof(uint32_t) };
+        specializationData[i] = state.specialization[i].value;
+    }
+
+    VkSpecializationInfo specializationInfo {};
+    specializationInfo.mapEntryCount = specializationEntries.size();
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+    specializationInfo.pData = specializationData.data();
+
+    VkSpecializationInfo const * pspecialization = state.specialization.empty() ? nullptr : &specializationInfo;
+
+    if (m_bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE)
+    {
+        modulesUsed = { pwindow->modules().get(modules[0]) };
+
+        VkComputePipelineCreateInfo pipelineInfo {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = modulesUsed[0]->module;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.stage.pSpecializationInfo = pspecialization;
+        pipelineInfo.layout = m_pipelineLayout;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineInfo.basePipelineIndex = -1;
+
+        VkResult result = vkCreateComputePipelines(pwindow->device(), pwindow->pipelineCache(), 1, &pipelineInfo,
+                                                   nullptr, &m_pipeline->pipeline);
+
+        if (result != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan compute pipeline.");
+
+        ADORE_INTERNAL_LOG(INFO, "Compute shader created:\n" + modules[0].path);
+        return;
+    }
 
     std::vector<VkPipelineShaderStageCreateInfo> shaderInfos(modules.size());
 
     for (unsigned int i = 0; i < modules.size(); i++)
     {
-        VkPipelineShaderStageCreateInfo pipelineInfo;
+        modulesUsed.push_back(pwindow->modules().get(modules[i]));
+
+        VkPipelineShaderStageCreateInfo pipelineInfo {};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         pipelineInfo.stage = stage(modules[i].type);
-        pipelineInfo.module = shader(pwindow->device(), read(modules[i].path));
+        pipelineInfo.module = modulesUsed.back()->module;
         pipelineInfo.pName = "main";
+        pipelineInfo.pSpecializationInfo = pspecialization;
         shaderInfos[i] = pipelineInfo;
     }
 
     std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 
+    // Recorded by recordState(), what is baked below is then only the initial value.
+    if (pwindow->dynamicState())
+        dynamicStates.insert(dynamicStates.end(), { VK_DYNAMIC_STATE_CULL_MODE, VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+                                                    VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+                                                    VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+                                                    VK_DYNAMIC_STATE_LINE_WIDTH });
+
+    if (pwindow->dynamicState3())
+        dynamicStates.insert(dynamicStates.end(), { VK_DYNAMIC_STATE_POLYGON_MODE_EXT,
+                                                    VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT,
+                                                    VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT,
+                                                    VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT });
+
     VkPipelineDynamicStateCreateInfo dynamicStateInfo {};
     dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamicStateInfo.dynamicStateCount = dynamicStates.size();
@@ -181,7 +481,7 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
 
     VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo {};
     inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssemblyInfo.topology = state.topology;
     inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
 
     VkViewport viewport;
@@ -207,9 +507,9 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
     rasterizerInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizerInfo.depthClampEnable = VK_FALSE;
     rasterizerInfo.rasterizerDiscardEnable = VK_FALSE;
-    rasterizerInfo.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizerInfo.lineWidth = 1.0f;
-    rasterizerInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizerInfo.polygonMode = state.polygonMode;
+    rasterizerInfo.lineWidth = state.lineWidth;
+    rasterizerInfo.cullMode = state.cullMode;
     rasterizerInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
     rasterizerInfo.depthBiasEnable = VK_FALSE;
     rasterizerInfo.depthBiasConstantFactor = 0.0f;
@@ -219,21 +519,15 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
     VkPipelineMultisampleStateCreateInfo multisampleInfo {};
     multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampleInfo.sampleShadingEnable = VK_FALSE;
-    multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampleInfo.rasterizationSamples = m_windowPass ? pwindow->samples() : VK_SAMPLE_COUNT_1_BIT;
     multisampleInfo.minSampleShading = 1.0f;
     multisampleInfo.pSampleMask = nullptr;
     multisampleInfo.alphaToCoverageEnable = VK_FALSE;
     multisampleInfo.alphaToOneEnable = VK_FALSE;
 
     VkPipelineColorBlendAttachmentState blendAttachmentInfo {};
-    blendAttachmentInfo.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    blendAttachmentInfo.blendEnable = VK_FALSE;
-    blendAttachmentInfo.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-    blendAttachmentInfo.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-    blendAttachmentInfo.colorBlendOp = VK_BLEND_OP_ADD;
-    blendAttachmentInfo.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    blendAttachmentInfo.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    blendAttachmentInfo.alphaBlendOp = VK_BLEND_OP_ADD;
+    blendAttachmentInfo.colorWriteMask = colorWriteMask(state.colorWrite);
+    blendFactors(state.blend, blendAttachmentInfo);
 
     VkPipelineColorBlendStateCreateInfo colorBlendingInfo {};
     colorBlendingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -242,16 +536,16 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
     colorBlendingInfo.attachmentCount = 1;
     colorBlendingInfo.pAttachments = &blendAttachmentInfo;
 
-    VkAttachmentDescription colorAttachment {};
-    colorAttachment.format = pwindow->format().format;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    
+    VkPipelineDepthStencilStateCreateInfo depthStencilInfo {};
+    depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencilInfo.depthTestEnable = state.depthTest ? VK_TRUE : VK_FALSE;
+    depthStencilInfo.depthWriteEnable = state.depthWrite ? VK_TRUE : VK_FALSE;
+    depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
+    depthStencilInfo.stencilTestEnable = VK_FALSE;
+    depthStencilInfo.minDepthBounds = 0.0f;
+    depthStencilInfo.maxDepthBounds = 1.0f;
+
     VkGraphicsPipelineCreateInfo pipelineInfo {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = shaderInfos.size();
@@ -265,19 +559,26 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
     pipelineInfo.pDynamicState = &dynamicStateInfo;
 
     pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = pwindow->renderpass();
+    pipelineInfo.renderPass = m_renderPass;
     pipelineInfo.subpass = 0;
-    pipelineInfo.pDepthStencilState = nullptr;
+
+    // Dynamic rendering only needs the formats of the window's attachments.
+    VkPipelineRenderingCreateInfo renderingInfo {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &pwindow->format().format;
+    renderingInfo.depthAttachmentFormat = pwindow->depthFormat();
+
+    if (m_windowPass && pwindow->dynamicRendering())
+        pipelineInfo.pNext = &renderingInfo;
+    pipelineInfo.pDepthStencilState = m_useDepth ? &depthStencilInfo : nullptr;
 
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
     
-    if (vkCreateGraphicsPipelines(pwindow->device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS)
+    if (vkCreateGraphicsPipelines(pwindow->device(), pwindow->pipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline->pipeline) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to create Vulkan graphics pipeline.");
 
-    for (auto& info : shaderInfos)
-        vkDestroyShaderModule(pwindow->device(), info.module, nullptr);
-
     std::vector<const char*> shader_paths;
 
     std::transform(modules.begin(), modules.end(), std::back_inserter(shader_paths),
@@ -289,16 +590,66 @@ VulkanShader::VulkanShader(std::shared_ptr<Adore::Window>& win,
 VulkanShader::~VulkanShader()
 {
     VulkanWindow * window = static_cast<VulkanWindow*>(m_win.get());
+    // The compile job reads the layout.
+    if (m_pipeline && m_pipeline->compiled.valid()) m_pipeline->compiled.wait();
+    std::lock_guard<std::recursive_mutex> lock(window->mutex());
+    window->shaders().remove(m_handle);
     vkQueueWaitIdle(window->queues().graphics);
-    vkDestroyPipeline(window->device(), m_pipeline, nullptr);
+    m_pipeline.reset();
     vkDestroyPipelineLayout(window->device(), m_pipelineLayout, nullptr);
     vkDestroyDescriptorPool(window->device(), m_descriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(window->device(), m_descriptorSetLayout, nullptr);
 }
 
+std::shared_ptr<Adore::Shader> VulkanShader::derive(Adore::ShaderVariant const& variant, bool const& async)
+{
+    PipelineState state = pipelineState(variant);
+    state.pushConstants = m_state.pushConstants;
+    state.colorWrite = m_state.colorWrite;
+
+    return std::make_shared<VulkanShader>(*this, state, async);
+}
+
+void VulkanShader::recordState(VkCommandBuffer const& commandBuffer) const
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    if (m_bindPoint != VK_PIPELINE_BIND_POINT_GRAPHICS || !pwindow->dynamicState()) return;
+
+    vkCmdSetCullMode(commandBuffer, m_state.cullMode);
+    vkCmdSetPrimitiveTopology(commandBuffer, m_state.topology);
+    vkCmdSetDepthTestEnable(commandBuffer, m_state.depthTest ? VK_TRUE : VK_FALSE);
+    vkCmdSetDepthWriteEnable(commandBuffer, m_state.depthWrite ? VK_TRUE : VK_FALSE);
+    vkCmdSetLineWidth(commandBuffer, m_state.lineWidth);
+
+    if (!pwindow->dynamicState3()) return;
+
+    auto const& commands = pwindow->dynamicState3Commands();
+
+    VkPipelineColorBlendAttachmentState blend {};
+    blendFactors(m_state.blend, blend);
+
+    VkColorBlendEquationEXT equation {};
+    equation.srcColorBlendFactor = blend.srcColorBlendFactor;
+    equation.dstColorBlendFactor = blend.dstColorBlendFactor;
+    equation.colorBlendOp = blend.colorBlendOp;
+    equation.srcAlphaBlendFactor = blend.srcAlphaBlendFactor;
+    equation.dstAlphaBlendFactor = blend.dstAlphaBlendFactor;
+    equation.alphaBlendOp = blend.alphaBlendOp;
+
+    VkColorComponentFlags writeMask = colorWriteMask(m_state.colorWrite);
+
+    commands.setPolygonMode(commandBuffer, m_state.polygonMode);
+    commands.setColorBlendEnable(commandBuffer, 0, 1, &blend.blendEnable);
+    commands.setColorBlendEquation(commandBuffer, 0, 1, &equation);
+    commands.setColorWriteMask(commandBuffer, 0, 1, &writeMask);
+}
+
 void VulkanShader::attach(std::shared_ptr<Adore::UniformBuffer>& buffer, uint32_t const& binding)
 {
     VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+    // Descriptor sets are read by a frame a render thread is replaying.
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
 
     auto descriptor_it = std::find_if
     (
@@ -348,6 +699,7 @@ void VulkanShader::attach(std::shared_ptr<Adore::UniformBuffer>& buffer, uint32_
 void VulkanShader::attach(std::shared_ptr<Adore::Sampler>& sampler, uint32_t const& binding)
 {
     VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
 
     auto descriptor_it = std::find_if
     (
@@ -370,10 +722,25 @@ void VulkanShader::attach(std::shared_ptr<Adore::Sampler>& sampler, uint32_t con
     
     m_samplers.push_back({binding, sampler});
 
+    auto pimage = dynamic_cast<VulkanImage*>(sampler.get());
+
+    auto views_it = std::find_if(m_views.begin(), m_views.end(),
+        [binding](auto const& view) { return view.binding == binding; });
+
+    if (views_it == m_views.end())
+        views_it = m_views.insert(m_views.end(), SampledView { binding, pimage, {} });
+
+    views_it->image = pimage;
+    for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+    {
+        views_it->written[i] = pimage->view();
+        m_setVersions[i]++;
+    }
+
     VkDescriptorImageInfo imageInfo {};
-    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    imageInfo.imageView = static_cast<VulkanSampler*>(sampler.get())->view();
-    imageInfo.sampler = static_cast<VulkanSampler*>(sampler.get())->sampler();
+    imageInfo.imageLayout = pimage->layout();
+    imageInfo.imageView = pimage->view();
+    imageInfo.sampler = pimage->sampler();
 
     std::vector<VkWriteDescriptorSet> writes(FRAMES_IN_FLIGHT);
 
@@ -390,4 +757,130 @@ void VulkanShader::attach(std::shared_ptr<Adore::Sampler>& sampler, uint32_t con
     }
 
     vkUpdateDescriptorSets(pwindow->device(), writes.size(), writes.data(), 0, nullptr);
-}
\ No newline at end of file
+}
+
+uint64_t VulkanShader::refresh(uint32_t const& frame, uint64_t const& started)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+
+    if (m_refreshed[frame] == started) return m_setVersions[frame];
+    m_refreshed[frame] = started;
+
+    for (auto& view : m_views)
+    {
+        if (view.written[frame] == view.image->view()) continue;
+
+        VkDescriptorImageInfo imageInfo {};
+        imageInfo.imageLayout = view.image->layout();
+        imageInfo.imageView = view.image->view();
+        imageInfo.sampler = view.image->sampler();
+
+        VkWriteDescriptorSet write {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_descriptorSets[frame];
+        write.dstBinding = view.binding;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(pwindow->device(), 1, &write, 0, nullptr);
+        view.written[frame] = view.image->view();
+        m_setVersions[frame]++;
+    }
+
+    return m_setVersions[frame];
+}
+
+void VulkanShader::attach(std::shared_ptr<Adore::StorageBuffer>& buffer, uint32_t const& binding)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+
+    auto descriptor_it = std::find_if
+    (
+                    m_descriptor.resources.begin(), m_descriptor.resources.end(),
+                    [binding](auto const& resource)
+                    {
+                        return resource.binding == binding
+                        && resource.type == Adore::ResourceType::STORAGE_BUFFER;
+                    }
+    );
+
+    if (descriptor_it == m_descriptor.resources.end())
+        throw Adore::AdoreException("No storage buffer with binding " + std::to_string(binding) + " found in shader.");
+
+    auto buffers_it = std::find_if(m_storageBuffers.begin(), m_storageBuffers.end(),
+        [binding](auto const& b) { return b.binding == binding; });
+
+    if (buffers_it != m_storageBuffers.end())
+        m_storageBuffers.erase(buffers_it);
+
+    m_storageBuffers.push_back({binding, buffer});
+
+    VkDescriptorBufferInfo bufferInfo {};
+    bufferInfo.buffer = static_cast<VulkanStorageBuffer*>(buffer.get())->buffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    std::vector<VkWriteDescriptorSet> writes(FRAMES_IN_FLIGHT);
+
+    for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = m_descriptorSets[i];
+        writes[i].dstBinding = binding;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfo;
+    }
+
+    vkUpdateDescriptorSets(pwindow->device(), writes.size(), writes.data(), 0, nullptr);
+}
+
+void VulkanShader::attach(std::shared_ptr<Adore::StorageImage>& image, uint32_t const& binding)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_win.get());
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+
+    auto descriptor_it = std::find_if
+    (
+                    m_descriptor.resources.begin(), m_descriptor.resources.end(),
+                    [binding](auto const& resource)
+                    {
+                        return resource.binding == binding
+                        && resource.type == Adore::ResourceType::STORAGE_IMAGE;
+                    }
+    );
+
+    if (descriptor_it == m_descriptor.resources.end())
+        throw Adore::AdoreException("No storage image with binding " + std::to_string(binding) + " found in shader.");
+
+    auto images_it = std::find_if(m_storageImages.begin(), m_storageImages.end(),
+        [binding](auto const& i) { return i.binding == binding; });
+
+    if (images_it != m_storageImages.end())
+        m_storageImages.erase(images_it);
+
+    m_storageImages.push_back({binding, image});
+
+    VkDescriptorImageInfo imageInfo {};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageInfo.imageView = static_cast<VulkanStorageImage*>(image.get())->view();
+    imageInfo.sampler = VK_NULL_HANDLE;
+
+    std::vector<VkWriteDescriptorSet> writes(FRAMES_IN_FLIGHT);
+
+    for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = m_descriptorSets[i];
+        writes[i].dstBinding = binding;
+        writes[i].dstArrayElement = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[i].pImageInfo = &imageInfo;
+    }
+
+    vkUpdateDescriptorSets(pwindow->device(), writes.size(), writes.data(), 0, nullptr);
+}
@@ -0,0 +1,7 @@
+#version 450
+
+// Occlusion queries only count samples, nothing is written.
+
+void main()
+{
+}
@@ -0,0 +1,27 @@
+#version 450
+
+// Draws the box between box.lower and box.upper as 12 triangles for an occlusion query.
+
+layout(push_constant) uniform Box
+{
+    mat4 viewProjection;
+    vec4 lower;
+    vec4 upper;
+} box;
+
+// Bit 0 of a corner picks x, bit 1 y and bit 2 z of the upper bound.
+const int CORNERS[36] = int[](
+    0, 2, 6, 0, 6, 4,
+    1, 3, 7, 1, 7, 5,
+    0, 1, 5, 0, 5, 4,
+    2, 3, 7, 2, 7, 6,
+    0, 1, 3, 0, 3, 2,
+    4, 5, 7, 4, 7, 6
+);
+
+void main()
+{
+    int corner = CORNERS[gl_VertexIndex];
+    vec3 position = mix(box.lower.xyz, box.upper.xyz, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+    gl_Position = box.viewProjection * vec4(position, 1.0);
+}
@@ -0,0 +1,436 @@
+#include <Adore/Internal/Vulkan/TextureStreamer.hpp>
+#include <Adore/Internal/Vulkan/Renderer.hpp>
+#include <Adore/Internal/Vulkan/RenderGraph.hpp>
+#include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Mips at most this many pixels across are always resident.
+static uint32_t const TAIL_SIZE = 64;
+// Bytes of uploads an update starts, past the first.
+static uint64_t const UPLOAD_LIMIT = 16ull << 20;
+
+VulkanStreamedTexture::VulkanStreamedTexture(std::shared_ptr<Adore::Renderer>& renderer,
+                                             std::shared_ptr<MipChain const> const& mips, VkFormat const& format,
+                                             Adore::Filter const& filter, Adore::Wrap const& wrap)
+    : Adore::StreamedTexture(renderer, mips->width, mips->height, mips->levels()),
+      m_mips(mips), m_format(format), m_requested(mips->levels())
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    m_tail = 0;
+    while (m_tail + 1 < m_levels && std::max(mips->mipWidth(m_tail), mips->mipHeight(m_tail)) > TAIL_SIZE)
+        m_tail++;
+
+    m_resident = m_target = m_wanted = m_tail;
+
+    m_image = VK_NULL_HANDLE;
+    m_memory = VK_NULL_HANDLE;
+    m_view = VK_NULL_HANDLE;
+    m_sampler = createSampler(pwindow->device(), pwindow->physicalDevice(), filter, wrap, VK_LOD_CLAMP_NONE);
+}
+
+VulkanStreamedTexture::~VulkanStreamedTexture()
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    vkDestroySampler(pwindow->device(), m_sampler, nullptr);
+    vkDestroyImageView(pwindow->device(), m_view, nullptr);
+    vkDestroyImage(pwindow->device(), m_image, nullptr);
+    pwindow->memory().free(m_memory);
+}
+
+void VulkanStreamedTexture::request(uint32_t const& mip)
+{
+    uint32_t current = m_requested.load(std::memory_order_relaxed);
+    while (mip < current && !m_requested.compare_exchange_weak(current, mip, std::memory_order_relaxed));
+}
+
+VulkanTextureStreamer::VulkanTextureStreamer(std::shared_ptr<Adore::Renderer>& renderer, uint64_t const& budget)
+    : Adore::TextureStreamer(renderer, budget)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    VkCommandPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = pwindow->queueIndices().graphics;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    if (vkCreateCommandPool(pwindow->device(), &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan command pool.");
+}
+
+VulkanTextureStreamer::~VulkanTextureStreamer()
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    // Workers still write to staging memory and frames in flight can still sample retired images.
+    for (auto& upload : m_uploads)
+        upload.staged.wait();
+    vkDeviceWaitIdle(pwindow->device());
+
+    for (auto const& upload : m_uploads)
+    {
+        destroy(upload);
+        destroy(upload.residency);
+    }
+    for (auto const& retired : m_retired)
+        destroy(retired.residency);
+
+    vkDestroyCommandPool(pwindow->device(), m_commandPool, nullptr);
+}
+
+std::shared_ptr<Adore::StreamedTexture> VulkanTextureStreamer::load(const char* path, Adore::Filter const& filter,
+                                                                    Adore::Wrap const& wrap)
+{
+    int width, height, channels;
+    stbi_uc * pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
+
+    if (!pixels) throw Adore::AdoreException("Failed to load image: " + std::string(path));
+
+    std::shared_ptr<Adore::StreamedTexture> texture;
+    try
+    {
+        texture = load(pixels, width, height, Adore::ImageFormat::RGBA8_SRGB, filter, wrap);
+    }
+    catch (...)
+    {
+        stbi_image_free(pixels);
+        throw;
+    }
+
+    stbi_image_free(pixels);
+    return texture;
+}
+
+std::shared_ptr<Adore::StreamedTexture> VulkanTextureStreamer::load(void const * pixels, uint32_t const& width,
+                                                                    uint32_t const& height,
+                                                                    Adore::ImageFormat const& format,
+                                                                    Adore::Filter const& filter, Adore::Wrap const& wrap)
+{
+    if (format != Adore::ImageFormat::RGBA8 && format != Adore::ImageFormat::RGBA8_SRGB)
+        throw Adore::AdoreException("Only RGBA8 and RGBA8_SRGB textures can be streamed.");
+
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+
+    auto mips = std::make_shared<MipChain const>(buildMipChain(pixels, width, height,
+                                                               format == Adore::ImageFormat::RGBA8_SRGB));
+    auto texture = std::make_shared<VulkanStreamedTexture>(m_renderer, mips, getVulkanFormat(format), filter, wrap);
+
+    // The tail is uploaded straight away so the texture can be attached as soon as it is returned.
+    Upload upload;
+    upload.first = texture->m_tail;
+    upload.residency = createResidency(*texture, upload.first);
+
+    createBuffer(pwindow->memory(), mips->bytes(upload.first), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 Adore::MemoryCategory::STAGING, upload.staging, upload.stagingMemory);
+
+    void * data;
+    vkMapMemory(pwindow->device(), upload.stagingMemory, 0, mips->bytes(upload.first), 0, &data);
+        memcpy(data, mips->pixels.data() + mips->offsets[upload.first], mips->bytes(upload.first));
+    vkUnmapMemory(pwindow->device(), upload.stagingMemory);
+
+    VkCommandBuffer commandBuffer = prenderer->beginCommandBuffer();
+    recordCopy(commandBuffer, upload, *mips);
+    prenderer->endCommandBuffer(commandBuffer);
+
+    destroy(upload);
+    swap(*texture, upload);
+
+    m_textures.push_back(texture);
+    return texture;
+}
+
+VulkanTextureStreamer::Residency VulkanTextureStreamer::createResidency(VulkanStreamedTexture const& texture,
+                                                                        uint32_t const& first)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    uint32_t levels = texture.m_levels - first;
+
+    Residency residency;
+    createImage(pwindow->memory(), texture.m_mips->mipWidth(first), texture.m_mips->mipHeight(first),
+                texture.m_format, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Adore::MemoryCategory::IMAGE,
+                residency.image, residency.memory, {}, levels);
+    residency.view = createImageView(pwindow->device(), residency.image, texture.m_format,
+                                     VK_IMAGE_ASPECT_COLOR_BIT, levels);
+    residency.bytes = texture.m_mips->bytes(first);
+    m_allocated += residency.bytes;
+
+    return residency;
+}
+
+void VulkanTextureStreamer::destroy(Residency const& residency)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    vkDestroyImageView(pwindow->device(), residency.view, nullptr);
+    vkDestroyImage(pwindow->device(), residency.image, nullptr);
+    pwindow->memory().free(residency.memory);
+    m_allocated -= residency.bytes;
+}
+
+// Everything but the residency, which either becomes the texture's or is destroyed with it.
+void VulkanTextureStreamer::destroy(Upload const& upload)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    vkDestroyFence(pwindow->device(), upload.fence, nullptr);
+    if (upload.commandBuffer != VK_NULL_HANDLE)
+        vkFreeCommandBuffers(pwindow->device(), m_commandPool, 1, &upload.commandBuffer);
+    vkDestroyBuffer(pwindow->device(), upload.staging, nullptr);
+    pwindow->memory().free(upload.stagingMemory);
+}
+
+void VulkanTextureStreamer::recordCopy(VkCommandBuffer const& commandBuffer, Upload const& upload,
+                                       MipChain const& mips)
+{
+    uint32_t levels = mips.levels() - upload.first;
+
+    RenderGraph::barrier(commandBuffer, upload.residency.image, VK_IMAGE_ASPECT_COLOR_BIT,
+                         RenderGraph::Access::NONE, RenderGraph::Access::TRANSFER_DST, levels);
+
+    std::vector<VkBufferImageCopy> regions(levels);
+    for (uint32_t i = 0; i < levels; i++)
+    {
+        uint32_t mip = upload.first + i;
+        regions[i].bufferOffset = mips.offsets[mip] - mips.offsets[upload.first];
+        regions[i].imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 };
+        regions[i].imageExtent = { mips.mipWidth(mip), mips.mipHeight(mip), 1 };
+    }
+
+    vkCmdCopyBufferToImage(commandBuffer, upload.staging, upload.residency.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levels, regions.data());
+
+    RenderGraph::barrier(commandBuffer, upload.residency.image, VK_IMAGE_ASPECT_COLOR_BIT,
+                         RenderGraph::Access::TRANSFER_DST, RenderGraph::Access::FRAGMENT_SAMPLED, levels);
+}
+
+// Shaders pick the new view up the next time they are bound, so the frame started last is the
+// last one that may bind the old.
+void VulkanTextureStreamer::swap(VulkanStreamedTexture& texture, Upload const& upload)
+{
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+
+    if (texture.m_image != VK_NULL_HANDLE)
+        m_retired.push_back({ { texture.m_image, texture.m_memory, texture.m_view,
+                                texture.m_mips->bytes(texture.m_resident) },
+                              prenderer->startedFrames() });
+
+    texture.m_image = upload.residency.image;
+    texture.m_memory = upload.residency.memory;
+    texture.m_view = upload.residency.view;
+    texture.m_resident = texture.m_target = upload.first;
+}
+
+void VulkanTextureStreamer::schedule(std::shared_ptr<VulkanStreamedTexture> const& texture, uint32_t const& first)
+{
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    std::shared_ptr<MipChain const> mips = texture->m_mips;
+    size_t size = mips->bytes(first);
+
+    Upload upload;
+    upload.texture = texture;
+    upload.first = first;
+    upload.residency = createResidency(*texture, first);
+
+    createBuffer(pwindow->memory(), size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 Adore::MemoryCategory::STAGING, upload.staging, upload.stagingMemory);
+
+    // Stays mapped until the staging memory is freed.
+    void * data;
+    vkMapMemory(pwindow->device(), upload.stagingMemory, 0, size, 0, &data);
+
+    upload.staged = pwindow->workers().submit([mips, first, size, data]()
+    {
+        memcpy(data, mips->pixels.data() + mips->offsets[first], size);
+    });
+
+    texture->m_target = first;
+    m_uploads.push_back(upload);
+}
+
+uint64_t VulkanTextureStreamer::evict(std::vector<std::shared_ptr<VulkanStreamedTexture>>& textures,
+                                      uint64_t const& bytes, uint64_t& uploaded)
+{
+    std::sort(textures.begin(), textures.end(), [](auto const& a, auto const& b)
+    {
+        return a->m_lastUsed < b->m_lastUsed;
+    });
+
+    uint64_t freed = 0;
+    for (auto const& texture : textures)
+    {
+        if (freed >= bytes) break;
+        if (texture->m_target != texture->m_resident) continue;
+
+        uint32_t first = texture->m_lastUsed < m_update ? texture->m_tail : texture->m_wanted;
+        if (first <= texture->m_target) continue;
+
+        // The smaller image is made before the larger one goes. Dropping to the tail is always
+        // allowed since it is the least that can get back under a lowered budget.
+        if (first != texture->m_tail && m_allocated + texture->m_mips->bytes(first) > m_budget) continue;
+
+        freed += texture->m_mips->bytes(texture->m_target) - texture->m_mips->bytes(first);
+        uploaded += texture->m_mips->bytes(first);
+        schedule(texture, first);
+    }
+
+    return freed;
+}
+
+void VulkanTextureStreamer::update()
+{
+    VulkanRenderer * prenderer = static_cast<VulkanRenderer*>(m_renderer.get());
+    VulkanWindow * pwindow = static_cast<VulkanWindow*>(m_renderer->window().get());
+    // Uploads share the graphics queue with a render thread.
+    std::lock_guard<std::recursive_mutex> lock(pwindow->mutex());
+    m_update++;
+
+    uint64_t finished = prenderer->finishedFrames();
+    auto retired_end = std::remove_if(m_retired.begin(), m_retired.end(), [&](Retired const& retired)
+    {
+        if (retired.frame > finished) return false;
+        destroy(retired.residency);
+        return true;
+    });
+    m_retired.erase(retired_end, m_retired.end());
+
+    auto uploads_end = std::remove_if(m_uploads.begin(), m_uploads.end(), [&](Upload& upload)
+    {
+        if (upload.commandBuffer == VK_NULL_HANDLE)
+        {
+            if (upload.staged.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+            upload.staged.get();
+
+            VkCommandBufferAllocateInfo allocInfo {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = m_commandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(pwindow->device(), &allocInfo, &upload.commandBuffer) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to allocate Vulkan command buffer.");
+
+            VkFenceCreateInfo fenceInfo {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            if (vkCreateFence(pwindow->device(), &fenceInfo, nullptr, &upload.fence) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to create Vulkan fence.");
+
+            VkCommandBufferBeginInfo beginInfo {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            // Expired textures still need the upload to finish before its image can be destroyed.
+            auto texture = upload.texture.lock();
+            MipChain const * mips = texture ? texture->m_mips.get() : nullptr;
+
+            vkBeginCommandBuffer(upload.commandBuffer, &beginInfo);
+            if (mips) recordCopy(upload.commandBuffer, upload, *mips);
+            vkEndCommandBuffer(upload.commandBuffer);
+
+            VkSubmitInfo submitInfo {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &upload.commandBuffer;
+
+            if (vkQueueSubmit(pwindow->queues().graphics, 1, &submitInfo, upload.fence) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to submit Vulkan texture upload.");
+
+            return false;
+        }
+
+        if (vkGetFenceStatus(pwindow->device(), upload.fence) != VK_SUCCESS) return false;
+
+        destroy(upload);
+        if (auto texture = upload.texture.lock())
+            swap(*texture, upload);
+        else
+            destroy(upload.residency);
+
+        return true;
+    });
+    m_uploads.erase(uploads_end, m_uploads.end());
+
+    std::vector<std::shared_ptr<VulkanStreamedTexture>> textures;
+    auto textures_end = std::remove_if(m_textures.begin(), m_textures.end(), [&](auto const& weak)
+    {
+        auto texture = weak.lock();
+        if (!texture) return true;
+
+        uint32_t requested = texture->m_requested.exchange(texture->m_levels, std::memory_order_relaxed);
+        if (requested < texture->m_levels)
+        {
+            texture->m_wanted = std::min(requested, texture->m_tail);
+            texture->m_lastUsed = m_update;
+        }
+
+        textures.push_back(texture);
+        return false;
+    });
+    m_textures.erase(textures_end, m_textures.end());
+
+    // Textures that were destroyed took their images with them.
+    m_allocated = 0;
+    for (auto const& texture : textures)
+        if (texture->m_image != VK_NULL_HANDLE) m_allocated += texture->m_mips->bytes(texture->m_resident);
+    for (auto const& upload : m_uploads)
+        m_allocated += upload.residency.bytes;
+    for (auto const& retired : m_retired)
+        m_allocated += retired.residency.bytes;
+
+    // What is resident once the uploads finish.
+    uint64_t used = 0;
+    for (auto const& texture : textures)
+        used += texture->m_mips->bytes(texture->m_target);
+
+    uint64_t uploaded = 0;
+    if (used > m_budget) used -= evict(textures, used - m_budget, uploaded);
+
+    // Textures requested this update, the furthest from what they asked for first.
+    std::vector<std::shared_ptr<VulkanStreamedTexture>> promotions;
+    for (auto const& texture : textures)
+    {
+        if (texture->m_lastUsed == m_update && texture->m_target == texture->m_resident
+            && texture->m_wanted < texture->m_target)
+            promotions.push_back(texture);
+    }
+    std::sort(promotions.begin(), promotions.end(), [](auto const& a, auto const& b)
+    {
+        return a->m_target - a->m_wanted > b->m_target - b->m_wanted;
+    });
+
+    for (auto const& texture : promotions)
+    {
+        if (uploaded > 0 && uploaded >= UPLOAD_LIMIT) break;
+
+        MipChain const& mips = *texture->m_mips;
+        uint64_t current = mips.bytes(texture->m_target);
+
+        if (used + mips.bytes(texture->m_wanted) - current > m_budget)
+            used -= evict(textures, used + mips.bytes(texture->m_wanted) - current - m_budget, uploaded);
+
+        // Whatever does not fit is left for a coarser mip, the current image stays until the
+        // new one is uploaded so both have to fit.
+        uint32_t first = texture->m_wanted;
+        while (first < texture->m_target && (used + mips.bytes(first) - current > m_budget
+                                             || m_allocated + mips.bytes(first) > m_budget))
+            first++;
+        if (first == texture->m_target) continue;
+
+        used += mips.bytes(first) - current;
+        uploaded += mips.bytes(first);
+        schedule(texture, first);
+    }
+}
+
+uint64_t VulkanTextureStreamer::used() const
+{
+    return m_allocated;
+}
@@ -5,10 +5,73 @@
 #include <set>
 #include <algorithm>
 
-Swapchain::Swapchain(VkDevice const& device, VkSurfaceKHR const& surface, VkSurfaceFormatKHR const& format,
-                     VkPresentModeKHR const& mode, uint32_t imageCount, VkExtent2D const& extent,
-                     std::vector<uint32_t> const& queueIndices, VkRenderPass const& renderPass)
-    : m_device(device)
+// Attachments that never leave the tile only need lazily allocated memory where the
+// device has it (tilers); otherwise fall back to regular device local memory.
+static void createAttachment(VulkanMemory& memory, VkExtent2D const& extent, VkFormat const& format, VkImageUsageFlags const& usage,
+                             VkSampleCountFlagBits const& samples, VkImageAspectFlags const& aspect,
+                             VkImage& image, VkDeviceMemory& imageMemory, VkImageView& view, bool const& transient = true)
+{
+    VkDevice const& device = memory.device();
+
+    VkImageCreateInfo imageInfo {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = { extent.width, extent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = transient ? usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = samples;
+
+    if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create Vulkan attachment image.");
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, image, &memReqs);
+
+    VkPhysicalDeviceMemoryProperties const& memProperties = memory.properties();
+
+    uint32_t typeIndex = UINT32_MAX;
+
+    VkMemoryPropertyFlags const preferences[] = {
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    };
+
+    for (VkMemoryPropertyFlags properties : preferences)
+    {
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount && typeIndex == UINT32_MAX; i++)
+            if (memReqs.memoryTypeBits & (1 << i)
+                && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+                typeIndex = i;
+    }
+
+    if (typeIndex == UINT32_MAX)
+        throw Adore::AdoreException("Failed to find suitable Vulkan memory type.");
+
+    imageMemory = memory.allocate(memReqs.size, typeIndex, Adore::MemoryCategory::ATTACHMENT);
+    vkBindImageMemory(device, image, imageMemory, 0);
+
+    VkImageViewCreateInfo viewInfo {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange = { aspect, 0, 1, 0, 1 };
+
+    if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create a Vulkan image view.");
+}
+
+Swapchain::Swapchain(VkDevice const& device, VulkanMemory& memory, VkSurfaceKHR const& surface,
+                     VkSurfaceFormatKHR const& format, VkPresentModeKHR const& mode, uint32_t imageCount,
+                     VkExtent2D const& extent, std::vector<uint32_t> const& queueIndices,
+                     VkRenderPass const& renderPass, VkSampleCountFlagBits const& samples, VkFormat const& depthFormat,
+                     bool const& readableDepth)
+    : m_device(device), m_memory(memory)
 {
     VkSwapchainCreateInfoKHR swapchainInfo {};
     swapchainInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -63,21 +126,46 @@ Swapchain::Swapchain(VkDevice const& device, VkSurfaceKHR const& surface, VkSurf
             throw Adore::AdoreException("Failed to create a Vulkan image view.");
     }
 
-    m_framebuffers.resize(imageCount);
+    bool multisampled = samples != VK_SAMPLE_COUNT_1_BIT;
 
-    for (size_t i = 0; i < imageCount; i++)
+    // Rendering dynamically, the renderer's graph allocates the attachments that only live
+    // through the frame.
+    if (multisampled && renderPass != VK_NULL_HANDLE)
+        createAttachment(memory, extent, format.format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                         samples, VK_IMAGE_ASPECT_COLOR_BIT, m_colorImage, m_colorMemory, m_colorView);
+
+    // Depth that is read after the pass has to live in real memory.
+    VkImageUsageFlags depthUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    if (readableDepth) depthUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    if (readableDepth || renderPass != VK_NULL_HANDLE)
+        createAttachment(memory, extent, depthFormat, depthUsage,
+                         samples, VK_IMAGE_ASPECT_DEPTH_BIT, m_depthImage, m_depthMemory, m_depthView, !readableDepth);
+
+    // No render pass means dynamic rendering, which uses the views directly.
+    if (renderPass != VK_NULL_HANDLE)
     {
-        VkFramebufferCreateInfo framebufferInfo {};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = &m_imageViews[i];
-        framebufferInfo.width = extent.width;
-        framebufferInfo.height = extent.height;
-        framebufferInfo.layers = 1;
-
-        if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_framebuffers[i]) != VK_SUCCESS)
-            throw Adore::AdoreException("Failed to create Vulkan framebuffer.");
+        m_framebuffers.resize(imageCount);
+
+        for (size_t i = 0; i < imageCount; i++)
+        {
+            // Must match the attachment order of the window's render pass.
+            std::vector<VkImageView> attachments = multisampled
+                ? std::vector<VkImageView>{ m_colorView, m_depthView, m_imageViews[i] }
+                : std::vector<VkImageView>{ m_imageViews[i], m_depthView };
+
+            VkFramebufferCreateInfo framebufferInfo {};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = attachments.size();
+            framebufferInfo.pAttachments = attachments.data();
+            framebufferInfo.width = extent.width;
+            framebufferInfo.height = extent.height;
+            framebufferInfo.layers = 1;
+
+            if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_framebuffers[i]) != VK_SUCCESS)
+                throw Adore::AdoreException("Failed to create Vulkan framebuffer.");
+        }
     }
 
     ADORE_INTERNAL_LOG(INFO, "Vulkan Swapchain created.");
@@ -93,6 +181,20 @@ Swapchain::~Swapchain()
     for (const auto& imageView : m_imageViews)
         vkDestroyImageView(m_device, imageView, nullptr);
 
+    if (m_depthImage != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(m_device, m_depthView, nullptr);
+        vkDestroyImage(m_device, m_depthImage, nullptr);
+        m_memory.free(m_depthMemory);
+    }
+
+    if (m_colorImage != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(m_device, m_colorView, nullptr);
+        vkDestroyImage(m_device, m_colorImage, nullptr);
+        m_memory.free(m_colorMemory);
+    }
+
     vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
 }
 
@@ -128,7 +230,7 @@ VkSurfaceFormatKHR chooseFormat(VkPhysicalDevice const& physicalDevice, VkSurfac
     return formats[0];
 }
 
-VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string const& title)
+VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string const& title, uint32_t const& samples)
     : Window(ctx, title)
 {
     VulkanContext * context = static_cast<VulkanContext*>(m_ctx.get());
@@ -151,13 +253,32 @@ VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string con
     m_physicalDevice = suitabilities.rbegin()->second;
     VkPhysicalDeviceProperties deviceProperties;
     vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+    m_limits = deviceProperties.limits;
     // ADORE_INTERNAL_LOG(INFO, "Physical Device: " + std::string(deviceProperties.deviceName));
 
+    VkSampleCountFlags supportedSamples = deviceProperties.limits.framebufferColorSampleCounts
+                                        & deviceProperties.limits.framebufferDepthSampleCounts;
+
+    for (uint32_t count = 64; count > 1; count >>= 1)
+    {
+        if (count <= samples && (supportedSamples & count))
+        {
+            m_samples = static_cast<VkSampleCountFlagBits>(count);
+            break;
+        }
+    }
+
+    if (samples > 1 && static_cast<uint32_t>(m_samples) != samples)
+        ADORE_INTERNAL_LOG(WARN, std::to_string(samples) + "x MSAA is not supported, using "
+                                 + std::to_string(static_cast<uint32_t>(m_samples)) + "x.");
+
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
 
+    m_queueIndices.compute = UINT32_MAX;
+
     int i = 0;
     for (const auto& queueFamily : queueFamilies)
     {
@@ -166,11 +287,16 @@ VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string con
 
         if (presentSupport) m_queueIndices.present = i;
         if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) m_queueIndices.graphics = i;
+        if ((queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            && m_queueIndices.compute == UINT32_MAX)
+            m_queueIndices.compute = i;
         i++;
     }
 
+    if (m_queueIndices.compute == UINT32_MAX) m_queueIndices.compute = m_queueIndices.graphics;
+
     std::vector<VkDeviceQueueCreateInfo> queueInfos;
-    std::set<uint32_t> uniqueFamilies = { m_queueIndices.graphics, m_queueIndices.present };
+    std::set<uint32_t> uniqueFamilies = { m_queueIndices.graphics, m_queueIndices.present, m_queueIndices.compute };
 
     float priority = 1.0f;
     for (const auto& family : uniqueFamilies)
@@ -184,11 +310,152 @@ VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string con
         queueInfos.push_back(queueInfo);
     }
 
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, extensions.data());
+
+    auto hasExtension = [&extensions](char const* name)
+    {
+        return std::any_of(extensions.begin(), extensions.end(), [name](auto const& extension)
+        {
+            return std::string(extension.extensionName) == name;
+        });
+    };
+
+    // The 1.2 and 1.3 feature structs are only valid on devices of that version, older devices
+    // get the same features from their KHR extensions or fall back to render passes.
+    bool const vulkan12 = deviceProperties.apiVersion >= VK_API_VERSION_1_2;
+    bool const vulkan13 = deviceProperties.apiVersion >= VK_API_VERSION_1_3;
+    bool const indirectCountExtension = !vulkan12 && hasExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    bool const dynamicRenderingExtension = !vulkan13 && hasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)
+        && (vulkan12 || (hasExtension(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME)
+                         && hasExtension(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)));
+
+    VkPhysicalDeviceVulkan13Features supported13 {};
+    supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    VkPhysicalDeviceVulkan12Features supported12 {};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR supportedRendering {};
+    supportedRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    VkPhysicalDeviceFeatures2 supported {};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+    void** query = &supported.pNext;
+    if (vulkan12)
+    {
+        *query = &supported12;
+        query = &supported12.pNext;
+    }
+    if (vulkan13)
+    {
+        *query = &supported13;
+        query = &supported13.pNext;
+    }
+    if (dynamicRenderingExtension)
+        *query = &supportedRendering;
+
+    vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supported);
+
     VkPhysicalDeviceFeatures deviceFeatures {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.multiDrawIndirect = supported.features.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supported.features.drawIndirectFirstInstance;
+    deviceFeatures.fillModeNonSolid = supported.features.fillModeNonSolid;
+    deviceFeatures.wideLines = supported.features.wideLines;
+    m_features = deviceFeatures;
 
     std::vector<char const*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
+    VkPhysicalDeviceVulkan12Features features12 {};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.drawIndirectCount = supported12.drawIndirectCount;
+
+    VkPhysicalDeviceVulkan13Features features13 {};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13.dynamicRendering = supported13.dynamicRendering;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR featuresRendering {};
+    featuresRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    featuresRendering.dynamicRendering = supportedRendering.dynamicRendering;
+
+    // The extension has no feature struct, being advertised is enough.
+    if (indirectCountExtension)
+        deviceExtensions.emplace_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    m_drawIndirectCount = vulkan12 ? supported12.drawIndirectCount : indirectCountExtension;
+
+    if (supportedRendering.dynamicRendering)
+    {
+        if (!vulkan12)
+        {
+            deviceExtensions.emplace_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+            deviceExtensions.emplace_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+        }
+        deviceExtensions.emplace_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+    m_dynamicRendering = vulkan13 ? supported13.dynamicRendering : supportedRendering.dynamicRendering;
+
+    void* deviceNext = nullptr;
+    void** chain = &deviceNext;
+    if (vulkan12)
+    {
+        *chain = &features12;
+        chain = &features12.pNext;
+    }
+    if (vulkan13)
+    {
+        *chain = &features13;
+        chain = &features13.pNext;
+    }
+    if (supportedRendering.dynamicRendering)
+    {
+        *chain = &featuresRendering;
+        chain = &featuresRendering.pNext;
+    }
+
+    // Extended dynamic state is core in 1.3, the third extension adds the blend state.
+    m_dynamicState = vulkan13;
+
+    bool dynamicState3Extension = hasExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT supportedState3 {};
+    supportedState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+    if (m_dynamicState && dynamicState3Extension)
+    {
+        VkPhysicalDeviceFeatures2 query {};
+        query.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        query.pNext = &supportedState3;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &query);
+    }
+
+    bool dynamicState3 = supportedState3.extendedDynamicState3PolygonMode
+                      && supportedState3.extendedDynamicState3ColorBlendEnable
+                      && supportedState3.extendedDynamicState3ColorBlendEquation
+                      && supportedState3.extendedDynamicState3ColorWriteMask;
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT featuresState3 {};
+    featuresState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    featuresState3.extendedDynamicState3PolygonMode = VK_TRUE;
+    featuresState3.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+    featuresState3.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+    featuresState3.extendedDynamicState3ColorWriteMask = VK_TRUE;
+
+    if (dynamicState3)
+    {
+        deviceExtensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+        *chain = &featuresState3;
+    }
+
+    // Lets memory stats report what the driver budgets rather than the heap sizes.
+    bool memoryBudget = hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    if (memoryBudget)
+        deviceExtensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
 #ifdef __APPLE__
     deviceExtensions.emplace_back("VK_KHR_portability_subset");
 #endif
@@ -197,6 +464,7 @@ VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string con
 
     VkDeviceCreateInfo deviceInfo {};
     deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = deviceNext;
     deviceInfo.queueCreateInfoCount = queueInfos.size();
     deviceInfo.pQueueCreateInfos = queueInfos.data();
     deviceInfo.pEnabledFeatures = &deviceFeatures;
@@ -208,8 +476,45 @@ VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string con
     if (vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device) != VK_SUCCESS)
         throw Adore::AdoreException("Failed to create a Vulkan device.");
 
+    m_modules = std::make_unique<VulkanModuleCache>(m_device);
+    m_memory = std::make_unique<VulkanMemory>(m_device, m_physicalDevice, memoryBudget);
+
+    if (dynamicState3)
+    {
+        m_dynamicState3.setPolygonMode = reinterpret_cast<PFN_vkCmdSetPolygonModeEXT>(
+            vkGetDeviceProcAddr(m_device, "vkCmdSetPolygonModeEXT"));
+        m_dynamicState3.setColorBlendEnable = reinterpret_cast<PFN_vkCmdSetColorBlendEnableEXT>(
+            vkGetDeviceProcAddr(m_device, "vkCmdSetColorBlendEnableEXT"));
+        m_dynamicState3.setColorBlendEquation = reinterpret_cast<PFN_vkCmdSetColorBlendEquationEXT>(
+            vkGetDeviceProcAddr(m_device, "vkCmdSetColorBlendEquationEXT"));
+        m_dynamicState3.setColorWriteMask = reinterpret_cast<PFN_vkCmdSetColorWriteMaskEXT>(
+            vkGetDeviceProcAddr(m_device, "vkCmdSetColorWriteMaskEXT"));
+    }
+
+    if (m_drawIndirectCount)
+        m_commands.drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(
+            vkGetDeviceProcAddr(m_device, vulkan12 ? "vkCmdDrawIndexedIndirectCount" : "vkCmdDrawIndexedIndirectCountKHR"));
+
+    if (m_dynamicRendering)
+    {
+        m_commands.beginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(
+            vkGetDeviceProcAddr(m_device, vulkan13 ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR"));
+        m_commands.endRendering = reinterpret_cast<PFN_vkCmdEndRendering>(
+            vkGetDeviceProcAddr(m_device, vulkan13 ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR"));
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheInfo {};
+    pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    if (vkCreatePipelineCache(m_device, &pipelineCacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+        throw Adore::AdoreException("Failed to create a Vulkan pipeline cache.");
+
+    // One core is left to the thread that records frames.
+    m_workers = std::make_unique<WorkerPool>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+
     vkGetDeviceQueue(m_device, m_queueIndices.graphics, 0, &m_queues.graphics);
     vkGetDeviceQueue(m_device, m_queueIndices.present, 0, &m_queues.present);
+    vkGetDeviceQueue(m_device, m_queueIndices.compute, 0, &m_queues.compute);
     
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &m_capabilities);
 
@@ -220,55 +525,113 @@ VulkanWindow::VulkanWindow(std::shared_ptr<Adore::Context>& ctx, std::string con
 
     m_mode = VK_PRESENT_MODE_FIFO_KHR;
 
+    // Nothing is shown headless, so presenting never waits there.
+    VkPresentModeKHR preferred = m_ctx->headless ? VK_PRESENT_MODE_IMMEDIATE_KHR : VK_PRESENT_MODE_MAILBOX_KHR;
+
     for (const auto& presentMode : m_presentModes)
-        if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+        if (presentMode == preferred)
             m_mode = presentMode;
 
     m_format = chooseFormat(m_physicalDevice, m_surface);
 
+    for (VkFormat candidate : { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT })
+    {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, candidate, &properties);
+
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+        {
+            m_depthFormat = candidate;
+            break;
+        }
+    }
+
+    if (m_depthFormat == VK_FORMAT_UNDEFINED)
+        throw Adore::AdoreException("No supported Vulkan depth format.");
+
     if (m_capabilities.maxImageCount == 0) m_imageCount = m_capabilities.minImageCount + 1;
     else m_imageCount = std::clamp(m_capabilities.minImageCount + 1,
                                  m_capabilities.minImageCount,
                                  m_capabilities.maxImageCount);
 
-    VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = m_format.format;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference colorAttachmentRef{};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-
-    VkSubpassDependency dependency {};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkRenderPassCreateInfo renderPassInfo {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
-
-    if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS)
-        throw Adore::AdoreException("Failed to create Vulkan renderpass.");
+    // With dynamic rendering, rendering begins directly on the swapchain image views and
+    // pipelines only need the attachment formats, so there is no render pass or framebuffers.
+    if (!m_dynamicRendering)
+    {
+        bool multisampled = m_samples != VK_SAMPLE_COUNT_1_BIT;
+
+        // When multisampling the colour attachment is resolved into the swapchain image at the
+        // end of the subpass, so neither it nor depth ever has to be written back to memory.
+        // The renderer's graph does the layout transitions around the pass, including the one
+        // for presenting.
+        VkAttachmentDescription colorAttachment{};
+        colorAttachment.format = m_format.format;
+        colorAttachment.samples = m_samples;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = m_depthFormat;
+        depthAttachment.samples = m_samples;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentDescription resolveAttachment{};
+        resolveAttachment.format = m_format.format;
+        resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        resolveAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        std::vector<VkAttachmentDescription> attachments = { colorAttachment, depthAttachment };
+        if (multisampled) attachments.push_back(resolveAttachment);
+
+        VkAttachmentReference colorAttachmentRef{};
+        colorAttachmentRef.attachment = 0;
+        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 1;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference resolveAttachmentRef{};
+        resolveAttachmentRef.attachment = 2;
+        resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorAttachmentRef;
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+        subpass.pResolveAttachments = multisampled ? &resolveAttachmentRef : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = attachments.size();
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan renderpass.");
+
+        // Only the depth store op differs, so pipelines and framebuffers work with either pass.
+        attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+        if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_depthStorePass) != VK_SUCCESS)
+            throw Adore::AdoreException("Failed to create Vulkan renderpass.");
+    }
 
     recreateSwapchain();
 
@@ -281,11 +644,29 @@ VulkanWindow::~VulkanWindow()
 
     m_swapchain.reset();
 
-    vkDestroyRenderPass(m_device, m_renderPass, nullptr); 
+    if (m_renderPass != VK_NULL_HANDLE)
+    {
+        vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+        vkDestroyRenderPass(m_device, m_depthStorePass, nullptr);
+    }
+    m_workers.reset();
+    vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+    m_modules.reset();
+    m_memory.reset();
     vkDestroyDevice(m_device, nullptr);
     vkDestroySurfaceKHR(context->instance(), m_surface, nullptr);
 }
 
+void VulkanWindow::resize(int const& width, int const& height)
+{
+    Window::resize(width, height);
+    if (!m_ctx->headless) return;
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    vkDeviceWaitIdle(m_device);
+    recreateSwapchain();
+}
+
 void VulkanWindow::recreateSwapchain()
 {
     this->framebufferSize(m_extent.width, m_extent.height);
@@ -294,8 +675,25 @@ void VulkanWindow::recreateSwapchain()
     m_extent.height = std::clamp(m_extent.height, m_capabilities.minImageExtent.height,
                                                 m_capabilities.maxImageExtent.height);
 
-    m_swapchain = std::make_unique<Swapchain>(m_device, m_surface, m_format, m_mode, m_imageCount, m_extent,
+    m_swapchain.reset();
+    m_swapchainVersion++;
+    m_swapchain = std::make_unique<Swapchain>(m_device, *m_memory, m_surface, m_format, m_mode,
+                                              m_imageCount, m_extent,
                                               std::vector<uint32_t>{ m_queueIndices.graphics,
                                                                      m_queueIndices.present },
-                                              m_renderPass);
+                                              m_renderPass, m_samples, m_depthFormat, m_readableDepth);
+}
+
+void VulkanWindow::readableDepth()
+{
+    if (m_readableDepth) return;
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, m_depthFormat, &properties);
+
+    if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        throw Adore::AdoreException("The Vulkan depth format can not be sampled.");
+
+    m_readableDepth = true;
+    recreateSwapchain();
 }
\ No newline at end of file
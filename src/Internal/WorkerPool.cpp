@@ -0,0 +1,69 @@
+#include <Adore/Internal/WorkerPool.hpp>
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int const& threads)
+{
+    for (unsigned int i = 0; i < std::max(1u, threads); i++)
+        m_threads.emplace_back(&WorkerPool::run, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_available.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void WorkerPool::run()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_available.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+            if (m_jobs.empty()) return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+std::shared_future<void> WorkerPool::submit(std::function<void()> const& job)
+{
+    // std::function has to be copyable, the task is not.
+    auto task = std::make_shared<std::packaged_task<void()>>(job);
+    std::shared_future<void> future = task->get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.emplace_back([task] { (*task)(); });
+    }
+
+    m_available.notify_one();
+    return future;
+}
+
+bool WorkerPool::current() const
+{
+    return std::any_of(m_threads.begin(), m_threads.end(),
+                       [](std::thread const& thread) { return thread.get_id() == std::this_thread::get_id(); });
+}
+
+WorkerPool& WorkerPool::shared()
+{
+    static WorkerPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
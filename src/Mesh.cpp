@@ -0,0 +1,407 @@
+#include <Adore/Mesh.hpp>
+#include <Adore/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // Sum of squared distances to a set of planes, each weighted by the area of its triangle.
+    // Stored as the 10 unique coefficients of the symmetric 4x4 matrix.
+    struct Quadric
+    {
+        float a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+        float weight = 0;
+
+        static Quadric plane(glm::vec3 const& n, float const& d, float const& weight)
+        {
+            Quadric q;
+            q.a2 = n.x * n.x * weight; q.ab = n.x * n.y * weight; q.ac = n.x * n.z * weight; q.ad = n.x * d * weight;
+            q.b2 = n.y * n.y * weight; q.bc = n.y * n.z * weight; q.bd = n.y * d * weight;
+            q.c2 = n.z * n.z * weight; q.cd = n.z * d * weight;
+            q.d2 = d * d * weight;
+            q.weight = weight;
+            return q;
+        }
+
+        void add(Quadric const& q)
+        {
+            a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+            b2 += q.b2; bc += q.bc; bd += q.bd;
+            c2 += q.c2; cd += q.cd;
+            d2 += q.d2;
+            weight += q.weight;
+        }
+
+        // Mean squared distance of p to the planes.
+        float error(glm::vec3 const& p) const
+        {
+            if (weight <= 0.0f) return 0.0f;
+
+            float e = a2 * p.x * p.x + 2.0f * ab * p.x * p.y + 2.0f * ac * p.x * p.z + 2.0f * ad * p.x +
+                      b2 * p.y * p.y + 2.0f * bc * p.y * p.z + 2.0f * bd * p.y +
+                      c2 * p.z * p.z + 2.0f * cd * p.z + d2;
+
+            return std::max(0.0f, e / weight);
+        }
+    };
+
+    struct Collapse
+    {
+        float cost;
+        uint16_t from;
+        uint16_t to;
+    };
+
+    glm::vec3 cross(glm::vec3 const& a, glm::vec3 const& b)
+    {
+        return glm::vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    class Simplifier
+    {
+        std::vector<glm::vec3> m_positions;
+        std::vector<Quadric> m_quadrics;
+        std::vector<bool> m_locked;
+        float m_error = 0.0f;
+
+        glm::vec3 normal(uint16_t const * triangle, uint16_t const& moved, glm::vec3 const& position) const
+        {
+            glm::vec3 p[3];
+            for (unsigned int i = 0; i < 3; i++)
+                p[i] = triangle[i] == moved ? position : m_positions[triangle[i]];
+
+            return cross(p[1] - p[0], p[2] - p[0]);
+        }
+
+        // One round of collapses that do not share any triangles, returns false if none were possible.
+        bool pass(std::vector<uint16_t>& indices, size_t const& target)
+        {
+            size_t const vertexCount = m_positions.size();
+            size_t const triangles = indices.size() / 3;
+
+            // Triangles around each vertex.
+            std::vector<uint32_t> offsets(vertexCount + 1, 0);
+            for (auto index : indices) offsets[index + 1]++;
+            for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+
+            std::vector<uint32_t> adjacency(indices.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+            std::vector<uint32_t> edges;
+            edges.reserve(indices.size());
+            for (size_t t = 0; t < triangles; t++)
+            {
+                for (unsigned int e = 0; e < 3; e++)
+                {
+                    uint16_t a = indices[t * 3 + e], b = indices[t * 3 + (e + 1) % 3];
+                    edges.push_back(static_cast<uint32_t>(std::min(a, b)) << 16 | std::max(a, b));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            std::vector<Collapse> collapses;
+            collapses.reserve(edges.size());
+            for (auto edge : edges)
+            {
+                uint16_t a = static_cast<uint16_t>(edge >> 16), b = static_cast<uint16_t>(edge & 0xFFFF);
+                Quadric q = m_quadrics[a];
+                q.add(m_quadrics[b]);
+
+                float toB = m_locked[a] ? std::numeric_limits<float>::infinity() : q.error(m_positions[b]);
+                float toA = m_locked[b] ? std::numeric_limits<float>::infinity() : q.error(m_positions[a]);
+
+                if (toB <= toA && !m_locked[a]) collapses.push_back({ toB, a, b });
+                else if (!m_locked[b]) collapses.push_back({ toA, b, a });
+            }
+            std::sort(collapses.begin(), collapses.end(),
+                      [](Collapse const& l, Collapse const& r) { return l.cost < r.cost; });
+
+            std::vector<uint16_t> remap(vertexCount);
+            for (size_t v = 0; v < vertexCount; v++) remap[v] = static_cast<uint16_t>(v);
+
+            std::vector<bool> touched(vertexCount, false);
+            size_t removed = 0;
+            size_t const needed = triangles - target / 3;
+            bool collapsed = false;
+
+            for (auto const& collapse : collapses)
+            {
+                if (removed >= needed) break;
+                if (touched[collapse.from] || touched[collapse.to]) continue;
+
+                size_t shared = 0;
+                bool flips = false;
+
+                for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1] && !flips; i++)
+                {
+                    uint16_t const * triangle = &indices[adjacency[i] * 3];
+
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    {
+                        shared++;
+                        continue;
+                    }
+
+                    glm::vec3 before = normal(triangle, collapse.from, m_positions[collapse.from]);
+                    glm::vec3 after = normal(triangle, collapse.from, m_positions[collapse.to]);
+                    flips = glm::dot(before, after) <= 0.0f;
+                }
+
+                if (flips || shared == 0) continue;
+
+                for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; i++)
+                    for (unsigned int v = 0; v < 3; v++)
+                        touched[indices[adjacency[i] * 3 + v]] = true;
+
+                remap[collapse.from] = collapse.to;
+                m_quadrics[collapse.to].add(m_quadrics[collapse.from]);
+                m_error = std::max(m_error, std::sqrt(collapse.cost));
+                removed += shared;
+                collapsed = true;
+            }
+
+            size_t count = 0;
+            for (size_t t = 0; t < triangles; t++)
+            {
+                uint16_t a = remap[indices[t * 3]], b = remap[indices[t * 3 + 1]], c = remap[indices[t * 3 + 2]];
+                if (a == b || b == c || a == c) continue;
+
+                indices[count++] = a;
+                indices[count++] = b;
+                indices[count++] = c;
+            }
+            indices.resize(count);
+
+            return collapsed;
+        }
+
+    public:
+        Simplifier(void const * vertices, uint32_t const& vertexCount, uint32_t const& stride,
+                   std::vector<uint16_t> const& indices)
+            : m_positions(vertexCount), m_quadrics(vertexCount), m_locked(vertexCount, false)
+        {
+            auto bytes = static_cast<char const *>(vertices);
+            for (uint32_t v = 0; v < vertexCount; v++)
+                std::memcpy(&m_positions[v], bytes + static_cast<size_t>(v) * stride, sizeof(float) * 3);
+
+            for (size_t t = 0; t + 2 < indices.size(); t += 3)
+            {
+                glm::vec3 const& p0 = m_positions[indices[t]];
+                glm::vec3 n = cross(m_positions[indices[t + 1]] - p0, m_positions[indices[t + 2]] - p0);
+                float area = glm::length(n);
+                if (area <= 0.0f) continue;
+
+                n = n / area;
+                Quadric q = Quadric::plane(n, -glm::dot(n, p0), area * 0.5f);
+                for (unsigned int i = 0; i < 3; i++) m_quadrics[indices[t + i]].add(q);
+            }
+
+            // Border edges belong to a single triangle.
+            std::vector<uint32_t> edges;
+            for (size_t t = 0; t + 2 < indices.size(); t += 3)
+            {
+                for (unsigned int e = 0; e < 3; e++)
+                {
+                    uint16_t a = indices[t + e], b = indices[t + (e + 1) % 3];
+                    edges.push_back(static_cast<uint32_t>(std::min(a, b)) << 16 | std::max(a, b));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t j = i;
+                while (j < edges.size() && edges[j] == edges[i]) j++;
+
+                if (j - i == 1)
+                {
+                    m_locked[edges[i] >> 16] = true;
+                    m_locked[edges[i] & 0xFFFF] = true;
+                }
+                i = j;
+            }
+
+            // Vertices split for normals or texture coordinates share a position, moving one
+            // of them would tear the surface.
+            std::vector<uint16_t> order(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++) order[v] = static_cast<uint16_t>(v);
+
+            auto less = [&](uint16_t const& l, uint16_t const& r)
+            {
+                glm::vec3 const& a = m_positions[l];
+                glm::vec3 const& b = m_positions[r];
+                if (a.x != b.x) return a.x < b.x;
+                if (a.y != b.y) return a.y < b.y;
+                return a.z < b.z;
+            };
+            std::sort(order.begin(), order.end(), less);
+
+            for (size_t i = 1; i < order.size(); i++)
+            {
+                if (!less(order[i - 1], order[i]) && !less(order[i], order[i - 1]))
+                    m_locked[order[i - 1]] = m_locked[order[i]] = true;
+            }
+        }
+
+        float reduce(std::vector<uint16_t>& indices, size_t const& target)
+        {
+            while (indices.size() > target && pass(indices, target));
+
+            return m_error;
+        }
+    };
+
+    Adore::BoundingSphere boundingSphere(void const * vertices, uint32_t const& vertexCount, uint32_t const& stride)
+    {
+        auto bytes = static_cast<char const *>(vertices);
+        auto position = [&](uint32_t const& v)
+        {
+            glm::vec3 p;
+            std::memcpy(&p, bytes + static_cast<size_t>(v) * stride, sizeof(float) * 3);
+            return p;
+        };
+
+        glm::vec3 min = position(0), max = position(0);
+        for (uint32_t v = 1; v < vertexCount; v++)
+        {
+            min = glm::min(min, position(v));
+            max = glm::max(max, position(v));
+        }
+
+        Adore::BoundingSphere sphere = { (min + max) * 0.5f, 0.0f };
+        for (uint32_t v = 0; v < vertexCount; v++)
+            sphere.radius = std::max(sphere.radius, glm::length(position(v) - sphere.center));
+
+        return sphere;
+    }
+}
+
+namespace Adore
+{
+    std::shared_ptr<Mesh> Mesh::create(std::shared_ptr<Renderer>& renderer,
+                                       void const * vertices, uint32_t const& vertexCount,
+                                       uint32_t const& stride, std::vector<uint16_t> const& indices,
+                                       uint32_t const& maxLevels, float const& reduction)
+    {
+        return create(renderer, vertices, vertexCount, stride,
+                      simplify(vertices, vertexCount, stride, indices, maxLevels, reduction));
+    }
+
+    std::shared_ptr<Mesh> Mesh::create(std::shared_ptr<Renderer>& renderer,
+                                       void const * vertices, uint32_t const& vertexCount,
+                                       uint32_t const& stride, MeshLods const& lods)
+    {
+        if (vertexCount == 0 || lods.levels.empty())
+            throw AdoreException("A mesh needs vertices and at least one level.");
+
+        for (auto const& level : lods.levels)
+        {
+            if (static_cast<size_t>(level.firstIndex) + level.indexCount > lods.indices.size())
+                throw AdoreException("Mesh level is outside of its index data.");
+        }
+
+        auto vertexBuffer = VertexBuffer::create(renderer, const_cast<void*>(vertices),
+                                                 static_cast<uint64_t>(vertexCount) * stride);
+        auto indexBuffer = IndexBuffer::create(renderer, const_cast<uint16_t*>(lods.indices.data()),
+                                               lods.indices.size() * sizeof(uint16_t));
+
+        return std::make_shared<Mesh>(vertexBuffer, indexBuffer, lods.levels,
+                                      boundingSphere(vertices, vertexCount, stride));
+    }
+
+    std::shared_ptr<Mesh> Mesh::create(std::shared_ptr<Renderer>& renderer,
+                                       void const * vertices, uint32_t const& vertexCount,
+                                       uint32_t const& stride, void const * attributes,
+                                       uint32_t const& attributeStride, MeshLods const& lods)
+    {
+        auto mesh = create(renderer, vertices, vertexCount, stride, lods);
+
+        auto attributeBuffer = VertexBuffer::create(renderer, const_cast<void*>(attributes),
+                                                    static_cast<uint64_t>(vertexCount) * attributeStride);
+
+        return std::make_shared<Mesh>(mesh->vertices(), mesh->indices(), mesh->levels(), mesh->bounds(),
+                                      attributeBuffer);
+    }
+
+    MeshLods Mesh::simplify(void const * vertices, uint32_t const& vertexCount, uint32_t const& stride,
+                            std::vector<uint16_t> const& indices, uint32_t const& maxLevels,
+                            float const& reduction)
+    {
+        if (indices.size() % 3 != 0)
+            throw AdoreException("Mesh indices have to be a triangle list.");
+
+        if (stride < sizeof(float) * 3)
+            throw AdoreException("Mesh vertices need at least a position.");
+
+        for (auto index : indices)
+        {
+            if (index >= vertexCount)
+                throw AdoreException("Mesh index is out of range of its vertices.");
+        }
+
+        MeshLods lods;
+        lods.indices = indices;
+        lods.levels.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+
+        Simplifier simplifier(vertices, vertexCount, stride, indices);
+        std::vector<uint16_t> level = indices;
+
+        while (lods.levels.size() < maxLevels)
+        {
+            size_t previous = level.size();
+            size_t target = static_cast<size_t>(previous / 3 * reduction) * 3;
+            if (target < 3) break;
+
+            float error = simplifier.reduce(level, target);
+
+            // Mostly locked meshes barely shrink, another copy of them is not worth the memory.
+            if (level.size() > previous - (previous - target) / 2) break;
+
+            lods.levels.push_back({ static_cast<uint32_t>(lods.indices.size()), static_cast<uint32_t>(level.size()), error });
+            lods.indices.insert(lods.indices.end(), level.begin(), level.end());
+        }
+
+        return lods;
+    }
+
+    float Mesh::screenSize(BoundingSphere const& bounds, glm::vec3 const& camera,
+                           float const& fovY, float const& viewportHeight)
+    {
+        float distance = glm::length(bounds.center - camera);
+
+        if (distance <= bounds.radius)
+            return std::numeric_limits<float>::infinity();
+
+        return bounds.radius / (distance * std::tan(fovY * 0.5f)) * viewportHeight;
+    }
+
+    uint32_t Mesh::select(float const& screenSize, uint32_t const& current, float const& threshold,
+                          float const& hysteresis) const
+    {
+        if (!std::isfinite(screenSize)) return 0;
+
+        float pixelsPerUnit = m_bounds.radius > 0.0f ? screenSize / (2.0f * m_bounds.radius) : 0.0f;
+        uint32_t level = 0;
+
+        for (uint32_t i = 1; i < m_levels.size(); i++)
+        {
+            float limit = i > current ? threshold * (1.0f - hysteresis) : threshold;
+            if (m_levels[i].error * pixelsPerUnit > limit) break;
+
+            level = i;
+        }
+
+        return level;
+    }
+
+    DrawPacket Mesh::packet(uint64_t const& key, Shader * shader, uint32_t const& level) const
+    {
+        MeshLod const& lod = m_levels[std::min<size_t>(level, m_levels.size() - 1)];
+        return { key, shader, m_vertices.get(), m_indices.get(), lod.indexCount, lod.firstIndex, 0,
+                 m_attributes.get() };
+    }
+}
@@ -0,0 +1,1026 @@
+#include <Adore/MeshImport.hpp>
+#include <Adore/Log.hpp>
+#include <Adore/Quantize.hpp>
+
+#include <Adore/Internal/Json.hpp>
+#include <Adore/Internal/Log.hpp>
+#include <Adore/Internal/MappedFile.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    glm::vec3 position(Adore::ImportedVertex const& vertex)
+    {
+        return glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+    }
+
+    void checkIndices(std::vector<uint32_t> const& indices, size_t const& vertexCount)
+    {
+        if (indices.size() % 3 != 0)
+            throw Adore::AdoreException("Mesh indices have to be a triangle list.");
+
+        for (auto const& index : indices)
+            if (index >= vertexCount)
+                throw Adore::AdoreException("Mesh index is out of range of its vertices.");
+    }
+
+    // Timestamps rather than a queue, a vertex is cached while fewer than size misses came after it.
+    class FifoCache
+    {
+        std::vector<uint32_t> m_time;
+        uint32_t m_now;
+        uint32_t const m_size;
+    public:
+        FifoCache(size_t const& vertexCount, uint32_t const& size)
+            : m_time(vertexCount, 0), m_now(size + 1), m_size(size) {};
+
+        bool miss(uint32_t const& vertex)
+        {
+            if (m_now - m_time[vertex] <= m_size) return false;
+
+            m_time[vertex] = m_now++;
+            return true;
+        }
+
+        void flush() { m_now += m_size + 1; }
+    };
+
+    // Starts of the clusters it ran into dead ends between, in triangles, go to boundaries.
+    std::vector<uint32_t> tipsify(std::vector<uint32_t> const& indices, uint32_t const& vertexCount,
+                                  uint32_t const& cacheSize, std::vector<size_t> * boundaries)
+    {
+        size_t triangles = indices.size() / 3;
+
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (auto const& index : indices) offsets[index + 1]++;
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangles; t++)
+            for (unsigned int k = 0; k < 3; k++)
+                adjacency[fill[indices[3 * t + k]]++] = static_cast<uint32_t>(t);
+
+        std::vector<uint32_t> live(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) live[v] = offsets[v + 1] - offsets[v];
+
+        std::vector<uint32_t> time(vertexCount, 0);
+        std::vector<bool> emitted(triangles, false);
+        std::vector<uint32_t> deadEnd;
+        std::vector<uint32_t> candidates;
+        uint32_t now = cacheSize + 1;
+        uint32_t cursor = 0;
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        auto scan = [&]() -> int64_t
+        {
+            while (cursor < vertexCount && live[cursor] == 0) cursor++;
+            return cursor < vertexCount ? static_cast<int64_t>(cursor) : -1;
+        };
+
+        int64_t fanning = scan();
+
+        while (fanning >= 0)
+        {
+            candidates.clear();
+
+            for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    uint32_t v = indices[3 * t + k];
+                    result.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (now - time[v] > cacheSize) time[v] = now++;
+                }
+
+                emitted[t] = true;
+            }
+
+            // The candidate that has been cached longest, as long as fanning around it would not
+            // push it out of the cache before it is finished.
+            int64_t next = -1;
+            int64_t best = -1;
+
+            for (auto const& v : candidates)
+            {
+                if (live[v] == 0) continue;
+
+                int64_t priority = 0;
+                if (now - time[v] + 2 * live[v] <= cacheSize) priority = now - time[v];
+
+                if (priority > best)
+                {
+                    best = priority;
+                    next = v;
+                }
+            }
+
+            if (next < 0)
+            {
+                if (boundaries && result.size() / 3 < triangles) boundaries->push_back(result.size() / 3);
+
+                while (!deadEnd.empty() && next < 0)
+                {
+                    uint32_t v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (live[v] > 0) next = v;
+                }
+
+                if (next < 0) next = scan();
+            }
+
+            fanning = next;
+        }
+
+        return result;
+    }
+
+    struct VertexHash
+    {
+        size_t operator()(Adore::ImportedVertex const& vertex) const
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            auto bytes = reinterpret_cast<unsigned char const *>(&vertex);
+
+            for (size_t i = 0; i < sizeof(vertex); i++)
+            {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct VertexEqual
+    {
+        bool operator()(Adore::ImportedVertex const& a, Adore::ImportedVertex const& b) const
+        {
+            return memcmp(&a, &b, sizeof(a)) == 0;
+        }
+    };
+
+    // Smooth normals for vertices without one, averaged over every triangle sharing the position
+    // and weighted by area.
+    void generateNormals(Adore::ImportedMesh& mesh)
+    {
+        auto missing = [](Adore::ImportedVertex const& v) { return !v.normal[0] && !v.normal[1] && !v.normal[2]; };
+        if (std::none_of(mesh.vertices.begin(), mesh.vertices.end(), missing)) return;
+
+        auto key = [](Adore::ImportedVertex const& v)
+        {
+            Adore::ImportedVertex positionOnly {};
+            memcpy(positionOnly.position, v.position, sizeof(v.position));
+            return positionOnly;
+        };
+
+        std::unordered_map<Adore::ImportedVertex, glm::vec3, VertexHash, VertexEqual> normals;
+
+        for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+        {
+            auto const& a = mesh.vertices[mesh.indices[t]];
+            auto const& b = mesh.vertices[mesh.indices[t + 1]];
+            auto const& c = mesh.vertices[mesh.indices[t + 2]];
+            glm::vec3 normal = glm::cross(position(b) - position(a), position(c) - position(a));
+
+            for (auto const * v : { &a, &b, &c })
+                normals[key(*v)] += normal;
+        }
+
+        for (auto& vertex : mesh.vertices)
+        {
+            if (!missing(vertex)) continue;
+
+            auto it = normals.find(key(vertex));
+            if (it == normals.end() || glm::length(it->second) == 0.0f) continue;
+
+            glm::vec3 normal = glm::normalize(it->second);
+            vertex.normal[0] = normal.x;
+            vertex.normal[1] = normal.y;
+            vertex.normal[2] = normal.z;
+        }
+    }
+
+    std::vector<char> readText(std::string const& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw Adore::AdoreException("Failed to open mesh: " + path);
+
+        std::vector<char> text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        text.push_back('\0');
+        return text;
+    }
+
+    void skipBlank(char const *& p)
+    {
+        while (*p == ' ' || *p == '\t') p++;
+    }
+
+    bool endOfLine(char const * p)
+    {
+        return *p == '\0' || *p == '\n' || *p == '\r' || *p == '#';
+    }
+
+    float readFloat(char const *& p, std::string const& path)
+    {
+        skipBlank(p);
+        char * end = nullptr;
+        float value = endOfLine(p) ? 0.0f : strtof(p, &end);
+
+        if (!end || end == p) throw Adore::AdoreException("Malformed number in " + path);
+
+        p = end;
+        return value;
+    }
+
+    // 1 based, negative counts back from the last one so far, 0 is absent.
+    uint32_t objIndex(long const& index, size_t const& count, std::string const& path)
+    {
+        long resolved = index > 0 ? index - 1 : static_cast<long>(count) + index;
+
+        if (index == 0 || resolved < 0 || static_cast<size_t>(resolved) >= count)
+            throw Adore::AdoreException("Face refers to a missing vertex in " + path);
+
+        return static_cast<uint32_t>(resolved);
+    }
+
+    Adore::ImportedMesh loadObj(std::string const& path)
+    {
+        std::vector<char> text = readText(path);
+        std::vector<glm::vec3> positions, normals;
+        std::vector<std::pair<float, float>> uvs;
+        std::vector<uint32_t> face;
+        Adore::ImportedMesh mesh;
+
+        char const * p = text.data();
+
+        while (*p)
+        {
+            skipBlank(p);
+
+            if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                p += 1;
+                float x = readFloat(p, path), y = readFloat(p, path), z = readFloat(p, path);
+                positions.emplace_back(x, y, z);
+            }
+            else if (p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+            {
+                p += 2;
+                float x = readFloat(p, path), y = readFloat(p, path), z = readFloat(p, path);
+                normals.emplace_back(x, y, z);
+            }
+            else if (p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+            {
+                p += 2;
+                float u = readFloat(p, path), v = readFloat(p, path);
+                uvs.emplace_back(u, v);
+            }
+            else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                p += 1;
+                face.clear();
+
+                for (skipBlank(p); !endOfLine(p); skipBlank(p))
+                {
+                    char * end = nullptr;
+                    Adore::ImportedVertex vertex {};
+
+                    glm::vec3 const& position = positions[objIndex(strtol(p, &end, 10), positions.size(), path)];
+                    memcpy(vertex.position, &position.x, sizeof(vertex.position));
+                    p = end;
+
+                    if (*p == '/' && *++p != '/')
+                    {
+                        // OBJ puts the origin at the bottom left, Vulkan samples from the top left.
+                        auto const& uv = uvs[objIndex(strtol(p, &end, 10), uvs.size(), path)];
+                        vertex.uv[0] = uv.first;
+                        vertex.uv[1] = 1.0f - uv.second;
+                        p = end;
+                    }
+
+                    if (*p == '/')
+                    {
+                        glm::vec3 const& normal = normals[objIndex(strtol(p + 1, &end, 10), normals.size(), path)];
+                        memcpy(vertex.normal, &normal.x, sizeof(vertex.normal));
+                        p = end;
+                    }
+
+                    if (*p != ' ' && *p != '\t' && !endOfLine(p))
+                        throw Adore::AdoreException("Malformed face in " + path);
+
+                    face.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+                    mesh.vertices.push_back(vertex);
+                }
+
+                // Polygons become fans.
+                for (size_t k = 2; k < face.size(); k++)
+                    mesh.indices.insert(mesh.indices.end(), { face[0], face[k - 1], face[k] });
+            }
+
+            while (*p && *p != '\n') p++;
+            if (*p) p++;
+        }
+
+        return mesh;
+    }
+
+    struct Gltf
+    {
+        Json json;
+        std::vector<std::pair<char const *, size_t>> buffers;
+        std::vector<std::unique_ptr<MappedFile>> files;
+        std::vector<std::vector<char>> decoded;
+    };
+
+    std::vector<char> base64(char const * text, size_t const& size)
+    {
+        auto value = [](char const& c) -> int
+        {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+') return 62;
+            if (c == '/') return 63;
+            return -1;
+        };
+
+        std::vector<char> bytes;
+        bytes.reserve(size / 4 * 3);
+
+        uint32_t bits = 0;
+        unsigned int count = 0;
+
+        for (size_t i = 0; i < size && text[i] != '='; i++)
+        {
+            int v = value(text[i]);
+            if (v < 0) throw Adore::AdoreException("Malformed base64 buffer in glTF.");
+
+            bits = bits << 6 | v;
+            if (++count == 4)
+            {
+                bytes.push_back(static_cast<char>(bits >> 16));
+                bytes.push_back(static_cast<char>(bits >> 8));
+                bytes.push_back(static_cast<char>(bits));
+                bits = 0;
+                count = 0;
+            }
+        }
+
+        if (count == 2) bytes.push_back(static_cast<char>(bits >> 4));
+        if (count == 3)
+        {
+            bytes.push_back(static_cast<char>(bits >> 10));
+            bytes.push_back(static_cast<char>(bits >> 2));
+        }
+
+        return bytes;
+    }
+
+    std::string decodeUri(std::string const& uri)
+    {
+        std::string path;
+
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size())
+            {
+                path += static_cast<char>(std::strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+                i += 2;
+            }
+            else
+                path += uri[i];
+        }
+
+        return path;
+    }
+
+    void loadBuffers(Gltf& gltf, std::string const& directory, char const * binary, size_t const& binarySize)
+    {
+        Json const& buffers = gltf.json["buffers"];
+        gltf.decoded.reserve(buffers.size());
+
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            Json const& buffer = buffers[i];
+            size_t length = static_cast<size_t>(buffer["byteLength"].number());
+            std::string const& uri = buffer["uri"].string();
+            std::pair<char const *, size_t> data;
+
+            if (buffer["uri"].isNull())
+            {
+                if (i != 0 || !binary) throw Adore::AdoreException("glTF buffer has no data.");
+                data = { binary, binarySize };
+            }
+            else if (uri.compare(0, 5, "data:") == 0)
+            {
+                size_t start = uri.find("base64,");
+                if (start == std::string::npos) throw Adore::AdoreException("glTF data URI is not base64.");
+
+                gltf.decoded.push_back(base64(uri.data() + start + 7, uri.size() - start - 7));
+                data = { gltf.decoded.back().data(), gltf.decoded.back().size() };
+            }
+            else
+            {
+                gltf.files.push_back(std::make_unique<MappedFile>(directory + decodeUri(uri)));
+                data = { static_cast<char const *>(gltf.files.back()->data()), gltf.files.back()->size() };
+            }
+
+            if (length > data.second) throw Adore::AdoreException("glTF buffer is shorter than its byteLength.");
+            gltf.buffers.push_back({ data.first, length });
+        }
+    }
+
+    struct Accessor
+    {
+        char const * data = nullptr;
+        size_t stride = 0;
+        size_t count = 0;
+        uint32_t componentType = 0;
+        bool normalized = false;
+    };
+
+    size_t componentSize(uint32_t const& componentType)
+    {
+        switch (componentType)
+        {
+            case 5120: case 5121: return 1;
+            case 5122: case 5123: return 2;
+            case 5125: case 5126: return 4;
+            default: throw Adore::AdoreException("Unknown glTF component type.");
+        }
+    }
+
+    Accessor accessor(Gltf const& gltf, Json const& index, uint32_t const& components)
+    {
+        Json const& json = gltf.json["accessors"][static_cast<size_t>(index.number(-1))];
+        if (json.isNull()) throw Adore::AdoreException("glTF refers to a missing accessor.");
+        if (!json["sparse"].isNull()) throw Adore::AdoreException("Sparse glTF accessors are not supported.");
+
+        static char const * const types[] = { "SCALAR", "VEC2", "VEC3", "VEC4" };
+        if (json["type"].string() != types[components - 1])
+            throw Adore::AdoreException("glTF accessor has the wrong type, expected " + std::string(types[components - 1]));
+
+        Accessor result;
+        result.count = static_cast<size_t>(json["count"].number());
+        result.componentType = static_cast<uint32_t>(json["componentType"].number());
+        result.normalized = json["normalized"].boolean();
+
+        size_t elementSize = componentSize(result.componentType) * components;
+        if (json["bufferView"].isNull()) return result;
+
+        Json const& view = gltf.json["bufferViews"][static_cast<size_t>(json["bufferView"].number(-1))];
+        size_t buffer = static_cast<size_t>(view["buffer"].number(-1));
+        if (view.isNull() || buffer >= gltf.buffers.size())
+            throw Adore::AdoreException("glTF accessor refers to a missing buffer.");
+
+        size_t viewOffset = static_cast<size_t>(view["byteOffset"].number());
+        size_t viewLength = static_cast<size_t>(view["byteLength"].number());
+        size_t offset = static_cast<size_t>(json["byteOffset"].number());
+        result.stride = static_cast<size_t>(view["byteStride"].number(static_cast<double>(elementSize)));
+
+        bool inside = viewOffset <= gltf.buffers[buffer].second
+                   && viewLength <= gltf.buffers[buffer].second - viewOffset
+                   && result.count <= viewLength && result.stride <= viewLength
+                   && (result.count == 0 || offset + result.stride * (result.count - 1) + elementSize <= viewLength);
+
+        if (!inside) throw Adore::AdoreException("glTF accessor is out of bounds of its buffer.");
+
+        result.data = gltf.buffers[buffer].first + viewOffset + offset;
+        return result;
+    }
+
+    // Normalised integers become [0, 1] or [-1, 1], anything else keeps its value.
+    double component(Accessor const& accessor, size_t const& element, uint32_t const& c)
+    {
+        if (!accessor.data) return 0.0;
+
+        char const * p = accessor.data + element * accessor.stride + c * componentSize(accessor.componentType);
+
+        auto read = [p](auto value)
+        {
+            memcpy(&value, p, sizeof(value));
+            return value;
+        };
+
+        switch (accessor.componentType)
+        {
+            case 5120:
+                return accessor.normalized ? std::max(read(int8_t()) / 127.0, -1.0) : read(int8_t());
+            case 5121:
+                return accessor.normalized ? read(uint8_t()) / 255.0 : read(uint8_t());
+            case 5122:
+                return accessor.normalized ? std::max(read(int16_t()) / 32767.0, -1.0) : read(int16_t());
+            case 5123:
+                return accessor.normalized ? read(uint16_t()) / 65535.0 : read(uint16_t());
+            case 5125:
+                return read(uint32_t());
+            default:
+                return read(float());
+        }
+    }
+
+    glm::mat4 nodeTransform(Json const& node)
+    {
+        glm::mat4 transform(1.0f);
+        Json const& matrix = node["matrix"];
+
+        if (matrix.size() == 16)
+        {
+            for (size_t i = 0; i < 4; i++)
+                for (size_t j = 0; j < 4; j++)
+                    transform[i][j] = static_cast<float>(matrix[i * 4 + j].number());
+
+            return transform;
+        }
+
+        // Quaternion as x, y, z, w.
+        float t[3], q[4], s[3];
+        for (size_t i = 0; i < 4; i++)
+        {
+            q[i] = static_cast<float>(node["rotation"][i].number(i == 3 ? 1.0 : 0.0));
+            if (i == 3) break;
+            t[i] = static_cast<float>(node["translation"][i].number());
+            s[i] = static_cast<float>(node["scale"][i].number(1.0));
+        }
+
+        float x = q[0], y = q[1], z = q[2], w = q[3];
+        glm::vec3 columns[3] = {
+            glm::vec3(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w)),
+            glm::vec3(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w)),
+            glm::vec3(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y))
+        };
+
+        for (int i = 0; i < 3; i++)
+            transform[i] = glm::vec4(columns[i] * s[i], 0.0f);
+        transform[3] = glm::vec4(t[0], t[1], t[2], 1.0f);
+
+        return transform;
+    }
+
+    void addMesh(Gltf const& gltf, size_t const& index, glm::mat4 const& world, Adore::ImportedMesh& mesh)
+    {
+        Json const& json = gltf.json["meshes"][index];
+        if (json.isNull()) throw Adore::AdoreException("glTF node refers to a missing mesh.");
+
+        glm::mat3 basis(world);
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(basis));
+        // Mirroring transforms turn triangles inside out.
+        bool flip = glm::dot(glm::cross(basis[0], basis[1]), basis[2]) < 0.0f;
+
+        Json const& primitives = json["primitives"];
+
+        for (size_t p = 0; p < primitives.size(); p++)
+        {
+            Json const& primitive = primitives[p];
+
+            if (primitive["mode"].number(4) != 4)
+            {
+                ADORE_INTERNAL_LOG(WARN, "Skipped a glTF primitive that is not a triangle list.");
+                continue;
+            }
+
+            Json const& attributes = primitive["attributes"];
+            if (attributes["POSITION"].isNull()) throw Adore::AdoreException("glTF primitive has no positions.");
+
+            Accessor positions = accessor(gltf, attributes["POSITION"], 3);
+            Accessor normals = attributes["NORMAL"].isNull() ? Accessor() : accessor(gltf, attributes["NORMAL"], 3);
+            Accessor uvs = attributes["TEXCOORD_0"].isNull() ? Accessor() : accessor(gltf, attributes["TEXCOORD_0"], 2);
+
+            if ((normals.data && normals.count < positions.count) || (uvs.data && uvs.count < positions.count))
+                throw Adore::AdoreException("glTF primitive has fewer attributes than positions.");
+
+            uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+
+            for (size_t v = 0; v < positions.count; v++)
+            {
+                Adore::ImportedVertex vertex {};
+                glm::vec4 p = world * glm::vec4(static_cast<float>(component(positions, v, 0)),
+                                                static_cast<float>(component(positions, v, 1)),
+                                                static_cast<float>(component(positions, v, 2)), 1.0f);
+                vertex.position[0] = p.x;
+                vertex.position[1] = p.y;
+                vertex.position[2] = p.z;
+
+                glm::vec3 n = normalMatrix * glm::vec3(static_cast<float>(component(normals, v, 0)),
+                                                       static_cast<float>(component(normals, v, 1)),
+                                                       static_cast<float>(component(normals, v, 2)));
+                if (glm::length(n) > 0.0f)
+                {
+                    n = glm::normalize(n);
+                    vertex.normal[0] = n.x;
+                    vertex.normal[1] = n.y;
+                    vertex.normal[2] = n.z;
+                }
+
+                vertex.uv[0] = static_cast<float>(component(uvs, v, 0));
+                vertex.uv[1] = static_cast<float>(component(uvs, v, 1));
+                mesh.vertices.push_back(vertex);
+            }
+
+            size_t first = mesh.indices.size();
+
+            if (primitive["indices"].isNull())
+            {
+                for (size_t v = 0; v < positions.count; v++)
+                    mesh.indices.push_back(base + static_cast<uint32_t>(v));
+            }
+            else
+            {
+                Accessor indices = accessor(gltf, primitive["indices"], 1);
+                if (indices.componentType == 5126) throw Adore::AdoreException("glTF indices are not integers.");
+
+                for (size_t i = 0; i < indices.count; i++)
+                {
+                    double index = component(indices, i, 0);
+                    if (index >= positions.count) throw Adore::AdoreException("glTF index is out of range.");
+                    mesh.indices.push_back(base + static_cast<uint32_t>(index));
+                }
+            }
+
+            if ((mesh.indices.size() - first) % 3 != 0)
+                throw Adore::AdoreException("glTF triangle list has a partial triangle.");
+
+            if (flip)
+                for (size_t i = first; i < mesh.indices.size(); i += 3)
+                    std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+    }
+
+    void addNode(Gltf const& gltf, Json const& index, glm::mat4 const& parent, Adore::ImportedMesh& mesh,
+                 unsigned int const& depth)
+    {
+        Json const& node = gltf.json["nodes"][static_cast<size_t>(index.number(-1))];
+        if (node.isNull()) throw Adore::AdoreException("glTF refers to a missing node.");
+        if (depth > 64) throw Adore::AdoreException("glTF node hierarchy is too deep or has a cycle.");
+
+        glm::mat4 world = parent * nodeTransform(node);
+
+        if (!node["mesh"].isNull()) addMesh(gltf, static_cast<size_t>(node["mesh"].number()), world, mesh);
+
+        Json const& children = node["children"];
+        for (size_t i = 0; i < children.size(); i++)
+            addNode(gltf, children[i], world, mesh, depth + 1);
+    }
+
+    uint32_t readUint32(char const * p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    Adore::ImportedMesh loadGltf(std::string const& path)
+    {
+        MappedFile file(path);
+        auto bytes = static_cast<char const *>(file.data());
+        size_t size = file.size();
+
+        char const * json = bytes;
+        size_t jsonSize = size;
+        char const * binary = nullptr;
+        size_t binarySize = 0;
+
+        // Binary glTF: a header, then a JSON chunk and optionally a BIN chunk.
+        if (size >= 12 && readUint32(bytes) == 0x46546C67)
+        {
+            if (readUint32(bytes + 4) != 2) throw Adore::AdoreException("Only glTF 2.0 is supported: " + path);
+
+            json = nullptr;
+            size_t offset = 12;
+
+            while (offset + 8 <= size)
+            {
+                size_t length = readUint32(bytes + offset);
+                uint32_t type = readUint32(bytes + offset + 4);
+                offset += 8;
+
+                if (length > size - offset) throw Adore::AdoreException("GLB chunk is out of bounds: " + path);
+
+                if (type == 0x4E4F534A && !json)
+                {
+                    json = bytes + offset;
+                    jsonSize = length;
+                }
+                else if (type == 0x004E4942 && !binary)
+                {
+                    binary = bytes + offset;
+                    binarySize = length;
+                }
+
+                offset += length;
+            }
+
+            if (!json) throw Adore::AdoreException("GLB has no JSON chunk: " + path);
+        }
+
+        Gltf gltf;
+        gltf.json = Json::parse(json, jsonSize);
+
+        size_t slash = path.find_last_of("/\\");
+        loadBuffers(gltf, slash == std::string::npos ? "" : path.substr(0, slash + 1), binary, binarySize);
+
+        Adore::ImportedMesh mesh;
+        Json const& scenes = gltf.json["scenes"];
+
+        if (scenes.size() == 0)
+        {
+            for (size_t i = 0; i < gltf.json["meshes"].size(); i++)
+                addMesh(gltf, i, glm::mat4(1.0f), mesh);
+        }
+        else
+        {
+            Json const& scene = scenes[static_cast<size_t>(gltf.json["scene"].number())];
+            for (size_t i = 0; i < scene["nodes"].size(); i++)
+                addNode(gltf, scene["nodes"][i], glm::mat4(1.0f), mesh, 0);
+        }
+
+        return mesh;
+    }
+}
+
+namespace Adore
+{
+    ImportedMesh importMesh(std::string const& path)
+    {
+        size_t dot = path.find_last_of('.');
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        ImportedMesh mesh;
+
+        if (extension == "obj")
+            mesh = loadObj(path);
+        else if (extension == "gltf" || extension == "glb")
+            mesh = loadGltf(path);
+        else
+            throw AdoreException("Unsupported mesh format: " + path);
+
+        generateNormals(mesh);
+        deduplicate(mesh);
+
+        ADORE_INTERNAL_LOG(INFO, "Imported " + path + ": " + std::to_string(mesh.vertices.size()) + " vertices, "
+                                 + std::to_string(mesh.indices.size() / 3) + " triangles.");
+
+        return mesh;
+    }
+
+    void deduplicate(ImportedMesh& mesh)
+    {
+        checkIndices(mesh.indices, mesh.vertices.size());
+
+        std::unordered_map<ImportedVertex, uint32_t, VertexHash, VertexEqual> unique;
+        unique.reserve(mesh.vertices.size());
+        std::vector<ImportedVertex> vertices;
+
+        for (auto& index : mesh.indices)
+        {
+            auto inserted = unique.emplace(mesh.vertices[index], static_cast<uint32_t>(vertices.size()));
+            if (inserted.second) vertices.push_back(mesh.vertices[index]);
+
+            index = inserted.first->second;
+        }
+
+        mesh.vertices = std::move(vertices);
+    }
+
+    void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t const& vertexCount, uint32_t const& cacheSize)
+    {
+        checkIndices(indices, vertexCount);
+        indices = tipsify(indices, vertexCount, cacheSize, nullptr);
+    }
+
+    void optimizeOverdraw(std::vector<uint32_t>& indices, std::vector<ImportedVertex> const& vertices,
+                          uint32_t const& cacheSize, float const& threshold)
+    {
+        checkIndices(indices, vertices.size());
+
+        uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+        size_t triangles = indices.size() / 3;
+        if (triangles == 0) return;
+
+        std::vector<size_t> hard = { 0 };
+        std::vector<uint32_t> ordered = tipsify(indices, vertexCount, cacheSize, &hard);
+        hard.push_back(triangles);
+
+        // Cuts that keep the cluster's own misses low enough cost little cache efficiency.
+        float limit = threshold * acmr(ordered, cacheSize);
+        std::vector<size_t> clusters;
+        FifoCache cache(vertexCount, cacheSize);
+
+        for (size_t h = 0; h + 1 < hard.size(); h++)
+        {
+            size_t start = hard[h];
+            size_t misses = 0;
+            clusters.push_back(start);
+            cache.flush();
+
+            for (size_t t = hard[h]; t < hard[h + 1]; t++)
+            {
+                for (unsigned int k = 0; k < 3; k++)
+                    misses += cache.miss(ordered[3 * t + k]);
+
+                if (t + 1 < hard[h + 1] && misses <= limit * (t + 1 - start))
+                {
+                    start = t + 1;
+                    misses = 0;
+                    clusters.push_back(start);
+                    cache.flush();
+                }
+            }
+        }
+
+        clusters.push_back(triangles);
+
+        // Area weighted centroid and normal of the mesh and of each cluster.
+        auto accumulate = [&](size_t const& from, size_t const& to, glm::vec3& centroid, glm::vec3& normal)
+        {
+            float area = 0.0f;
+
+            for (size_t t = from; t < to; t++)
+            {
+                glm::vec3 a = position(vertices[ordered[3 * t]]);
+                glm::vec3 b = position(vertices[ordered[3 * t + 1]]);
+                glm::vec3 c = position(vertices[ordered[3 * t + 2]]);
+                glm::vec3 n = glm::cross(b - a, c - a);
+                float weight = glm::length(n);
+
+                centroid += (a + b + c) * (weight / 3.0f);
+                normal += n;
+                area += weight;
+            }
+
+            if (area > 0.0f) centroid = centroid / area;
+        };
+
+        glm::vec3 meshCentroid(0.0f), meshNormal(0.0f);
+        accumulate(0, triangles, meshCentroid, meshNormal);
+
+        std::vector<std::pair<float, size_t>> order;
+        for (size_t c = 0; c + 1 < clusters.size(); c++)
+        {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            accumulate(clusters[c], clusters[c + 1], centroid, normal);
+
+            float length = glm::length(normal);
+            float outward = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+            order.push_back({ -outward, c });
+        }
+
+        std::stable_sort(order.begin(), order.end(),
+                         [](auto const& a, auto const& b) { return a.first < b.first; });
+
+        indices.clear();
+        for (auto const& cluster : order)
+            indices.insert(indices.end(), ordered.begin() + 3 * clusters[cluster.second],
+                           ordered.begin() + 3 * clusters[cluster.second + 1]);
+    }
+
+    void optimizeVertexFetch(ImportedMesh& mesh)
+    {
+        checkIndices(mesh.indices, mesh.vertices.size());
+
+        std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+        std::vector<ImportedVertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+
+        for (auto& index : mesh.indices)
+        {
+            if (remap[index] == UINT32_MAX)
+            {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        mesh.vertices = std::move(vertices);
+    }
+
+    void optimize(ImportedMesh& mesh, uint32_t const& cacheSize, float const& threshold)
+    {
+        optimizeOverdraw(mesh.indices, mesh.vertices, cacheSize, threshold);
+        optimizeVertexFetch(mesh);
+    }
+
+    float acmr(std::vector<uint32_t> const& indices, uint32_t const& cacheSize)
+    {
+        if (indices.size() < 3) return 0.0f;
+
+        FifoCache cache(*std::max_element(indices.begin(), indices.end()) + size_t(1), cacheSize);
+        size_t misses = 0;
+
+        for (auto const& index : indices)
+            misses += cache.miss(index);
+
+        return static_cast<float>(misses) / (indices.size() / 3);
+    }
+
+    LayoutDescriptor vertexLayout(VertexStreams const& streams)
+    {
+        LayoutDescriptor layout;
+
+        if (streams == VertexStreams::INTERLEAVED)
+        {
+            layout.attributes = {
+                { 0, 0, offsetof(ImportedVertex, position), AttributeFormat::VEC3_FLOAT },
+                { 0, 1, offsetof(ImportedVertex, normal), AttributeFormat::VEC3_FLOAT },
+                { 0, 2, offsetof(ImportedVertex, uv), AttributeFormat::VEC2_FLOAT }
+            };
+            layout.bindings = { { 0, sizeof(ImportedVertex) } };
+        }
+        else if (streams == VertexStreams::SPLIT)
+        {
+            layout.attributes = {
+                { 0, 0, 0, AttributeFormat::VEC3_FLOAT },
+                { 1, 1, 0, AttributeFormat::VEC3_FLOAT },
+                { 1, 2, sizeof(float) * 3, AttributeFormat::VEC2_FLOAT }
+            };
+            layout.bindings = { { 0, sizeof(float) * 3 }, { 1, sizeof(float) * 5 } };
+        }
+        else
+        {
+            layout.attributes = {
+                { 0, 0, 0, AttributeFormat::VEC3_FLOAT },
+                { 1, 1, 0, AttributeFormat::A2B10G10R10_SNORM },
+                { 1, 2, sizeof(uint32_t), AttributeFormat::VEC2_HALF }
+            };
+            layout.bindings = { { 0, sizeof(float) * 3 }, { 1, sizeof(uint32_t) * 2 } };
+        }
+
+        return layout;
+    }
+
+    std::shared_ptr<Mesh> createMesh(std::shared_ptr<Renderer>& renderer, ImportedMesh const& mesh,
+                                     VertexStreams const& streams, uint32_t const& maxLevels,
+                                     float const& reduction)
+    {
+        checkIndices(mesh.indices, mesh.vertices.size());
+
+        if (mesh.vertices.empty() || mesh.indices.empty())
+            throw AdoreException("Imported mesh is empty.");
+
+        if (mesh.vertices.size() > 65536)
+            throw AdoreException("Imported mesh has more than 65536 vertices, split it to address them with 16 bit indices.");
+
+        uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+
+        MeshLods lods;
+        if (maxLevels > 1)
+            lods = Mesh::simplify(mesh.vertices.data(), vertexCount, sizeof(ImportedVertex), indices, maxLevels, reduction);
+        else
+            lods = { indices, { { 0, static_cast<uint32_t>(indices.size()), 0.0f } } };
+
+        // Simplified levels come out in whatever order the collapses left them.
+        for (size_t i = 1; i < lods.levels.size(); i++)
+        {
+            auto first = lods.indices.begin() + lods.levels[i].firstIndex;
+            auto last = first + lods.levels[i].indexCount;
+
+            std::vector<uint32_t> level(first, last);
+            optimizeVertexCache(level, vertexCount);
+            std::copy(level.begin(), level.end(), first);
+        }
+
+        if (streams == VertexStreams::INTERLEAVED)
+            return Mesh::create(renderer, mesh.vertices.data(), vertexCount, sizeof(ImportedVertex), lods);
+
+        std::vector<float> positions;
+        positions.reserve(vertexCount * 3);
+        for (auto const& vertex : mesh.vertices)
+            positions.insert(positions.end(), vertex.position, vertex.position + 3);
+
+        // Both attribute streams are written straight from the imported vertices.
+        LayoutDescriptor layout = vertexLayout(streams);
+        uint32_t stride = layout.bindings[1].stride;
+        std::vector<char> attributes(static_cast<size_t>(vertexCount) * stride);
+
+        quantize(layout.attributes[1].format, attributes.data() + layout.attributes[1].offset, stride,
+                 mesh.vertices[0].normal, sizeof(ImportedVertex), 3, vertexCount);
+        quantize(layout.attributes[2].format, attributes.data() + layout.attributes[2].offset, stride,
+                 mesh.vertices[0].uv, sizeof(ImportedVertex), 2, vertexCount);
+
+        return Mesh::create(renderer, positions.data(), vertexCount, sizeof(float) * 3,
+                            attributes.data(), stride, lods);
+    }
+}
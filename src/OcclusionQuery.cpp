@@ -0,0 +1,18 @@
+#include <Adore/OcclusionQuery.hpp>
+
+#include <Adore/Internal/Vulkan/OcclusionQuery.hpp>
+#include <Adore/Internal/Log.hpp>
+
+namespace Adore
+{
+    std::shared_ptr<OcclusionQuery> OcclusionQuery::create(std::shared_ptr<Renderer>& renderer, uint32_t const& count)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanOcclusionQuery>(renderer, count);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+}
@@ -0,0 +1,417 @@
+#include <Adore/Quantize.hpp>
+#include <Adore/Internal/Quantize.hpp>
+#include <Adore/Log.hpp>
+#include <Adore/Internal/SIMD.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef ADORE_SSE
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+using Format = Adore::AttributeFormat;
+
+namespace
+{
+    struct FormatLayout
+    {
+        uint32_t components;
+        uint32_t size;
+    };
+
+    FormatLayout layout(Format const& format)
+    {
+        switch (format)
+        {
+            case Format::FLOAT: case Format::INT: case Format::UINT:             return { 1, 4 };
+            case Format::VEC2_FLOAT: case Format::VEC2_INT: case Format::VEC2_UINT: return { 2, 8 };
+            case Format::VEC3_FLOAT: case Format::VEC3_INT: case Format::VEC3_UINT: return { 3, 12 };
+            case Format::VEC4_FLOAT: case Format::VEC4_INT: case Format::VEC4_UINT: return { 4, 16 };
+            case Format::DOUBLE:       return { 1, 8 };
+            case Format::VEC2_DOUBLE:  return { 2, 16 };
+            case Format::VEC3_DOUBLE:  return { 3, 24 };
+            case Format::VEC4_DOUBLE:  return { 4, 32 };
+            case Format::HALF:         return { 1, 2 };
+            case Format::VEC2_HALF:    return { 2, 4 };
+            case Format::VEC4_HALF:    return { 4, 8 };
+            case Format::VEC2_SNORM8:  case Format::VEC2_UNORM8:  return { 2, 2 };
+            case Format::VEC4_SNORM8:  case Format::VEC4_UNORM8:  return { 4, 4 };
+            case Format::VEC2_SNORM16: case Format::VEC2_UNORM16: return { 2, 4 };
+            case Format::VEC4_SNORM16: case Format::VEC4_UNORM16: return { 4, 8 };
+            case Format::A2B10G10R10_SNORM: case Format::A2B10G10R10_UNORM: return { 4, 4 };
+        }
+
+        return { 0, 0 };
+    }
+
+    bool isInteger(Format const& format)
+    {
+        switch (format)
+        {
+            case Format::INT: case Format::VEC2_INT: case Format::VEC3_INT: case Format::VEC4_INT:
+            case Format::UINT: case Format::VEC2_UINT: case Format::VEC3_UINT: case Format::VEC4_UINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool isDouble(Format const& format)
+    {
+        return format == Format::DOUBLE || format == Format::VEC2_DOUBLE || format == Format::VEC3_DOUBLE
+            || format == Format::VEC4_DOUBLE;
+    }
+
+    uint32_t pack1010102(int32_t const (&v)[4])
+    {
+        return (v[0] & 0x3FF) | (v[1] & 0x3FF) << 10 | (v[2] & 0x3FF) << 20 | static_cast<uint32_t>(v[3] & 0x3) << 30;
+    }
+
+    template <typename T>
+    void store(char * out, T const * values, uint32_t const& count)
+    {
+        memcpy(out, values, sizeof(T) * count);
+    }
+
+    // NaN clamps to lo, like the SSE path.
+    float clamp(float const& value, float const& lo, float const& hi)
+    {
+        float clamped = value > lo ? value : lo;
+        return clamped < hi ? clamped : hi;
+    }
+
+    int32_t snorm(float const& value, float const& max)
+    {
+        return static_cast<int32_t>(std::lrint(clamp(value, -1.0f, 1.0f) * max));
+    }
+
+    int32_t unorm(float const& value, float const& max)
+    {
+        return static_cast<int32_t>(std::lrint(clamp(value, 0.0f, 1.0f) * max));
+    }
+
+    void packScalar(Format const& format, float const (&v)[4], uint32_t const& components, char * out)
+    {
+        int32_t n[4];
+
+        switch (format)
+        {
+            case Format::HALF: case Format::VEC2_HALF: case Format::VEC4_HALF:
+            {
+                uint16_t halves[4];
+                for (uint32_t c = 0; c < components; c++) halves[c] = Adore::toHalf(v[c]);
+                return store(out, halves, components);
+            }
+            case Format::VEC2_SNORM8: case Format::VEC4_SNORM8:
+            {
+                int8_t bytes[4];
+                for (uint32_t c = 0; c < components; c++) bytes[c] = static_cast<int8_t>(snorm(v[c], 127.0f));
+                return store(out, bytes, components);
+            }
+            case Format::VEC2_UNORM8: case Format::VEC4_UNORM8:
+            {
+                uint8_t bytes[4];
+                for (uint32_t c = 0; c < components; c++) bytes[c] = static_cast<uint8_t>(unorm(v[c], 255.0f));
+                return store(out, bytes, components);
+            }
+            case Format::VEC2_SNORM16: case Format::VEC4_SNORM16:
+            {
+                int16_t shorts[4];
+                for (uint32_t c = 0; c < components; c++) shorts[c] = static_cast<int16_t>(snorm(v[c], 32767.0f));
+                return store(out, shorts, components);
+            }
+            case Format::VEC2_UNORM16: case Format::VEC4_UNORM16:
+            {
+                uint16_t shorts[4];
+                for (uint32_t c = 0; c < components; c++) shorts[c] = static_cast<uint16_t>(unorm(v[c], 65535.0f));
+                return store(out, shorts, components);
+            }
+            case Format::A2B10G10R10_SNORM:
+            {
+                for (uint32_t c = 0; c < 4; c++) n[c] = snorm(v[c], c < 3 ? 511.0f : 1.0f);
+                uint32_t packed = pack1010102(n);
+                return store(out, &packed, 1);
+            }
+            case Format::A2B10G10R10_UNORM:
+            {
+                for (uint32_t c = 0; c < 4; c++) n[c] = unorm(v[c], c < 3 ? 1023.0f : 3.0f);
+                uint32_t packed = pack1010102(n);
+                return store(out, &packed, 1);
+            }
+            default:
+                return store(out, v, components);
+        }
+    }
+
+#ifdef ADORE_SSE
+    // Half bits in the low 16 bits of each lane, sign extended so _mm_packs_epi32 keeps them.
+    // The same steps as toHalf, four at a time.
+    __m128i halves(__m128 const& value)
+    {
+        __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u))));
+        __m128 absolute = _mm_xor_ps(value, sign);
+        __m128i bits = _mm_castps_si128(absolute);
+
+        __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+        __m128i regular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), bits);
+        __m128i subnormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), bits);
+        __m128i special = _mm_or_si128(_mm_and_si128(nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+        __m128i magic = _mm_set1_epi32(0x3F000000);
+        __m128i small = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(magic))), magic);
+
+        __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 18), 31);
+        __m128i rounded = _mm_sub_epi32(_mm_add_epi32(bits, _mm_set1_epi32(static_cast<int>(0xC8000FFFu))), odd);
+        __m128i normal = _mm_srli_epi32(rounded, 13);
+
+        __m128i finite = _mm_or_si128(_mm_and_si128(subnormal, small), _mm_andnot_si128(subnormal, normal));
+        __m128i result = _mm_or_si128(_mm_and_si128(regular, finite), _mm_andnot_si128(regular, special));
+
+        return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+    }
+
+    __m128i normalise(__m128 const& value, __m128 const& lo, __m128 const& max)
+    {
+        return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(value, lo), _mm_set1_ps(1.0f)), max));
+    }
+
+    // Writes vertices of size bytes, spacing bytes apart in registers, stride bytes apart at out.
+    void scatter(char * out, uint32_t const& stride, __m128i const (&packed)[4], uint32_t const& spacing,
+                 uint32_t const& size, uint32_t const& vertices)
+    {
+        alignas(16) char bytes[64];
+        for (uint32_t r = 0; r < 4; r++)
+            _mm_store_si128(reinterpret_cast<__m128i *>(bytes + 16 * r), packed[r]);
+
+        for (uint32_t k = 0; k < vertices; k++)
+            memcpy(out + k * stride, bytes + k * spacing, size);
+    }
+
+    // Four vertices at a time, so their packs share registers and the format is switched on
+    // once per group. Lanes past vertices are padding and are not written.
+    void packSSE(Format const& format, __m128 (&v)[4], uint32_t const& size, char * out, uint32_t const& stride,
+                 uint32_t const& vertices)
+    {
+        __m128 const zero = _mm_setzero_ps();
+        __m128 const minusOne = _mm_set1_ps(-1.0f);
+        __m128i packed[4] = {};
+        __m128i n[4];
+
+        switch (format)
+        {
+            case Format::HALF: case Format::VEC2_HALF: case Format::VEC4_HALF:
+            {
+                for (uint32_t k = 0; k < 4; k++) n[k] = halves(v[k]);
+                packed[0] = _mm_packs_epi32(n[0], n[1]);
+                packed[1] = _mm_packs_epi32(n[2], n[3]);
+                return scatter(out, stride, packed, 8, size, vertices);
+            }
+            case Format::VEC2_SNORM8: case Format::VEC4_SNORM8:
+            {
+                for (uint32_t k = 0; k < 4; k++) n[k] = normalise(v[k], minusOne, _mm_set1_ps(127.0f));
+                packed[0] = _mm_packs_epi16(_mm_packs_epi32(n[0], n[1]), _mm_packs_epi32(n[2], n[3]));
+                return scatter(out, stride, packed, 4, size, vertices);
+            }
+            case Format::VEC2_UNORM8: case Format::VEC4_UNORM8:
+            {
+                for (uint32_t k = 0; k < 4; k++) n[k] = normalise(v[k], zero, _mm_set1_ps(255.0f));
+                packed[0] = _mm_packus_epi16(_mm_packs_epi32(n[0], n[1]), _mm_packs_epi32(n[2], n[3]));
+                return scatter(out, stride, packed, 4, size, vertices);
+            }
+            case Format::VEC2_SNORM16: case Format::VEC4_SNORM16:
+            {
+                for (uint32_t k = 0; k < 4; k++) n[k] = normalise(v[k], minusOne, _mm_set1_ps(32767.0f));
+                packed[0] = _mm_packs_epi32(n[0], n[1]);
+                packed[1] = _mm_packs_epi32(n[2], n[3]);
+                return scatter(out, stride, packed, 8, size, vertices);
+            }
+            case Format::VEC2_UNORM16: case Format::VEC4_UNORM16:
+            {
+                // SSE2 only packs with signed saturation, so shift into the signed range and back.
+                __m128i bias = _mm_set1_epi32(32768);
+                __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+                for (uint32_t k = 0; k < 4; k++) n[k] = _mm_sub_epi32(normalise(v[k], zero, _mm_set1_ps(65535.0f)), bias);
+                packed[0] = _mm_xor_si128(_mm_packs_epi32(n[0], n[1]), flip);
+                packed[1] = _mm_xor_si128(_mm_packs_epi32(n[2], n[3]), flip);
+                return scatter(out, stride, packed, 8, size, vertices);
+            }
+            case Format::A2B10G10R10_SNORM: case Format::A2B10G10R10_UNORM:
+            {
+                // Transposed, each register holds one component of all four vertices.
+                _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+
+                bool signedNormal = format == Format::A2B10G10R10_SNORM;
+                __m128 lo = signedNormal ? minusOne : zero;
+                __m128 max = _mm_set1_ps(signedNormal ? 511.0f : 1023.0f);
+                __m128 alphaMax = _mm_set1_ps(signedNormal ? 1.0f : 3.0f);
+                __m128i mask = _mm_set1_epi32(0x3FF);
+
+                __m128i x = _mm_and_si128(normalise(v[0], lo, max), mask);
+                __m128i y = _mm_slli_epi32(_mm_and_si128(normalise(v[1], lo, max), mask), 10);
+                __m128i z = _mm_slli_epi32(_mm_and_si128(normalise(v[2], lo, max), mask), 20);
+                __m128i w = _mm_slli_epi32(normalise(v[3], lo, alphaMax), 30);
+
+                packed[0] = _mm_or_si128(_mm_or_si128(x, y), _mm_or_si128(z, w));
+                return scatter(out, stride, packed, 4, size, vertices);
+            }
+            default:
+            {
+                for (uint32_t k = 0; k < 4; k++) packed[k] = _mm_castps_si128(v[k]);
+                return scatter(out, stride, packed, 16, size, vertices);
+            }
+        }
+    }
+#endif
+
+    // The components of one attribute, filled in the way Vulkan fills in missing ones.
+    template <typename Source, typename T>
+    void attribute(char const * in, uint32_t const& components, T (&values)[4])
+    {
+        Source read[4] = { 0, 0, 0, 1 };
+        memcpy(read, in, sizeof(Source) * components);
+        for (uint32_t c = 0; c < 4; c++) values[c] = static_cast<T>(read[c]);
+    }
+
+    // simd picks the SSE path where there is one, the results are the same either way.
+    template <typename Source>
+    void convert(Format const& format, char * destination, uint32_t const& destinationStride,
+                 char const * source, uint32_t const& sourceStride, uint32_t const& components, size_t const& count,
+                 bool const& simd = true)
+    {
+        FormatLayout formatLayout = layout(format);
+
+        if (components == 0 || components > formatLayout.components)
+            throw Adore::AdoreException("Quantising " + std::to_string(components) + " components into a format with "
+                                        + std::to_string(formatLayout.components) + ".");
+
+        if (isInteger(format))
+            throw Adore::AdoreException("Only float, half, normalised and packed attributes can be quantised.");
+
+        if (isDouble(format))
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                double doubles[4];
+                attribute<Source>(source + i * sourceStride, components, doubles);
+                store(destination + i * destinationStride, doubles, formatLayout.components);
+            }
+            return;
+        }
+
+#ifdef ADORE_SSE
+        for (size_t i = 0; simd && i < count; i += 4)
+        {
+            uint32_t vertices = static_cast<uint32_t>(std::min<size_t>(count - i, 4));
+            __m128 v[4];
+
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                float values[4] = { 0, 0, 0, 0 };
+                if (k < vertices) attribute<Source>(source + (i + k) * sourceStride, components, values);
+                v[k] = _mm_loadu_ps(values);
+            }
+
+            packSSE(format, v, formatLayout.size, destination + i * destinationStride, destinationStride, vertices);
+        }
+        if (simd) return;
+#endif
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float v[4];
+            attribute<Source>(source + i * sourceStride, components, v);
+            packScalar(format, v, formatLayout.components, destination + i * destinationStride);
+        }
+    }
+}
+
+namespace Adore
+{
+    uint32_t attributeSize(AttributeFormat const& format)
+    {
+        return layout(format).size;
+    }
+
+    uint16_t toHalf(float const& value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+        uint32_t half;
+
+        if (bits >= 0x47800000u)
+        {
+            // Too large for a half, infinity or NaN.
+            half = bits > 0x7F800000u ? 0x7E00 : 0x7C00;
+        }
+        else if (bits < 0x38800000u)
+        {
+            // Subnormal: adding 0.5 lines the mantissa up so the FPU does the rounding.
+            float magic = 0.5f, shifted;
+            memcpy(&shifted, &bits, sizeof(shifted));
+            shifted += magic;
+            memcpy(&half, &shifted, sizeof(half));
+            half -= 0x3F000000u;
+        }
+        else
+        {
+            // Rebias the exponent, then round half to even on the dropped 13 bits.
+            uint32_t odd = (bits >> 13) & 1;
+            half = (bits + 0xC8000FFFu + odd) >> 13;
+        }
+
+        return static_cast<uint16_t>(half | sign >> 16);
+    }
+
+    float fromHalf(uint16_t const& value)
+    {
+        uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1F;
+        uint32_t mantissa = value & 0x3FF;
+        uint32_t bits;
+
+        if (exponent == 0x1F)
+            bits = sign | 0x7F800000u | mantissa << 13;
+        else if (exponent != 0)
+            bits = sign | (exponent + 112) << 23 | mantissa << 13;
+        else
+        {
+            float subnormal = mantissa * 5.9604644775390625e-8f;
+            memcpy(&bits, &subnormal, sizeof(bits));
+            bits |= sign;
+        }
+
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void quantize(AttributeFormat const& format, void * destination, uint32_t const& destinationStride,
+                  float const * source, uint32_t const& sourceStride, uint32_t const& components,
+                  size_t const& count)
+    {
+        convert<float>(format, static_cast<char *>(destination), destinationStride,
+                       reinterpret_cast<char const *>(source), sourceStride, components, count);
+    }
+
+    void quantize(AttributeFormat const& format, void * destination, uint32_t const& destinationStride,
+                  double const * source, uint32_t const& sourceStride, uint32_t const& components,
+                  size_t const& count)
+    {
+        convert<double>(format, static_cast<char *>(destination), destinationStride,
+                        reinterpret_cast<char const *>(source), sourceStride, components, count);
+    }
+}
+
+void quantizeScalar(Adore::AttributeFormat const& format, void * destination, uint32_t const& destinationStride,
+                    float const * source, uint32_t const& sourceStride, uint32_t const& components,
+                    size_t const& count)
+{
+    convert<float>(format, static_cast<char *>(destination), destinationStride,
+                   reinterpret_cast<char const *>(source), sourceStride, components, count, false);
+}
@@ -0,0 +1,423 @@
+#include <Adore/Reflection.hpp>
+
+#include <Adore/Internal/SPIRV.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+// The subset of the SPIR-V specification the interface of a module needs.
+namespace
+{
+    uint32_t const MAGIC = 0x07230203;
+
+    enum Op : uint16_t
+    {
+        OP_DECORATE = 71,
+        OP_MEMBER_DECORATE = 72,
+        OP_TYPE_BOOL = 20,
+        OP_TYPE_INT = 21,
+        OP_TYPE_FLOAT = 22,
+        OP_TYPE_VECTOR = 23,
+        OP_TYPE_MATRIX = 24,
+        OP_TYPE_IMAGE = 25,
+        OP_TYPE_SAMPLER = 26,
+        OP_TYPE_SAMPLED_IMAGE = 27,
+        OP_TYPE_ARRAY = 28,
+        OP_TYPE_RUNTIME_ARRAY = 29,
+        OP_TYPE_STRUCT = 30,
+        OP_TYPE_POINTER = 32,
+        OP_CONSTANT = 43,
+        OP_SPEC_CONSTANT_TRUE = 48,
+        OP_SPEC_CONSTANT_FALSE = 49,
+        OP_SPEC_CONSTANT = 50,
+        OP_VARIABLE = 59
+    };
+
+    enum Decoration : uint32_t
+    {
+        SPEC_ID = 1,
+        BLOCK = 2,
+        BUFFER_BLOCK = 3,
+        ARRAY_STRIDE = 6,
+        MATRIX_STRIDE = 7,
+        BUILT_IN = 11,
+        LOCATION = 30,
+        BINDING = 33,
+        DESCRIPTOR_SET = 34,
+        OFFSET = 35
+    };
+
+    enum StorageClass : uint32_t
+    {
+        UNIFORM_CONSTANT = 0,
+        INPUT = 1,
+        UNIFORM = 2,
+        PUSH_CONSTANT = 9,
+        STORAGE_BUFFER = 12
+    };
+
+    struct Input
+    {
+        uint32_t location;
+        Adore::AttributeFormat format;
+        uint32_t size;
+    };
+
+    // Everything one module contributes, before the modules are combined.
+    struct ModuleReflection
+    {
+        std::vector<Input> inputs;
+        std::vector<Adore::ResourceLayout> resources;
+        uint32_t pushConstants = 0;
+        std::vector<Adore::SpecializationConstant> specializationConstants;
+    };
+
+    struct Id
+    {
+        uint16_t opcode = 0;
+        // Operands after the result id, or after the result type and id for constants and variables.
+        std::vector<uint32_t> operands;
+        uint32_t type = 0;
+        std::unordered_map<uint32_t, uint32_t> decorations;
+        std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> memberDecorations;
+    };
+
+    class Parser
+    {
+        std::vector<Id> m_ids;
+        Adore::ShaderType m_stage;
+
+        Id const& id(uint32_t const& index) const
+        {
+            if (index >= m_ids.size() || m_ids[index].opcode == 0)
+                throw Adore::AdoreException("SPIR-V refers to an undefined id.");
+            return m_ids[index];
+        }
+
+        static bool decorated(Id const& value, uint32_t const& decoration)
+        {
+            return value.decorations.count(decoration) != 0;
+        }
+
+        uint32_t constant(uint32_t const& index) const
+        {
+            auto const& value = id(index);
+            if (value.opcode != OP_CONSTANT && value.opcode != OP_SPEC_CONSTANT)
+                throw Adore::AdoreException("SPIR-V array length is not a constant.");
+            return value.operands[0];
+        }
+
+        // Bytes taken by a value of type inside an explicitly laid out block.
+        uint32_t size(uint32_t const& index) const
+        {
+            auto const& type = id(index);
+
+            switch (type.opcode)
+            {
+                case OP_TYPE_BOOL:
+                    return 4;
+                case OP_TYPE_INT:
+                case OP_TYPE_FLOAT:
+                    return type.operands[0] / 8;
+                case OP_TYPE_VECTOR:
+                    return size(type.operands[0]) * type.operands[1];
+                case OP_TYPE_MATRIX:
+                    return size(type.operands[0]) * type.operands[1];
+                case OP_TYPE_ARRAY:
+                {
+                    auto stride = type.decorations.find(ARRAY_STRIDE);
+                    uint32_t length = constant(type.operands[1]);
+                    return length * (stride != type.decorations.end() ? stride->second : size(type.operands[0]));
+                }
+                case OP_TYPE_STRUCT:
+                {
+                    uint32_t end = 0;
+
+                    for (uint32_t member = 0; member < type.operands.size(); member++)
+                    {
+                        auto decorations = type.memberDecorations.find(member);
+                        if (decorations == type.memberDecorations.end() || !decorations->second.count(OFFSET))
+                            throw Adore::AdoreException("SPIR-V block member has no offset.");
+
+                        uint32_t memberSize = size(type.operands[member]);
+
+                        // Matrices are laid out by their stride rather than their column size.
+                        auto const& memberType = id(type.operands[member]);
+                        if (memberType.opcode == OP_TYPE_MATRIX && decorations->second.count(MATRIX_STRIDE))
+                            memberSize = decorations->second.at(MATRIX_STRIDE) * memberType.operands[1];
+
+                        end = std::max(end, decorations->second.at(OFFSET) + memberSize);
+                    }
+
+                    return end;
+                }
+                default:
+                    throw Adore::AdoreException("SPIR-V block holds a type with no size.");
+            }
+        }
+
+        Input input(uint32_t const& location, uint32_t const& index) const
+        {
+            using Format = Adore::AttributeFormat;
+
+            auto const& type = id(index);
+            auto const& scalar = type.opcode == OP_TYPE_VECTOR ? id(type.operands[0]) : type;
+            uint32_t count = type.opcode == OP_TYPE_VECTOR ? type.operands[1] : 1;
+
+            static Format const floats[] = { Format::FLOAT, Format::VEC2_FLOAT, Format::VEC3_FLOAT, Format::VEC4_FLOAT };
+            static Format const doubles[] = { Format::DOUBLE, Format::VEC2_DOUBLE, Format::VEC3_DOUBLE, Format::VEC4_DOUBLE };
+            static Format const ints[] = { Format::INT, Format::VEC2_INT, Format::VEC3_INT, Format::VEC4_INT };
+            static Format const uints[] = { Format::UINT, Format::VEC2_UINT, Format::VEC3_UINT, Format::VEC4_UINT };
+
+            if (count < 1 || count > 4)
+                throw Adore::AdoreException("SPIR-V vertex input has an unsupported type.");
+
+            if (scalar.opcode == OP_TYPE_FLOAT && scalar.operands[0] == 32)
+                return { location, floats[count - 1], 4 * count };
+            if (scalar.opcode == OP_TYPE_FLOAT && scalar.operands[0] == 64)
+                return { location, doubles[count - 1], 8 * count };
+            if (scalar.opcode == OP_TYPE_INT && scalar.operands[0] == 32)
+                return { location, scalar.operands[1] ? ints[count - 1] : uints[count - 1], 4 * count };
+
+            throw Adore::AdoreException("SPIR-V vertex input at location " + std::to_string(location)
+                                        + " has an unsupported type.");
+        }
+
+        Adore::ResourceLayout resource(Id const& variable, uint32_t const& storage, uint32_t const& pointee) const
+        {
+            if (decorated(variable, DESCRIPTOR_SET) && variable.decorations.at(DESCRIPTOR_SET) != 0)
+                throw Adore::AdoreException("Only descriptor set 0 is supported.");
+
+            if (!decorated(variable, BINDING))
+                throw Adore::AdoreException("SPIR-V resource has no binding.");
+
+            Adore::ResourceLayout layout {};
+            layout.binding = variable.decorations.at(BINDING);
+            layout.count = 1;
+            layout.stage = m_stage;
+
+            uint32_t typeIndex = pointee;
+            while (id(typeIndex).opcode == OP_TYPE_ARRAY || id(typeIndex).opcode == OP_TYPE_RUNTIME_ARRAY)
+            {
+                if (id(typeIndex).opcode == OP_TYPE_RUNTIME_ARRAY)
+                    throw Adore::AdoreException("Unsized descriptor arrays are not supported.");
+
+                layout.count *= constant(id(typeIndex).operands[1]);
+                typeIndex = id(typeIndex).operands[0];
+            }
+
+            auto const& type = id(typeIndex);
+
+            if (storage == STORAGE_BUFFER || (storage == UNIFORM && decorated(type, BUFFER_BLOCK)))
+                layout.type = Adore::ResourceType::STORAGE_BUFFER;
+            else if (storage == UNIFORM)
+                layout.type = Adore::ResourceType::BUFFER;
+            else if (type.opcode == OP_TYPE_SAMPLED_IMAGE)
+                layout.type = Adore::ResourceType::SAMPLER;
+            // Image operands: sampled type, dim, depth, arrayed, multisampled, sampled.
+            else if (type.opcode == OP_TYPE_IMAGE && type.operands[5] == 2)
+                layout.type = Adore::ResourceType::STORAGE_IMAGE;
+            else
+                throw Adore::AdoreException("SPIR-V resource at binding " + std::to_string(layout.binding)
+                                            + " is not supported, samplers and images have to be combined.");
+
+            return layout;
+        }
+    public:
+        Parser(Adore::ShaderType const& stage) : m_stage(stage) {};
+
+        ModuleReflection parse(uint32_t const * code, size_t const& words)
+        {
+            if (words < 5 || code[0] != MAGIC)
+                throw Adore::AdoreException("Shader module is not SPIR-V.");
+
+            m_ids.assign(code[3], Id {});
+
+            std::vector<uint32_t> variables;
+
+            for (size_t i = 5; i < words;)
+            {
+                uint16_t opcode = code[i] & 0xffff;
+                uint16_t count = code[i] >> 16;
+
+                if (count == 0 || i + count > words)
+                    throw Adore::AdoreException("SPIR-V instruction runs past the end of the module.");
+
+                uint32_t const * operands = &code[i + 1];
+                uint32_t operandCount = count - 1;
+
+                // Each of these defines operands[0] as its result, with nothing before it.
+                switch (opcode)
+                {
+                    case OP_DECORATE:
+                        if (operandCount >= 2 && operands[0] < m_ids.size())
+                            m_ids[operands[0]].decorations[operands[1]] = operandCount > 2 ? operands[2] : 0;
+                        break;
+                    case OP_MEMBER_DECORATE:
+                        if (operandCount >= 3 && operands[0] < m_ids.size())
+                            m_ids[operands[0]].memberDecorations[operands[1]][operands[2]] = operandCount > 3 ? operands[3] : 0;
+                        break;
+                    case OP_TYPE_BOOL:
+                    case OP_TYPE_INT:
+                    case OP_TYPE_FLOAT:
+                    case OP_TYPE_VECTOR:
+                    case OP_TYPE_MATRIX:
+                    case OP_TYPE_IMAGE:
+                    case OP_TYPE_SAMPLER:
+                    case OP_TYPE_SAMPLED_IMAGE:
+                    case OP_TYPE_ARRAY:
+                    case OP_TYPE_RUNTIME_ARRAY:
+                    case OP_TYPE_STRUCT:
+                    case OP_TYPE_POINTER:
+                        if (operandCount < 1 || operands[0] >= m_ids.size())
+                            throw Adore::AdoreException("SPIR-V type has an invalid id.");
+                        m_ids[operands[0]].opcode = opcode;
+                        m_ids[operands[0]].operands.assign(operands + 1, operands + operandCount);
+                        break;
+                    case OP_CONSTANT:
+                    case OP_SPEC_CONSTANT_TRUE:
+                    case OP_SPEC_CONSTANT_FALSE:
+                    case OP_SPEC_CONSTANT:
+                    case OP_VARIABLE:
+                        if (operandCount < 2 || operands[1] >= m_ids.size())
+                            throw Adore::AdoreException("SPIR-V value has an invalid id.");
+                        m_ids[operands[1]].opcode = opcode;
+                        m_ids[operands[1]].type = operands[0];
+                        m_ids[operands[1]].operands.assign(operands + 2, operands + operandCount);
+                        if (opcode == OP_VARIABLE) variables.push_back(operands[1]);
+                        break;
+                    default:
+                        break;
+                }
+
+                i += count;
+            }
+
+            ModuleReflection reflection;
+
+            for (uint32_t index = 0; index < m_ids.size(); index++)
+            {
+                auto const& value = m_ids[index];
+                bool specialization = value.opcode == OP_SPEC_CONSTANT || value.opcode == OP_SPEC_CONSTANT_TRUE
+                                   || value.opcode == OP_SPEC_CONSTANT_FALSE;
+
+                if (specialization && decorated(value, SPEC_ID))
+                    reflection.specializationConstants.push_back({ value.decorations.at(SPEC_ID),
+                                                                   size(value.type), m_stage });
+            }
+
+            for (auto index : variables)
+            {
+                auto const& variable = m_ids[index];
+                auto const& pointer = id(variable.type);
+                uint32_t storage = variable.operands[0];
+                uint32_t pointee = pointer.operands[1];
+
+                switch (storage)
+                {
+                    case INPUT:
+                        if (m_stage != Adore::ShaderType::VERTEX || decorated(variable, BUILT_IN)) break;
+                        // Built-in inputs declared as a block, such as gl_PerVertex, carry it on members.
+                        if (id(pointee).opcode == OP_TYPE_STRUCT) break;
+                        if (!decorated(variable, LOCATION))
+                            throw Adore::AdoreException("SPIR-V vertex input has no location.");
+                        reflection.inputs.push_back(input(variable.decorations.at(LOCATION), pointee));
+                        break;
+                    case PUSH_CONSTANT:
+                        reflection.pushConstants = std::max(reflection.pushConstants, size(pointee));
+                        break;
+                    case UNIFORM_CONSTANT:
+                    case UNIFORM:
+                    case STORAGE_BUFFER:
+                        reflection.resources.push_back(resource(variable, storage, pointee));
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            return reflection;
+        }
+    };
+
+    // The hash, the number of words and the stage, which ends up in the reflection.
+    using CacheKey = std::tuple<uint64_t, size_t, Adore::ShaderType>;
+
+    // The words are compared on a hit, modules whose hashes collide get an entry each.
+    struct CacheEntry
+    {
+        std::shared_ptr<uint32_t const> words;
+        ModuleReflection reflection;
+    };
+
+    std::mutex cacheMutex;
+    std::multimap<CacheKey, CacheEntry> cache;
+
+    ModuleReflection const * cached(SPIRV const& code, CacheKey const& key)
+    {
+        auto range = cache.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it)
+            if (code.equals(it->second.words.get(), code.count())) return &it->second.reflection;
+
+        return nullptr;
+    }
+
+    ModuleReflection const& reflectModule(Adore::ShaderModule const& module)
+    {
+        SPIRV code(module);
+        CacheKey key { code.hash(), code.count(), module.type };
+
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            if (auto pcached = cached(code, key)) return *pcached;
+        }
+
+        auto reflection = Parser(module.type).parse(code.words(), code.count());
+
+        // Entries are never erased, so the reference outlives the lock.
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (auto pcached = cached(code, key)) return *pcached;
+        return cache.emplace(key, CacheEntry { code.share(), std::move(reflection) })->second.reflection;
+    }
+}
+
+namespace Adore
+{
+    ShaderReflection reflect(std::vector<ShaderModule> const& modules)
+    {
+        ShaderReflection reflection {};
+        std::vector<Input> inputs;
+
+        for (auto const& module : modules)
+        {
+            auto const& part = reflectModule(module);
+
+            inputs.insert(inputs.end(), part.inputs.begin(), part.inputs.end());
+            reflection.descriptor.resources.insert(reflection.descriptor.resources.end(),
+                                                   part.resources.begin(), part.resources.end());
+            reflection.descriptor.pushConstants = std::max(reflection.descriptor.pushConstants, part.pushConstants);
+            reflection.specializationConstants.insert(reflection.specializationConstants.end(),
+                                                      part.specializationConstants.begin(),
+                                                      part.specializationConstants.end());
+        }
+
+        std::sort(inputs.begin(), inputs.end(), [](auto const& a, auto const& b) { return a.location < b.location; });
+
+        uint32_t offset = 0;
+        for (auto const& input : inputs)
+        {
+            reflection.descriptor.attributes.push_back({ 0, input.location, offset, input.format });
+            offset += input.size;
+        }
+
+        if (!inputs.empty())
+            reflection.descriptor.bindings.push_back({ 0, offset });
+
+        return reflection;
+    }
+}
@@ -0,0 +1,162 @@
+#include <Adore/RenderQueue.hpp>
+#include <Adore/Internal/Parallel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    // Below this every pass is cheaper than starting the threads.
+    size_t const PACKETS_PER_THREAD = 16384;
+
+    // Stable LSD radix sort, one byte per pass. Each thread histograms and scatters its own
+    // chunk, offsets are laid out digit by digit then thread by thread to keep it stable.
+    // Bytes every key has in common are skipped.
+    void radixSort(std::vector<Entry>& entries, uint64_t const& varying)
+    {
+        size_t const count = entries.size();
+        unsigned int threads = threadCount(count, PACKETS_PER_THREAD);
+
+        std::vector<Entry> scratch(count);
+        std::vector<std::array<size_t, 256>> offsets(threads);
+        Entry * src = entries.data();
+        Entry * dst = scratch.data();
+
+        for (unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            if (((varying >> shift) & 0xFF) == 0) continue;
+
+            parallel(threads, count, [&](unsigned int t, size_t begin, size_t end)
+            {
+                offsets[t].fill(0);
+                for (size_t i = begin; i < end; i++)
+                    offsets[t][(src[i].key >> shift) & 0xFF]++;
+            });
+
+            size_t offset = 0;
+            for (unsigned int digit = 0; digit < 256; digit++)
+            {
+                for (unsigned int t = 0; t < threads; t++)
+                {
+                    size_t size = offsets[t][digit];
+                    offsets[t][digit] = offset;
+                    offset += size;
+                }
+            }
+
+            parallel(threads, count, [&](unsigned int t, size_t begin, size_t end)
+            {
+                auto& bucket = offsets[t];
+                for (size_t i = begin; i < end; i++)
+                    dst[bucket[(src[i].key >> shift) & 0xFF]++] = src[i];
+            });
+
+            std::swap(src, dst);
+        }
+
+        if (src != entries.data())
+            std::copy(src, src + count, entries.data());
+    }
+
+    Adore::RenderQueue::StateChanges stateChanges(std::vector<Adore::DrawPacket> const& packets)
+    {
+        Adore::RenderQueue::StateChanges changes;
+        Adore::DrawPacket const * previous = nullptr;
+
+        for (auto const& packet : packets)
+        {
+            if (!previous || packet.shader != previous->shader) changes.shaders++;
+            if (!previous || packet.vertices != previous->vertices || packet.attributes != previous->attributes)
+                changes.vertexBuffers++;
+            if (packet.indices && (!previous || packet.indices != previous->indices)) changes.indexBuffers++;
+            previous = &packet;
+        }
+
+        return changes;
+    }
+}
+
+namespace Adore
+{
+    std::shared_ptr<RenderQueue> RenderQueue::create()
+    {
+        return std::make_shared<RenderQueue>();
+    }
+
+    uint64_t RenderQueue::key(uint8_t const& layer, uint16_t const& pipeline, uint32_t const& material,
+                              float const& depth)
+    {
+        uint64_t quantised = static_cast<uint64_t>(std::lround(std::clamp(depth, 0.0f, 1.0f) * 0xFFFFFF));
+
+        return static_cast<uint64_t>(layer) << 56
+             | static_cast<uint64_t>(pipeline & 0xFFF) << 44
+             | static_cast<uint64_t>(material & 0xFFFFF) << 24
+             | quantised;
+    }
+
+    RenderQueue::Writer::~Writer()
+    {
+        m_queue.append(m_packets);
+    }
+
+    void RenderQueue::append(std::vector<DrawPacket>& packets)
+    {
+        if (packets.empty()) return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.insert(m_packets.end(), packets.begin(), packets.end());
+        m_sorted = false;
+    }
+
+    void RenderQueue::submit(DrawPacket const& packet)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.push_back(packet);
+        m_sorted = false;
+    }
+
+    void RenderQueue::sort()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_sorted) return;
+
+        m_stats.packets = m_packets.size();
+        m_stats.unsorted = stateChanges(m_packets);
+
+        std::vector<Entry> entries(m_packets.size());
+        uint64_t any = 0, all = ~0ull;
+
+        for (size_t i = 0; i < m_packets.size(); i++)
+        {
+            entries[i] = { m_packets[i].key, static_cast<uint32_t>(i) };
+            any |= m_packets[i].key;
+            all &= m_packets[i].key;
+        }
+
+        radixSort(entries, any ^ all);
+
+        std::vector<DrawPacket> sorted;
+        sorted.reserve(m_packets.size());
+
+        for (auto const& entry : entries)
+            sorted.push_back(m_packets[entry.packet]);
+
+        m_packets.swap(sorted);
+        m_stats.sorted = stateChanges(m_packets);
+        m_sorted = true;
+    }
+
+    void RenderQueue::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.clear();
+        m_sorted = true;
+    }
+}
@@ -0,0 +1,21 @@
+#include <Adore/RenderTarget.hpp>
+
+#include <Adore/Internal/Vulkan/RenderTarget.hpp>
+#include <Adore/Internal/Log.hpp>
+
+namespace Adore
+{
+    std::shared_ptr<RenderTarget> RenderTarget::create(std::shared_ptr<Renderer>& renderer,
+                                                       uint32_t const& width, uint32_t const& height,
+                                                       ImageFormat const& format, bool const& depth,
+                                                       Filter const& filter, Wrap const& wrap)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanRenderTarget>(renderer, width, height, format, depth, filter, wrap);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+}
@@ -4,12 +4,12 @@
 
 namespace Adore
 {
-    std::shared_ptr<Renderer> Renderer::create(std::shared_ptr<Window>& win)
+    std::shared_ptr<Renderer> Renderer::create(std::shared_ptr<Window>& win, bool const& renderThread)
     {
         switch (win->context()->api)
         {
             case API::Vulkan:
-                return std::make_shared<VulkanRenderer>(win);
+                return std::make_shared<VulkanRenderer>(win, renderThread);
             default:
                 throw AdoreException("Unsupported API.");
         }
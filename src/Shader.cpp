@@ -1,18 +1,127 @@
 #include <Adore/Shader.hpp>
+#include <Adore/RenderTarget.hpp>
+#include <Adore/Reflection.hpp>
 #include <Adore/Internal/Log.hpp>
 #include <Adore/Internal/Vulkan/Shader.hpp>
 #include <Adore/Internal/Vulkan/Window.hpp>
+#include <Adore/Internal/Vulkan/RenderTarget.hpp>
+
+#include <algorithm>
 
 namespace Adore
 {
+    bool ShaderVariant::operator==(ShaderVariant const& other) const
+    {
+        return blend == other.blend && cull == other.cull && topology == other.topology
+            && depthTest == other.depthTest && depthWrite == other.depthWrite
+            && wireframe == other.wireframe && lineWidth == other.lineWidth
+            && specialization.size() == other.specialization.size()
+            && std::equal(specialization.begin(), specialization.end(), other.specialization.begin(),
+                          [](auto const& a, auto const& b) { return a.id == b.id && a.value == b.value; });
+    }
+
     std::shared_ptr<Shader> Shader::create(std::shared_ptr<Window>& win,
                                 std::vector<ShaderModule> const& modules,
-                                LayoutDescriptor const& descriptor)
+                                LayoutDescriptor const& descriptor,
+                                ShaderVariant const& variant)
+    {
+        switch (win->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanShader>(win, modules, descriptor, VK_NULL_HANDLE, false,
+                                                      pipelineState(variant));
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+
+    std::shared_ptr<Shader> Shader::create(std::shared_ptr<RenderTarget>& target,
+                                std::vector<ShaderModule> const& modules,
+                                LayoutDescriptor const& descriptor,
+                                ShaderVariant const& variant)
+    {
+        auto win = target->renderer()->window();
+
+        switch (win->context()->api)
+        {
+            case API::Vulkan:
+            {
+                auto ptarget = static_cast<VulkanRenderTarget*>(target.get());
+                return std::make_shared<VulkanShader>(win, modules, descriptor,
+                                                      ptarget->renderPass(), ptarget->depth(),
+                                                      pipelineState(variant));
+            }
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+
+    std::shared_ptr<Shader> Shader::createAsync(std::shared_ptr<Window>& win,
+                                ShaderDescription const& description)
+    {
+        switch (win->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanShader>(win, description.modules, description.descriptor,
+                                                      VK_NULL_HANDLE, false, pipelineState(description.variant),
+                                                      true);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+
+    std::shared_ptr<Shader> Shader::createAsync(std::shared_ptr<RenderTarget>& target,
+                                ShaderDescription const& description)
+    {
+        auto win = target->renderer()->window();
+
+        switch (win->context()->api)
+        {
+            case API::Vulkan:
+            {
+                auto ptarget = static_cast<VulkanRenderTarget*>(target.get());
+                return std::make_shared<VulkanShader>(win, description.modules, description.descriptor,
+                                                      ptarget->renderPass(), ptarget->depth(),
+                                                      pipelineState(description.variant), true);
+            }
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+
+    std::vector<std::shared_ptr<Shader>> Shader::createBatch(std::shared_ptr<Window>& win,
+                                std::vector<ShaderDescription> const& descriptions)
+    {
+        std::vector<std::shared_ptr<Shader>> shaders;
+        shaders.reserve(descriptions.size());
+
+        for (auto const& description : descriptions)
+            shaders.push_back(createAsync(win, description));
+
+        for (auto& shader : shaders)
+            shader->wait();
+
+        return shaders;
+    }
+
+    std::shared_ptr<Shader> Shader::create(std::shared_ptr<Window>& win,
+                                std::vector<ShaderModule> const& modules)
+    {
+        return create(win, modules, reflect(modules).descriptor);
+    }
+
+    std::shared_ptr<Shader> Shader::create(std::shared_ptr<RenderTarget>& target,
+                                std::vector<ShaderModule> const& modules)
+    {
+        return create(target, modules, reflect(modules).descriptor);
+    }
+
+    uint32_t Shader::preload(std::shared_ptr<Window>& win, std::string const& directory)
     {
         switch (win->context()->api)
         {
             case API::Vulkan:
-                return std::make_shared<VulkanShader>(win, modules, descriptor);
+                return static_cast<VulkanWindow*>(win.get())->modules().preload(directory);
             default:
                 throw AdoreException("Unsupported API.");
         }
@@ -0,0 +1,112 @@
+#include <Adore/ShaderVariants.hpp>
+#include <Adore/RenderTarget.hpp>
+
+#include <algorithm>
+
+namespace Adore
+{
+    static void combine(size_t& hash, uint64_t const& value)
+    {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+
+    size_t ShaderVariantHash::operator()(ShaderVariant const& variant) const
+    {
+        size_t hash = 0;
+        combine(hash, static_cast<uint64_t>(variant.blend));
+        combine(hash, static_cast<uint64_t>(variant.cull));
+        combine(hash, static_cast<uint64_t>(variant.topology));
+        combine(hash, (variant.depthTest ? 1 : 0) | (variant.depthWrite ? 2 : 0) | (variant.wireframe ? 4 : 0));
+        combine(hash, static_cast<uint64_t>(variant.lineWidth * 256.0f));
+
+        for (auto const& constant : variant.specialization)
+            combine(hash, static_cast<uint64_t>(constant.id) << 32 | constant.value);
+
+        return hash;
+    }
+
+    std::shared_ptr<ShaderVariants> ShaderVariants::create(std::shared_ptr<Window>& win,
+            std::vector<ShaderModule> const& modules, LayoutDescriptor const& descriptor)
+    {
+        return std::make_shared<ShaderVariants>(win, nullptr, modules, descriptor);
+    }
+
+    std::shared_ptr<ShaderVariants> ShaderVariants::create(std::shared_ptr<RenderTarget>& target,
+            std::vector<ShaderModule> const& modules, LayoutDescriptor const& descriptor)
+    {
+        return std::make_shared<ShaderVariants>(target->renderer()->window(), target, modules, descriptor);
+    }
+
+    std::shared_ptr<Shader> ShaderVariants::get(ShaderVariant const& variant, bool const& async)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_variants.find(variant);
+        if (it != m_variants.end()) return it->second;
+
+        ShaderDescription description { m_modules, m_descriptor, variant };
+        std::shared_ptr<Shader> shader;
+
+        // Later variants are derived so they can share the first one's pipeline.
+        if (m_base)
+            shader = m_base->derive(variant, async);
+        else if (async)
+            shader = m_target ? Shader::createAsync(m_target, description) : Shader::createAsync(m_win, description);
+        else
+            shader = m_target ? Shader::create(m_target, m_modules, m_descriptor, variant)
+                              : Shader::create(m_win, m_modules, m_descriptor, variant);
+
+        for (auto& uniform : m_uniforms) shader->attach(uniform.resource, uniform.binding);
+        for (auto& sampler : m_samplers) shader->attach(sampler.resource, sampler.binding);
+        for (auto& buffer : m_storageBuffers) shader->attach(buffer.resource, buffer.binding);
+        for (auto& image : m_storageImages) shader->attach(image.resource, image.binding);
+
+        if (!m_base) m_base = shader;
+        m_variants.emplace(variant, shader);
+        return shader;
+    }
+
+    template <typename T>
+    void ShaderVariants::attach(std::vector<Binding<T>>& bindings, std::shared_ptr<T>& resource,
+                                uint32_t const& binding)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (auto& variant : m_variants)
+            variant.second->attach(resource, binding);
+
+        auto it = std::find_if(bindings.begin(), bindings.end(),
+                               [binding](auto const& b) { return b.binding == binding; });
+
+        if (it != bindings.end())
+            it->resource = resource;
+        else
+            bindings.push_back({ binding, resource });
+    }
+
+    void ShaderVariants::attach(std::shared_ptr<UniformBuffer>& buffer, uint32_t const& binding)
+    {
+        attach(m_uniforms, buffer, binding);
+    }
+
+    void ShaderVariants::attach(std::shared_ptr<Sampler>& sampler, uint32_t const& binding)
+    {
+        attach(m_samplers, sampler, binding);
+    }
+
+    void ShaderVariants::attach(std::shared_ptr<StorageBuffer>& buffer, uint32_t const& binding)
+    {
+        attach(m_storageBuffers, buffer, binding);
+    }
+
+    void ShaderVariants::attach(std::shared_ptr<StorageImage>& image, uint32_t const& binding)
+    {
+        attach(m_storageImages, image, binding);
+    }
+
+    size_t ShaderVariants::size()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_variants.size();
+    }
+}
@@ -0,0 +1,29 @@
+#include <Adore/TextureStreamer.hpp>
+
+#include <Adore/Internal/Vulkan/TextureStreamer.hpp>
+#include <Adore/Internal/Log.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Adore
+{
+    uint32_t StreamedTexture::mipFor(float const& pixels) const
+    {
+        if (!(pixels > 1.0f)) return m_levels - 1;
+
+        float mip = std::floor(std::log2(std::max(m_width, m_height) / pixels));
+        return static_cast<uint32_t>(std::min(std::max(mip, 0.0f), static_cast<float>(m_levels - 1)));
+    }
+
+    std::shared_ptr<TextureStreamer> TextureStreamer::create(std::shared_ptr<Renderer>& renderer, uint64_t const& budget)
+    {
+        switch (renderer->window()->context()->api)
+        {
+            case API::Vulkan:
+                return std::make_shared<VulkanTextureStreamer>(renderer, budget);
+            default:
+                throw AdoreException("Unsupported API.");
+        }
+    }
+}
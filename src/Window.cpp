@@ -4,12 +4,13 @@
 
 namespace Adore
 {
-    std::shared_ptr<Window> Window::create(std::shared_ptr<Context>& ctx, std::string const& title)
+    std::shared_ptr<Window> Window::create(std::shared_ptr<Context>& ctx, std::string const& title,
+                                           uint32_t const& samples)
     {
         switch (ctx->api)
         {
             case API::Vulkan:
-                return std::make_shared<VulkanWindow>(ctx, title);
+                return std::make_shared<VulkanWindow>(ctx, title, samples);
             default:
                 throw AdoreException("Unsupported API.");
         }
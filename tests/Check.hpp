@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdio>
+
+// Tests are plain programs, a failed CHECK is printed and the test carries on so every failure
+// shows up in one run. main() returns failures() as the exit code.
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+#define CHECK(condition)                                                                    \
+    do                                                                                      \
+    {                                                                                       \
+        if (!(condition))                                                                   \
+        {                                                                                   \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);        \
+            failures()++;                                                                   \
+        }                                                                                   \
+    } while (false)
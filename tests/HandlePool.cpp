@@ -0,0 +1,85 @@
+#include "Check.hpp"
+
+#include <Adore/Internal/HandlePool.hpp>
+
+struct Resource;
+
+using Pool = HandlePool<Resource, int>;
+using Handle = Adore::Handle<Resource>;
+
+static uint32_t const GENERATIONS = 1u << (32 - Handle::INDEX_BITS);
+
+static void lookup()
+{
+    Pool pool;
+    Handle a = pool.insert(1), b = pool.insert(2), c = pool.insert(3);
+
+    CHECK(!a.null() && !b.null() && !c.null());
+    CHECK(pool.get(Handle {}) == nullptr);
+    CHECK(*pool.get(a) == 1 && *pool.get(b) == 2 && *pool.get(c) == 3);
+
+    // The last value is swapped into the hole, the others are still found.
+    pool.remove(a);
+    CHECK(pool.size() == 2);
+    CHECK(pool.get(a) == nullptr);
+    CHECK(*pool.get(b) == 2 && *pool.get(c) == 3);
+    CHECK(pool.data()[0] == 3 && pool.data()[1] == 2);
+
+    // Removing twice does nothing the second time.
+    pool.remove(a);
+    CHECK(pool.size() == 2);
+
+    // The slot is reused with the next generation, the old handle stays stale.
+    Handle d = pool.insert(4);
+    CHECK(d.index() == a.index());
+    CHECK(d.generation() == a.generation() + 1);
+    CHECK(pool.get(a) == nullptr);
+    CHECK(*pool.get(d) == 4);
+}
+
+static void wraparound()
+{
+    Pool pool;
+    Handle first = pool.insert(0);
+    Handle handle = first;
+
+    // Every generation of one slot, through the wrap back to the first.
+    for (uint32_t i = 1; i < GENERATIONS - 1; i++)
+    {
+        pool.remove(handle);
+        Handle next = pool.insert(static_cast<int>(i));
+
+        CHECK(!next.null());
+        CHECK(next.index() == first.index());
+        CHECK(next.generation() != 0);
+        CHECK(pool.get(handle) == nullptr);
+        CHECK(*pool.get(next) == static_cast<int>(i));
+        handle = next;
+    }
+
+    CHECK(handle.generation() == GENERATIONS - 1);
+
+    // 0 is skipped, so the first generation comes around again and its old handle is live.
+    pool.remove(handle);
+    Handle wrapped = pool.insert(-1);
+    CHECK(wrapped.generation() == 1);
+    CHECK(wrapped == first);
+    CHECK(pool.get(handle) == nullptr);
+}
+
+static void nullSlot()
+{
+    // Slot 0 at generation 1 is not the null handle either.
+    Pool pool;
+    Handle handle = pool.insert(7);
+    CHECK(handle.index() == 0);
+    CHECK(!handle.null());
+}
+
+int main()
+{
+    lookup();
+    wraparound();
+    nullSlot();
+    return failures();
+}
@@ -0,0 +1,140 @@
+#include "Check.hpp"
+
+#include <Adore/Quantize.hpp>
+#include <Adore/Internal/Quantize.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using Format = Adore::AttributeFormat;
+
+static float bitsToFloat(uint32_t const& bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void halfReference()
+{
+    float const inf = std::numeric_limits<float>::infinity();
+    float const nan = std::numeric_limits<float>::quiet_NaN();
+
+    CHECK(Adore::toHalf(0.0f) == 0x0000);
+    CHECK(Adore::toHalf(-0.0f) == 0x8000);
+    CHECK(Adore::toHalf(1.0f) == 0x3C00);
+    CHECK(Adore::toHalf(-2.0f) == 0xC000);
+    CHECK(Adore::toHalf(0.333333333f) == 0x3555);
+
+    // Ties round to even: 1 + 2^-11 is halfway between 0x3C00 and 0x3C01, 1 + 3 * 2^-11 between
+    // 0x3C01 and 0x3C02. Anything past halfway rounds up.
+    CHECK(Adore::toHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3C00);
+    CHECK(Adore::toHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3C02);
+    CHECK(Adore::toHalf(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)) == 0x3C01);
+    CHECK(Adore::toHalf(-1.0f - std::ldexp(1.0f, -11)) == 0xBC00);
+
+    // Subnormals, including their ties.
+    CHECK(Adore::toHalf(std::ldexp(1.0f, -14)) == 0x0400);
+    CHECK(Adore::toHalf(std::ldexp(1.0f, -24)) == 0x0001);
+    CHECK(Adore::toHalf(std::ldexp(1.0f, -25)) == 0x0000);
+    CHECK(Adore::toHalf(3.0f * std::ldexp(1.0f, -25)) == 0x0002);
+    CHECK(Adore::toHalf(-std::ldexp(1.0f, -24)) == 0x8001);
+    CHECK(Adore::toHalf(1e-10f) == 0x0000);
+
+    // 65504 is the largest half, 65520 is halfway to the next power of two and rounds to
+    // infinity with everything past it.
+    CHECK(Adore::toHalf(65504.0f) == 0x7BFF);
+    CHECK(Adore::toHalf(65519.0f) == 0x7BFF);
+    CHECK(Adore::toHalf(65520.0f) == 0x7C00);
+    CHECK(Adore::toHalf(1e6f) == 0x7C00);
+    CHECK(Adore::toHalf(-1e6f) == 0xFC00);
+    CHECK(Adore::toHalf(inf) == 0x7C00);
+    CHECK(Adore::toHalf(-inf) == 0xFC00);
+
+    // NaN stays NaN, quiet, whatever its payload.
+    CHECK(Adore::toHalf(nan) == 0x7E00);
+    CHECK(Adore::toHalf(-nan) == 0xFE00);
+    CHECK(Adore::toHalf(bitsToFloat(0x7F800001u)) == 0x7E00);
+}
+
+static void halfRoundTrip()
+{
+    for (uint32_t half = 0; half <= 0xFFFF; half++)
+    {
+        bool nan = (half & 0x7C00) == 0x7C00 && (half & 0x3FF) != 0;
+        if (nan) continue;
+
+        CHECK(Adore::toHalf(Adore::fromHalf(static_cast<uint16_t>(half))) == half);
+    }
+}
+
+// Every format quantize() writes, with its component count.
+static std::vector<std::pair<Format, uint32_t>> const FORMATS = {
+    { Format::FLOAT, 1 }, { Format::VEC2_FLOAT, 2 }, { Format::VEC3_FLOAT, 3 }, { Format::VEC4_FLOAT, 4 },
+    { Format::HALF, 1 }, { Format::VEC2_HALF, 2 }, { Format::VEC4_HALF, 4 },
+    { Format::VEC2_SNORM8, 2 }, { Format::VEC4_SNORM8, 4 }, { Format::VEC2_UNORM8, 2 }, { Format::VEC4_UNORM8, 4 },
+    { Format::VEC2_SNORM16, 2 }, { Format::VEC4_SNORM16, 4 }, { Format::VEC2_UNORM16, 2 }, { Format::VEC4_UNORM16, 4 },
+    { Format::A2B10G10R10_SNORM, 4 }, { Format::A2B10G10R10_UNORM, 4 }
+};
+
+// The SSE path has to write exactly what the scalar one does, padding between vertices included.
+static void compare(Format const& format, uint32_t const& components, std::vector<float> const& source)
+{
+    uint32_t const size = Adore::attributeSize(format);
+    uint32_t const stride = size + 3;
+    size_t const count = source.size() / components;
+
+    std::vector<unsigned char> simd(count * stride, 0xCD), scalar(count * stride, 0xCD);
+    Adore::quantize(format, simd.data(), stride, source.data(), components * sizeof(float), components, count);
+    quantizeScalar(format, scalar.data(), stride, source.data(), components * sizeof(float), components, count);
+
+    CHECK(simd == scalar);
+}
+
+static void simdMatchesScalar()
+{
+    float const inf = std::numeric_limits<float>::infinity();
+    float const nan = std::numeric_limits<float>::quiet_NaN();
+
+    // Out of range, non-finite, rounding ties of the normalised formats (0.5 / 255 and such)
+    // and half ties, then random values around the normalised range.
+    std::vector<float> values = {
+        0.0f, -0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 1e30f, -1e30f, inf, -inf, nan, -nan,
+        0.5f / 255.0f, 1.5f / 255.0f, 0.5f / 127.0f, -0.5f / 127.0f, 0.5f / 65535.0f, 2.5f / 1023.0f,
+        1.0f + std::ldexp(1.0f, -11), 1.0f + 3.0f * std::ldexp(1.0f, -11), 65520.0f, 65519.0f,
+        std::ldexp(1.0f, -25), 3.0f * std::ldexp(1.0f, -25)
+    };
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> range(-1.5f, 1.5f);
+    while (values.size() < 4 * 103) values.push_back(range(random));
+
+    for (auto const& [format, components] : FORMATS)
+    {
+        for (uint32_t given = 1; given <= components; given++)
+        {
+            // Counts that are not a multiple of four leave padding lanes in the last group.
+            size_t count = 103 - given;
+            std::vector<float> source(values.begin(), values.begin() + given * count);
+            compare(format, given, source);
+        }
+    }
+
+    // A sweep over float bit patterns for the halves, sign and all.
+    std::vector<float> sweep;
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFu; bits += 65521)
+        sweep.push_back(bitsToFloat(static_cast<uint32_t>(bits)));
+
+    compare(Format::HALF, 1, sweep);
+}
+
+int main()
+{
+    halfReference();
+    halfRoundTrip();
+    simdMatchesScalar();
+    return failures();
+}
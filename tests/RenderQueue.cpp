@@ -0,0 +1,63 @@
+#include "Check.hpp"
+
+#include <Adore/RenderQueue.hpp>
+
+#include <cstdint>
+#include <random>
+
+// Packets remember their submission order in count, which the sort must keep for equal keys.
+static bool sortedStably(std::vector<Adore::DrawPacket> const& packets)
+{
+    for (size_t i = 1; i < packets.size(); i++)
+    {
+        if (packets[i - 1].key > packets[i].key) return false;
+        if (packets[i - 1].key == packets[i].key && packets[i - 1].count > packets[i].count) return false;
+    }
+    return true;
+}
+
+static void sortKeys(std::vector<uint64_t> const& keys)
+{
+    Adore::RenderQueue queue;
+    for (size_t i = 0; i < keys.size(); i++)
+        queue.submit({ keys[i], nullptr, nullptr, nullptr, static_cast<uint32_t>(i) });
+
+    queue.sort();
+
+    CHECK(queue.packets().size() == keys.size());
+    CHECK(sortedStably(queue.packets()));
+}
+
+int main()
+{
+    std::mt19937_64 random(1);
+
+    // Few distinct keys, so most packets tie, with differences in low, middle and top bytes.
+    std::vector<uint64_t> few;
+    for (size_t i = 0; i < 1000; i++)
+        few.push_back((random() % 4) << 56 | (random() % 3) << 24 | (random() % 2));
+    sortKeys(few);
+
+    // Enough packets to sort on several threads, each byte pass has to stay stable across them.
+    std::vector<uint64_t> many;
+    for (size_t i = 0; i < 200000; i++)
+        many.push_back(Adore::RenderQueue::key(static_cast<uint8_t>(random() % 3), static_cast<uint16_t>(random() % 16),
+                                               static_cast<uint32_t>(random() % 64), 0.5f));
+    sortKeys(many);
+
+    // All keys equal, every byte is skipped and the order is left alone.
+    sortKeys(std::vector<uint64_t>(5000, 42));
+
+    // Submitting after a sort sorts again, clearing leaves nothing.
+    Adore::RenderQueue queue;
+    queue.submit({ 2, nullptr, nullptr, nullptr, 0 });
+    queue.sort();
+    queue.submit({ 1, nullptr, nullptr, nullptr, 1 });
+    queue.sort();
+    CHECK(queue.packets().size() == 2 && queue.packets()[0].key == 1);
+    queue.clear();
+    queue.sort();
+    CHECK(queue.packets().empty());
+
+    return failures();
+}
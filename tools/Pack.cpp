@@ -0,0 +1,176 @@
+#include <Adore/AssetPack.hpp>
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Packs loose assets into an Adore asset pack:
+//     AdorePack <output> <kind>:<name>=<file>...
+// Textures are decoded here so loading them is a copy, every other kind is stored as it is.
+static void usage()
+{
+    std::fprintf(stderr,
+        "Usage: AdorePack <output> <kind>:<name>=<file>...\n"
+        "Kinds:\n"
+        "  vert, frag, comp   SPIR-V of that stage\n"
+        "  vertices, indices  raw buffer contents\n"
+        "  texture            image decoded to RGBA8 sRGB\n"
+        "  texture-linear     image decoded to RGBA8 UNORM\n"
+        "  raw                anything else\n");
+}
+
+struct Input
+{
+    Adore::AssetEntry entry;
+    std::vector<char> data;
+};
+
+static std::vector<char> readFile(std::string const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Failed to open " + path);
+
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static Input load(std::string const& argument)
+{
+    size_t colon = argument.find(':');
+    size_t equals = argument.find('=', colon == std::string::npos ? 0 : colon);
+
+    if (colon == std::string::npos || equals == std::string::npos)
+        throw std::runtime_error("Expected <kind>:<name>=<file>, got " + argument);
+
+    std::string kind = argument.substr(0, colon);
+    std::string name = argument.substr(colon + 1, equals - colon - 1);
+    std::string path = argument.substr(equals + 1);
+
+    Input input {};
+    if (name.empty() || name.size() >= sizeof(input.entry.name))
+        throw std::runtime_error("Names must be 1 to " + std::to_string(sizeof(input.entry.name) - 1)
+                                 + " characters: " + name);
+
+    memcpy(input.entry.name, name.c_str(), name.size());
+
+    if (kind == "texture" || kind == "texture-linear")
+    {
+        int width, height, channels;
+        stbi_uc * pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) throw std::runtime_error("Failed to load image " + path);
+
+        input.entry.type = Adore::AssetType::TEXTURE;
+        input.entry.format = static_cast<uint32_t>(kind == "texture" ? Adore::ImageFormat::RGBA8_SRGB
+                                                                     : Adore::ImageFormat::RGBA8);
+        input.entry.width = width;
+        input.entry.height = height;
+        input.data.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+        return input;
+    }
+
+    input.data = readFile(path);
+
+    if (kind == "vert" || kind == "frag" || kind == "comp")
+    {
+        if (input.data.size() % sizeof(uint32_t) != 0)
+            throw std::runtime_error(path + " is not SPIR-V");
+
+        input.entry.type = Adore::AssetType::SHADER;
+        input.entry.format = static_cast<uint32_t>(kind == "vert" ? Adore::ShaderType::VERTEX
+                                                 : kind == "frag" ? Adore::ShaderType::FRAGMENT
+                                                                  : Adore::ShaderType::COMPUTE);
+    }
+    else if (kind == "vertices")
+        input.entry.type = Adore::AssetType::VERTICES;
+    else if (kind == "indices")
+        input.entry.type = Adore::AssetType::INDICES;
+    else if (kind == "raw")
+        input.entry.type = Adore::AssetType::RAW;
+    else
+        throw std::runtime_error("Unknown kind " + kind);
+
+    return input;
+}
+
+static void pad(std::ofstream& file, uint64_t& offset)
+{
+    static char const zeros[Adore::ASSET_PACK_ALIGNMENT] = {};
+
+    uint64_t padding = (Adore::ASSET_PACK_ALIGNMENT - offset % Adore::ASSET_PACK_ALIGNMENT) % Adore::ASSET_PACK_ALIGNMENT;
+    file.write(zeros, padding);
+    offset += padding;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc < 3)
+    {
+        usage();
+        return 1;
+    }
+
+    try
+    {
+        std::vector<Input> inputs;
+        for (int i = 2; i < argc; i++)
+            inputs.push_back(load(argv[i]));
+
+        // The runtime finds entries with a binary search.
+        std::sort(inputs.begin(), inputs.end(), [](Input const& a, Input const& b)
+                  { return strcmp(a.entry.name, b.entry.name) < 0; });
+
+        for (size_t i = 1; i < inputs.size(); i++)
+            if (strcmp(inputs[i - 1].entry.name, inputs[i].entry.name) == 0)
+                throw std::runtime_error("Duplicate name " + std::string(inputs[i].entry.name));
+
+        std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+        if (!file) throw std::runtime_error("Failed to create " + std::string(argv[1]));
+
+        Adore::AssetPackHeader header {};
+        memcpy(header.magic, Adore::ASSET_PACK_MAGIC, sizeof(header.magic));
+        header.version = Adore::ASSET_PACK_VERSION;
+        header.count = static_cast<uint32_t>(inputs.size());
+
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        uint64_t offset = sizeof(header);
+
+        uint64_t total = 0;
+        for (auto& input : inputs)
+        {
+            pad(file, offset);
+            input.entry.offset = offset;
+            input.entry.size = input.data.size();
+            file.write(input.data.data(), input.data.size());
+            offset += input.data.size();
+            total += input.data.size();
+        }
+
+        pad(file, offset);
+        header.toc = offset;
+
+        for (auto const& input : inputs)
+            file.write(reinterpret_cast<char const *>(&input.entry), sizeof(input.entry));
+
+        file.seekp(0);
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+        if (!file) throw std::runtime_error("Failed to write " + std::string(argv[1]));
+
+        std::printf("Packed %zu assets, %llu bytes, into %s\n", inputs.size(),
+                    static_cast<unsigned long long>(total), argv[1]);
+    }
+    catch (std::exception const& e)
+    {
+        std::fprintf(stderr, "AdorePack: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+#include <Adore/Adore.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Runs a capture written by Renderer::capture() and times every frame:
+//     AdoreReplay <capture> [--loops N] [--paced] [--frames] [--window] [--partial]
+// Frames go to a headless surface unless --window is given, so no display is needed. Resources
+// are made once up front, so only the frames' calls are timed. Captures that left calls out are
+// refused unless --partial is given, as their replay does less than the application did.
+static void usage()
+{
+    std::fprintf(stderr,
+        "Usage: AdoreReplay <capture> [options]\n"
+        "Options:\n"
+        "  --loops N   replay the captured frames N times, 1 by default\n"
+        "  --paced     wait out each frame's captured time instead of running flat out\n"
+        "  --frames    print every frame, not just the summary\n"
+        "  --window    present to a shown window instead of a headless surface\n"
+        "  --partial   replay captures that left calls out anyway\n");
+}
+
+class Reader
+{
+    std::vector<char> m_bytes;
+    size_t m_offset = 0;
+public:
+    Reader(std::string const& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Failed to open " + path);
+
+        m_bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void const * read(size_t const& size)
+    {
+        if (size > m_bytes.size() - m_offset) throw std::runtime_error("Capture is truncated");
+
+        void const * data = m_bytes.data() + m_offset;
+        m_offset += size;
+        return data;
+    }
+
+    template <typename T>
+    T read()
+    {
+        T value;
+        memcpy(&value, read(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> array(size_t const& count)
+    {
+        std::vector<T> values(count);
+        if (count) memcpy(values.data(), read(count * sizeof(T)), count * sizeof(T));
+        return values;
+    }
+
+    bool done() const { return m_offset == m_bytes.size(); }
+};
+
+// One call of a frame, with its resources looked up when the capture is loaded.
+struct Op
+{
+    Adore::CaptureRecord record;
+    std::shared_ptr<Adore::Shader> shader;
+    std::shared_ptr<Adore::UniformBuffer> uniform;
+    std::shared_ptr<Adore::Sampler> sampler;
+    Adore::VertexBufferHandle vertices;
+    // For indexed draws that started past the first index, the slice to draw and the buffer to
+    // bind again after it.
+    Adore::IndexBufferHandle indices;
+    Adore::IndexBufferHandle restore;
+    // Binding or count.
+    uint32_t value = 0;
+    uint32_t offset = 0;
+    std::vector<uint8_t> bytes;
+};
+
+struct Frame
+{
+    std::vector<Op> ops;
+    double capturedMs;
+};
+
+struct Capture
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t skipped = 0;
+    std::unordered_map<uint32_t, std::shared_ptr<Adore::Shader>> shaders;
+    std::unordered_map<uint32_t, std::shared_ptr<Adore::UniformBuffer>> uniforms;
+    std::unordered_map<uint32_t, std::shared_ptr<Adore::Sampler>> samplers;
+    std::unordered_map<uint32_t, std::shared_ptr<Adore::VertexBuffer>> vertexBuffers;
+    std::unordered_map<uint32_t, std::shared_ptr<Adore::IndexBuffer>> indexBuffers;
+    std::unordered_map<uint32_t, std::vector<uint8_t>> indexContents;
+    // Index buffer, first index and count of every slice.
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, std::shared_ptr<Adore::IndexBuffer>> slices;
+    // Uniform contents when the capture started, set again before every loop.
+    std::vector<std::pair<std::shared_ptr<Adore::UniformBuffer>, std::vector<uint8_t>>> initial;
+    std::vector<Frame> frames;
+};
+
+template <typename T>
+static std::shared_ptr<T> const& find(std::unordered_map<uint32_t, std::shared_ptr<T>> const& resources,
+                                      uint32_t const& id)
+{
+    auto found = resources.find(id);
+    if (found == resources.end()) throw std::runtime_error("Capture uses resource " + std::to_string(id)
+                                                           + " before writing it");
+    return found->second;
+}
+
+static std::shared_ptr<Adore::Shader> loadShader(Reader& reader, std::shared_ptr<Adore::Window>& window)
+{
+    std::vector<Adore::ShaderModule> modules(reader.read<uint32_t>());
+    for (auto& module : modules)
+    {
+        module.type = static_cast<Adore::ShaderType>(reader.read<uint32_t>());
+        module.code = reader.array<uint32_t>(reader.read<uint32_t>());
+    }
+
+    Adore::LayoutDescriptor descriptor;
+    descriptor.attributes = reader.array<Adore::AttributeLayout>(reader.read<uint32_t>());
+    descriptor.bindings = reader.array<Adore::BindingLayout>(reader.read<uint32_t>());
+    descriptor.resources = reader.array<Adore::ResourceLayout>(reader.read<uint32_t>());
+    descriptor.pushConstants = reader.read<uint32_t>();
+
+    Adore::ShaderVariant variant;
+    variant.blend = static_cast<Adore::BlendMode>(reader.read<uint32_t>());
+    variant.cull = static_cast<Adore::CullMode>(reader.read<uint32_t>());
+    variant.topology = static_cast<Adore::Topology>(reader.read<uint32_t>());
+    variant.depthTest = reader.read<uint8_t>();
+    variant.depthWrite = reader.read<uint8_t>();
+    variant.wireframe = reader.read<uint8_t>();
+    variant.lineWidth = reader.read<float>();
+    variant.specialization = reader.array<Adore::SpecializationValue>(reader.read<uint32_t>());
+
+    return Adore::Shader::create(window, modules, descriptor, variant);
+}
+
+static Capture load(std::string const& path, std::shared_ptr<Adore::Renderer>& renderer)
+{
+    Reader reader(path);
+
+    if (reader.read<uint32_t>() != Adore::CAPTURE_MAGIC)
+        throw std::runtime_error(path + " is not an Adore capture");
+    if (reader.read<uint32_t>() != Adore::CAPTURE_VERSION)
+        throw std::runtime_error(path + " was captured by another version of Adore");
+
+    Capture capture;
+    capture.width = reader.read<uint32_t>();
+    capture.height = reader.read<uint32_t>();
+
+    auto window = renderer->window();
+    window->resize(capture.width, capture.height);
+
+    Frame frame;
+    uint32_t boundIndices = 0;
+
+    while (!reader.done())
+    {
+        Op op;
+        op.record = static_cast<Adore::CaptureRecord>(reader.read<uint8_t>());
+
+        switch (op.record)
+        {
+            case Adore::CaptureRecord::VERTEX_BUFFER:
+            {
+                uint32_t id = reader.read<uint32_t>();
+                auto contents = reader.array<uint8_t>(reader.read<uint64_t>());
+                capture.vertexBuffers[id] = Adore::VertexBuffer::create(renderer, contents.data(), contents.size());
+                continue;
+            }
+            case Adore::CaptureRecord::INDEX_BUFFER:
+            {
+                uint32_t id = reader.read<uint32_t>();
+                auto contents = reader.array<uint8_t>(reader.read<uint64_t>());
+                capture.indexBuffers[id] = Adore::IndexBuffer::create(renderer, contents.data(), contents.size());
+                capture.indexContents[id] = std::move(contents);
+                continue;
+            }
+            case Adore::CaptureRecord::UNIFORM_BUFFER:
+            {
+                uint32_t id = reader.read<uint32_t>();
+                auto contents = reader.array<uint8_t>(reader.read<uint64_t>());
+                auto uniform = Adore::UniformBuffer::create(renderer, contents.data(), contents.size());
+                capture.uniforms[id] = uniform;
+                capture.initial.push_back({ uniform, std::move(contents) });
+                continue;
+            }
+            case Adore::CaptureRecord::TEXTURE:
+            {
+                uint32_t id = reader.read<uint32_t>();
+                uint32_t width = reader.read<uint32_t>();
+                uint32_t height = reader.read<uint32_t>();
+                auto format = static_cast<Adore::ImageFormat>(reader.read<uint32_t>());
+                auto filter = static_cast<Adore::Filter>(reader.read<uint32_t>());
+                auto wrap = static_cast<Adore::Wrap>(reader.read<uint32_t>());
+                uint32_t pixelSize = format == Adore::ImageFormat::RGBA32_FLOAT ? 16
+                                   : format == Adore::ImageFormat::RGBA16_FLOAT ? 8 : 4;
+                void const * pixels = reader.read(static_cast<size_t>(width) * height * pixelSize);
+                capture.samplers[id] = Adore::Sampler::create(renderer, pixels, width, height, format, filter, wrap);
+                continue;
+            }
+            case Adore::CaptureRecord::SHADER:
+            {
+                uint32_t id = reader.read<uint32_t>();
+                capture.shaders[id] = loadShader(reader, window);
+                continue;
+            }
+            case Adore::CaptureRecord::ATTACH_UNIFORM:
+                op.shader = find(capture.shaders, reader.read<uint32_t>());
+                op.value = reader.read<uint32_t>();
+                op.uniform = find(capture.uniforms, reader.read<uint32_t>());
+                break;
+            case Adore::CaptureRecord::ATTACH_SAMPLER:
+                op.shader = find(capture.shaders, reader.read<uint32_t>());
+                op.value = reader.read<uint32_t>();
+                op.sampler = find(capture.samplers, reader.read<uint32_t>());
+                break;
+            case Adore::CaptureRecord::SET_UNIFORM:
+                op.uniform = find(capture.uniforms, reader.read<uint32_t>());
+                op.bytes = reader.array<uint8_t>(reader.read<uint64_t>());
+                break;
+            case Adore::CaptureRecord::BEGIN:
+                op.shader = find(capture.shaders, reader.read<uint32_t>());
+                break;
+            case Adore::CaptureRecord::END:
+                break;
+            case Adore::CaptureRecord::BIND_VERTEX:
+                op.vertices = find(capture.vertexBuffers, reader.read<uint32_t>())->handle();
+                op.value = reader.read<uint32_t>();
+                break;
+            case Adore::CaptureRecord::BIND_INDEX:
+                boundIndices = reader.read<uint32_t>();
+                op.indices = find(capture.indexBuffers, boundIndices)->handle();
+                break;
+            case Adore::CaptureRecord::DRAW:
+                op.value = reader.read<uint32_t>();
+                break;
+            case Adore::CaptureRecord::DRAW_INDEXED:
+            {
+                op.value = reader.read<uint32_t>();
+                uint32_t firstIndex = reader.read<uint32_t>();
+                if (!firstIndex) break;
+
+                // Renderer::drawIndexed() always starts at the first index, so the range is copied out.
+                auto& slice = capture.slices[std::make_tuple(boundIndices, firstIndex, op.value)];
+                if (!slice)
+                {
+                    auto const& contents = capture.indexContents[boundIndices];
+                    size_t offset = static_cast<size_t>(firstIndex) * sizeof(uint16_t);
+                    size_t size = static_cast<size_t>(op.value) * sizeof(uint16_t);
+                    if (offset + size > contents.size())
+                        throw std::runtime_error("Indexed draw past the end of its index buffer");
+
+                    std::vector<uint8_t> indices(contents.begin() + offset, contents.begin() + offset + size);
+                    slice = Adore::IndexBuffer::create(renderer, indices.data(), indices.size());
+                }
+
+                op.indices = slice->handle();
+                op.restore = capture.indexBuffers[boundIndices]->handle();
+                break;
+            }
+            case Adore::CaptureRecord::PUSH:
+                op.offset = reader.read<uint32_t>();
+                op.bytes = reader.array<uint8_t>(reader.read<uint32_t>());
+                break;
+            case Adore::CaptureRecord::FRAME:
+                frame.capturedMs = reader.read<double>();
+                capture.frames.push_back(std::move(frame));
+                frame = Frame();
+                continue;
+            case Adore::CaptureRecord::SKIPPED:
+                capture.skipped = reader.read<uint64_t>();
+                continue;
+            default:
+                throw std::runtime_error("Unknown record " + std::to_string(static_cast<uint32_t>(op.record)));
+        }
+
+        frame.ops.push_back(std::move(op));
+    }
+
+    return capture;
+}
+
+static void run(std::shared_ptr<Adore::Renderer>& renderer, Frame& frame)
+{
+    for (auto& op : frame.ops)
+    {
+        switch (op.record)
+        {
+            case Adore::CaptureRecord::ATTACH_UNIFORM:
+                op.shader->attach(op.uniform, op.value);
+                break;
+            case Adore::CaptureRecord::ATTACH_SAMPLER:
+                op.shader->attach(op.sampler, op.value);
+                break;
+            case Adore::CaptureRecord::SET_UNIFORM:
+                op.uniform->set(op.bytes.data());
+                break;
+            case Adore::CaptureRecord::BEGIN:
+                renderer->begin(op.shader);
+                break;
+            case Adore::CaptureRecord::END:
+                renderer->end();
+                break;
+            case Adore::CaptureRecord::BIND_VERTEX:
+                renderer->bind(op.vertices, op.value);
+                break;
+            case Adore::CaptureRecord::BIND_INDEX:
+                renderer->bind(op.indices);
+                break;
+            case Adore::CaptureRecord::DRAW:
+                renderer->draw(op.value);
+                break;
+            case Adore::CaptureRecord::DRAW_INDEXED:
+                if (op.indices.null())
+                {
+                    renderer->drawIndexed(op.value);
+                    break;
+                }
+                renderer->bind(op.indices);
+                renderer->drawIndexed(op.value);
+                renderer->bind(op.restore);
+                break;
+            case Adore::CaptureRecord::PUSH:
+                renderer->push(op.bytes.data(), static_cast<uint32_t>(op.bytes.size()), op.offset);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static double percentile(std::vector<double> values, double const& fraction)
+{
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(fraction * (values.size() - 1) + 0.5)];
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc < 2)
+    {
+        usage();
+        return 1;
+    }
+
+    std::string path;
+    unsigned int loops = 1;
+    bool paced = false;
+    bool everyFrame = false;
+    bool headless = true;
+    bool partial = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--loops" && i + 1 < argc)
+            loops = std::max(1, std::atoi(argv[++i]));
+        else if (argument == "--paced")
+            paced = true;
+        else if (argument == "--frames")
+            everyFrame = true;
+        else if (argument == "--window")
+            headless = false;
+        else if (argument == "--partial")
+            partial = true;
+        else if (path.empty() && argument.rfind("--", 0) != 0)
+            path = argument;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if (path.empty())
+    {
+        usage();
+        return 1;
+    }
+
+    try
+    {
+        auto context = Adore::Context::create(Adore::API::Vulkan, "AdoreReplay", headless);
+        auto window = Adore::Window::create(context, "AdoreReplay");
+        auto renderer = Adore::Renderer::create(window);
+
+        Capture capture = load(path, renderer);
+        if (capture.frames.empty()) throw std::runtime_error(path + " holds no frames");
+
+        if (capture.skipped && !partial)
+            throw std::runtime_error(path + " left " + std::to_string(capture.skipped)
+                                     + " calls out, pass --partial to replay it anyway");
+
+        std::vector<double> cpuMs;
+        std::vector<double> gpuMs;
+        double capturedMs = 0.0;
+
+        for (unsigned int loop = 0; loop < loops && window->is_open(); loop++)
+        {
+            for (auto& uniform : capture.initial)
+                uniform.first->set(uniform.second.data());
+
+            for (size_t i = 0; i < capture.frames.size() && window->is_open(); i++)
+            {
+                Frame& frame = capture.frames[i];
+                window->poll();
+
+                auto start = std::chrono::steady_clock::now();
+                run(renderer, frame);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                if (paced && ms < frame.capturedMs)
+                    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(frame.capturedMs - ms));
+
+                cpuMs.push_back(ms);
+                gpuMs.push_back(renderer->gpuTime());
+                capturedMs += frame.capturedMs;
+
+                if (everyFrame)
+                    std::printf("frame %zu: cpu %.3f ms, gpu %.3f ms, captured %.3f ms\n",
+                                cpuMs.size() - 1, ms, gpuMs.back(), frame.capturedMs);
+            }
+        }
+
+        renderer->finish();
+
+        if (cpuMs.empty()) throw std::runtime_error("The window was closed before a frame was replayed");
+
+        double cpuMean = 0.0;
+        double gpuMean = 0.0;
+        for (size_t i = 0; i < cpuMs.size(); i++)
+        {
+            cpuMean += cpuMs[i] / cpuMs.size();
+            gpuMean += gpuMs[i] / gpuMs.size();
+        }
+
+        std::printf("%s: %zu frames\n", path.c_str(), cpuMs.size());
+        std::printf("  cpu      mean %.3f ms, median %.3f ms, p95 %.3f ms\n",
+                    cpuMean, percentile(cpuMs, 0.5), percentile(cpuMs, 0.95));
+        std::printf("  gpu      mean %.3f ms, median %.3f ms, p95 %.3f ms\n",
+                    gpuMean, percentile(gpuMs, 0.5), percentile(gpuMs, 0.95));
+        std::printf("  captured mean %.3f ms\n", capturedMs / cpuMs.size());
+
+        if (capture.skipped)
+            std::printf("  %llu captured calls were left out, the replay does less than the application did\n",
+                        static_cast<unsigned long long>(capture.skipped));
+    }
+    catch (std::exception const& e)
+    {
+        std::fprintf(stderr, "AdoreReplay: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}